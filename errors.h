@@ -12,6 +12,9 @@ typedef enum graph_res_e {
     GRAPH_ERR_MEM,
     GRAPH_ERR_FOUND,
     GRAPH_ERR_NOT_FOUND,
+    GRAPH_ERR_OVERFLOW,
+    GRAPH_ERR_IO,
+    GRAPH_ERR_FORMAT,
 
 } graph_res_t;
 
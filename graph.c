@@ -1,6 +1,348 @@
 #include <malloc.h>
+#include <sched.h>
 #include <stdio.h>
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include "graph.h"
+#include "graph_parallel.h"
+#include "graph_sort.h"
+
+/* The amount of matrix entries worth a thread of their own when filling an adjacency matrix. */
+#define GRAPH_MATRIX_GRAIN  (1 << 20)
+
+/**
+ * @brief   Find the edge from a vertex to a given neighbor using the neighbor index of the vertex.
+ * @param   v       The vertex.
+ * @param   d_id    The id of the neighbor.
+ * @return  The edge (v, d_id), or NULL if there is no such edge.
+ */
+struct graph_edge *graph_neighbor_find(struct graph_vertex *v, uint64_t d_id) {
+    size_t i = 0;
+
+    if (v->neighbor_index.is_hashed) {
+        return graph_hash_find(&v->neighbor_index.u.hashed, d_id);
+    }
+
+    for (i = 0; i < v->neighbor_count; ++i) {
+        if (d_id == v->neighbor_index.u.inline_edges[i]->d_id) {
+            return v->neighbor_index.u.inline_edges[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief   Move the neighbor index of a vertex from the inline array to a hash table.
+ * @param   g           The graph.
+ * @param   v           The vertex (its index must be inline).
+ * @param   capacity    The amount of neighbors the hash table should have room for.
+ * @return  GRAPH_ERR_SUCCESS on success, on failure the inline array is left intact.
+ */
+static graph_res_t graph_neighbor_index_promote(struct graph *g, struct graph_vertex *v, size_t capacity) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_hash hashed;
+    size_t i = 0;
+
+    graph_hash_init(&hashed, &g->allocator);
+
+    if (capacity < (GRAPH_NEIGHBOR_INLINE_MAX * 2)) {
+        capacity = GRAPH_NEIGHBOR_INLINE_MAX * 2;
+    }
+    res = graph_hash_reserve(&hashed, capacity);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    for (i = 0; i < v->neighbor_count; ++i) {
+        res = graph_hash_insert(&hashed, v->neighbor_index.u.inline_edges[i]->d_id,
+                                v->neighbor_index.u.inline_edges[i]);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+    }
+
+    /* Transfer ownership, the hash table overlaps the inline array. */
+    v->neighbor_index.u.hashed = hashed;
+    v->neighbor_index.is_hashed = true;
+    graph_hash_init(&hashed, &g->allocator);
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    graph_hash_destroy(&hashed);
+    return res;
+}
+
+/**
+ * @brief   Make sure the neighbor index of a vertex has room for more neighbors without growing.
+ * @param   g       The graph.
+ * @param   v       The vertex.
+ * @param   count   The amount of neighbors about to be attached.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+static graph_res_t graph_neighbor_index_reserve(struct graph *g, struct graph_vertex *v, size_t count) {
+    if (v->neighbor_index.is_hashed) {
+        return graph_hash_reserve(&v->neighbor_index.u.hashed, v->neighbor_count + count);
+    }
+    if ((v->neighbor_count + count) > GRAPH_NEIGHBOR_INLINE_MAX) {
+        return graph_neighbor_index_promote(g, v, v->neighbor_count + count);
+    }
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/**
+ * @brief   Move the neighbor index of a vertex from its hash table back to the inline array.
+ * @param   v   The vertex (must have at most GRAPH_NEIGHBOR_INLINE_MAX neighbors).
+ */
+static void graph_neighbor_index_demote(struct graph_vertex *v) {
+    struct graph_edge *edges[GRAPH_NEIGHBOR_INLINE_MAX];
+    struct graph_hash *hashed = &v->neighbor_index.u.hashed;
+    size_t count = 0;
+    size_t i = 0;
+
+    for (i = 0; i < hashed->capacity; ++i) {
+        if (NULL != hashed->entries[i].value) {
+            edges[count++] = hashed->entries[i].value;
+        }
+    }
+
+    graph_hash_destroy(hashed);
+    v->neighbor_index.is_hashed = false;
+    for (i = 0; i < count; ++i) {
+        v->neighbor_index.u.inline_edges[i] = edges[i];
+    }
+}
+
+/**
+ * @brief   Attach an edge to the neighbors of its source vertex.
+ * @param   g   The graph.
+ * @param   v   The source vertex of the edge.
+ * @param   e   The edge, must not be connected to v already.
+ * @return  GRAPH_ERR_SUCCESS on success, on failure the vertex is left untouched.
+ */
+static graph_res_t graph_attach_edge(struct graph *g, struct graph_vertex *v, struct graph_edge *e) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+
+    if ((!v->neighbor_index.is_hashed) && (GRAPH_NEIGHBOR_INLINE_MAX == v->neighbor_count)) {
+        res = graph_neighbor_index_promote(g, v, GRAPH_NEIGHBOR_INLINE_MAX * 2);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+    }
+
+    if (v->neighbor_index.is_hashed) {
+        res = graph_hash_insert(&v->neighbor_index.u.hashed, e->d_id, e);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+    } else {
+        v->neighbor_index.u.inline_edges[v->neighbor_count] = e;
+    }
+
+    GRAPH_LIST_PUBLISH_HEAD(&v->neighbors, e, next);
+    v->neighbor_count++;
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    return res;
+}
+
+/**
+ * @brief   Detach an edge from the neighbors of its source vertex.
+ * @param   v   The source vertex of the edge.
+ * @param   e   The edge, must be connected to v.
+ */
+static void graph_detach_edge(struct graph_vertex *v, struct graph_edge *e) {
+    size_t i = 0;
+
+    if (v->neighbor_index.is_hashed) {
+        (void)graph_hash_remove(&v->neighbor_index.u.hashed, e->d_id);
+
+        /* Shrink back only well below the threshold so a vertex around it doesn't flip on every change. */
+        if ((v->neighbor_count - 1) <= (GRAPH_NEIGHBOR_INLINE_MAX / 2)) {
+            graph_neighbor_index_demote(v);
+        }
+    } else {
+        /* Swap with the last inline edge to keep the array packed. */
+        for (i = 0; i < v->neighbor_count; ++i) {
+            if (e == v->neighbor_index.u.inline_edges[i]) {
+                v->neighbor_index.u.inline_edges[i] = v->neighbor_index.u.inline_edges[v->neighbor_count - 1];
+                break;
+            }
+        }
+    }
+
+    GRAPH_LIST_UNPUBLISH(e, next);
+    v->neighbor_count--;
+}
+
+/**
+ * @brief   The shard of a vertex while concurrent writes are enabled.
+ * @param   g   The graph.
+ * @param   id  The id of the vertex.
+ * @return  The shard, or NULL if the graph isn't sharded.
+ */
+static struct graph_shard *graph_shard_of(struct graph *g, uint64_t id) {
+    if (NULL == g->shards) {
+        return NULL;
+    }
+
+    /* Fibonacci hashing, the middle bits of the product are well mixed even for sequential ids. */
+    return &g->shards[((id * 0x9E3779B97F4A7C15ULL) >> 32) & (GRAPH_SHARD_COUNT - 1)];
+}
+
+/**
+ * @brief   The index a vertex is (or would be) in.
+ * @param   g   The graph.
+ * @param   id  The id of the vertex.
+ * @return  The index.
+ */
+static struct graph_hash *graph_vertex_index_of(struct graph *g, uint64_t id) {
+    struct graph_shard *shard = graph_shard_of(g, id);
+
+    return (NULL == shard) ? &g->vertex_index : &shard->vertex_index;
+}
+
+/**
+ * @brief   The pool a vertex is allocated from.
+ * @param   g   The graph.
+ * @param   id  The id of the vertex.
+ * @return  The pool.
+ */
+static struct graph_pool *graph_vertex_pool_of(struct graph *g, uint64_t id) {
+    struct graph_shard *shard = graph_shard_of(g, id);
+
+    return (NULL == shard) ? &g->vertex_pool : &shard->vertex_pool;
+}
+
+/**
+ * @brief   The pool an edge is allocated from, the one of its source vertex.
+ * @param   g       The graph.
+ * @param   s_id    The id of the source vertex of the edge.
+ * @return  The pool.
+ */
+static struct graph_pool *graph_edge_pool_of(struct graph *g, uint64_t s_id) {
+    struct graph_shard *shard = graph_shard_of(g, s_id);
+
+    return (NULL == shard) ? &g->edge_pool : &shard->edge_pool;
+}
+
+/**
+ * @brief   Lock the shards of the two ends of an edge, the lower one first (a no-op if the graph isn't sharded).
+ * @param   g       The graph.
+ * @param   s_id    The id of the first vertex.
+ * @param   d_id    The id of the second vertex.
+ */
+static void graph_lock_pair(struct graph *g, uint64_t s_id, uint64_t d_id) {
+    struct graph_shard *first = graph_shard_of(g, s_id);
+    struct graph_shard *second = graph_shard_of(g, d_id);
+    struct graph_shard *swap = NULL;
+
+    if (NULL == first) {
+        return;
+    }
+
+    if (second < first) {
+        swap = first;
+        first = second;
+        second = swap;
+    }
+    (void)pthread_mutex_lock(&first->lock);
+    if (second != first) {
+        (void)pthread_mutex_lock(&second->lock);
+    }
+}
+
+/**
+ * @brief   Unlock the shards locked by graph_lock_pair.
+ * @param   g       The graph.
+ * @param   s_id    The id of the first vertex.
+ * @param   d_id    The id of the second vertex.
+ */
+static void graph_unlock_pair(struct graph *g, uint64_t s_id, uint64_t d_id) {
+    struct graph_shard *first = graph_shard_of(g, s_id);
+    struct graph_shard *second = graph_shard_of(g, d_id);
+
+    if (NULL == first) {
+        return;
+    }
+
+    if (second != first) {
+        (void)pthread_mutex_unlock(&second->lock);
+    }
+    (void)pthread_mutex_unlock(&first->lock);
+}
+
+/**
+ * @brief   Lock every shard, in order (a no-op if the graph isn't sharded).
+ * @param   g   The graph.
+ */
+static void graph_lock_all(struct graph *g) {
+    size_t i = 0;
+
+    for (i = 0; (NULL != g->shards) && (i < GRAPH_SHARD_COUNT); ++i) {
+        (void)pthread_mutex_lock(&g->shards[i].lock);
+    }
+}
+
+/**
+ * @brief   Unlock the shards locked by graph_lock_all.
+ * @param   g   The graph.
+ */
+static void graph_unlock_all(struct graph *g) {
+    size_t i = 0;
+
+    for (i = GRAPH_SHARD_COUNT; (NULL != g->shards) && (i > 0); --i) {
+        (void)pthread_mutex_unlock(&g->shards[i - 1].lock);
+    }
+}
+
+/**
+ * @brief   Lock the vertices list of the graph (a no-op if the graph isn't sharded).
+ * @param   g   The graph.
+ */
+static void graph_lock_list(struct graph *g) {
+    if (NULL != g->shards) {
+        (void)pthread_mutex_lock(&g->list_lock);
+    }
+}
+
+/**
+ * @brief   Unlock the vertices list locked by graph_lock_list.
+ * @param   g   The graph.
+ */
+static void graph_unlock_list(struct graph *g) {
+    if (NULL != g->shards) {
+        (void)pthread_mutex_unlock(&g->list_lock);
+    }
+}
+
+/**
+ * @brief   Remove an edge from the graph and free it, along with its twin in an undirectional graph.
+ * @param   g   The graph.
+ * @param   e   The edge.
+ *
+ * @note    Room for retiring both edges must have been reserved (see graph_epoch_reserve).
+ */
+static void graph_unlink_edge(struct graph *g, struct graph_edge *e) {
+    graph_conn_remove_edge(g, e);
+    graph_detach_edge(e->s, e);
+
+    if (g->is_directional) {
+        GRAPH_LIST_UNPUBLISH(e, in_next);
+        e->d->in_neighbor_count--;
+    } else if (NULL != e->twin) {
+        graph_detach_edge(e->d, e->twin);
+        graph_epoch_retire(&g->epoch, graph_edge_pool_of(g, e->d_id), e->twin);
+    }
+
+    graph_epoch_retire(&g->epoch, graph_edge_pool_of(g, e->s_id), e);
+}
 
 /**
  * @brief   Checks if s is connected to d, if so, return the connecting edge in e.
@@ -13,379 +355,1018 @@ bool graph_is_connected(struct graph_vertex *s, struct graph_vertex *d, struct g
     bool res = false;
     struct graph_edge *curr_edge = NULL;
 
-    /* Parameter check. */
-    if ((NULL == s) || (NULL == d)) {
+    /* Parameter check. */
+    if ((NULL == s) || (NULL == d)) {
+        goto cleanup;
+    }
+
+    /* Check if d is in the neighbor index of s. */
+    curr_edge = graph_neighbor_find(s, d->id);
+    if (NULL != curr_edge) {
+        res = true;
+        if (NULL != e) {
+            *e = curr_edge;
+        }
+    }
+
+    cleanup:
+    return res;
+}
+
+/**
+ * @brief   Find a vertex of the graph by its id.
+ * @param   g   The graph.
+ * @param   id  The id of the vertex.
+ * @return  The vertex, or NULL if there is no such vertex.
+ */
+struct graph_vertex *graph_find_vertex(struct graph *g, uint64_t id) {
+    return graph_hash_find(graph_vertex_index_of(g, id), id);
+}
+
+/**
+ * @brief   Release the memory the vertices of the graph own outside of the slabs.
+ * @param   g   The graph.
+ *
+ * @note    The vertices and edges themselves are left in place, to be released with their pools.
+ */
+static void graph_release_vertices(struct graph *g) {
+    struct graph_vertex *v = NULL;
+
+    /* Only the hashed neighbor indexes own memory outside the slabs. */
+    LIST_FOREACH(v, &g->vertices, next) {
+        if (v->neighbor_index.is_hashed) {
+            graph_hash_destroy(&v->neighbor_index.u.hashed);
+        }
+    }
+}
+
+/** @see graph.h */
+graph_res_t GRAPH_init(bool is_directional, struct graph **g) {
+    return GRAPH_init_ex(is_directional, NULL, g);
+}
+
+/** @see graph.h */
+graph_res_t GRAPH_init_ex(bool is_directional, const struct graph_allocator *allocator, struct graph **g) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph *local_graph = NULL;
+
+    /* Parameter check. */
+    if (NULL == g) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+    if (NULL == allocator) {
+        allocator = &graph_allocator_default;
+    }
+    if ((NULL == allocator->alloc) || (NULL == allocator->free)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    /* Allocate memory for the g. */
+    local_graph = allocator->alloc(allocator->ctx, sizeof(*local_graph));
+    if (NULL == local_graph) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+
+    /* Initialize fields. */
+    local_graph->is_directional = is_directional;
+    local_graph->vertex_count = 0;
+    LIST_INIT(&local_graph->vertices);
+    local_graph->allocator = *allocator;
+    graph_hash_init(&local_graph->vertex_index, &local_graph->allocator);
+    graph_pool_init(&local_graph->vertex_pool, &local_graph->allocator, sizeof(struct graph_vertex));
+    graph_pool_init(&local_graph->edge_pool, &local_graph->allocator, sizeof(struct graph_edge));
+    graph_epoch_init(&local_graph->epoch, &local_graph->allocator);
+    local_graph->shards = NULL;
+    (void)pthread_mutex_init(&local_graph->list_lock, NULL);
+    graph_conn_init(&local_graph->conn, &local_graph->allocator);
+
+    /* Transfer ownership and indicate success. */
+    *g = local_graph;
+    local_graph = NULL;
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    if (NULL != local_graph) {
+        allocator->free(allocator->ctx, local_graph, sizeof(*local_graph));
+    }
+
+    return res;
+}
+
+/**
+ * @brief   Release the shards of the graph, along with the vertices and edges allocated from them.
+ * @param   g   The graph.
+ */
+static void graph_release_shards(struct graph *g) {
+    size_t i = 0;
+
+    if (NULL == g->shards) {
+        return;
+    }
+
+    for (i = 0; i < GRAPH_SHARD_COUNT; ++i) {
+        graph_pool_destroy(&g->shards[i].edge_pool);
+        graph_pool_destroy(&g->shards[i].vertex_pool);
+        graph_hash_destroy(&g->shards[i].vertex_index);
+        (void)pthread_mutex_destroy(&g->shards[i].lock);
+    }
+    g->allocator.free(g->allocator.ctx, g->shards, sizeof(*g->shards) * GRAPH_SHARD_COUNT);
+    g->shards = NULL;
+}
+
+/** @see graph.h */
+graph_res_t GRAPH_destroy(struct graph *g) {
+    struct graph_allocator allocator;
+
+    /* Parameter check. */
+    if (NULL == g) {
+        return GRAPH_ERR_PARAMS;
+    }
+
+    graph_release_vertices(g);
+
+    /* Release the vertices and edges a slab at a time. */
+    graph_release_shards(g);
+    graph_pool_destroy(&g->edge_pool);
+    graph_pool_destroy(&g->vertex_pool);
+    graph_hash_destroy(&g->vertex_index);
+    graph_epoch_destroy(&g->epoch);
+    (void)pthread_mutex_destroy(&g->list_lock);
+    graph_conn_destroy(&g->conn);
+
+    /* Free the graph. */
+    allocator = g->allocator;
+    allocator.free(allocator.ctx, g, sizeof(*g));
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph.h */
+graph_res_t GRAPH_clear(struct graph *g) {
+    size_t i = 0;
+
+    /* Parameter check. */
+    if (NULL == g) {
+        return GRAPH_ERR_PARAMS;
+    }
+
+    graph_release_vertices(g);
+
+    /* Return all the vertices and edges to their pools at once, the retired ones included. */
+    graph_epoch_clear(&g->epoch);
+    graph_pool_reset(&g->edge_pool);
+    graph_pool_reset(&g->vertex_pool);
+    graph_hash_clear(&g->vertex_index);
+    for (i = 0; (NULL != g->shards) && (i < GRAPH_SHARD_COUNT); ++i) {
+        graph_pool_reset(&g->shards[i].edge_pool);
+        graph_pool_reset(&g->shards[i].vertex_pool);
+        graph_hash_clear(&g->shards[i].vertex_index);
+    }
+
+    LIST_INIT(&g->vertices);
+    g->vertex_count = 0;
+    graph_conn_clear(&g->conn);
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/**
+ * @brief   Add a new vertex to the graph.
+ * @param   g   The graph.
+ * @param   id  The id of the new vertex.
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_FOUND if the vertex already exists.
+ */
+static graph_res_t graph_insert_vertex(struct graph *g, uint64_t id) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_vertex *v = NULL;
+
+    /* Check if the vertex already exists. */
+    if (NULL != graph_find_vertex(g, id)) {
+        res = GRAPH_ERR_FOUND;
+        goto cleanup;
+    }
+
+    /* Allocate memory for the vertex. */
+    v = graph_pool_alloc(graph_vertex_pool_of(g, id));
+    if (NULL == v) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+
+    /* Initialize fields. */
+    v->id = id;
+    v->neighbor_count = 0;
+    LIST_INIT(&v->neighbors);
+    v->neighbor_index.is_hashed = false;
+    v->in_neighbor_count = 0;
+    LIST_INIT(&v->in_neighbors);
+
+    /* Attach to graph. */
+    res = graph_hash_insert(graph_vertex_index_of(g, id), id, v);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    graph_lock_list(g);
+    GRAPH_LIST_PUBLISH_HEAD(&g->vertices, v, next);
+    g->vertex_count++;
+    graph_unlock_list(g);
+    graph_conn_insert_vertex(g, v);
+
+    /* Indicate success. */
+    v = NULL;
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    if (NULL != v) {
+        graph_pool_free(graph_vertex_pool_of(g, id), v);
+    }
+    return res;
+}
+
+/** @see graph.h */
+graph_res_t GRAPH_add_vertex(struct graph *g, uint64_t id) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+
+    /* Parameter check. */
+    if (NULL == g) {
+        return GRAPH_ERR_PARAMS;
+    }
+
+    graph_lock_pair(g, id, id);
+    res = graph_insert_vertex(g, id);
+    graph_unlock_pair(g, id, id);
+
+    return res;
+}
+
+/** @see graph.h */
+graph_res_t GRAPH_add_vertices(struct graph *g, const uint64_t *ids, size_t count, graph_res_t *results) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    graph_res_t item_res = GRAPH_ERR_UNDEFINED;
+    size_t i = 0;
+
+    /* Parameter check. */
+    if ((NULL == g) || ((NULL == ids) && (0 != count))) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    /* Size the index and the pool for the whole batch up front, the shards of a sharded graph grow as they go. */
+    if (NULL == g->shards) {
+        res = graph_hash_reserve(&g->vertex_index, g->vertex_count + count);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+        res = graph_pool_reserve(&g->vertex_pool, count);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+    }
+
+    res = GRAPH_ERR_SUCCESS;
+    for (i = 0; i < count; ++i) {
+        item_res = GRAPH_add_vertex(g, ids[i]);
+        if (NULL != results) {
+            results[i] = item_res;
+        }
+        if ((GRAPH_ERR_SUCCESS != item_res) && (GRAPH_ERR_SUCCESS == res)) {
+            res = item_res;
+        }
+    }
+
+    cleanup:
+    return res;
+}
+
+/** @see graph.h */
+graph_res_t GRAPH_remove_vertex(struct graph *g, uint64_t id) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_vertex *v = NULL;
+
+    /* Parameter check. */
+    if (NULL == g) {
+        return GRAPH_ERR_PARAMS;
+    }
+
+    /* The edges of the vertex may end in any shard. */
+    graph_lock_all(g);
+
+    /* Check if the vertex doesn't exist. */
+    v = graph_find_vertex(g, id);
+    if (NULL == v) {
+        res = GRAPH_ERR_NOT_FOUND;
+        goto cleanup;
+    }
+
+    /* Make room for retiring the vertex and its edges, so the removal can't fail halfway. */
+    res = graph_epoch_reserve(&g->epoch, (v->neighbor_count * 2) + v->in_neighbor_count + 1);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Go over all the edges connected to it and remove them. */
+    while (!LIST_EMPTY(&v->neighbors)) {
+        graph_unlink_edge(g, LIST_FIRST(&v->neighbors));
+    }
+    while (!LIST_EMPTY(&v->in_neighbors)) {
+        graph_unlink_edge(g, LIST_FIRST(&v->in_neighbors));
+    }
+
+    /* Detach the vertex from the graph and free it, holding every shard keeps the other writers off the list. */
+    graph_conn_remove_vertex(g, v);
+    (void)graph_hash_remove(graph_vertex_index_of(g, id), id);
+    GRAPH_LIST_UNPUBLISH(v, next);
+    g->vertex_count--;
+    graph_epoch_retire(&g->epoch, graph_vertex_pool_of(g, id), v);
+
+    /* Indicate success. */
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    graph_unlock_all(g);
+    return res;
+}
+
+/**
+ * @brief   Adds an edge between two vertices of the graph.
+ * @param   g               The graph.
+ * @param   s               The source vertex.
+ * @param   d               The destination vertex.
+ * @param   weight          The weight of the edge.
+ * @param   check_duplicate Should the existence of the edge be checked first.
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_FOUND if the edge already exists.
+ */
+static graph_res_t graph_insert_edge(struct graph *g, struct graph_vertex *s, struct graph_vertex *d, double weight,
+                                     bool check_duplicate) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_edge *e = NULL;
+    struct graph_edge *e2 = NULL;
+
+    /* Check that the edge doesn't exist. */
+    if (check_duplicate && graph_is_connected(s, d, NULL)) {
+        res = GRAPH_ERR_FOUND;
+        goto cleanup;
+    }
+
+    /* Allocate memory for the edge. */
+    e = graph_pool_alloc(graph_edge_pool_of(g, s->id));
+    if (NULL == e) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    if ((!g->is_directional) && (s != d)) {
+        /* Allocate memory for the edge on the other side. */
+        e2 = graph_pool_alloc(graph_edge_pool_of(g, d->id));
+        if (NULL == e2) {
+            res = GRAPH_ERR_MEM;
+            goto cleanup;
+        }
+
+        /*
+         * Make room for it up front, so once the first edge is published the second can only fail on a repeated edge
+         * the caller vouched against (see GRAPH_ADD_EDGES_SKIP_DUPLICATE_CHECK), and the first can then be retired.
+         */
+        res = graph_neighbor_index_reserve(g, d, 1);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+        res = graph_epoch_reserve(&g->epoch, 1);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+    }
+
+    /* Initialize fields. */
+    e->s_id = s->id;
+    e->d_id = d->id;
+    e->weight = weight;
+    e->s = s;
+    e->d = d;
+    e->twin = e2;
+
+    /* Attach to vertices. if its undirectional, attach also to destination. */
+    res = graph_attach_edge(g, s, e);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    if (NULL != e2) {
+        e2->s_id = d->id;
+        e2->d_id = s->id;
+        e2->weight = weight;
+        e2->s = d;
+        e2->d = s;
+        e2->twin = e;
+
+        res = graph_attach_edge(g, d, e2);
+        if (GRAPH_ERR_SUCCESS != res) {
+            /* Readers may already stand on the first edge, so it is retired rather than freed. */
+            graph_detach_edge(s, e);
+            graph_epoch_retire(&g->epoch, graph_edge_pool_of(g, s->id), e);
+            e = NULL;
+            goto cleanup;
+        }
+    }
+    if (g->is_directional) {
+        GRAPH_LIST_PUBLISH_HEAD(&d->in_neighbors, e, in_next);
+        d->in_neighbor_count++;
+    }
+    graph_conn_insert_edge(g, e);
+
+    /* Indicate success. */
+    e = NULL;
+    e2 = NULL;
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    if (NULL != e) {
+        graph_pool_free(graph_edge_pool_of(g, s->id), e);
+    }
+    if (NULL != e2) {
+        graph_pool_free(graph_edge_pool_of(g, d->id), e2);
+    }
+    return res;
+}
+
+/**
+ * @brief   Find the vertices of an edge and add it, under the locks of their shards.
+ * @param   g               The graph.
+ * @param   s_id            The id of the source vertex.
+ * @param   d_id            The id of the destination vertex.
+ * @param   weight          The weight of the edge.
+ * @param   check_duplicate Should the existence of the edge be checked first.
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_NOT_FOUND if one of the vertices doesn't exist.
+ */
+static graph_res_t graph_add_edge_locked(struct graph *g, uint64_t s_id, uint64_t d_id, double weight,
+                                         bool check_duplicate) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_vertex *s = NULL;
+    struct graph_vertex *d = NULL;
+
+    graph_lock_pair(g, s_id, d_id);
+
+    /* Find the vertices. */
+    s = graph_find_vertex(g, s_id);
+    d = graph_find_vertex(g, d_id);
+    if ((NULL == s) || (NULL == d)) {
+        res = GRAPH_ERR_NOT_FOUND;
+        goto cleanup;
+    }
+
+    res = graph_insert_edge(g, s, d, weight, check_duplicate);
+
+    cleanup:
+    graph_unlock_pair(g, s_id, d_id);
+    return res;
+}
+
+/** @see graph.h */
+graph_res_t GRAPH_add_edge(struct graph *g, uint64_t s_id, uint64_t d_id, double weight) {
+    /* Parameter check. */
+    if (NULL == g) {
+        return GRAPH_ERR_PARAMS;
+    }
+
+    return graph_add_edge_locked(g, s_id, d_id, weight, true);
+}
+
+/** @see graph.h */
+graph_res_t GRAPH_add_edges(struct graph *g, const uint64_t *s_ids, const uint64_t *d_ids, const double *weights,
+                            size_t count, uint32_t flags, graph_res_t *results) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    graph_res_t item_res = GRAPH_ERR_UNDEFINED;
+    uint64_t *sources = NULL;
+    uint64_t *order = NULL;
+    struct graph_vertex *group = NULL;
+    struct graph_vertex *s = NULL;
+    struct graph_vertex *d = NULL;
+    bool check_duplicate = (0 == (flags & GRAPH_ADD_EDGES_SKIP_DUPLICATE_CHECK));
+    size_t group_end = 0;
+    size_t i = 0;
+    size_t k = 0;
+
+    /* Parameter check. */
+    if ((NULL == g) || (((NULL == s_ids) || (NULL == d_ids)) && (0 != count))) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    /* The ends of the edges of a batch may be in any shard, so a sharded graph takes them one at a time. */
+    if (NULL != g->shards) {
+        res = GRAPH_ERR_SUCCESS;
+        for (i = 0; i < count; ++i) {
+            item_res = graph_add_edge_locked(g, s_ids[i], d_ids[i], (NULL != weights) ? weights[i] : 0,
+                                             check_duplicate);
+            if (NULL != results) {
+                results[i] = item_res;
+            }
+            if ((GRAPH_ERR_SUCCESS != item_res) && (GRAPH_ERR_SUCCESS == res)) {
+                res = item_res;
+            }
+        }
+        goto cleanup;
+    }
+
+    /*
+     * Group the batch by source, so each source is resolved and its index sized once. An undirectional edge is
+     * grouped by its lower end instead, so the repeats of an edge in either direction share a group, and as the sort
+     * is stable they are added in batch order (the first one wins, as when adding them one by one).
+     */
+    sources = g->allocator.alloc(g->allocator.ctx, sizeof(*sources) * (count + 1));
+    order = g->allocator.alloc(g->allocator.ctx, sizeof(*order) * (count + 1));
+    if ((NULL == sources) || (NULL == order)) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    for (i = 0; i < count; ++i) {
+        sources[i] = ((!g->is_directional) && (d_ids[i] < s_ids[i])) ? d_ids[i] : s_ids[i];
+        order[i] = i;
+    }
+    res = graph_sort_u64(sources, order, count, &g->allocator);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Take the edges of the whole batch from the pool up front. */
+    res = graph_pool_reserve(&g->edge_pool, g->is_directional ? count : (count * 2));
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    res = GRAPH_ERR_SUCCESS;
+    for (i = 0; i < count; i = group_end) {
+        for (group_end = i + 1; (group_end < count) && (sources[group_end] == sources[i]); ++group_end);
+
+        group = graph_find_vertex(g, sources[i]);
+        if (NULL != group) {
+            /* Failing to presize only means the index will grow on the way. */
+            (void)graph_neighbor_index_reserve(g, group, group_end - i);
+        }
+
+        for (k = i; k < group_end; ++k) {
+            s = (s_ids[order[k]] == sources[i]) ? group : graph_find_vertex(g, s_ids[order[k]]);
+            d = graph_find_vertex(g, d_ids[order[k]]);
+            if ((NULL == s) || (NULL == d)) {
+                item_res = GRAPH_ERR_NOT_FOUND;
+            } else {
+                item_res = graph_insert_edge(g, s, d, (NULL != weights) ? weights[order[k]] : 0, check_duplicate);
+            }
+
+            if (NULL != results) {
+                results[order[k]] = item_res;
+            }
+            if ((GRAPH_ERR_SUCCESS != item_res) && (GRAPH_ERR_SUCCESS == res)) {
+                res = item_res;
+            }
+        }
+    }
+
+    cleanup:
+    if (NULL != sources) {
+        g->allocator.free(g->allocator.ctx, sources, sizeof(*sources) * (count + 1));
+    }
+    if (NULL != order) {
+        g->allocator.free(g->allocator.ctx, order, sizeof(*order) * (count + 1));
+    }
+    return res;
+}
+
+/** @see graph.h */
+graph_res_t GRAPH_remove_edge(struct graph *g, uint64_t s_id, uint64_t d_id) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_edge *e = NULL;
+    struct graph_vertex *s = NULL;
+
+    /* Parameter check. */
+    if (NULL == g) {
+        return GRAPH_ERR_PARAMS;
+    }
+
+    graph_lock_pair(g, s_id, d_id);
+
+    /* Find the source vertex. */
+    s = graph_find_vertex(g, s_id);
+    if (NULL == s) {
+        res = GRAPH_ERR_NOT_FOUND;
+        goto cleanup;
+    }
+
+    /* Check that the edge exists and get it. */
+    e = graph_neighbor_find(s, d_id);
+    if (NULL == e) {
+        res = GRAPH_ERR_NOT_FOUND;
         goto cleanup;
     }
 
-    /* Check if d is in the neighbor list of s. */
-    LIST_FOREACH(curr_edge, &s->neighbors, next) {
-        if (d->id == curr_edge->d_id) {
-            res = true;
-            if (NULL != e) {
-                *e = curr_edge;
-            }
-            goto cleanup;
-        }
+    /* remove from s. if its undirectional, remove also its twin from d. */
+    res = graph_epoch_reserve(&g->epoch, 2);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
     }
+    graph_unlink_edge(g, e);
+
+    /* Indicate success. */
+    res = GRAPH_ERR_SUCCESS;
 
     cleanup:
+    graph_unlock_pair(g, s_id, d_id);
     return res;
 }
 
 /** @see graph.h */
-graph_res_t GRAPH_init(bool is_directional, struct graph **g) {
+graph_res_t GRAPH_has_edge(struct graph *g, uint64_t s_id, uint64_t d_id, bool *has_edge) {
     graph_res_t res = GRAPH_ERR_UNDEFINED;
-    struct graph *local_graph = NULL;
+    struct graph_vertex *s = NULL;
 
     /* Parameter check. */
-    if (NULL == g) {
-        res = GRAPH_ERR_PARAMS;
-        goto cleanup;
+    if ((NULL == g) || (NULL == has_edge)) {
+        return GRAPH_ERR_PARAMS;
     }
 
-    /* Allocate memory for the g. */
-    local_graph = malloc(sizeof(*local_graph));
-    if (NULL == local_graph) {
-        res = GRAPH_ERR_MEM;
+    graph_lock_pair(g, s_id, d_id);
+
+    /* Find the vertices. */
+    s = graph_find_vertex(g, s_id);
+    if ((NULL == s) || (NULL == graph_find_vertex(g, d_id))) {
+        res = GRAPH_ERR_NOT_FOUND;
         goto cleanup;
     }
 
-    /* Initialize fields. */
-    local_graph->is_directional = is_directional;
-    local_graph->vertex_count = 0;
-    LIST_INIT(&local_graph->vertices);
-
-    /* Transfer ownership and indicate success. */
-    *g = local_graph;
-    local_graph = NULL;
+    *has_edge = (NULL != graph_neighbor_find(s, d_id));
 
     res = GRAPH_ERR_SUCCESS;
 
     cleanup:
-    if (NULL != local_graph) {
-        free(local_graph);
-    }
-
+    graph_unlock_pair(g, s_id, d_id);
     return res;
 }
 
 /** @see graph.h */
-graph_res_t GRAPH_destroy(struct graph *g) {
+graph_res_t GRAPH_get_edge_weight(struct graph *g, uint64_t s_id, uint64_t d_id, double *weight) {
     graph_res_t res = GRAPH_ERR_UNDEFINED;
-    struct graph_vertex *v = NULL;
+    struct graph_vertex *s = NULL;
+    struct graph_edge *e = NULL;
 
     /* Parameter check. */
-    if (NULL == g) {
+    if ((NULL == g) || (NULL == weight)) {
         return GRAPH_ERR_PARAMS;
     }
 
-    /* Go over all the vertices and remove them. */
-    while (!LIST_EMPTY(&g->vertices)) {
-        v = LIST_FIRST(&g->vertices);
-        GRAPH_remove_vertex(g, v->id);
-        /* v is a dangling pointer here. */
+    /* The edge lives with its source, the shard of the source is enough. */
+    graph_lock_pair(g, s_id, s_id);
+
+    /* Find the edge. */
+    s = graph_find_vertex(g, s_id);
+    if (NULL != s) {
+        e = graph_neighbor_find(s, d_id);
+    }
+    if (NULL == e) {
+        res = GRAPH_ERR_NOT_FOUND;
+        goto cleanup;
     }
 
-    /* Free the graph. */
-    free(g);
+    *weight = e->weight;
 
-    return GRAPH_ERR_SUCCESS;
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    graph_unlock_pair(g, s_id, s_id);
+    return res;
 }
 
 /** @see graph.h */
-graph_res_t GRAPH_add_vertex(struct graph *g, uint64_t id) {
-    graph_res_t res = GRAPH_ERR_UNDEFINED;
-    struct graph_vertex *v = NULL;
-
+graph_res_t GRAPH_enable_concurrent_reads(struct graph *g) {
     /* Parameter check. */
-    if (NULL == g) {
-        res = GRAPH_ERR_PARAMS;
-        goto cleanup;
+    if ((NULL == g) || (NULL != g->shards)) {
+        return GRAPH_ERR_PARAMS;
     }
 
-    /* Check if the vertex already exists. */
-    LIST_FOREACH(v, &g->vertices, next) {
-        if (id == v->id) {
-            v = NULL;
-            res = GRAPH_ERR_FOUND;
-            goto cleanup;
-        }
-    }
+    g->epoch.is_enabled = true;
 
-    /* Allocate memory for the vertex. */
-    v = malloc(sizeof(*v));
-    if (NULL == v) {
-        res = GRAPH_ERR_MEM;
-        goto cleanup;
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph.h */
+graph_res_t GRAPH_reader_register(struct graph *g, struct graph_reader *reader) {
+    /* Parameter check. */
+    if ((NULL == g) || (NULL == reader) || (!g->epoch.is_enabled)) {
+        return GRAPH_ERR_PARAMS;
     }
 
-    /* Initialize fields. */
-    v->id = id;
-    v->neighbor_count = 0;
-    LIST_INIT(&v->neighbors);
+    graph_epoch_register(&g->epoch, reader);
 
-    /* Attach to graph. */
-    LIST_INSERT_HEAD(&g->vertices, v, next);
-    g->vertex_count++;
+    return GRAPH_ERR_SUCCESS;
+}
 
-    /* Indicate success. */
-    v = NULL;
-    res = GRAPH_ERR_SUCCESS;
+/** @see graph.h */
+graph_res_t GRAPH_reader_unregister(struct graph *g, struct graph_reader *reader) {
+    /* Parameter check. */
+    if ((NULL == g) || (NULL == reader)) {
+        return GRAPH_ERR_PARAMS;
+    }
 
-    cleanup:
-    if (NULL != v) {
-        free(v);
+    graph_epoch_unregister(&g->epoch, reader);
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph.h */
+graph_res_t GRAPH_read_begin(struct graph *g, struct graph_reader *reader) {
+    /* Parameter check. */
+    if ((NULL == g) || (NULL == reader)) {
+        return GRAPH_ERR_PARAMS;
     }
-    return res;
+
+    graph_epoch_enter(&g->epoch, reader);
+
+    return GRAPH_ERR_SUCCESS;
 }
 
 /** @see graph.h */
-graph_res_t GRAPH_remove_vertex(struct graph *g, uint64_t id) {
-    graph_res_t res = GRAPH_ERR_UNDEFINED;
-    struct graph_vertex *v = NULL;
-    struct graph_edge *e = NULL;
+graph_res_t GRAPH_read_end(struct graph *g, struct graph_reader *reader) {
+    /* Parameter check. */
+    if ((NULL == g) || (NULL == reader)) {
+        return GRAPH_ERR_PARAMS;
+    }
+
+    graph_epoch_exit(reader);
 
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph.h */
+graph_res_t GRAPH_synchronize(struct graph *g) {
     /* Parameter check. */
     if (NULL == g) {
-        res = GRAPH_ERR_PARAMS;
-        goto cleanup;
+        return GRAPH_ERR_PARAMS;
     }
 
-    /* Check if the vertex doesn't exist. */
-    LIST_FOREACH(v, &g->vertices, next) {
-        if (id == v->id) {
-            break;
+    /* Every advance waits for the read sections older than the epoch, give them the CPU until they end. */
+    while (0 != g->epoch.retired_count) {
+        if (!graph_epoch_reclaim(&g->epoch)) {
+            (void)sched_yield();
         }
     }
-    if (NULL == v) {
-        res = GRAPH_ERR_NOT_FOUND;
-        goto cleanup;
-    }
-
-    /* Go over all the edges connected to it and remove them. */
-    while (!LIST_EMPTY(&v->neighbors)) {
-        e = LIST_FIRST(&v->neighbors);
-        GRAPH_remove_edge(g, e->s_id, e->d_id);
-        /* e is a dangling pointer here. */
-    }
-
-    /* Detach the vertex from the graph and free it. */
-    LIST_REMOVE(v, next);
-    g->vertex_count--;
-    free(v);
-
-    /* Indicate success. */
-    res = GRAPH_ERR_SUCCESS;
 
-    cleanup:
-    return res;
+    return GRAPH_ERR_SUCCESS;
 }
 
 /** @see graph.h */
-graph_res_t GRAPH_add_edge(struct graph *g, uint64_t s_id, uint64_t d_id, double weight) {
+graph_res_t GRAPH_enable_concurrent_writes(struct graph *g) {
     graph_res_t res = GRAPH_ERR_UNDEFINED;
-    struct graph_edge *e = NULL;
-    struct graph_edge *e2 = NULL;
     struct graph_vertex *v = NULL;
-    struct graph_vertex *s = NULL;
-    struct graph_vertex *d = NULL;
+    size_t i = 0;
 
     /* Parameter check. */
-    if (NULL == g) {
+    if ((NULL == g) || g->epoch.is_enabled || (GRAPH_CONN_DISABLED != g->conn.mode)) {
         res = GRAPH_ERR_PARAMS;
         goto cleanup;
     }
-
-    /* Find the vertices. */
-    LIST_FOREACH(v, &g->vertices, next) {
-        if (s_id == v->id) {
-            s = v;
-        }
-        if (d_id == v->id) {
-            d = v;
-        }
-    }
-    if ((NULL == s) || (NULL == d)) {
-        res = GRAPH_ERR_NOT_FOUND;
+    if (NULL != g->shards) {
+        res = GRAPH_ERR_SUCCESS;
         goto cleanup;
     }
 
-    /* Check that the edge doesn't exist. */
-    if (graph_is_connected(s, d, NULL)) {
-        res = GRAPH_ERR_FOUND;
-        goto cleanup;
-    }
-
-    /* Allocate memory for the edge. */
-    e = malloc(sizeof(*e));
-    if (NULL == e) {
+    g->shards = g->allocator.alloc(g->allocator.ctx, sizeof(*g->shards) * GRAPH_SHARD_COUNT);
+    if (NULL == g->shards) {
         res = GRAPH_ERR_MEM;
         goto cleanup;
     }
-    if ((!g->is_directional) && (s_id != d_id)) {
-        /* Allocate memory for the edge on the other side. */
-        e2 = malloc(sizeof(*e2));
-        if (NULL == e2) {
-            res = GRAPH_ERR_MEM;
-            goto cleanup;
-        }
+    for (i = 0; i < GRAPH_SHARD_COUNT; ++i) {
+        (void)pthread_mutex_init(&g->shards[i].lock, NULL);
+        graph_hash_init(&g->shards[i].vertex_index, &g->allocator);
+        graph_pool_init(&g->shards[i].vertex_pool, &g->allocator, sizeof(struct graph_vertex));
+        graph_pool_init(&g->shards[i].edge_pool, &g->allocator, sizeof(struct graph_edge));
     }
 
-    /* Initialize fields. */
-    e->s_id = s_id;
-    e->d_id = d_id;
-    e->weight = weight;
-
-    /* Attach to vertices. if its undirectional, attach only to source. */
-    LIST_INSERT_HEAD(&s->neighbors, e, next);
-    s->neighbor_count++;
-    if ((!g->is_directional) && (s_id != d_id)) {
-        e2->s_id = d_id;
-        e2->d_id = s_id;
-        e2->weight = weight;
-
-        LIST_INSERT_HEAD(&d->neighbors, e2, next);
-        d->neighbor_count++;
+    /*
+     * Move the vertices to the indexes of their shards. The objects stay in the slabs of the graph pools, which live
+     * as long as the shards do, so they can be freed to the pools of their shards like any other.
+     */
+    LIST_FOREACH(v, &g->vertices, next) {
+        res = graph_hash_insert(&graph_shard_of(g, v->id)->vertex_index, v->id, v);
+        if (GRAPH_ERR_SUCCESS != res) {
+            graph_release_shards(g);
+            goto cleanup;
+        }
     }
+    graph_hash_destroy(&g->vertex_index);
 
-    /* Indicate success. */
-    e = NULL;
-    e2 = NULL;
     res = GRAPH_ERR_SUCCESS;
 
     cleanup:
-    if (NULL != e) {
-        free(e);
-    }
-    if (NULL != e2) {
-        free(e2);
-    }
     return res;
 }
 
 /** @see graph.h */
-graph_res_t GRAPH_remove_edge(struct graph *g, uint64_t s_id, uint64_t d_id) {
-    graph_res_t res = GRAPH_ERR_UNDEFINED;
-    struct graph_edge *e = NULL;
+graph_res_t GRAPH_enable_connectivity(struct graph *g) {
+    /* Parameter check. */
+    if ((NULL == g) || (NULL != g->shards)) {
+        return GRAPH_ERR_PARAMS;
+    }
+
+    return graph_conn_enable(g);
+}
+
+/** @see graph.h */
+graph_res_t GRAPH_connected(struct graph *g, uint64_t u_id, uint64_t v_id, bool *is_connected) {
+    struct graph_vertex *u = NULL;
     struct graph_vertex *v = NULL;
-    struct graph_vertex *s = NULL;
-    struct graph_vertex *d = NULL;
 
     /* Parameter check. */
-    if (NULL == g) {
-        res = GRAPH_ERR_PARAMS;
-        goto cleanup;
+    if ((NULL == g) || (NULL == is_connected) || (GRAPH_CONN_DISABLED == g->conn.mode)) {
+        return GRAPH_ERR_PARAMS;
     }
 
     /* Find the vertices. */
-    LIST_FOREACH(v, &g->vertices, next) {
-        if (s_id == v->id) {
-            s = v;
-        }
-        if (d_id == v->id) {
-            d = v;
-        }
+    u = graph_find_vertex(g, u_id);
+    v = graph_find_vertex(g, v_id);
+    if ((NULL == u) || (NULL == v)) {
+        return GRAPH_ERR_NOT_FOUND;
     }
-    if ((NULL == s) || (NULL == d)) {
-        res = GRAPH_ERR_NOT_FOUND;
-        goto cleanup;
+
+    return graph_conn_connected(g, u, v, is_connected);
+}
+
+/**
+ * @brief   Fill a buffer with a value, using vector stores where available.
+ * @param   buffer  The buffer.
+ * @param   count   The amount of doubles in the buffer.
+ * @param   value   The value.
+ */
+static void graph_fill_doubles(double *buffer, size_t count, double value) {
+    size_t i = 0;
+
+#if defined(__AVX__)
+    __m256d values = _mm256_set1_pd(value);
+
+    for (; (i + 4) <= count; i += 4) {
+        _mm256_storeu_pd(buffer + i, values);
     }
+#elif defined(__SSE2__)
+    __m128d values = _mm_set1_pd(value);
 
-    /* Check that the edge exists and get it. */
-    if (!graph_is_connected(s, d, &e)) {
-        res = GRAPH_ERR_NOT_FOUND;
-        goto cleanup;
+    for (; (i + 2) <= count; i += 2) {
+        _mm_storeu_pd(buffer + i, values);
     }
+#endif
+    for (; i < count; ++i) {
+        buffer[i] = value;
+    }
+}
+
+/**
+ * @brief   The context of the parallel fill of an adjacency matrix.
+ */
+struct graph_adjacency_matrix_ctx {
+    /* The vertex of each row. */
+    struct graph_vertex **vertices;
 
-    /* remove from s. if its undirectional, remove also from d. */
-    LIST_REMOVE(e, next);
-    s->neighbor_count--;
-    free(e);
+    /* The ids of the vertices, and a map from id to the matching entry. */
+    uint64_t *ids;
+    struct graph_hash *id_map;
 
-    if ((!g->is_directional) && (s_id != d_id)) {
-        /* We can ignore return value, it will always succeed. */
-        (void)graph_is_connected(d, s, &e);
-        LIST_REMOVE(e, next);
-        d->neighbor_count--;
-        free(e);
-    }
+    double *matrix_data;
+    size_t size;
 
-    /* Indicate success. */
-    res = GRAPH_ERR_SUCCESS;
+    /* The value of a missing edge. */
+    double no_edge;
+};
 
-    cleanup:
-    return res;
+/**
+ * @brief   Fill a range of rows of an adjacency matrix, each row is owned by a single thread.
+ */
+static void graph_adjacency_matrix_fill_range(void *ctx, size_t begin, size_t end, size_t thread_id) {
+    struct graph_adjacency_matrix_ctx *fill = ctx;
+    struct graph_edge *e = NULL;
+    uint64_t *column = NULL;
+    double *row = NULL;
+    size_t i = 0;
+
+    (void)thread_id;
+    for (i = begin; i < end; ++i) {
+        row = fill->matrix_data + (i * fill->size);
+        graph_fill_doubles(row, fill->size, fill->no_edge);
+        LIST_FOREACH(e, &fill->vertices[i]->neighbors, next) {
+            column = graph_hash_find(fill->id_map, e->d_id);
+            row[column - fill->ids] = e->weight;
+        }
+    }
 }
 
 /** @see graph.h */
 graph_res_t GRAPH_get_adjecency_matrix(struct graph *g, double ***adj_matrix, size_t *size) {
+    return GRAPH_get_adjecency_matrix_ex(g, 0, adj_matrix, size, NULL);
+}
+
+/** @see graph.h */
+graph_res_t GRAPH_get_adjecency_matrix_ex(struct graph *g, size_t thread_count, double ***adj_matrix, size_t *size,
+                                          uint64_t **ids) {
+    return GRAPH_get_weight_matrix(g, thread_count, -1, adj_matrix, size, ids);
+}
+
+/** @see graph.h */
+graph_res_t GRAPH_get_weight_matrix(struct graph *g, size_t thread_count, double no_edge, double ***adj_matrix,
+                                    size_t *size, uint64_t **ids) {
     graph_res_t res = GRAPH_ERR_UNDEFINED;
-    struct graph_vertex  *v = NULL;
-    struct graph_vertex  *v2 = NULL;
-    struct graph_edge *e = NULL;
+    struct graph_adjacency_matrix_ctx fill;
+    struct graph_hash id_map;
+    struct graph_vertex *v = NULL;
     double **local_matrix = NULL;
     double *matrix_data = NULL;
+    size_t n = 0;
     size_t i = 0;
-    size_t j = 0;
+
+    fill.vertices = NULL;
+    fill.ids = NULL;
+    graph_hash_init(&id_map, &graph_allocator_default);
 
     /* Parameter check. */
     if ((NULL == g) || (NULL == adj_matrix) || (NULL == size)) {
         res = GRAPH_ERR_PARAMS;
         goto cleanup;
     }
+    n = g->vertex_count;
+    if ((0 != n) && (n > (SIZE_MAX / sizeof(*matrix_data) / n))) {
+        res = GRAPH_ERR_OVERFLOW;
+        goto cleanup;
+    }
 
-    /* Allocate the rows array. */
-    local_matrix = malloc(sizeof(*local_matrix) * g->vertex_count);
+    /* Allocate the rows array (at least one row, so an empty matrix can be freed as any other). */
+    local_matrix = malloc(sizeof(*local_matrix) * (n + 1));
     if (NULL == local_matrix) {
         res = GRAPH_ERR_MEM;
         goto cleanup;
     }
 
     /* Allocate a buffer for the matrix itself. */
-    matrix_data = malloc(sizeof(*matrix_data) * g->vertex_count * g->vertex_count);
+    matrix_data = malloc(sizeof(*matrix_data) * ((n * n) + 1));
     if (NULL == matrix_data) {
         res = GRAPH_ERR_MEM;
         goto cleanup;
     }
 
     /* Fix the rows in the rows array. */
-    for (i = 0; i < g->vertex_count; ++i) {
-        local_matrix[i] = (matrix_data + (i * g->vertex_count));
+    for (i = 0; i <= n; ++i) {
+        local_matrix[i] = (matrix_data + (i * n));
     }
 
-    for (i = 0; i < g->vertex_count; ++i) {
-        for (j = 0; j < g->vertex_count; ++j) {
-            local_matrix[i][j] = -1;
-        }
+    /* Number the vertices in list order, and map their ids to their rows. */
+    fill.vertices = malloc(sizeof(*fill.vertices) * (n + 1));
+    fill.ids = malloc(sizeof(*fill.ids) * (n + 1));
+    if ((NULL == fill.vertices) || (NULL == fill.ids)) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    res = graph_hash_reserve(&id_map, n);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
     }
-
-    /* Go over all the vertices and fill the matrix. */
     i = 0;
-    j = 0;
     LIST_FOREACH(v, &g->vertices, next) {
-        LIST_FOREACH(e, &v->neighbors, next) {
-            /* Find the index of d_id */
-            LIST_FOREACH(v2, &g->vertices, next) {
-                if (e->d_id == v2->id) {
-                    matrix_data[i * g->vertex_count + j] = e->weight;
-                }
-                j++;
-            }
-            j = 0;
-            i++;
+        fill.vertices[i] = v;
+        fill.ids[i] = v->id;
+        res = graph_hash_insert(&id_map, v->id, &fill.ids[i]);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
         }
+        i++;
+    }
+
+    /* Fill the rows, in parallel once the matrix is large enough. */
+    fill.id_map = &id_map;
+    fill.matrix_data = matrix_data;
+    fill.size = n;
+    fill.no_edge = no_edge;
+    res = graph_parallel_for(n, thread_count, GRAPH_MATRIX_GRAIN / ((0 == n) ? 1 : n) + 1,
+                             graph_adjacency_matrix_fill_range, &fill);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
     }
 
     /* Transfer ownership and indicate success. */
     *adj_matrix = local_matrix;
-    *size = g->vertex_count;
+    *size = n;
     local_matrix = NULL;
     matrix_data = NULL;
+    if (NULL != ids) {
+        *ids = fill.ids;
+        fill.ids = NULL;
+    }
 
     res = GRAPH_ERR_SUCCESS;
 
     cleanup:
+    graph_hash_destroy(&id_map);
+    if (NULL != fill.vertices) {
+        free(fill.vertices);
+    }
+    if (NULL != fill.ids) {
+        free(fill.ids);
+    }
     if (NULL != local_matrix) {
         free(local_matrix);
     }
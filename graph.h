@@ -10,6 +10,10 @@
 #include "queue.h"
 
 #include "errors.h"
+#include "graph_alloc.h"
+#include "graph_conn.h"
+#include "graph_epoch.h"
+#include "graph_hash.h"
 
 /**
  * @brief   A graph edge.
@@ -24,8 +28,18 @@ struct graph_edge {
     /* The weight of the edge. */
     double weight;
 
+    /* The vertices s_id and d_id, cached so they don't need to be resolved. */
+    struct graph_vertex *s;
+    struct graph_vertex *d;
+
+    /* In an undirectional graph, the mirror edge (d_id, s_id) in the neighbor list of d (NULL for a self loop). */
+    struct graph_edge *twin;
+
     /* The next edge in the list, used only if this edge is a part of a neighbor list of a vertex. */
     LIST_ENTRY(graph_edge) next;
+
+    /* The next edge in the incoming list of d, used only in a directional graph. */
+    LIST_ENTRY(graph_edge) in_next;
 };
 
 /**
@@ -33,6 +47,27 @@ struct graph_edge {
  */
 BSD_LIST_HEAD(neighbor_list, graph_edge);
 
+/* The maximal degree of a vertex whose neighbors are indexed inline, above it a hash table is used. */
+#define GRAPH_NEIGHBOR_INLINE_MAX   (8)
+
+/**
+ * @brief   An index of the neighbors of a vertex by their id.
+ *          Low degree vertices keep their edges in a small inline array (scanned linearly), once the degree
+ *          grows past GRAPH_NEIGHBOR_INLINE_MAX the edges move to a hash table keyed by the destination id.
+ */
+struct neighbor_index {
+    /* Is the hash table in use (otherwise the inline array is). */
+    bool is_hashed;
+
+    union {
+        /* The first neighbor_count edges of the vertex, in no particular order. */
+        struct graph_edge *inline_edges[GRAPH_NEIGHBOR_INLINE_MAX];
+
+        /* The edges of the vertex, keyed by their d_id. */
+        struct graph_hash hashed;
+    } u;
+};
+
 /**
  * @brief   A graph vertex.
  */
@@ -43,6 +78,11 @@ struct graph_vertex {
     /* The neighbors of the vertex. */
     size_t neighbor_count;
     struct neighbor_list neighbors;
+    struct neighbor_index neighbor_index;
+
+    /* The edges ending at the vertex, used only in a directional graph (linked by in_next). */
+    size_t in_neighbor_count;
+    struct neighbor_list in_neighbors;
 
     /* The next vertex in the list, used only if this is a part of a vertices list of a graph. */
     LIST_ENTRY(graph_vertex) next;
@@ -53,6 +93,25 @@ struct graph_vertex {
  */
 BSD_LIST_HEAD(vertex_list, graph_vertex);
 
+/* The amount of shards the vertices are split into while concurrent writes are enabled (a power of 2). */
+#define GRAPH_SHARD_COUNT   (64)
+
+/**
+ * @brief   A shard of the vertices of a graph, picked by a hash of the vertex id.
+ *          Its lock guards its index, its pools and everything hanging off its vertices: their neighbor lists and
+ *          indexes, their incoming lists and their counts.
+ */
+struct graph_shard {
+    pthread_mutex_t lock;
+
+    /* The vertices of the shard by their id. */
+    struct graph_hash vertex_index;
+
+    /* The vertices of the shard, and the edges leaving them, are allocated from these. */
+    struct graph_pool vertex_pool;
+    struct graph_pool edge_pool;
+};
+
 /**
  * @brief   A struct of a graph G=(V,E)
  */
@@ -63,6 +122,28 @@ struct graph {
     /* The vertices of the graph. */
     size_t vertex_count;
     struct vertex_list vertices;
+
+    /* An index of the vertices by their id, kept in sync with the vertices list. */
+    struct graph_hash vertex_index;
+
+    /* The allocator all the memory of the graph is taken from. */
+    struct graph_allocator allocator;
+
+    /* The pools the vertices and edges are allocated from. */
+    struct graph_pool vertex_pool;
+    struct graph_pool edge_pool;
+
+    /* The reclamation of unlinked vertices and edges, deferred while concurrent reads are enabled. */
+    struct graph_epoch epoch;
+
+    /* The shards replacing the vertex index and the pools while concurrent writes are enabled, NULL otherwise. */
+    struct graph_shard *shards;
+
+    /* Guards the vertices list and the vertex count while concurrent writes are enabled. */
+    pthread_mutex_t list_lock;
+
+    /* The connected components, tracked through the updates once enabled. */
+    struct graph_conn conn;
 };
 
 /**
@@ -75,15 +156,39 @@ struct graph {
  */
 graph_res_t GRAPH_init(bool is_directional, struct graph **g);
 
+/**
+ * @brief   Initialize an empty graph whose memory is taken from a given allocator.
+ * @param   is_directional  Is the graph directional.
+ * @param   allocator       The allocator (optional, malloc and free are used if NULL).
+ *                          It is copied, but its context must outlive the graph.
+ * @param   g               The graph generated (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    Vertices and edges are carved out of per-graph slabs taken from the allocator, the slabs are
+ *          returned to it by GRAPH_destroy.
+ */
+graph_res_t GRAPH_init_ex(bool is_directional, const struct graph_allocator *allocator, struct graph **g);
+
 /**
  * @brief   Destroy a graph and free its memory.
  * @param   g   The graph.
  * @return  GRAPH_ERR_SUCCESS on success.
  *
+ * @note    This takes O(V) time, vertices and edges are released a slab at a time.
  * @note    g is a dangling pointer after the call and should be assigned to NULL.
  */
 graph_res_t GRAPH_destroy(struct graph *g);
 
+/**
+ * @brief   Remove all the vertices and edges of the graph, keeping its memory for reuse.
+ * @param   g   The graph.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    This takes O(V) time, the slabs of the graph and its vertex index capacity are kept, so
+ *          refilling the graph to a similar size doesn't allocate.
+ */
+graph_res_t GRAPH_clear(struct graph *g);
+
 /**
  * @brief   Add a new vertex to the graph.
  * @param   g   The graph.
@@ -92,11 +197,25 @@ graph_res_t GRAPH_destroy(struct graph *g);
  */
 graph_res_t GRAPH_add_vertex(struct graph *g, uint64_t id);
 
+/**
+ * @brief   Add a batch of new vertices to the graph.
+ * @param   g       The graph.
+ * @param   ids     The ids of the new vertices.
+ * @param   count   The amount of vertices.
+ * @param   results The result of adding each vertex, as GRAPH_add_vertex would return it (optional).
+ * @return  GRAPH_ERR_SUCCESS if all the vertices were added, otherwise the result of the first one that wasn't.
+ *
+ * @note    The vertex index and the vertex pool are sized for the whole batch up front.
+ */
+graph_res_t GRAPH_add_vertices(struct graph *g, const uint64_t *ids, size_t count, graph_res_t *results);
+
 /**
  * @brief   Remove a given vertex from the graph and all its connected edges.
  * @param   g   The graph.
  * @param   id  The vertex to remove.
  * @return  GRAPH_ERR_SUCCECSS on success.
+ *
+ * @note    This takes O(deg(v)) time, in a directional graph the edges ending at the vertex are removed too.
  */
 graph_res_t GRAPH_remove_vertex(struct graph *g, uint64_t id);
 
@@ -112,15 +231,160 @@ graph_res_t GRAPH_remove_vertex(struct graph *g, uint64_t id);
  */
 graph_res_t GRAPH_add_edge(struct graph *g, uint64_t s_id, uint64_t d_id, double weight);
 
+/* GRAPH_add_edges flag: the batch is trusted not to contain existing or repeated edges, they aren't checked. */
+#define GRAPH_ADD_EDGES_SKIP_DUPLICATE_CHECK    (1 << 0)
+
+/**
+ * @brief   Adds a batch of edges to the graph.
+ * @param   g       The graph.
+ * @param   s_ids   The ids of the source vertices (must exist!)
+ * @param   d_ids   The ids of the destination vertices (must exist!)
+ * @param   weights The weights of the edges (optional, 0 if NULL).
+ * @param   count   The amount of edges.
+ * @param   flags   GRAPH_ADD_EDGES_* flags.
+ * @param   results The result of adding each edge, as GRAPH_add_edge would return it (optional).
+ * @return  GRAPH_ERR_SUCCESS if all the edges were added, otherwise the result of one that wasn't.
+ *
+ * @note    The batch is grouped by source (by lower end in an undirectional graph), so each source is resolved and
+ *          its neighbor index sized once, and the edges of the whole batch are taken from the pool up front. Repeated
+ *          edges are added in batch order, the first one wins.
+ * @note    With GRAPH_ADD_EDGES_SKIP_DUPLICATE_CHECK, adding an existing edge leaves the graph inconsistent.
+ */
+graph_res_t GRAPH_add_edges(struct graph *g, const uint64_t *s_ids, const uint64_t *d_ids, const double *weights,
+                            size_t count, uint32_t flags, graph_res_t *results);
+
 /**
  * @brief   Remove an edge from the graph.
  * @param   g       The graph
  * @param   s_id    id of the source vertex.
  * @param   d_id    id of the destination vertex.
  * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    This takes O(1) expected time, in an undirectional graph the mirror edge is reached through its twin.
  */
 graph_res_t GRAPH_remove_edge(struct graph *g, uint64_t s_id, uint64_t d_id);
 
+/**
+ * @brief   Checks if there is an edge between two vertices.
+ * @param   g           The graph.
+ * @param   s_id        id of the source vertex.
+ * @param   d_id        id of the destination vertex.
+ * @param   has_edge    Is there an edge (s_id, d_id) (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_NOT_FOUND if one of the vertices doesn't exist.
+ *
+ * @note    The check is O(1) expected, regardless of the degree of the vertices.
+ */
+graph_res_t GRAPH_has_edge(struct graph *g, uint64_t s_id, uint64_t d_id, bool *has_edge);
+
+/**
+ * @brief   Returns the weight of an edge.
+ * @param   g       The graph.
+ * @param   s_id    id of the source vertex.
+ * @param   d_id    id of the destination vertex.
+ * @param   weight  The weight of the edge (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_NOT_FOUND if there is no such edge.
+ */
+graph_res_t GRAPH_get_edge_weight(struct graph *g, uint64_t s_id, uint64_t d_id, double *weight);
+
+/**
+ * @brief   Let readers traverse the graph while a single writer mutates it.
+ *          The lists of vertices, neighbors and incoming edges are published with release stores, and the vertices
+ *          and edges the writer removes are only returned to their pools once no read section can still hold them.
+ *          A read section follows the lists with GRAPH_READ_FOREACH and reads only the id of a vertex and the
+ *          s_id, d_id, weight, s and d of an edge, which never change while the object is in the graph.
+ * @param   g   The graph.
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_PARAMS if concurrent writes are enabled (the two modes don't mix).
+ *
+ * @note    Call it before the readers start, it can't be turned off. The writers must still be serialized, and the
+ *          counts, the indexes by id (GRAPH_has_edge, GRAPH_get_edge_weight and friends), GRAPH_clear and the
+ *          snapshots aren't safe against a concurrent writer.
+ */
+graph_res_t GRAPH_enable_concurrent_reads(struct graph *g);
+
+/**
+ * @brief   Register a thread reading the graph, it may begin read sections until it is unregistered.
+ * @param   g       The graph, with concurrent reads enabled.
+ * @param   reader  The reader, owned by the caller until it is unregistered.
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_PARAMS if concurrent reads aren't enabled.
+ */
+graph_res_t GRAPH_reader_register(struct graph *g, struct graph_reader *reader);
+
+/**
+ * @brief   Unregister a reader, outside of a read section.
+ * @param   g       The graph.
+ * @param   reader  The reader.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t GRAPH_reader_unregister(struct graph *g, struct graph_reader *reader);
+
+/**
+ * @brief   Begin a read section, the vertices and edges reached in it stay valid until GRAPH_read_end.
+ * @param   g       The graph.
+ * @param   reader  The registered reader.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    Read sections should be short, a reader parked in one holds back the reclamation of everything removed
+ *          after it began.
+ */
+graph_res_t GRAPH_read_begin(struct graph *g, struct graph_reader *reader);
+
+/**
+ * @brief   End a read section, nothing reached in it may be used after the call.
+ * @param   g       The graph.
+ * @param   reader  The registered reader.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t GRAPH_read_end(struct graph *g, struct graph_reader *reader);
+
+/**
+ * @brief   Wait for the read sections holding removed vertices and edges to end, and return them all to their pools.
+ * @param   g   The graph.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    Called by the writer outside of any read section, otherwise it waits forever. Without it, removed objects
+ *          are reclaimed in batches as the writer goes.
+ */
+graph_res_t GRAPH_synchronize(struct graph *g);
+
+/**
+ * @brief   Let threads add and remove vertices and edges at once.
+ *          The vertex index and the pools are split into GRAPH_SHARD_COUNT shards, each behind its own lock, by a hash
+ *          of the vertex id. GRAPH_add_vertex locks the shard of the vertex, GRAPH_add_edge, GRAPH_remove_edge and
+ *          GRAPH_has_edge lock the shards of both ends (lower shard first, so two threads working on the same pair
+ *          in opposite directions can't deadlock), GRAPH_get_edge_weight the shard of the source. GRAPH_remove_vertex
+ *          locks every shard in order, as the edges it removes may end anywhere. The batch functions go through the
+ *          same locks one item at a time.
+ * @param   g   The graph, the vertices it already has are moved to their shards.
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_PARAMS if concurrent reads or connectivity tracking are enabled
+ *          (the modes don't mix).
+ *
+ * @note    Call it before the writers start, it can't be turned off. The allocator of the graph must be thread safe.
+ *          Traversals, snapshots, GRAPH_clear and GRAPH_destroy still need the writers to be done.
+ */
+graph_res_t GRAPH_enable_concurrent_writes(struct graph *g);
+
+/**
+ * @brief   Keep track of the connected components of the graph (ignoring the direction of the edges) as it changes.
+ *          Adding a vertex or an edge costs near constant time while edges are only added, removing an edge
+ *          O(log^2(V)) amortized (see struct graph_conn), and GRAPH_connected answers in O(log(V)).
+ * @param   g   The graph, its current edges are taken in.
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_PARAMS if concurrent writes are enabled.
+ *
+ * @note    It can't be turned off, every update pays for it from then on.
+ */
+graph_res_t GRAPH_enable_connectivity(struct graph *g);
+
+/**
+ * @brief   Check if there is a path between two vertices, ignoring the direction of the edges.
+ * @param   g               The graph, with connectivity tracking enabled.
+ * @param   u_id            The id of the first vertex.
+ * @param   v_id            The id of the second vertex.
+ * @param   is_connected    Are the vertices connected (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_PARAMS if connectivity tracking isn't enabled,
+ *          GRAPH_ERR_NOT_FOUND if one of the vertices doesn't exist.
+ */
+graph_res_t GRAPH_connected(struct graph *g, uint64_t u_id, uint64_t v_id, bool *is_connected);
+
 /**
  * @brief   Returns an adjecency matrix of the graph.
  *          The order of the vertices is the order of the internal graph list.
@@ -131,9 +395,44 @@ graph_res_t GRAPH_remove_edge(struct graph *g, uint64_t s_id, uint64_t d_id);
  * @return  GRAPH_ERR_SUCCESS on success.
  *
  * @note    GRAPH_free_adjecency_matrix should be called on the matrix to free it.
+ * @see     GRAPH_get_adjecency_matrix_ex
  */
 graph_res_t GRAPH_get_adjecency_matrix(struct graph *g, double ***adj_matrix, size_t *size);
 
+/**
+ * @brief   Returns an adjecency matrix of the graph, along with the id of the vertex of each row.
+ *          The order of the vertices is the order of the internal graph list.
+ *          if e=(u,v) is an edge in the graph, adj[u][v] = w(e), otherwise, adj[u][v]=-1.
+ * @param g             The graph.
+ * @param thread_count  The amount of threads to fill the matrix with (0 for one per online CPU).
+ * @param adj_matrix    The returned adjencency matrix.
+ * @param size          The size of the col/row of the matrix.
+ * @param ids           The id of the vertex of each row/col (optional, out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_OVERFLOW if the matrix can't be addressed.
+ *
+ * @note    This takes O(V^2/thread_count + E) time, rows are initialized and filled in parallel.
+ * @note    GRAPH_free_adjecency_matrix should be called on the matrix to free it, and free on ids.
+ */
+graph_res_t GRAPH_get_adjecency_matrix_ex(struct graph *g, size_t thread_count, double ***adj_matrix, size_t *size,
+                                          uint64_t **ids);
+
+/**
+ * @brief   Returns an adjecency matrix of the graph with a chosen value for the missing edges.
+ *          if e=(u,v) is an edge in the graph, adj[u][v] = w(e), otherwise, adj[u][v]=no_edge.
+ * @param g             The graph.
+ * @param thread_count  The amount of threads to fill the matrix with (0 for one per online CPU).
+ * @param no_edge       The value of the entries without an edge.
+ * @param adj_matrix    The returned adjencency matrix.
+ * @param size          The size of the col/row of the matrix.
+ * @param ids           The id of the vertex of each row/col (optional, out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_OVERFLOW if the matrix can't be addressed.
+ *
+ * @note    GRAPH_free_adjecency_matrix should be called on the matrix to free it, and free on ids.
+ * @see     GRAPH_get_adjecency_matrix_ex
+ */
+graph_res_t GRAPH_get_weight_matrix(struct graph *g, size_t thread_count, double no_edge, double ***adj_matrix,
+                                    size_t *size, uint64_t **ids);
+
 /**
  * @brief   Frees the memory of the adjecency matrix.
  * @param g             The graph.
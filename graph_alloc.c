@@ -0,0 +1,156 @@
+#include <malloc.h>
+#include "graph_alloc.h"
+
+/* The size each slab aims for. */
+#define GRAPH_SLAB_SIZE         (64 * 1024)
+
+/* The alignment of the objects in a slab, enough for any of the graph structs. */
+#define GRAPH_SLAB_ALIGNMENT    (16)
+
+/* Round size up to a multiple of the slab alignment. */
+#define GRAPH_SLAB_ALIGN(size)  ((((size) + GRAPH_SLAB_ALIGNMENT - 1) / GRAPH_SLAB_ALIGNMENT) * GRAPH_SLAB_ALIGNMENT)
+
+/* The offset of the first object from the start of the slab. */
+#define GRAPH_SLAB_HEADER_SIZE  GRAPH_SLAB_ALIGN(sizeof(struct graph_slab))
+
+static void *graph_default_alloc(void *ctx, size_t size) {
+    (void)ctx;
+    return malloc(size);
+}
+
+static void graph_default_free(void *ctx, void *ptr, size_t size) {
+    (void)ctx;
+    (void)size;
+    free(ptr);
+}
+
+/** @see graph_alloc.h */
+const struct graph_allocator graph_allocator_default = {
+    .alloc = graph_default_alloc,
+    .free = graph_default_free,
+    .ctx = NULL,
+};
+
+/**
+ * @brief   The size of a slab of the pool in bytes.
+ * @param   pool    The pool.
+ * @return  The size of a slab.
+ */
+static size_t graph_pool_slab_size(struct graph_pool *pool) {
+    return GRAPH_SLAB_HEADER_SIZE + (pool->object_size * pool->slab_objects);
+}
+
+/** @see graph_alloc.h */
+void graph_pool_init(struct graph_pool *pool, const struct graph_allocator *allocator, size_t object_size) {
+    if (object_size < sizeof(void *)) {
+        object_size = sizeof(void *);
+    }
+
+    pool->allocator = allocator;
+    pool->object_size = GRAPH_SLAB_ALIGN(object_size);
+    pool->slab_objects = (GRAPH_SLAB_SIZE - GRAPH_SLAB_HEADER_SIZE) / pool->object_size;
+    if (0 == pool->slab_objects) {
+        pool->slab_objects = 1;
+    }
+    pool->slabs = NULL;
+    pool->spare_slabs = NULL;
+    pool->slab_used = 0;
+    pool->free_list = NULL;
+}
+
+/** @see graph_alloc.h */
+void graph_pool_destroy(struct graph_pool *pool) {
+    struct graph_slab *slab = NULL;
+    size_t slab_size = graph_pool_slab_size(pool);
+
+    graph_pool_reset(pool);
+    while (NULL != pool->spare_slabs) {
+        slab = pool->spare_slabs;
+        pool->spare_slabs = slab->next;
+        pool->allocator->free(pool->allocator->ctx, slab, slab_size);
+    }
+}
+
+/** @see graph_alloc.h */
+void graph_pool_reset(struct graph_pool *pool) {
+    struct graph_slab *slab = NULL;
+
+    while (NULL != pool->slabs) {
+        slab = pool->slabs;
+        pool->slabs = slab->next;
+        slab->next = pool->spare_slabs;
+        pool->spare_slabs = slab;
+    }
+
+    pool->slab_used = 0;
+    pool->free_list = NULL;
+}
+
+/** @see graph_alloc.h */
+graph_res_t graph_pool_reserve(struct graph_pool *pool, size_t count) {
+    struct graph_slab *slab = NULL;
+    size_t available = 0;
+
+    /* What is left of the current slab and the spare slabs. */
+    if (NULL != pool->slabs) {
+        available = pool->slab_objects - pool->slab_used;
+    }
+    for (slab = pool->spare_slabs; (NULL != slab) && (available < count); slab = slab->next) {
+        available += pool->slab_objects;
+    }
+
+    /* Allocate the missing slabs as spare slabs. */
+    while (available < count) {
+        slab = pool->allocator->alloc(pool->allocator->ctx, graph_pool_slab_size(pool));
+        if (NULL == slab) {
+            return GRAPH_ERR_MEM;
+        }
+        slab->next = pool->spare_slabs;
+        pool->spare_slabs = slab;
+        available += pool->slab_objects;
+    }
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph_alloc.h */
+void *graph_pool_alloc(struct graph_pool *pool) {
+    void *object = NULL;
+    struct graph_slab *slab = NULL;
+
+    /* Prefer recently freed objects, they are likely still in the cache. */
+    if (NULL != pool->free_list) {
+        object = pool->free_list;
+        pool->free_list = *(void **)object;
+        goto cleanup;
+    }
+
+    /* Start a new slab if the current one is exhausted, preferring a spare one. */
+    if ((NULL == pool->slabs) || (pool->slab_objects == pool->slab_used)) {
+        if (NULL != pool->spare_slabs) {
+            slab = pool->spare_slabs;
+            pool->spare_slabs = slab->next;
+        } else {
+            slab = pool->allocator->alloc(pool->allocator->ctx, graph_pool_slab_size(pool));
+            if (NULL == slab) {
+                goto cleanup;
+            }
+        }
+        slab->next = pool->slabs;
+        pool->slabs = slab;
+        pool->slab_used = 0;
+    }
+
+    /* Carve the next object out of the current slab. */
+    object = (char *)pool->slabs + GRAPH_SLAB_HEADER_SIZE + (pool->slab_used * pool->object_size);
+    pool->slab_used++;
+
+    cleanup:
+    return object;
+}
+
+/** @see graph_alloc.h */
+void graph_pool_free(struct graph_pool *pool, void *object) {
+    *(void **)object = pool->free_list;
+    pool->free_list = object;
+}
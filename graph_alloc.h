@@ -0,0 +1,113 @@
+#ifndef LIBGRAPH_GRAPH_ALLOC_H
+#define LIBGRAPH_GRAPH_ALLOC_H
+
+/******************************
+ * Includes
+ ******************************/
+#include <stdint.h>
+#include <stddef.h>
+
+#include "errors.h"
+
+/**
+ * @brief   A memory allocator, all the memory of a graph is taken from and returned to it.
+ */
+struct graph_allocator {
+    /* Allocate size bytes aligned for any type, returns NULL on failure. */
+    void *(*alloc)(void *ctx, size_t size);
+
+    /* Release a block returned by alloc, size is the size it was allocated with. */
+    void (*free)(void *ctx, void *ptr, size_t size);
+
+    /* An opaque context passed to alloc and free. */
+    void *ctx;
+};
+
+/**
+ * @brief   The default allocator, backed by malloc and free.
+ */
+extern const struct graph_allocator graph_allocator_default;
+
+/**
+ * @brief   A slab of a pool, the objects follow the header.
+ */
+struct graph_slab {
+    /* The next slab of the pool. */
+    struct graph_slab *next;
+};
+
+/**
+ * @brief   A pool of fixed size objects (a size class), carved out of large slabs.
+ *          Freed objects are kept in a free list and reused, slabs are only returned to the allocator
+ *          when the pool is destroyed.
+ */
+struct graph_pool {
+    /* The allocator the slabs are taken from. */
+    const struct graph_allocator *allocator;
+
+    /* The size of each object (rounded up so a free list link fits in it). */
+    size_t object_size;
+
+    /* The amount of objects in each slab. */
+    size_t slab_objects;
+
+    /* The slabs of the pool in use, objects are carved out of the first one. */
+    struct graph_slab *slabs;
+
+    /* Slabs kept by graph_pool_reset, reused before new slabs are allocated. */
+    struct graph_slab *spare_slabs;
+
+    /* The amount of objects carved out of the first slab so far. */
+    size_t slab_used;
+
+    /* The freed objects, linked through their first word. */
+    void *free_list;
+};
+
+/**
+ * @brief   Initialize an empty pool, no memory is allocated until the first allocation.
+ * @param   pool        The pool.
+ * @param   allocator   The allocator the slabs are taken from.
+ * @param   object_size The size of the objects of the pool.
+ */
+void graph_pool_init(struct graph_pool *pool, const struct graph_allocator *allocator, size_t object_size);
+
+/**
+ * @brief   Release all the slabs of the pool, every object of the pool is dangling after the call.
+ * @param   pool    The pool.
+ */
+void graph_pool_destroy(struct graph_pool *pool);
+
+/**
+ * @brief   Return all the objects to the pool at once while keeping its slabs for reuse.
+ * @param   pool    The pool.
+ *
+ * @note    Every object of the pool is dangling after the call.
+ */
+void graph_pool_reset(struct graph_pool *pool);
+
+/**
+ * @brief   Make sure count objects can be allocated from the pool without going to the allocator.
+ * @param   pool    The pool.
+ * @param   count   The amount of objects.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    The free list isn't counted, so the reservation may take more slabs than needed.
+ */
+graph_res_t graph_pool_reserve(struct graph_pool *pool, size_t count);
+
+/**
+ * @brief   Allocate an object from the pool.
+ * @param   pool    The pool.
+ * @return  The object, or NULL on failure.
+ */
+void *graph_pool_alloc(struct graph_pool *pool);
+
+/**
+ * @brief   Return an object to the pool.
+ * @param   pool    The pool.
+ * @param   object  The object, must have been allocated from the pool.
+ */
+void graph_pool_free(struct graph_pool *pool, void *object);
+
+#endif //LIBGRAPH_GRAPH_ALLOC_H
@@ -0,0 +1,115 @@
+#ifndef LIBGRAPH_GRAPH_CH_H
+#define LIBGRAPH_GRAPH_CH_H
+
+/******************************
+ * Includes
+ ******************************/
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "errors.h"
+#include "graph_csr.h"
+#include "graph_utils.h"
+
+/**
+ * @brief   The arcs of a contraction hierarchy leading up from each vertex, in compressed sparse rows.
+ *          The arcs of vertex i are targets[offsets[i]..offsets[i+1]), sorted by index, all of higher rank than i.
+ */
+struct graph_ch_arcs {
+    /* The first arc of each vertex (vertex_count + 1 entries). */
+    uint64_t *offsets;
+
+    /* The other end and the weight of each arc. */
+    graph_index_t *targets;
+    double *weights;
+
+    /* The vertex a shortcut bypasses (the lower ranked of its two halves), GRAPH_INDEX_NONE for an original edge. */
+    graph_index_t *middles;
+
+    /* The amount of arcs. */
+    size_t arc_count;
+};
+
+/**
+ * @brief   A contraction hierarchy of a snapshot: the vertices ranked in the order they were contracted, and the
+ *          original edges plus the shortcuts contracting them added, split by the direction of the rank.
+ *          A shortest path goes up in rank then down, so a query only searches upwards from both ends.
+ *          The vertices keep the indexes of the snapshot the hierarchy was built from.
+ */
+struct graph_ch {
+    /* The amount of vertices. */
+    size_t vertex_count;
+
+    /* The id of each vertex, ascending (as in the snapshot). */
+    uint64_t *ids;
+
+    /* The rank of each vertex, in [0, vertex_count). */
+    graph_index_t *ranks;
+
+    /* The arcs (v, w) of the snapshot going up, stored at v with w as the target. */
+    struct graph_ch_arcs forward;
+
+    /* The arcs (w, v) of the snapshot coming down, stored at v with w as the target. */
+    struct graph_ch_arcs backward;
+
+    /* The amount of arcs that are shortcuts. */
+    size_t shortcut_count;
+
+    /* The file mapping the arrays point into, NULL if they were allocated. */
+    void *mapping;
+    size_t mapping_size;
+};
+
+/**
+ * @brief   Build the contraction hierarchy of a snapshot, with non negative weights.
+ *          Vertices are contracted in rounds: every vertex not contracted yet gets a priority from its edge
+ *          difference (the shortcuts its contraction needs minus the arcs it removes), its contracted neighbors and
+ *          its level in the hierarchy so far. The vertices of lowest priority among their neighbors are contracted
+ *          together, and only the neighbors of the contracted vertices are reprioritized. A shortcut is skipped when
+ *          a bounded witness search finds a path at least as short avoiding the vertex.
+ * @param   csr             The snapshot.
+ * @param   thread_count    The amount of threads for prioritizing and witness searches (0 for one per online CPU).
+ * @param   ch              The hierarchy (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_PARAMS on a negative weight.
+ *
+ * @note    The hierarchy is the same for any amount of threads.
+ * @note    GRAPH_ch_destroy should be called to release the hierarchy.
+ */
+graph_res_t GRAPH_ch_build(const struct graph_csr *csr, size_t thread_count, struct graph_ch **ch);
+
+/**
+ * @brief   Release a contraction hierarchy (unmapping it if it was loaded with GRAPH_ch_load_mmap).
+ * @param   ch  The hierarchy.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t GRAPH_ch_destroy(struct graph_ch *ch);
+
+/**
+ * @brief   Find the index of a vertex in a contraction hierarchy, in O(log(V)).
+ * @param   ch      The hierarchy.
+ * @param   id      The id of the vertex.
+ * @param   index   The index of the vertex (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_NOT_FOUND if there is no such vertex.
+ */
+graph_res_t GRAPH_ch_find_index(const struct graph_ch *ch, uint64_t id, graph_index_t *index);
+
+/**
+ * @brief   Find the shortest path between two vertices with a contraction hierarchy.
+ *          Both ends search upwards, skipping the vertices reached shorter from above (stall on demand), each stops
+ *          once its closest vertex is past the shortest path where the searches met. The shortcuts of that path are
+ *          then unpacked into the original edges.
+ * @param   ch              The hierarchy.
+ * @param   source          The index of the source.
+ * @param   target          The index of the target.
+ * @param   is_unpacking    Should the path be unpacked, or only the distance found.
+ * @param   query           The context, it holds the distance and the path (see GRAPH_shortest_path), which is
+ *                          left empty when not unpacking.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    The hierarchy is only read, threads may query it at once, each with its own context.
+ */
+graph_res_t GRAPH_ch_query(const struct graph_ch *ch, graph_index_t source, graph_index_t target, bool is_unpacking,
+                           struct graph_path_query *query);
+
+#endif //LIBGRAPH_GRAPH_CH_H
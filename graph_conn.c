@@ -0,0 +1,821 @@
+#include "graph.h"
+#include "graph_conn.h"
+
+/**
+ * @brief   The key of an edge in the edge states, the address of the lower of its two halves.
+ * @param   e   The edge.
+ * @return  The key.
+ */
+static uint64_t graph_conn_edge_key(const struct graph_edge *e) {
+    if ((NULL != e->twin) && ((uintptr_t)e->twin < (uintptr_t)e)) {
+        return (uint64_t)(uintptr_t)e->twin;
+    }
+
+    return (uint64_t)(uintptr_t)e;
+}
+
+/**
+ * @brief   Draw a treap priority (xorshift64).
+ * @param   conn    The connectivity.
+ * @return  The priority.
+ */
+static uint32_t graph_conn_priority(struct graph_conn *conn) {
+    conn->seed ^= conn->seed << 13;
+    conn->seed ^= conn->seed >> 7;
+    conn->seed ^= conn->seed << 17;
+
+    return (uint32_t)(conn->seed >> 32);
+}
+
+/**
+ * @brief   Allocate a tour node, a tree of its own.
+ * @param   conn    The connectivity.
+ * @param   edge    The edge of an arc, NULL for a vertex.
+ * @return  The node, or NULL on failure.
+ */
+static struct graph_conn_node *graph_conn_node_alloc(struct graph_conn *conn, struct graph_conn_edge *edge) {
+    struct graph_conn_node *n = graph_pool_alloc(&conn->node_pool);
+
+    if (NULL == n) {
+        return NULL;
+    }
+
+    n->left = NULL;
+    n->right = NULL;
+    n->parent = NULL;
+    n->up = NULL;
+    n->edge = edge;
+    n->reverse = NULL;
+    LIST_INIT(&n->nontree);
+    n->vertex_count = (NULL == edge) ? 1 : 0;
+    n->priority = graph_conn_priority(conn);
+    n->flags = 0;
+    n->subtree_flags = 0;
+
+    return n;
+}
+
+/**
+ * @brief   Recompute the totals of a node from its children.
+ * @param   n   The node.
+ */
+static void graph_conn_update(struct graph_conn_node *n) {
+    n->vertex_count = (NULL == n->edge) ? 1 : 0;
+    n->subtree_flags = n->flags;
+    if (NULL != n->left) {
+        n->vertex_count += n->left->vertex_count;
+        n->subtree_flags |= n->left->subtree_flags;
+    }
+    if (NULL != n->right) {
+        n->vertex_count += n->right->vertex_count;
+        n->subtree_flags |= n->right->subtree_flags;
+    }
+}
+
+/**
+ * @brief   Set the own flags of a node and fix the totals of its ancestors.
+ * @param   n       The node.
+ * @param   flags   GRAPH_CONN_* flags.
+ */
+static void graph_conn_set_flags(struct graph_conn_node *n, uint8_t flags) {
+    n->flags = flags;
+    for (; NULL != n; n = n->parent) {
+        graph_conn_update(n);
+    }
+}
+
+/**
+ * @brief   The root of the treap of a node, which identifies its tree.
+ * @param   n   The node.
+ * @return  The root.
+ */
+static struct graph_conn_node *graph_conn_root(struct graph_conn_node *n) {
+    while (NULL != n->parent) {
+        n = n->parent;
+    }
+
+    return n;
+}
+
+/**
+ * @brief   Concatenate two tours.
+ * @param   a   The root of the first tour (optional).
+ * @param   b   The root of the second tour (optional).
+ * @return  The root of the concatenation.
+ */
+static struct graph_conn_node *graph_conn_merge(struct graph_conn_node *a, struct graph_conn_node *b) {
+    if (NULL == a) {
+        return b;
+    }
+    if (NULL == b) {
+        return a;
+    }
+
+    if (a->priority >= b->priority) {
+        a->right = graph_conn_merge(a->right, b);
+        a->right->parent = a;
+        graph_conn_update(a);
+        return a;
+    }
+
+    b->left = graph_conn_merge(a, b->left);
+    b->left->parent = b;
+    graph_conn_update(b);
+    return b;
+}
+
+/**
+ * @brief   Split a tour at a node, walking up from it.
+ * @param   n           The node.
+ * @param   is_before   Should the node start the right part (otherwise it ends the left part).
+ * @param   left        The root of the left part (out parameter).
+ * @param   right       The root of the right part (out parameter).
+ */
+static void graph_conn_split(struct graph_conn_node *n, bool is_before, struct graph_conn_node **left,
+                             struct graph_conn_node **right) {
+    struct graph_conn_node *l = NULL;
+    struct graph_conn_node *r = NULL;
+    struct graph_conn_node *x = n;
+    struct graph_conn_node *p = n->parent;
+    struct graph_conn_node *pp = NULL;
+
+    if (is_before) {
+        l = n->left;
+        n->left = NULL;
+        r = n;
+    } else {
+        r = n->right;
+        n->right = NULL;
+        l = n;
+    }
+    if (NULL != l) {
+        l->parent = NULL;
+    }
+    if (NULL != r) {
+        r->parent = NULL;
+    }
+    graph_conn_update(n);
+
+    /* Every ancestor joins the side the path comes from the other side of, with the part built so far as child. */
+    while (NULL != p) {
+        pp = p->parent;
+        if (p->right == x) {
+            p->right = l;
+            if (NULL != l) {
+                l->parent = p;
+            }
+            l = p;
+        } else {
+            p->left = r;
+            if (NULL != r) {
+                r->parent = p;
+            }
+            r = p;
+        }
+        p->parent = NULL;
+        graph_conn_update(p);
+        x = p;
+        p = pp;
+    }
+
+    *left = l;
+    *right = r;
+}
+
+/**
+ * @brief   Rotate a tour so that it starts at a node (a tour is cyclic).
+ * @param   n   The node.
+ * @return  The root of the tour.
+ */
+static struct graph_conn_node *graph_conn_reroot(struct graph_conn_node *n) {
+    struct graph_conn_node *left = NULL;
+    struct graph_conn_node *right = NULL;
+
+    graph_conn_split(n, true, &left, &right);
+    return graph_conn_merge(right, left);
+}
+
+/**
+ * @brief   Find a node of a tour with a given own flag.
+ * @param   root    The root of the tour.
+ * @param   flag    A GRAPH_CONN_* flag.
+ * @return  The node, or NULL if there is none.
+ */
+static struct graph_conn_node *graph_conn_find_flagged(struct graph_conn_node *root, uint8_t flag) {
+    struct graph_conn_node *n = root;
+
+    if (0 == (n->subtree_flags & flag)) {
+        return NULL;
+    }
+    while (0 == (n->flags & flag)) {
+        n = ((NULL != n->left) && (0 != (n->left->subtree_flags & flag))) ? n->left : n->right;
+    }
+
+    return n;
+}
+
+/**
+ * @brief   The node of a vertex in the tour of a level, added as a tree of its own if the vertex isn't there yet.
+ * @param   conn    The connectivity.
+ * @param   cv      The vertex.
+ * @param   level   The level.
+ * @return  The node, or NULL on failure.
+ */
+static struct graph_conn_node *graph_conn_vertex_node(struct graph_conn *conn, struct graph_conn_vertex *cv,
+                                                      uint32_t level) {
+    struct graph_conn_node *n = cv->node;
+    uint32_t i = 0;
+
+    for (i = 0; i < level; ++i) {
+        if (NULL == n->up) {
+            n->up = graph_conn_node_alloc(conn, NULL);
+            if (NULL == n->up) {
+                return NULL;
+            }
+        }
+        n = n->up;
+    }
+
+    return n;
+}
+
+/**
+ * @brief   Link a tree edge into the tours of a range of levels, its arcs below the range must be linked already.
+ * @param   conn    The connectivity.
+ * @param   ce      The edge, its ends must be in different trees at every level of the range.
+ * @param   from    The lowest level.
+ * @param   to      The highest level.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+static graph_res_t graph_conn_link(struct graph_conn *conn, struct graph_conn_edge *ce, uint32_t from, uint32_t to) {
+    struct graph_conn_node **slot = &ce->arcs;
+    struct graph_conn_node *u = NULL;
+    struct graph_conn_node *v = NULL;
+    struct graph_conn_node *forward = NULL;
+    struct graph_conn_node *backward = NULL;
+    uint32_t i = 0;
+
+    for (i = 0; i < from; ++i) {
+        slot = &(*slot)->up;
+    }
+
+    for (i = from; i <= to; ++i) {
+        u = graph_conn_vertex_node(conn, ce->ends[0], i);
+        v = graph_conn_vertex_node(conn, ce->ends[1], i);
+        forward = graph_conn_node_alloc(conn, ce);
+        backward = graph_conn_node_alloc(conn, ce);
+        if ((NULL == u) || (NULL == v) || (NULL == forward) || (NULL == backward)) {
+            return GRAPH_ERR_MEM;
+        }
+        forward->reverse = backward;
+        backward->reverse = forward;
+        graph_conn_set_flags(forward, (i == ce->level) ? GRAPH_CONN_TREE : 0);
+
+        /* The tour of u, then over to v, the tour of v and back. */
+        (void)graph_conn_merge(graph_conn_merge(graph_conn_reroot(u), forward),
+                               graph_conn_merge(graph_conn_reroot(v), backward));
+
+        *slot = forward;
+        slot = &forward->up;
+    }
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/**
+ * @brief   Cut a tree edge out of the tours of all its levels and free its arcs.
+ * @param   conn    The connectivity.
+ * @param   ce      The edge.
+ */
+static void graph_conn_cut(struct graph_conn *conn, struct graph_conn_edge *ce) {
+    struct graph_conn_node *forward = ce->arcs;
+    struct graph_conn_node *next = NULL;
+    struct graph_conn_node *inner = NULL;
+    struct graph_conn_node *outer = NULL;
+    struct graph_conn_node *arc = NULL;
+
+    while (NULL != forward) {
+        next = forward->up;
+
+        /* Starting at the forward arc the tour is: forward, the side of the second end, backward, the rest. */
+        (void)graph_conn_reroot(forward);
+        graph_conn_split(forward->reverse, true, &inner, &outer);
+        graph_conn_split(forward, false, &arc, &inner);
+        graph_conn_split(forward->reverse, false, &arc, &outer);
+
+        graph_pool_free(&conn->node_pool, forward->reverse);
+        graph_pool_free(&conn->node_pool, forward);
+        forward = next;
+    }
+
+    ce->arcs = NULL;
+}
+
+/**
+ * @brief   Add a non tree edge to the lists of its ends at its level.
+ * @param   conn    The connectivity.
+ * @param   ce      The edge.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+static graph_res_t graph_conn_list(struct graph_conn *conn, struct graph_conn_edge *ce) {
+    struct graph_conn_node *n = NULL;
+    size_t side = 0;
+
+    for (side = 0; side < 2; ++side) {
+        n = graph_conn_vertex_node(conn, ce->ends[side], ce->level);
+        if (NULL == n) {
+            return GRAPH_ERR_MEM;
+        }
+        ce->halves[side].edge = ce;
+        LIST_INSERT_HEAD(&n->nontree, &ce->halves[side], next);
+        if (0 == (n->flags & GRAPH_CONN_NONTREE)) {
+            graph_conn_set_flags(n, n->flags | GRAPH_CONN_NONTREE);
+        }
+    }
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/**
+ * @brief   Remove a non tree edge from the lists of its ends.
+ * @param   conn    The connectivity.
+ * @param   ce      The edge.
+ */
+static void graph_conn_unlist(struct graph_conn *conn, struct graph_conn_edge *ce) {
+    struct graph_conn_node *n = NULL;
+    size_t side = 0;
+
+    for (side = 0; side < 2; ++side) {
+        /* The ends are at the level of the edge already, so this doesn't allocate. */
+        n = graph_conn_vertex_node(conn, ce->ends[side], ce->level);
+        LIST_REMOVE(&ce->halves[side], next);
+        if (LIST_EMPTY(&n->nontree)) {
+            graph_conn_set_flags(n, n->flags & ~GRAPH_CONN_NONTREE);
+        }
+    }
+}
+
+/**
+ * @brief   Look for an edge reconnecting the two trees a removed tree edge split at a level.
+ *          The tree edges of the smaller tree go up a level, then its non tree edges are tried, those that stay
+ *          within it go up a level too, until one reaches the other tree and becomes a tree edge.
+ * @param   conn        The connectivity.
+ * @param   ce          The removed edge, cut at every level.
+ * @param   level       The level, at most the level of the removed edge.
+ * @param   is_replaced Was a replacement found (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+static graph_res_t graph_conn_replace(struct graph_conn *conn, struct graph_conn_edge *ce, uint32_t level,
+                                      bool *is_replaced) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_conn_node *small = graph_conn_root(graph_conn_vertex_node(conn, ce->ends[0], level));
+    struct graph_conn_node *large = graph_conn_root(graph_conn_vertex_node(conn, ce->ends[1], level));
+    struct graph_conn_node *swap = NULL;
+    struct graph_conn_node *n = NULL;
+    struct graph_conn_node *other = NULL;
+    struct graph_conn_half *half = NULL;
+    struct graph_conn_edge *candidate = NULL;
+
+    *is_replaced = false;
+    if (small->vertex_count > large->vertex_count) {
+        swap = small;
+        small = large;
+        large = swap;
+    }
+
+    /* The smaller tree has at most half the vertices, so it may go up a level. */
+    while (NULL != (n = graph_conn_find_flagged(small, GRAPH_CONN_TREE))) {
+        graph_conn_set_flags(n, 0);
+        n->edge->level = level + 1;
+        res = graph_conn_link(conn, n->edge, level + 1, level + 1);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+    }
+
+    while (NULL != (n = graph_conn_find_flagged(small, GRAPH_CONN_NONTREE))) {
+        while (!LIST_EMPTY(&n->nontree)) {
+            half = LIST_FIRST(&n->nontree);
+            candidate = half->edge;
+            other = graph_conn_vertex_node(conn, candidate->ends[(half == &candidate->halves[0]) ? 1 : 0], level);
+            graph_conn_unlist(conn, candidate);
+
+            if (graph_conn_root(other) == large) {
+                res = graph_conn_link(conn, candidate, 0, level);
+                *is_replaced = true;
+                goto cleanup;
+            }
+
+            /* Both ends are in the smaller tree, which is a tree of the next level by now. */
+            candidate->level = level + 1;
+            res = graph_conn_list(conn, candidate);
+            if (GRAPH_ERR_SUCCESS != res) {
+                goto cleanup;
+            }
+        }
+    }
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    return res;
+}
+
+/**
+ * @brief   Add an edge to the spanning forest structure, at level 0.
+ * @param   conn    The connectivity.
+ * @param   e       The edge.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+static graph_res_t graph_conn_forest_insert(struct graph_conn *conn, struct graph_edge *e) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_conn_edge *ce = graph_pool_alloc(&conn->edge_pool);
+
+    if (NULL == ce) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    ce->ends[0] = graph_hash_find(&conn->vertices, e->s_id);
+    ce->ends[1] = graph_hash_find(&conn->vertices, e->d_id);
+    ce->level = 0;
+    ce->arcs = NULL;
+
+    res = graph_hash_insert(&conn->edges, graph_conn_edge_key(e), ce);
+    if (GRAPH_ERR_SUCCESS != res) {
+        graph_pool_free(&conn->edge_pool, ce);
+        goto cleanup;
+    }
+
+    if (graph_conn_root(ce->ends[0]->node) != graph_conn_root(ce->ends[1]->node)) {
+        res = graph_conn_link(conn, ce, 0, 0);
+    } else {
+        res = graph_conn_list(conn, ce);
+    }
+
+    cleanup:
+    return res;
+}
+
+/**
+ * @brief   Remove an edge from the spanning forest structure, reconnecting its trees if it was a tree edge.
+ * @param   conn    The connectivity.
+ * @param   e       The edge.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+static graph_res_t graph_conn_forest_remove(struct graph_conn *conn, struct graph_edge *e) {
+    graph_res_t res = GRAPH_ERR_SUCCESS;
+    struct graph_conn_edge *ce = graph_hash_remove(&conn->edges, graph_conn_edge_key(e));
+    bool is_replaced = false;
+    uint32_t level = 0;
+
+    if (NULL == ce->arcs) {
+        graph_conn_unlist(conn, ce);
+    } else {
+        graph_conn_cut(conn, ce);
+        for (level = ce->level + 1; (level > 0) && (!is_replaced) && (GRAPH_ERR_SUCCESS == res); --level) {
+            res = graph_conn_replace(conn, ce, level - 1, &is_replaced);
+        }
+    }
+
+    graph_pool_free(&conn->edge_pool, ce);
+    return res;
+}
+
+/**
+ * @brief   Find the representative of the union-find set of a vertex, halving the path on the way.
+ * @param   cv  The vertex.
+ * @return  The representative.
+ */
+static struct graph_conn_vertex *graph_conn_find(struct graph_conn_vertex *cv) {
+    while (cv->parent != cv) {
+        cv->parent = cv->parent->parent;
+        cv = cv->parent;
+    }
+
+    return cv;
+}
+
+/**
+ * @brief   Join the union-find sets of two vertices, by rank.
+ * @param   a   The first vertex.
+ * @param   b   The second vertex.
+ */
+static void graph_conn_union(struct graph_conn_vertex *a, struct graph_conn_vertex *b) {
+    struct graph_conn_vertex *swap = NULL;
+
+    a = graph_conn_find(a);
+    b = graph_conn_find(b);
+    if (a == b) {
+        return;
+    }
+
+    if (a->rank < b->rank) {
+        swap = a;
+        a = b;
+        b = swap;
+    }
+    b->parent = a;
+    if (a->rank == b->rank) {
+        a->rank++;
+    }
+}
+
+/**
+ * @brief   Is an edge tracked, self loops don't affect connectivity.
+ * @param   e   The edge.
+ * @return  true if the edge is tracked.
+ */
+static bool graph_conn_is_tracked(const struct graph_edge *e) {
+    return e->s != e->d;
+}
+
+/**
+ * @brief   Forget all the states, leaving the tables and the pools empty.
+ * @param   conn    The connectivity.
+ */
+static void graph_conn_reset(struct graph_conn *conn) {
+    graph_hash_clear(&conn->vertices);
+    graph_hash_clear(&conn->edges);
+    graph_pool_reset(&conn->node_pool);
+    graph_pool_reset(&conn->edge_pool);
+    graph_pool_reset(&conn->vertex_pool);
+    conn->edge_count = 0;
+    conn->added_count = 0;
+}
+
+/**
+ * @brief   Give up on the states after running out of memory, the next query rebuilds them.
+ * @param   conn    The connectivity.
+ */
+static void graph_conn_invalidate(struct graph_conn *conn) {
+    graph_conn_reset(conn);
+    conn->mode = GRAPH_CONN_STALE;
+}
+
+/**
+ * @brief   Rebuild the states of a graph from scratch as a union-find.
+ * @param   g   The graph.
+ * @return  GRAPH_ERR_SUCCESS on success, on failure the states are left empty.
+ */
+static graph_res_t graph_conn_build_union_find(struct graph *g) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_conn *conn = &g->conn;
+    struct graph_conn_vertex *cv = NULL;
+    struct graph_vertex *v = NULL;
+    struct graph_edge *e = NULL;
+
+    graph_conn_reset(conn);
+    res = graph_hash_reserve(&conn->vertices, g->vertex_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    res = graph_pool_reserve(&conn->vertex_pool, g->vertex_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    LIST_FOREACH(v, &g->vertices, next) {
+        cv = graph_pool_alloc(&conn->vertex_pool);
+        cv->parent = cv;
+        cv->rank = 0;
+        cv->node = NULL;
+        res = graph_hash_insert(&conn->vertices, v->id, cv);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+    }
+
+    /* An undirectional edge is seen from both ends, it only counts once. */
+    LIST_FOREACH(v, &g->vertices, next) {
+        LIST_FOREACH(e, &v->neighbors, next) {
+            if (graph_conn_is_tracked(e) && (graph_conn_edge_key(e) == (uint64_t)(uintptr_t)e)) {
+                graph_conn_union(graph_hash_find(&conn->vertices, e->s_id), graph_hash_find(&conn->vertices, e->d_id));
+                conn->edge_count++;
+            }
+        }
+    }
+
+    conn->mode = GRAPH_CONN_UNION_FIND;
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    if (GRAPH_ERR_SUCCESS != res) {
+        graph_conn_reset(conn);
+    }
+    return res;
+}
+
+/**
+ * @brief   Move from the union-find to the spanning forest structure, adding the edges of the graph one by one.
+ * @param   g   The graph.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+static graph_res_t graph_conn_build_forest(struct graph *g) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_conn *conn = &g->conn;
+    struct graph_conn_vertex *cv = NULL;
+    struct graph_vertex *v = NULL;
+    struct graph_edge *e = NULL;
+
+    LIST_FOREACH(v, &g->vertices, next) {
+        cv = graph_hash_find(&conn->vertices, v->id);
+        cv->node = graph_conn_node_alloc(conn, NULL);
+        if (NULL == cv->node) {
+            res = GRAPH_ERR_MEM;
+            goto cleanup;
+        }
+    }
+
+    res = graph_hash_reserve(&conn->edges, conn->edge_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    LIST_FOREACH(v, &g->vertices, next) {
+        LIST_FOREACH(e, &v->neighbors, next) {
+            if (graph_conn_is_tracked(e) && (graph_conn_edge_key(e) == (uint64_t)(uintptr_t)e)) {
+                res = graph_conn_forest_insert(conn, e);
+                if (GRAPH_ERR_SUCCESS != res) {
+                    goto cleanup;
+                }
+            }
+        }
+    }
+
+    conn->mode = GRAPH_CONN_FOREST;
+    conn->added_count = 0;
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    return res;
+}
+
+/** @see graph_conn.h */
+void graph_conn_init(struct graph_conn *conn, const struct graph_allocator *allocator) {
+    conn->mode = GRAPH_CONN_DISABLED;
+    graph_hash_init(&conn->vertices, allocator);
+    graph_hash_init(&conn->edges, allocator);
+    graph_pool_init(&conn->vertex_pool, allocator, sizeof(struct graph_conn_vertex));
+    graph_pool_init(&conn->edge_pool, allocator, sizeof(struct graph_conn_edge));
+    graph_pool_init(&conn->node_pool, allocator, sizeof(struct graph_conn_node));
+    conn->edge_count = 0;
+    conn->added_count = 0;
+    conn->seed = 0x2545F4914F6CDD1DULL;
+}
+
+/** @see graph_conn.h */
+void graph_conn_destroy(struct graph_conn *conn) {
+    graph_hash_destroy(&conn->vertices);
+    graph_hash_destroy(&conn->edges);
+    graph_pool_destroy(&conn->node_pool);
+    graph_pool_destroy(&conn->edge_pool);
+    graph_pool_destroy(&conn->vertex_pool);
+    conn->mode = GRAPH_CONN_DISABLED;
+}
+
+/** @see graph_conn.h */
+graph_res_t graph_conn_enable(struct graph *g) {
+    if (GRAPH_CONN_DISABLED != g->conn.mode) {
+        return GRAPH_ERR_SUCCESS;
+    }
+
+    return graph_conn_build_union_find(g);
+}
+
+/** @see graph_conn.h */
+void graph_conn_clear(struct graph_conn *conn) {
+    if (GRAPH_CONN_DISABLED == conn->mode) {
+        return;
+    }
+
+    /* An empty graph has no edge to remove, a union-find is enough. */
+    graph_conn_reset(conn);
+    conn->mode = GRAPH_CONN_UNION_FIND;
+}
+
+/** @see graph_conn.h */
+void graph_conn_insert_vertex(struct graph *g, struct graph_vertex *v) {
+    struct graph_conn *conn = &g->conn;
+    struct graph_conn_vertex *cv = NULL;
+
+    if ((GRAPH_CONN_UNION_FIND != conn->mode) && (GRAPH_CONN_FOREST != conn->mode)) {
+        return;
+    }
+
+    cv = graph_pool_alloc(&conn->vertex_pool);
+    if (NULL == cv) {
+        goto fail;
+    }
+    cv->parent = cv;
+    cv->rank = 0;
+    cv->node = NULL;
+    if (GRAPH_CONN_FOREST == conn->mode) {
+        cv->node = graph_conn_node_alloc(conn, NULL);
+        if (NULL == cv->node) {
+            goto fail;
+        }
+    }
+    if (GRAPH_ERR_SUCCESS != graph_hash_insert(&conn->vertices, v->id, cv)) {
+        goto fail;
+    }
+
+    return;
+
+    fail:
+    graph_conn_invalidate(conn);
+}
+
+/** @see graph_conn.h */
+void graph_conn_remove_vertex(struct graph *g, struct graph_vertex *v) {
+    struct graph_conn *conn = &g->conn;
+    struct graph_conn_vertex *cv = NULL;
+    struct graph_conn_node *n = NULL;
+    struct graph_conn_node *next = NULL;
+
+    if ((GRAPH_CONN_UNION_FIND != conn->mode) && (GRAPH_CONN_FOREST != conn->mode)) {
+        return;
+    }
+
+    /* Its edges are gone, so it is alone in its set (no edge was removed in a union-find) or in its trees. */
+    cv = graph_hash_remove(&conn->vertices, v->id);
+    for (n = cv->node; NULL != n; n = next) {
+        next = n->up;
+        graph_pool_free(&conn->node_pool, n);
+    }
+    graph_pool_free(&conn->vertex_pool, cv);
+}
+
+/** @see graph_conn.h */
+void graph_conn_insert_edge(struct graph *g, struct graph_edge *e) {
+    struct graph_conn *conn = &g->conn;
+
+    if (((GRAPH_CONN_UNION_FIND != conn->mode) && (GRAPH_CONN_FOREST != conn->mode)) || (!graph_conn_is_tracked(e))) {
+        return;
+    }
+
+    conn->edge_count++;
+    if (GRAPH_CONN_UNION_FIND == conn->mode) {
+        graph_conn_union(graph_hash_find(&conn->vertices, e->s_id), graph_hash_find(&conn->vertices, e->d_id));
+        return;
+    }
+
+    if (GRAPH_ERR_SUCCESS != graph_conn_forest_insert(conn, e)) {
+        graph_conn_invalidate(conn);
+        return;
+    }
+
+    /* Once the additions since the last removal outweigh the rest of the graph, they have paid for a rebuild. */
+    conn->added_count++;
+    if (((conn->added_count * 2) > (conn->edge_count + g->vertex_count)) &&
+        (GRAPH_ERR_SUCCESS != graph_conn_build_union_find(g))) {
+        graph_conn_invalidate(conn);
+    }
+}
+
+/** @see graph_conn.h */
+void graph_conn_remove_edge(struct graph *g, struct graph_edge *e) {
+    struct graph_conn *conn = &g->conn;
+
+    if (((GRAPH_CONN_UNION_FIND != conn->mode) && (GRAPH_CONN_FOREST != conn->mode)) || (!graph_conn_is_tracked(e))) {
+        return;
+    }
+
+    /* A union-find can't split a set, the first removal moves to the forest (the edge is still in the graph). */
+    if ((GRAPH_CONN_UNION_FIND == conn->mode) && (GRAPH_ERR_SUCCESS != graph_conn_build_forest(g))) {
+        graph_conn_invalidate(conn);
+        return;
+    }
+
+    conn->edge_count--;
+    conn->added_count = 0;
+    if (GRAPH_ERR_SUCCESS != graph_conn_forest_remove(conn, e)) {
+        graph_conn_invalidate(conn);
+    }
+}
+
+/** @see graph_conn.h */
+graph_res_t graph_conn_connected(struct graph *g, struct graph_vertex *u, struct graph_vertex *v, bool *is_connected) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_conn *conn = &g->conn;
+    struct graph_conn_vertex *cu = NULL;
+    struct graph_conn_vertex *cv = NULL;
+
+    if (GRAPH_CONN_STALE == conn->mode) {
+        res = graph_conn_build_union_find(g);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+    }
+
+    cu = graph_hash_find(&conn->vertices, u->id);
+    cv = graph_hash_find(&conn->vertices, v->id);
+    if (GRAPH_CONN_UNION_FIND == conn->mode) {
+        *is_connected = (graph_conn_find(cu) == graph_conn_find(cv));
+    } else {
+        *is_connected = (graph_conn_root(cu->node) == graph_conn_root(cv->node));
+    }
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    return res;
+}
@@ -0,0 +1,204 @@
+#ifndef LIBGRAPH_GRAPH_CONN_H
+#define LIBGRAPH_GRAPH_CONN_H
+
+/******************************
+ * Includes
+ ******************************/
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "queue.h"
+
+#include "errors.h"
+#include "graph_alloc.h"
+#include "graph_hash.h"
+
+struct graph;
+struct graph_vertex;
+struct graph_edge;
+
+/**
+ * @brief   How the connectivity of a graph is tracked.
+ */
+typedef enum graph_conn_mode_e {
+    /* Not tracked. */
+    GRAPH_CONN_DISABLED = 0,
+
+    /* No edge was removed lately, the components are the sets of a union-find. */
+    GRAPH_CONN_UNION_FIND,
+
+    /* Edges are being removed, the components are the trees of a leveled spanning forest. */
+    GRAPH_CONN_FOREST,
+
+    /* An update ran out of memory, the components are rebuilt by the next query. */
+    GRAPH_CONN_STALE,
+} graph_conn_mode_t;
+
+/* The own flags of a node of an Euler tour, or of any node under it. */
+#define GRAPH_CONN_TREE     (1 << 0)    /* The forward arc of a tree edge whose level is the one of the tour. */
+#define GRAPH_CONN_NONTREE  (1 << 1)    /* A vertex with non tree edges at the level of the tour. */
+
+/**
+ * @brief   An end of a non tree edge, in the list of its vertex at the level of the edge.
+ */
+struct graph_conn_half {
+    LIST_ENTRY(graph_conn_half) next;
+    struct graph_conn_edge *edge;
+};
+
+BSD_LIST_HEAD(graph_conn_half_list, graph_conn_half);
+
+/**
+ * @brief   A node of an Euler tour of a spanning tree, kept in a treap ordered by the tour.
+ *          A vertex appears once in the tour of each level, a tree edge as an arc in each direction.
+ */
+struct graph_conn_node {
+    /* The treap links. */
+    struct graph_conn_node *left;
+    struct graph_conn_node *right;
+    struct graph_conn_node *parent;
+
+    /* The same vertex, or the same arc, one level up (NULL at the highest level it is at). */
+    struct graph_conn_node *up;
+
+    /* The edge of an arc (NULL for a vertex) and the arc going the other way. */
+    struct graph_conn_edge *edge;
+    struct graph_conn_node *reverse;
+
+    /* The non tree edges of a vertex at the level of the tour. */
+    struct graph_conn_half_list nontree;
+
+    /* The amount of vertices in the subtree. */
+    size_t vertex_count;
+
+    /* The heap priority of the treap. */
+    uint32_t priority;
+
+    /* GRAPH_CONN_* flags of the node, and of its whole subtree. */
+    uint8_t flags;
+    uint8_t subtree_flags;
+};
+
+/**
+ * @brief   The connectivity state of a vertex.
+ */
+struct graph_conn_vertex {
+    /* The union-find parent (itself at the root of a set) and the rank of the set. */
+    struct graph_conn_vertex *parent;
+    uint32_t rank;
+
+    /* The node of the vertex in the tour of level 0, the higher levels follow through up. */
+    struct graph_conn_node *node;
+};
+
+/**
+ * @brief   The connectivity state of an edge of the spanning forest structure.
+ */
+struct graph_conn_edge {
+    /* The vertices of the edge. */
+    struct graph_conn_vertex *ends[2];
+
+    /* The level of the edge, it only goes up while the edge stays in the graph. */
+    uint32_t level;
+
+    /* The forward arc of a tree edge at level 0, the higher levels follow through up (NULL for a non tree edge). */
+    struct graph_conn_node *arcs;
+
+    /* The ends of a non tree edge in the lists of its vertices. */
+    struct graph_conn_half halves[2];
+};
+
+/**
+ * @brief   The connected components of a graph (ignoring the direction of the edges), maintained through its updates.
+ *          While edges are only added a union-find answers in near constant time. The first removal builds a spanning
+ *          forest with levels (Holm, de Lichtenberg and Thorup): every edge has a level, the tree edges of level i and
+ *          up span the trees of forest F_i, each an Euler tour in a treap. A tree of F_i has at most V / 2^i vertices,
+ *          so when a tree edge is removed the smaller half is searched for a replacement level by level, pushing the
+ *          edges it searched up a level, for O(log^2(V)) amortized per update. Enough additions in a row go back to the
+ *          union-find.
+ */
+struct graph_conn {
+    graph_conn_mode_t mode;
+
+    /* The state of each vertex by its id, and of each edge by its address (the lower of the two halves). */
+    struct graph_hash vertices;
+    struct graph_hash edges;
+
+    /* The pools of the states and the tour nodes. */
+    struct graph_pool vertex_pool;
+    struct graph_pool edge_pool;
+    struct graph_pool node_pool;
+
+    /* The amount of edges tracked (self loops aren't), and those added since the last removal. */
+    size_t edge_count;
+    size_t added_count;
+
+    /* The state of the generator of treap priorities. */
+    uint64_t seed;
+};
+
+/**
+ * @brief   Initialize the connectivity of a graph, disabled.
+ * @param   conn        The connectivity.
+ * @param   allocator   The allocator of its memory.
+ */
+void graph_conn_init(struct graph_conn *conn, const struct graph_allocator *allocator);
+
+/**
+ * @brief   Release the memory of the connectivity.
+ * @param   conn    The connectivity.
+ */
+void graph_conn_destroy(struct graph_conn *conn);
+
+/**
+ * @brief   Start tracking the connectivity of a graph, with a union-find of its current edges.
+ * @param   g   The graph.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t graph_conn_enable(struct graph *g);
+
+/**
+ * @brief   Forget all the vertices and edges, for when the graph is cleared.
+ * @param   conn    The connectivity.
+ */
+void graph_conn_clear(struct graph_conn *conn);
+
+/**
+ * @brief   Track a vertex just added to the graph.
+ * @param   g   The graph.
+ * @param   v   The vertex.
+ */
+void graph_conn_insert_vertex(struct graph *g, struct graph_vertex *v);
+
+/**
+ * @brief   Stop tracking a vertex about to be removed from the graph, along with all its edges.
+ * @param   g   The graph.
+ * @param   v   The vertex.
+ */
+void graph_conn_remove_vertex(struct graph *g, struct graph_vertex *v);
+
+/**
+ * @brief   Track an edge just added to the graph.
+ * @param   g   The graph.
+ * @param   e   The edge (either half in an undirectional graph).
+ */
+void graph_conn_insert_edge(struct graph *g, struct graph_edge *e);
+
+/**
+ * @brief   Stop tracking an edge about to be removed from the graph, it must still be in the graph.
+ * @param   g   The graph.
+ * @param   e   The edge (either half in an undirectional graph).
+ */
+void graph_conn_remove_edge(struct graph *g, struct graph_edge *e);
+
+/**
+ * @brief   Check if two vertices are in the same component.
+ * @param   g               The graph.
+ * @param   u               The first vertex.
+ * @param   v               The second vertex.
+ * @param   is_connected    Are the vertices connected (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_MEM if the components had to be rebuilt and couldn't be.
+ */
+graph_res_t graph_conn_connected(struct graph *g, struct graph_vertex *u, struct graph_vertex *v, bool *is_connected);
+
+#endif //LIBGRAPH_GRAPH_CONN_H
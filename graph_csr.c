@@ -0,0 +1,610 @@
+#include <malloc.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "graph_csr.h"
+#include "graph_parallel.h"
+#include "graph_sort.h"
+
+/* The minimal amount of rows worth a thread of their own. */
+#define GRAPH_CSR_GRAIN         (4096)
+
+/* Rows up to this length are sorted with an insertion sort. */
+#define GRAPH_CSR_SMALL_ROW     (16)
+
+/* The position of a missing edge. */
+#define GRAPH_CSR_NO_EDGE       (UINT64_MAX)
+
+/**
+ * @brief   The context of the parallel steps of GRAPH_freeze.
+ */
+struct graph_freeze_ctx {
+    struct graph_csr *csr;
+
+    /* The vertex of each index. */
+    struct graph_vertex **vertices;
+};
+
+/**
+ * @brief   Restore the heap property below a node of a heap of (target, weight) pairs.
+ */
+static void graph_csr_sift_down(graph_index_t *targets, double *weights, size_t node, size_t count) {
+    graph_index_t target = targets[node];
+    double weight = weights[node];
+    size_t child = 0;
+
+    while ((child = (2 * node) + 1) < count) {
+        if (((child + 1) < count) && (targets[child + 1] > targets[child])) {
+            child++;
+        }
+        if (targets[child] <= target) {
+            break;
+        }
+        targets[node] = targets[child];
+        weights[node] = weights[child];
+        node = child;
+    }
+    targets[node] = target;
+    weights[node] = weight;
+}
+
+/**
+ * @brief   Sort a row of a snapshot by target, insertion sort for short rows, heap sort otherwise.
+ * @param   targets The targets of the row.
+ * @param   weights The weights of the row.
+ * @param   count   The length of the row.
+ */
+static void graph_csr_sort_row(graph_index_t *targets, double *weights, size_t count) {
+    graph_index_t target = 0;
+    double weight = 0;
+    size_t i = 0;
+    size_t j = 0;
+
+    if (count <= GRAPH_CSR_SMALL_ROW) {
+        for (i = 1; i < count; ++i) {
+            target = targets[i];
+            weight = weights[i];
+            for (j = i; (j > 0) && (targets[j - 1] > target); --j) {
+                targets[j] = targets[j - 1];
+                weights[j] = weights[j - 1];
+            }
+            targets[j] = target;
+            weights[j] = weight;
+        }
+        return;
+    }
+
+    for (i = count / 2; i > 0; --i) {
+        graph_csr_sift_down(targets, weights, i - 1, count);
+    }
+    for (i = count - 1; i > 0; --i) {
+        target = targets[0];
+        weight = weights[0];
+        targets[0] = targets[i];
+        weights[0] = weights[i];
+        targets[i] = target;
+        weights[i] = weight;
+        graph_csr_sift_down(targets, weights, 0, i);
+    }
+}
+
+static void graph_csr_sort_rows_range(void *ctx, size_t begin, size_t end, size_t thread_id) {
+    struct graph_csr *csr = ctx;
+    size_t i = 0;
+
+    (void)thread_id;
+    for (i = begin; i < end; ++i) {
+        graph_csr_sort_row(csr->targets + csr->offsets[i], csr->weights + csr->offsets[i],
+                           csr->offsets[i + 1] - csr->offsets[i]);
+    }
+}
+
+/**
+ * @brief   Fill and sort a range of rows of the snapshot from the neighbor lists of their vertices.
+ */
+static void graph_freeze_fill_range(void *ctx, size_t begin, size_t end, size_t thread_id) {
+    struct graph_freeze_ctx *freeze = ctx;
+    struct graph_csr *csr = freeze->csr;
+    struct graph_edge *e = NULL;
+    uint64_t *id = NULL;
+    uint64_t k = 0;
+    size_t i = 0;
+
+    (void)thread_id;
+    for (i = begin; i < end; ++i) {
+        k = csr->offsets[i];
+        LIST_FOREACH(e, &freeze->vertices[i]->neighbors, next) {
+            id = graph_hash_find(&csr->id_map, e->d_id);
+            csr->targets[k] = (graph_index_t)(id - csr->ids);
+            csr->weights[k] = e->weight;
+            k++;
+        }
+        graph_csr_sort_row(csr->targets + csr->offsets[i], csr->weights + csr->offsets[i], k - csr->offsets[i]);
+    }
+}
+
+/** @see graph_csr.h */
+graph_res_t graph_csr_alloc(bool is_directional, size_t vertex_count, size_t edge_count, struct graph_csr **csr) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_csr *local_csr = NULL;
+
+    /* Parameter check. */
+    if (NULL == csr) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+    if (vertex_count >= GRAPH_INDEX_NONE) {
+        res = GRAPH_ERR_OVERFLOW;
+        goto cleanup;
+    }
+
+    local_csr = calloc(1, sizeof(*local_csr));
+    if (NULL == local_csr) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    local_csr->is_directional = is_directional;
+    local_csr->vertex_count = vertex_count;
+    local_csr->edge_count = edge_count;
+    graph_hash_init(&local_csr->id_map, &graph_allocator_default);
+
+    /* Allocate at least one entry so empty snapshots look like any other. */
+    local_csr->ids = malloc(sizeof(*local_csr->ids) * (vertex_count + 1));
+    local_csr->offsets = malloc(sizeof(*local_csr->offsets) * (vertex_count + 1));
+    local_csr->targets = malloc(sizeof(*local_csr->targets) * (edge_count + 1));
+    local_csr->weights = malloc(sizeof(*local_csr->weights) * (edge_count + 1));
+    if ((NULL == local_csr->ids) || (NULL == local_csr->offsets) ||
+        (NULL == local_csr->targets) || (NULL == local_csr->weights)) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    local_csr->offsets[0] = 0;
+
+    /* Transfer ownership and indicate success. */
+    *csr = local_csr;
+    local_csr = NULL;
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    if (NULL != local_csr) {
+        (void)GRAPH_csr_destroy(local_csr);
+    }
+    return res;
+}
+
+/** @see graph_csr.h */
+graph_res_t graph_csr_build_id_map(struct graph_csr *csr) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    size_t i = 0;
+
+    graph_hash_clear(&csr->id_map);
+    res = graph_hash_reserve(&csr->id_map, csr->vertex_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    for (i = 0; i < csr->vertex_count; ++i) {
+        res = graph_hash_insert(&csr->id_map, csr->ids[i], &csr->ids[i]);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+    }
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    return res;
+}
+
+/** @see graph_csr.h */
+graph_res_t graph_csr_sort_rows(struct graph_csr *csr, size_t thread_count) {
+    return graph_parallel_for(csr->vertex_count, thread_count, GRAPH_CSR_GRAIN, graph_csr_sort_rows_range, csr);
+}
+
+/** @see graph_csr.h */
+graph_res_t GRAPH_freeze(struct graph *g, size_t thread_count, struct graph_csr **csr) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_csr *local_csr = NULL;
+    struct graph_freeze_ctx freeze = {NULL, NULL};
+    struct graph_vertex **list_vertices = NULL;
+    uint64_t *order = NULL;
+    struct graph_vertex *v = NULL;
+    size_t edge_count = 0;
+    size_t i = 0;
+
+    /* Parameter check. */
+    if ((NULL == g) || (NULL == csr)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    /* Count the edges. */
+    LIST_FOREACH(v, &g->vertices, next) {
+        edge_count += v->neighbor_count;
+    }
+
+    res = graph_csr_alloc(g->is_directional, g->vertex_count, edge_count, &local_csr);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Number the vertices by ascending id, their position in the list is sorted along as the payload. */
+    freeze.vertices = malloc(sizeof(*freeze.vertices) * (g->vertex_count + 1));
+    list_vertices = malloc(sizeof(*list_vertices) * (g->vertex_count + 1));
+    order = malloc(sizeof(*order) * (g->vertex_count + 1));
+    if ((NULL == freeze.vertices) || (NULL == list_vertices) || (NULL == order)) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    i = 0;
+    LIST_FOREACH(v, &g->vertices, next) {
+        local_csr->ids[i] = v->id;
+        list_vertices[i] = v;
+        order[i] = i;
+        i++;
+    }
+    res = graph_sort_u64(local_csr->ids, order, g->vertex_count, &g->allocator);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    for (i = 0; i < g->vertex_count; ++i) {
+        freeze.vertices[i] = list_vertices[order[i]];
+    }
+    res = graph_csr_build_id_map(local_csr);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* The rows are laid out in index order. */
+    for (i = 0; i < g->vertex_count; ++i) {
+        local_csr->offsets[i + 1] = local_csr->offsets[i] + freeze.vertices[i]->neighbor_count;
+    }
+
+    /* Fill the rows in parallel. */
+    freeze.csr = local_csr;
+    res = graph_parallel_for(g->vertex_count, thread_count, GRAPH_CSR_GRAIN, graph_freeze_fill_range, &freeze);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Transfer ownership and indicate success. */
+    *csr = local_csr;
+    local_csr = NULL;
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    if (NULL != freeze.vertices) {
+        free(freeze.vertices);
+    }
+    if (NULL != list_vertices) {
+        free(list_vertices);
+    }
+    if (NULL != order) {
+        free(order);
+    }
+    if (NULL != local_csr) {
+        (void)GRAPH_csr_destroy(local_csr);
+    }
+    return res;
+}
+
+/** @see graph_csr.h */
+graph_res_t GRAPH_thaw(const struct graph_csr *csr, struct graph **g) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph *local_graph = NULL;
+    uint64_t *s_ids = NULL;
+    uint64_t *d_ids = NULL;
+    double *weights = NULL;
+    size_t count = 0;
+    size_t i = 0;
+    uint64_t k = 0;
+
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == g)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    res = GRAPH_init(csr->is_directional, &local_graph);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    res = GRAPH_add_vertices(local_graph, csr->ids, csr->vertex_count, NULL);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    s_ids = malloc(sizeof(*s_ids) * (csr->edge_count + 1));
+    d_ids = malloc(sizeof(*d_ids) * (csr->edge_count + 1));
+    weights = malloc(sizeof(*weights) * (csr->edge_count + 1));
+    if ((NULL == s_ids) || (NULL == d_ids) || (NULL == weights)) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+
+    /* In an undirectional snapshot each edge is in both rows, take it once. */
+    for (i = 0; i < csr->vertex_count; ++i) {
+        for (k = csr->offsets[i]; k < csr->offsets[i + 1]; ++k) {
+            if ((!csr->is_directional) && (csr->targets[k] < i)) {
+                continue;
+            }
+            s_ids[count] = csr->ids[i];
+            d_ids[count] = csr->ids[csr->targets[k]];
+            weights[count] = csr->weights[k];
+            count++;
+        }
+    }
+
+    /* A snapshot has no repeated edges. */
+    res = GRAPH_add_edges(local_graph, s_ids, d_ids, weights, count, GRAPH_ADD_EDGES_SKIP_DUPLICATE_CHECK, NULL);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Transfer ownership and indicate success. */
+    *g = local_graph;
+    local_graph = NULL;
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    if (NULL != local_graph) {
+        (void)GRAPH_destroy(local_graph);
+    }
+    if (NULL != s_ids) {
+        free(s_ids);
+    }
+    if (NULL != d_ids) {
+        free(d_ids);
+    }
+    if (NULL != weights) {
+        free(weights);
+    }
+    return res;
+}
+
+/** @see graph_csr.h */
+graph_res_t GRAPH_csr_destroy(struct graph_csr *csr) {
+    /* Parameter check. */
+    if (NULL == csr) {
+        return GRAPH_ERR_PARAMS;
+    }
+
+    graph_hash_destroy(&csr->id_map);
+    if (NULL != csr->mapping) {
+        (void)munmap(csr->mapping, csr->mapping_size);
+    } else {
+        if (NULL != csr->ids) {
+            free(csr->ids);
+        }
+        if (NULL != csr->offsets) {
+            free(csr->offsets);
+        }
+        if (NULL != csr->targets) {
+            free(csr->targets);
+        }
+        if (NULL != csr->weights) {
+            free(csr->weights);
+        }
+    }
+    free(csr);
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph_csr.h */
+graph_res_t GRAPH_csr_find_index(const struct graph_csr *csr, uint64_t id, graph_index_t *index) {
+    uint64_t *entry = NULL;
+    size_t low = 0;
+    size_t high = 0;
+    size_t middle = 0;
+
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == index)) {
+        return GRAPH_ERR_PARAMS;
+    }
+
+    if (0 != csr->id_map.count) {
+        entry = graph_hash_find(&csr->id_map, id);
+        if (NULL == entry) {
+            return GRAPH_ERR_NOT_FOUND;
+        }
+        *index = (graph_index_t)(entry - csr->ids);
+        return GRAPH_ERR_SUCCESS;
+    }
+
+    /* Without a map, the ids are sorted. */
+    high = csr->vertex_count;
+    while (low < high) {
+        middle = low + ((high - low) / 2);
+        if (csr->ids[middle] < id) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if ((low == csr->vertex_count) || (id != csr->ids[low])) {
+        return GRAPH_ERR_NOT_FOUND;
+    }
+
+    *index = (graph_index_t)low;
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph_csr.h */
+graph_res_t GRAPH_csr_neighbors(const struct graph_csr *csr, graph_index_t index, const graph_index_t **targets,
+                                const double **weights, size_t *count) {
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == targets) || (NULL == count) || (index >= csr->vertex_count)) {
+        return GRAPH_ERR_PARAMS;
+    }
+
+    *targets = csr->targets + csr->offsets[index];
+    if (NULL != weights) {
+        *weights = csr->weights + csr->offsets[index];
+    }
+    *count = csr->offsets[index + 1] - csr->offsets[index];
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/**
+ * @brief   Find the position of an edge in a snapshot with a binary search over the row of its source.
+ * @param   csr         The snapshot.
+ * @param   s_id        id of the source vertex.
+ * @param   d_id        id of the destination vertex.
+ * @param   position    The position of the edge in targets, or GRAPH_CSR_NO_EDGE (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_NOT_FOUND if one of the vertices doesn't exist.
+ */
+static graph_res_t graph_csr_find_edge(const struct graph_csr *csr, uint64_t s_id, uint64_t d_id,
+                                       uint64_t *position) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    graph_index_t s = 0;
+    graph_index_t d = 0;
+    uint64_t low = 0;
+    uint64_t high = 0;
+    uint64_t middle = 0;
+
+    res = GRAPH_csr_find_index(csr, s_id, &s);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    res = GRAPH_csr_find_index(csr, d_id, &d);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    *position = GRAPH_CSR_NO_EDGE;
+    low = csr->offsets[s];
+    high = csr->offsets[s + 1];
+    while (low < high) {
+        middle = low + ((high - low) / 2);
+        if (csr->targets[middle] < d) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if ((low < csr->offsets[s + 1]) && (d == csr->targets[low])) {
+        *position = low;
+    }
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    return res;
+}
+
+/** @see graph_csr.h */
+graph_res_t GRAPH_csr_has_edge(const struct graph_csr *csr, uint64_t s_id, uint64_t d_id, bool *has_edge) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    uint64_t position = 0;
+
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == has_edge)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    res = graph_csr_find_edge(csr, s_id, d_id, &position);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    *has_edge = (GRAPH_CSR_NO_EDGE != position);
+
+    cleanup:
+    return res;
+}
+
+/** @see graph_csr.h */
+graph_res_t GRAPH_csr_get_edge_weight(const struct graph_csr *csr, uint64_t s_id, uint64_t d_id, double *weight) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    uint64_t position = 0;
+
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == weight)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    res = graph_csr_find_edge(csr, s_id, d_id, &position);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    if (GRAPH_CSR_NO_EDGE == position) {
+        res = GRAPH_ERR_NOT_FOUND;
+        goto cleanup;
+    }
+
+    *weight = csr->weights[position];
+
+    cleanup:
+    return res;
+}
+
+/** @see graph_csr.h */
+graph_res_t GRAPH_csr_transpose(const struct graph_csr *csr, struct graph_csr **transpose) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_csr *local_csr = NULL;
+    uint64_t *cursors = NULL;
+    graph_index_t v = 0;
+    size_t i = 0;
+    uint64_t k = 0;
+
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == transpose)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    res = graph_csr_alloc(csr->is_directional, csr->vertex_count, csr->edge_count, &local_csr);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    cursors = malloc(sizeof(*cursors) * (csr->vertex_count + 1));
+    if (NULL == cursors) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    (void)memcpy(local_csr->ids, csr->ids, sizeof(*csr->ids) * csr->vertex_count);
+    res = graph_csr_build_id_map(local_csr);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Count the in-degrees. */
+    (void)memset(local_csr->offsets, 0, sizeof(*local_csr->offsets) * (csr->vertex_count + 1));
+    for (k = 0; k < csr->edge_count; ++k) {
+        local_csr->offsets[csr->targets[k] + 1]++;
+    }
+    for (i = 0; i < csr->vertex_count; ++i) {
+        local_csr->offsets[i + 1] += local_csr->offsets[i];
+        cursors[i] = local_csr->offsets[i];
+    }
+
+    /* Scatter the edges by ascending source, so the rows come out sorted. */
+    for (i = 0; i < csr->vertex_count; ++i) {
+        for (k = csr->offsets[i]; k < csr->offsets[i + 1]; ++k) {
+            v = csr->targets[k];
+            local_csr->targets[cursors[v]] = (graph_index_t)i;
+            local_csr->weights[cursors[v]++] = csr->weights[k];
+        }
+    }
+
+    /* Transfer ownership and indicate success. */
+    *transpose = local_csr;
+    local_csr = NULL;
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    if (NULL != cursors) {
+        free(cursors);
+    }
+    if (NULL != local_csr) {
+        (void)GRAPH_csr_destroy(local_csr);
+    }
+    return res;
+}
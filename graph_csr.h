@@ -0,0 +1,163 @@
+#ifndef LIBGRAPH_GRAPH_CSR_H
+#define LIBGRAPH_GRAPH_CSR_H
+
+/******************************
+ * Includes
+ ******************************/
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "errors.h"
+#include "graph.h"
+#include "graph_hash.h"
+
+/**
+ * @brief   A dense index of a vertex in a snapshot, in [0, vertex_count).
+ */
+typedef uint32_t graph_index_t;
+
+/* An invalid vertex index, also the bound on the amount of vertices in a snapshot. */
+#define GRAPH_INDEX_NONE    ((graph_index_t)UINT32_MAX)
+
+/**
+ * @brief   An immutable compressed-sparse-row snapshot of a graph.
+ *          The vertices are numbered 0..vertex_count-1 by ascending id, the neighbors of vertex i are
+ *          targets[offsets[i]..offsets[i+1]), sorted by index, with the matching weights.
+ *          In an undirectional snapshot every edge appears in the rows of both its vertices.
+ */
+struct graph_csr {
+    /* Is the graph directional. */
+    bool is_directional;
+
+    /* The amount of vertices and of (directed) edges. */
+    size_t vertex_count;
+    size_t edge_count;
+
+    /* The id of each vertex, ascending. */
+    uint64_t *ids;
+
+    /* The first edge of each vertex (vertex_count + 1 entries). */
+    uint64_t *offsets;
+
+    /* The destination index and weight of each edge. */
+    graph_index_t *targets;
+    double *weights;
+
+    /* A map from id to the matching entry of ids, empty for a mapped snapshot (ids are binary searched). */
+    struct graph_hash id_map;
+
+    /* The file mapping the arrays point into, NULL if they were allocated. */
+    void *mapping;
+    size_t mapping_size;
+};
+
+/**
+ * @brief   Build an immutable CSR snapshot of a graph.
+ * @param   g               The graph.
+ * @param   thread_count    The amount of threads to build with (0 for one per online CPU).
+ * @param   csr             The snapshot (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_OVERFLOW if the graph has too many vertices.
+ *
+ * @note    The build takes O(V+E) time (plus sorting each row), rows are filled and sorted in parallel.
+ * @note    The snapshot doesn't reference the graph, GRAPH_csr_destroy should be called to release it.
+ */
+graph_res_t GRAPH_freeze(struct graph *g, size_t thread_count, struct graph_csr **csr);
+
+/**
+ * @brief   Build a mutable graph from a snapshot.
+ * @param   csr The snapshot.
+ * @param   g   The graph generated (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    The graph is loaded with the batch API, the caller should call GRAPH_destroy to release it.
+ */
+graph_res_t GRAPH_thaw(const struct graph_csr *csr, struct graph **g);
+
+/**
+ * @brief   Release a snapshot.
+ * @param   csr The snapshot.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t GRAPH_csr_destroy(struct graph_csr *csr);
+
+/**
+ * @brief   Find the index of a vertex in a snapshot, in O(1) expected (O(log(V)) for a mapped snapshot).
+ * @param   csr     The snapshot.
+ * @param   id      The id of the vertex.
+ * @param   index   The index of the vertex (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_NOT_FOUND if there is no such vertex.
+ */
+graph_res_t GRAPH_csr_find_index(const struct graph_csr *csr, uint64_t id, graph_index_t *index);
+
+/**
+ * @brief   Get the neighbors of a vertex in a snapshot.
+ * @param   csr         The snapshot.
+ * @param   index       The index of the vertex.
+ * @param   targets     The indexes of the neighbors, sorted (out parameter).
+ * @param   weights     The weights of the edges to the neighbors (out parameter, optional).
+ * @param   count       The amount of neighbors (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    The arrays point into the snapshot and are valid as long as it is.
+ */
+graph_res_t GRAPH_csr_neighbors(const struct graph_csr *csr, graph_index_t index, const graph_index_t **targets,
+                                const double **weights, size_t *count);
+
+/**
+ * @brief   Checks if there is an edge between two vertices of a snapshot, in O(log(deg)).
+ * @param   csr         The snapshot.
+ * @param   s_id        id of the source vertex.
+ * @param   d_id        id of the destination vertex.
+ * @param   has_edge    Is there an edge (s_id, d_id) (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_NOT_FOUND if one of the vertices doesn't exist.
+ */
+graph_res_t GRAPH_csr_has_edge(const struct graph_csr *csr, uint64_t s_id, uint64_t d_id, bool *has_edge);
+
+/**
+ * @brief   Returns the weight of an edge of a snapshot, in O(log(deg)).
+ * @param   csr     The snapshot.
+ * @param   s_id    id of the source vertex.
+ * @param   d_id    id of the destination vertex.
+ * @param   weight  The weight of the edge (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_NOT_FOUND if there is no such edge.
+ */
+graph_res_t GRAPH_csr_get_edge_weight(const struct graph_csr *csr, uint64_t s_id, uint64_t d_id, double *weight);
+
+/**
+ * @brief   Build the transpose of a snapshot: the same vertices with every edge reversed, so the rows hold the
+ *          in-edges of the vertices. The transpose of an undirectional snapshot is a copy of it.
+ * @param   csr         The snapshot.
+ * @param   transpose   The transposed snapshot (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    GRAPH_csr_destroy should be called to release the transpose.
+ */
+graph_res_t GRAPH_csr_transpose(const struct graph_csr *csr, struct graph_csr **transpose);
+
+/**
+ * @brief   Allocate a snapshot with uninitialized arrays (but for offsets[0] = 0) and an empty id map.
+ * @param   is_directional  Is the graph directional.
+ * @param   vertex_count    The amount of vertices.
+ * @param   edge_count      The amount of edges.
+ * @param   csr             The snapshot (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t graph_csr_alloc(bool is_directional, size_t vertex_count, size_t edge_count, struct graph_csr **csr);
+
+/**
+ * @brief   Fill the id map of a snapshot from its ids.
+ * @param   csr The snapshot.
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_FOUND if an id appears twice.
+ */
+graph_res_t graph_csr_build_id_map(struct graph_csr *csr);
+
+/**
+ * @brief   Sort the edges of every row of a snapshot by their target.
+ * @param   csr             The snapshot.
+ * @param   thread_count    The amount of threads to sort with.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t graph_csr_sort_rows(struct graph_csr *csr, size_t thread_count);
+
+#endif //LIBGRAPH_GRAPH_CSR_H
@@ -0,0 +1,168 @@
+#include <string.h>
+#include "graph_epoch.h"
+
+/* The first capacity of the retired queue. */
+#define GRAPH_EPOCH_MIN_CAPACITY    (64)
+
+/** @see graph_epoch.h */
+void graph_epoch_init(struct graph_epoch *epoch, const struct graph_allocator *allocator) {
+    epoch->is_enabled = false;
+    epoch->epoch = GRAPH_EPOCH_QUIESCENT + 1;
+    (void)pthread_mutex_init(&epoch->lock, NULL);
+    epoch->readers = NULL;
+    epoch->allocator = allocator;
+    epoch->retired = NULL;
+    epoch->retired_count = 0;
+    epoch->retired_capacity = 0;
+    epoch->reclaim_at = GRAPH_EPOCH_RECLAIM_BATCH;
+}
+
+/** @see graph_epoch.h */
+void graph_epoch_destroy(struct graph_epoch *epoch) {
+    if (NULL != epoch->retired) {
+        epoch->allocator->free(epoch->allocator->ctx, epoch->retired,
+                               sizeof(*epoch->retired) * epoch->retired_capacity);
+    }
+    epoch->retired = NULL;
+    epoch->retired_count = 0;
+    epoch->retired_capacity = 0;
+    (void)pthread_mutex_destroy(&epoch->lock);
+}
+
+/** @see graph_epoch.h */
+void graph_epoch_clear(struct graph_epoch *epoch) {
+    epoch->retired_count = 0;
+    epoch->reclaim_at = GRAPH_EPOCH_RECLAIM_BATCH;
+}
+
+/** @see graph_epoch.h */
+void graph_epoch_register(struct graph_epoch *epoch, struct graph_reader *reader) {
+    __atomic_store_n(&reader->epoch, GRAPH_EPOCH_QUIESCENT, __ATOMIC_RELAXED);
+
+    (void)pthread_mutex_lock(&epoch->lock);
+    reader->next = epoch->readers;
+    epoch->readers = reader;
+    (void)pthread_mutex_unlock(&epoch->lock);
+}
+
+/** @see graph_epoch.h */
+void graph_epoch_unregister(struct graph_epoch *epoch, struct graph_reader *reader) {
+    struct graph_reader **curr = NULL;
+
+    (void)pthread_mutex_lock(&epoch->lock);
+    for (curr = &epoch->readers; NULL != *curr; curr = &(*curr)->next) {
+        if (reader == *curr) {
+            *curr = reader->next;
+            break;
+        }
+    }
+    (void)pthread_mutex_unlock(&epoch->lock);
+}
+
+/** @see graph_epoch.h */
+void graph_epoch_enter(struct graph_epoch *epoch, struct graph_reader *reader) {
+    /*
+     * Announcing a stale epoch is safe: the scan that advanced past it came before the announcement, so everything
+     * retired by then was already unlinked. The fence orders the announcement before the loads of the read section.
+     */
+    __atomic_store_n(&reader->epoch, __atomic_load_n(&epoch->epoch, __ATOMIC_RELAXED), __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/** @see graph_epoch.h */
+void graph_epoch_exit(struct graph_reader *reader) {
+    __atomic_store_n(&reader->epoch, GRAPH_EPOCH_QUIESCENT, __ATOMIC_RELEASE);
+}
+
+/** @see graph_epoch.h */
+graph_res_t graph_epoch_reserve(struct graph_epoch *epoch, size_t count) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_retired *retired = NULL;
+    size_t capacity = (0 == epoch->retired_capacity) ? GRAPH_EPOCH_MIN_CAPACITY : epoch->retired_capacity;
+
+    if ((!epoch->is_enabled) || ((epoch->retired_count + count) <= epoch->retired_capacity)) {
+        res = GRAPH_ERR_SUCCESS;
+        goto cleanup;
+    }
+
+    while (capacity < (epoch->retired_count + count)) {
+        capacity *= 2;
+    }
+    retired = epoch->allocator->alloc(epoch->allocator->ctx, sizeof(*retired) * capacity);
+    if (NULL == retired) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+
+    if (NULL != epoch->retired) {
+        (void)memcpy(retired, epoch->retired, sizeof(*retired) * epoch->retired_count);
+        epoch->allocator->free(epoch->allocator->ctx, epoch->retired,
+                               sizeof(*epoch->retired) * epoch->retired_capacity);
+    }
+    epoch->retired = retired;
+    epoch->retired_capacity = capacity;
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    return res;
+}
+
+/** @see graph_epoch.h */
+void graph_epoch_retire(struct graph_epoch *epoch, struct graph_pool *pool, void *object) {
+    struct graph_retired *retired = NULL;
+
+    if (!epoch->is_enabled) {
+        graph_pool_free(pool, object);
+        return;
+    }
+
+    retired = &epoch->retired[epoch->retired_count++];
+    retired->object = object;
+    retired->pool = pool;
+    retired->epoch = epoch->epoch;
+
+    /* Scanning the readers costs a lock, so it is only tried once a batch has piled up since the last try. */
+    if (epoch->retired_count >= epoch->reclaim_at) {
+        (void)graph_epoch_reclaim(epoch);
+    }
+}
+
+/** @see graph_epoch.h */
+bool graph_epoch_reclaim(struct graph_epoch *epoch) {
+    bool is_advancing = true;
+    struct graph_reader *reader = NULL;
+    uint64_t reader_epoch = 0;
+    size_t reclaimed = 0;
+
+    /* Order the unlinking of the retired objects before the scan (against the fence of graph_epoch_enter). */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    (void)pthread_mutex_lock(&epoch->lock);
+    for (reader = epoch->readers; NULL != reader; reader = reader->next) {
+        reader_epoch = __atomic_load_n(&reader->epoch, __ATOMIC_ACQUIRE);
+        if ((GRAPH_EPOCH_QUIESCENT != reader_epoch) && (epoch->epoch != reader_epoch)) {
+            is_advancing = false;
+            break;
+        }
+    }
+    (void)pthread_mutex_unlock(&epoch->lock);
+
+    if (is_advancing) {
+        __atomic_store_n(&epoch->epoch, epoch->epoch + 1, __ATOMIC_RELAXED);
+    }
+
+    /* An object retired at epoch e may only be held by readers that announced e or earlier, all gone by e + 2. */
+    while ((reclaimed < epoch->retired_count) && ((epoch->retired[reclaimed].epoch + 2) <= epoch->epoch)) {
+        graph_pool_free(epoch->retired[reclaimed].pool, epoch->retired[reclaimed].object);
+        reclaimed++;
+    }
+    if (0 != reclaimed) {
+        (void)memmove(epoch->retired, &epoch->retired[reclaimed],
+                      sizeof(*epoch->retired) * (epoch->retired_count - reclaimed));
+        epoch->retired_count -= reclaimed;
+    }
+    epoch->reclaim_at = epoch->retired_count + GRAPH_EPOCH_RECLAIM_BATCH;
+
+    return is_advancing;
+}
@@ -0,0 +1,173 @@
+#ifndef LIBGRAPH_GRAPH_EPOCH_H
+#define LIBGRAPH_GRAPH_EPOCH_H
+
+/******************************
+ * Includes
+ ******************************/
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "queue.h"
+
+#include "errors.h"
+#include "graph_alloc.h"
+
+/* The epoch of a reader outside of a read section, the global epoch starts above it. */
+#define GRAPH_EPOCH_QUIESCENT   (0)
+
+/* The amount of retired objects worth trying to reclaim, below it retiring only queues the object. */
+#define GRAPH_EPOCH_RECLAIM_BATCH   (64)
+
+/**
+ * @brief   A thread reading a graph while it is being mutated, registered with the graph for as long as it reads.
+ */
+struct graph_reader {
+    /* The global epoch when the current read section began, GRAPH_EPOCH_QUIESCENT outside of one. */
+    uint64_t epoch;
+
+    /* The next registered reader. */
+    struct graph_reader *next;
+};
+
+/**
+ * @brief   An object unlinked from the graph that readers may still hold.
+ */
+struct graph_retired {
+    /* The object and the pool it is returned to. */
+    void *object;
+    struct graph_pool *pool;
+
+    /* The global epoch when it was unlinked. */
+    uint64_t epoch;
+};
+
+/**
+ * @brief   Epoch based reclamation of the vertices and edges of a graph.
+ *          A reader announces the global epoch when it begins a read section. An object unlinked by the writer is
+ *          queued with the epoch it was unlinked at, and the epoch only advances once every reader in a read section
+ *          has announced the current one. Two advances later no reader can still hold the object, so it is returned
+ *          to its pool.
+ */
+struct graph_epoch {
+    /* Is reclamation deferred (otherwise objects are returned to their pools as soon as they are unlinked). */
+    bool is_enabled;
+
+    /* The global epoch, only advanced by the writer. */
+    uint64_t epoch;
+
+    /* The registered readers, the lock guards the list (not the read sections). */
+    pthread_mutex_t lock;
+    struct graph_reader *readers;
+
+    /* The retired objects, oldest first (so in ascending epochs). */
+    const struct graph_allocator *allocator;
+    struct graph_retired *retired;
+    size_t retired_count;
+    size_t retired_capacity;
+
+    /* The amount of retired objects at which reclaiming is tried next. */
+    size_t reclaim_at;
+};
+
+/**
+ * @brief   Initialize the reclamation of a graph, disabled until is_enabled is set.
+ * @param   epoch       The reclamation state.
+ * @param   allocator   The allocator of the retired queue.
+ */
+void graph_epoch_init(struct graph_epoch *epoch, const struct graph_allocator *allocator);
+
+/**
+ * @brief   Release the reclamation state, the retired objects are left to be released with their pools.
+ * @param   epoch   The reclamation state.
+ */
+void graph_epoch_destroy(struct graph_epoch *epoch);
+
+/**
+ * @brief   Forget all the retired objects, for when their pools are reset.
+ * @param   epoch   The reclamation state.
+ */
+void graph_epoch_clear(struct graph_epoch *epoch);
+
+/**
+ * @brief   Register a reader, so the epoch doesn't advance past its read sections.
+ * @param   epoch   The reclamation state.
+ * @param   reader  The reader, outside of a read section until graph_epoch_enter is called.
+ */
+void graph_epoch_register(struct graph_epoch *epoch, struct graph_reader *reader);
+
+/**
+ * @brief   Unregister a reader, it must be outside of a read section.
+ * @param   epoch   The reclamation state.
+ * @param   reader  The reader.
+ */
+void graph_epoch_unregister(struct graph_epoch *epoch, struct graph_reader *reader);
+
+/**
+ * @brief   Begin a read section, no vertex or edge the reader reaches is returned to its pool until graph_epoch_exit.
+ * @param   epoch   The reclamation state.
+ * @param   reader  The reader.
+ */
+void graph_epoch_enter(struct graph_epoch *epoch, struct graph_reader *reader);
+
+/**
+ * @brief   End a read section, the reader must not hold any vertex or edge of the graph after the call.
+ * @param   reader  The reader.
+ */
+void graph_epoch_exit(struct graph_reader *reader);
+
+/**
+ * @brief   Make sure count objects can be retired without growing the retired queue.
+ * @param   epoch   The reclamation state.
+ * @param   count   The amount of objects.
+ * @return  GRAPH_ERR_SUCCESS on success (always when reclamation isn't deferred).
+ */
+graph_res_t graph_epoch_reserve(struct graph_epoch *epoch, size_t count);
+
+/**
+ * @brief   Return an unlinked object to its pool once no reader can hold it.
+ * @param   epoch   The reclamation state.
+ * @param   pool    The pool of the object.
+ * @param   object  The object.
+ *
+ * @note    Room for the object must have been reserved with graph_epoch_reserve.
+ */
+void graph_epoch_retire(struct graph_epoch *epoch, struct graph_pool *pool, void *object);
+
+/**
+ * @brief   Advance the global epoch if every reader in a read section has seen it, and return the objects no reader
+ *          can hold anymore to their pools.
+ * @param   epoch   The reclamation state.
+ * @return  true if the epoch advanced.
+ */
+bool graph_epoch_reclaim(struct graph_epoch *epoch);
+
+/**
+ * @brief   Publish an element at the head of a list, readers following the list see it fully initialized.
+ */
+#define GRAPH_LIST_PUBLISH_HEAD(head, elm, field) do {                                                      \
+    if ((LIST_NEXT((elm), field) = LIST_FIRST((head))) != NULL)                                             \
+        LIST_FIRST((head))->field.le_prev = &LIST_NEXT((elm), field);                                       \
+    (elm)->field.le_prev = &LIST_FIRST((head));                                                             \
+    __atomic_store_n(&LIST_FIRST((head)), (elm), __ATOMIC_RELEASE);                                         \
+} while (0)
+
+/**
+ * @brief   Unlink an element from a list, it keeps pointing into the list so readers standing on it can go on.
+ */
+#define GRAPH_LIST_UNPUBLISH(elm, field) do {                                                               \
+    if (LIST_NEXT((elm), field) != NULL)                                                                    \
+        LIST_NEXT((elm), field)->field.le_prev = (elm)->field.le_prev;                                      \
+    __atomic_store_n((elm)->field.le_prev, LIST_NEXT((elm), field), __ATOMIC_RELEASE);                      \
+} while (0)
+
+/**
+ * @brief   Read the links of a list inside a read section.
+ */
+#define GRAPH_READ_FIRST(head)          __atomic_load_n(&LIST_FIRST((head)), __ATOMIC_ACQUIRE)
+#define GRAPH_READ_NEXT(elm, field)     __atomic_load_n(&LIST_NEXT((elm), field), __ATOMIC_ACQUIRE)
+
+#define GRAPH_READ_FOREACH(var, head, field)                                                                \
+    for ((var) = GRAPH_READ_FIRST((head)); (var); (var) = GRAPH_READ_NEXT((var), field))
+
+#endif //LIBGRAPH_GRAPH_EPOCH_H
@@ -0,0 +1,340 @@
+#include <malloc.h>
+#include "graph_export.h"
+
+/**
+ * @brief   The numbering of the vertices of an exported matrix.
+ */
+struct graph_export_numbering {
+    /* The id of the vertex of each row/col. */
+    uint64_t *ids;
+
+    /* A map from id to the matching entry of ids. */
+    struct graph_hash id_map;
+
+    /* The amount of edges of the graph. */
+    size_t entry_count;
+};
+
+/**
+ * @brief   Number the vertices of the graph in list order and count its edges.
+ * @param   g           The graph.
+ * @param   numbering   The numbering (out parameter), released with graph_export_numbering_destroy.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+static graph_res_t graph_export_number_vertices(struct graph *g, struct graph_export_numbering *numbering) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_vertex *v = NULL;
+    size_t i = 0;
+
+    numbering->entry_count = 0;
+    graph_hash_init(&numbering->id_map, &graph_allocator_default);
+    numbering->ids = malloc(sizeof(*numbering->ids) * (g->vertex_count + 1));
+    if (NULL == numbering->ids) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    res = graph_hash_reserve(&numbering->id_map, g->vertex_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    LIST_FOREACH(v, &g->vertices, next) {
+        numbering->ids[i] = v->id;
+        res = graph_hash_insert(&numbering->id_map, v->id, &numbering->ids[i]);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+        numbering->entry_count += v->neighbor_count;
+        i++;
+    }
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    return res;
+}
+
+/**
+ * @brief   Release a numbering, the ids are kept if they were taken by the caller (set to NULL).
+ * @param   numbering   The numbering.
+ */
+static void graph_export_numbering_destroy(struct graph_export_numbering *numbering) {
+    graph_hash_destroy(&numbering->id_map);
+    if (NULL != numbering->ids) {
+        free(numbering->ids);
+        numbering->ids = NULL;
+    }
+}
+
+/**
+ * @brief   Check the export parameters and that the indexes of a matrix fit the requested width.
+ * @param   index_width The width of the indexes.
+ * @param   weight_type The type of the values.
+ * @param   max_index   The largest index to be stored.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+static graph_res_t graph_export_check(graph_index_width_t index_width, graph_weight_type_t weight_type,
+                                      size_t max_index) {
+    if ((GRAPH_INDEX_WIDTH_32 != index_width) && (GRAPH_INDEX_WIDTH_64 != index_width)) {
+        return GRAPH_ERR_PARAMS;
+    }
+    if ((GRAPH_WEIGHT_NONE != weight_type) && (GRAPH_WEIGHT_FLOAT != weight_type) &&
+        (GRAPH_WEIGHT_DOUBLE != weight_type)) {
+        return GRAPH_ERR_PARAMS;
+    }
+    if ((GRAPH_INDEX_WIDTH_32 == index_width) && (max_index > UINT32_MAX)) {
+        return GRAPH_ERR_OVERFLOW;
+    }
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/**
+ * @brief   The size of an exported value.
+ * @param   weight_type The type of the values.
+ * @return  The size of a value, 0 if values aren't exported.
+ */
+static size_t graph_export_value_size(graph_weight_type_t weight_type) {
+    switch (weight_type) {
+        case GRAPH_WEIGHT_FLOAT:
+            return sizeof(float);
+        case GRAPH_WEIGHT_DOUBLE:
+            return sizeof(double);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief   Store an index in an array of indexes of the given width.
+ */
+static inline void graph_export_store_index(void *array, graph_index_width_t index_width, size_t position,
+                                            uint64_t index) {
+    if (GRAPH_INDEX_WIDTH_32 == index_width) {
+        ((uint32_t *)array)[position] = (uint32_t)index;
+    } else {
+        ((uint64_t *)array)[position] = index;
+    }
+}
+
+/**
+ * @brief   Store a weight in an array of values of the given type.
+ */
+static inline void graph_export_store_value(void *array, graph_weight_type_t weight_type, size_t position,
+                                            double weight) {
+    if (GRAPH_WEIGHT_FLOAT == weight_type) {
+        ((float *)array)[position] = (float)weight;
+    } else if (GRAPH_WEIGHT_DOUBLE == weight_type) {
+        ((double *)array)[position] = weight;
+    }
+}
+
+/** @see graph_export.h */
+graph_res_t GRAPH_get_adjacency_csr(struct graph *g, graph_index_width_t index_width, graph_weight_type_t weight_type,
+                                    struct graph_adjacency_csr **csr) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_export_numbering numbering = {NULL};
+    struct graph_adjacency_csr *local_csr = NULL;
+    struct graph_vertex *v = NULL;
+    struct graph_edge *e = NULL;
+    uint64_t *column = NULL;
+    size_t value_size = graph_export_value_size(weight_type);
+    size_t row = 0;
+    size_t k = 0;
+
+    /* Parameter check. */
+    if ((NULL == g) || (NULL == csr)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    res = graph_export_number_vertices(g, &numbering);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    res = graph_export_check(index_width, weight_type,
+                             (numbering.entry_count > g->vertex_count) ? numbering.entry_count : g->vertex_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Allocate the matrix. */
+    local_csr = calloc(1, sizeof(*local_csr));
+    if (NULL == local_csr) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    local_csr->size = g->vertex_count;
+    local_csr->entry_count = numbering.entry_count;
+    local_csr->index_width = index_width;
+    local_csr->weight_type = weight_type;
+    local_csr->row_offsets = malloc(index_width * (g->vertex_count + 1));
+    local_csr->columns = malloc(index_width * (numbering.entry_count + 1));
+    if ((NULL == local_csr->row_offsets) || (NULL == local_csr->columns)) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    if (0 != value_size) {
+        local_csr->values = malloc(value_size * (numbering.entry_count + 1));
+        if (NULL == local_csr->values) {
+            res = GRAPH_ERR_MEM;
+            goto cleanup;
+        }
+    }
+
+    /* A single pass over the neighbor lists, rows are written in list order. */
+    LIST_FOREACH(v, &g->vertices, next) {
+        graph_export_store_index(local_csr->row_offsets, index_width, row, k);
+        LIST_FOREACH(e, &v->neighbors, next) {
+            column = graph_hash_find(&numbering.id_map, e->d_id);
+            graph_export_store_index(local_csr->columns, index_width, k, (uint64_t)(column - numbering.ids));
+            graph_export_store_value(local_csr->values, weight_type, k, e->weight);
+            k++;
+        }
+        row++;
+    }
+    graph_export_store_index(local_csr->row_offsets, index_width, row, k);
+
+    /* Transfer ownership and indicate success. */
+    local_csr->ids = numbering.ids;
+    numbering.ids = NULL;
+    *csr = local_csr;
+    local_csr = NULL;
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    graph_export_numbering_destroy(&numbering);
+    if (NULL != local_csr) {
+        (void)GRAPH_free_adjacency_csr(local_csr);
+    }
+    return res;
+}
+
+/** @see graph_export.h */
+graph_res_t GRAPH_free_adjacency_csr(struct graph_adjacency_csr *csr) {
+    /* Parameter check. */
+    if (NULL == csr) {
+        return GRAPH_ERR_PARAMS;
+    }
+
+    if (NULL != csr->ids) {
+        free(csr->ids);
+    }
+    if (NULL != csr->row_offsets) {
+        free(csr->row_offsets);
+    }
+    if (NULL != csr->columns) {
+        free(csr->columns);
+    }
+    if (NULL != csr->values) {
+        free(csr->values);
+    }
+    free(csr);
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph_export.h */
+graph_res_t GRAPH_get_adjacency_coo(struct graph *g, graph_index_width_t index_width, graph_weight_type_t weight_type,
+                                    struct graph_adjacency_coo **coo) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_export_numbering numbering = {NULL};
+    struct graph_adjacency_coo *local_coo = NULL;
+    struct graph_vertex *v = NULL;
+    struct graph_edge *e = NULL;
+    uint64_t *column = NULL;
+    size_t value_size = graph_export_value_size(weight_type);
+    size_t row = 0;
+    size_t k = 0;
+
+    /* Parameter check. */
+    if ((NULL == g) || (NULL == coo)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    res = graph_export_number_vertices(g, &numbering);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    res = graph_export_check(index_width, weight_type, g->vertex_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Allocate the matrix. */
+    local_coo = calloc(1, sizeof(*local_coo));
+    if (NULL == local_coo) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    local_coo->size = g->vertex_count;
+    local_coo->entry_count = numbering.entry_count;
+    local_coo->index_width = index_width;
+    local_coo->weight_type = weight_type;
+    local_coo->rows = malloc(index_width * (numbering.entry_count + 1));
+    local_coo->columns = malloc(index_width * (numbering.entry_count + 1));
+    if ((NULL == local_coo->rows) || (NULL == local_coo->columns)) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    if (0 != value_size) {
+        local_coo->values = malloc(value_size * (numbering.entry_count + 1));
+        if (NULL == local_coo->values) {
+            res = GRAPH_ERR_MEM;
+            goto cleanup;
+        }
+    }
+
+    /* A single pass over the neighbor lists. */
+    LIST_FOREACH(v, &g->vertices, next) {
+        LIST_FOREACH(e, &v->neighbors, next) {
+            column = graph_hash_find(&numbering.id_map, e->d_id);
+            graph_export_store_index(local_coo->rows, index_width, k, row);
+            graph_export_store_index(local_coo->columns, index_width, k, (uint64_t)(column - numbering.ids));
+            graph_export_store_value(local_coo->values, weight_type, k, e->weight);
+            k++;
+        }
+        row++;
+    }
+
+    /* Transfer ownership and indicate success. */
+    local_coo->ids = numbering.ids;
+    numbering.ids = NULL;
+    *coo = local_coo;
+    local_coo = NULL;
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    graph_export_numbering_destroy(&numbering);
+    if (NULL != local_coo) {
+        (void)GRAPH_free_adjacency_coo(local_coo);
+    }
+    return res;
+}
+
+/** @see graph_export.h */
+graph_res_t GRAPH_free_adjacency_coo(struct graph_adjacency_coo *coo) {
+    /* Parameter check. */
+    if (NULL == coo) {
+        return GRAPH_ERR_PARAMS;
+    }
+
+    if (NULL != coo->ids) {
+        free(coo->ids);
+    }
+    if (NULL != coo->rows) {
+        free(coo->rows);
+    }
+    if (NULL != coo->columns) {
+        free(coo->columns);
+    }
+    if (NULL != coo->values) {
+        free(coo->values);
+    }
+    free(coo);
+
+    return GRAPH_ERR_SUCCESS;
+}
@@ -0,0 +1,120 @@
+#ifndef LIBGRAPH_GRAPH_EXPORT_H
+#define LIBGRAPH_GRAPH_EXPORT_H
+
+/******************************
+ * Includes
+ ******************************/
+#include <stdint.h>
+#include <stddef.h>
+
+#include "errors.h"
+#include "graph.h"
+
+/**
+ * @brief   The width of the indexes of an exported sparse matrix.
+ */
+typedef enum graph_index_width_e {
+    GRAPH_INDEX_WIDTH_32 = 4,
+    GRAPH_INDEX_WIDTH_64 = 8,
+} graph_index_width_t;
+
+/**
+ * @brief   The type of the values of an exported sparse matrix.
+ */
+typedef enum graph_weight_type_e {
+    /* Only the structure is exported, values is NULL. */
+    GRAPH_WEIGHT_NONE = 0,
+    GRAPH_WEIGHT_FLOAT,
+    GRAPH_WEIGHT_DOUBLE,
+} graph_weight_type_t;
+
+/**
+ * @brief   An adjacency matrix in compressed sparse row format.
+ *          Rows and columns are numbered in the order of the internal graph list, the entries of row i are
+ *          columns[row_offsets[i]..row_offsets[i+1]) in the order of the neighbor list of its vertex.
+ *          The arrays hold uint32_t or uint64_t indexes by index_width, and float or double values by weight_type.
+ */
+struct graph_adjacency_csr {
+    /* The size of the col/row of the matrix, and the amount of entries in it. */
+    size_t size;
+    size_t entry_count;
+
+    graph_index_width_t index_width;
+    graph_weight_type_t weight_type;
+
+    /* The id of the vertex of each row/col. */
+    uint64_t *ids;
+
+    /* size + 1 offsets into columns. */
+    void *row_offsets;
+
+    /* The column and value of each entry. */
+    void *columns;
+    void *values;
+};
+
+/**
+ * @brief   An adjacency matrix in coordinate format.
+ *          Rows and columns are numbered in the order of the internal graph list, entries are grouped by row.
+ *          The arrays hold uint32_t or uint64_t indexes by index_width, and float or double values by weight_type.
+ */
+struct graph_adjacency_coo {
+    /* The size of the col/row of the matrix, and the amount of entries in it. */
+    size_t size;
+    size_t entry_count;
+
+    graph_index_width_t index_width;
+    graph_weight_type_t weight_type;
+
+    /* The id of the vertex of each row/col. */
+    uint64_t *ids;
+
+    /* The row, column and value of each entry. */
+    void *rows;
+    void *columns;
+    void *values;
+};
+
+/**
+ * @brief   Export the adjacency matrix of the graph in compressed sparse row format.
+ * @param   g           The graph.
+ * @param   index_width The width of the exported indexes.
+ * @param   weight_type The type of the exported values.
+ * @param   csr         The exported matrix (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_OVERFLOW if the indexes don't fit index_width.
+ *
+ * @note    This takes O(V+E) time and memory, the neighbor lists are walked once.
+ * @note    GRAPH_free_adjacency_csr should be called on the matrix to free it.
+ */
+graph_res_t GRAPH_get_adjacency_csr(struct graph *g, graph_index_width_t index_width, graph_weight_type_t weight_type,
+                                    struct graph_adjacency_csr **csr);
+
+/**
+ * @brief   Frees an exported compressed sparse row matrix.
+ * @param   csr The matrix.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t GRAPH_free_adjacency_csr(struct graph_adjacency_csr *csr);
+
+/**
+ * @brief   Export the adjacency matrix of the graph in coordinate format.
+ * @param   g           The graph.
+ * @param   index_width The width of the exported indexes.
+ * @param   weight_type The type of the exported values.
+ * @param   coo         The exported matrix (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_OVERFLOW if the indexes don't fit index_width.
+ *
+ * @note    This takes O(V+E) time and memory, the neighbor lists are walked once.
+ * @note    GRAPH_free_adjacency_coo should be called on the matrix to free it.
+ */
+graph_res_t GRAPH_get_adjacency_coo(struct graph *g, graph_index_width_t index_width, graph_weight_type_t weight_type,
+                                    struct graph_adjacency_coo **coo);
+
+/**
+ * @brief   Frees an exported coordinate matrix.
+ * @param   coo The matrix.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t GRAPH_free_adjacency_coo(struct graph_adjacency_coo *coo);
+
+#endif //LIBGRAPH_GRAPH_EXPORT_H
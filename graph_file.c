@@ -0,0 +1,755 @@
+#include <malloc.h>
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "graph_file.h"
+
+/* Round an offset up to the alignment of the sections. */
+#define GRAPH_FILE_ALIGN(offset)    ((((offset) + GRAPH_FILE_ALIGNMENT - 1) / GRAPH_FILE_ALIGNMENT) * \
+                                     GRAPH_FILE_ALIGNMENT)
+
+/* The offset of the first section. */
+#define GRAPH_FILE_HEADER_SIZE      GRAPH_FILE_ALIGN(sizeof(struct graph_file_header))
+
+/* The offset of the first section of a contraction hierarchy file. */
+#define GRAPH_CH_FILE_HEADER_SIZE   GRAPH_FILE_ALIGN(sizeof(struct graph_ch_file_header))
+
+/* The initial state of a checksum. */
+#define GRAPH_CHECKSUM_SEED         (0x9e3779b97f4a7c15ULL)
+
+/**
+ * @brief   A streaming checksum over 64 bit words, bytes that don't fill a word yet are kept pending.
+ */
+struct graph_checksum {
+    uint64_t state;
+    uint8_t pending[8];
+    size_t pending_size;
+};
+
+/**
+ * @brief   The layout of the sections of a graph file.
+ */
+struct graph_file_layout {
+    uint64_t ids_offset;
+    uint64_t offsets_offset;
+    uint64_t targets_offset;
+    uint64_t weights_offset;
+    uint64_t file_size;
+};
+
+static inline uint64_t graph_rotl64(uint64_t value, unsigned int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+/**
+ * @brief   Mix a word into a checksum (the murmur3 block mix).
+ */
+static inline uint64_t graph_checksum_mix(uint64_t state, uint64_t word) {
+    word *= 0x87c37b91114253d5ULL;
+    word = graph_rotl64(word, 31);
+    word *= 0x4cf5ad432745937fULL;
+    state ^= word;
+    return (graph_rotl64(state, 27) * 5) + 0x52dce729;
+}
+
+/**
+ * @brief   Is the host little-endian, the file layout is used as is so it must match the host.
+ */
+static bool graph_file_is_little_endian(void) {
+    uint16_t value = 1;
+    uint8_t first = 0;
+
+    (void)memcpy(&first, &value, sizeof(first));
+    return (1 == first);
+}
+
+static void graph_checksum_init(struct graph_checksum *checksum) {
+    checksum->state = GRAPH_CHECKSUM_SEED;
+    checksum->pending_size = 0;
+}
+
+static void graph_checksum_update(struct graph_checksum *checksum, const void *data, size_t size) {
+    const uint8_t *bytes = data;
+    uint64_t word = 0;
+    size_t take = 0;
+
+    /* Complete a pending word first. */
+    if (0 != checksum->pending_size) {
+        take = sizeof(checksum->pending) - checksum->pending_size;
+        if (take > size) {
+            take = size;
+        }
+        (void)memcpy(checksum->pending + checksum->pending_size, bytes, take);
+        checksum->pending_size += take;
+        bytes += take;
+        size -= take;
+        if (sizeof(checksum->pending) == checksum->pending_size) {
+            (void)memcpy(&word, checksum->pending, sizeof(word));
+            checksum->state = graph_checksum_mix(checksum->state, word);
+            checksum->pending_size = 0;
+        }
+    }
+
+    for (; size >= sizeof(word); size -= sizeof(word), bytes += sizeof(word)) {
+        (void)memcpy(&word, bytes, sizeof(word));
+        checksum->state = graph_checksum_mix(checksum->state, word);
+    }
+
+    (void)memcpy(checksum->pending + checksum->pending_size, bytes, size);
+    checksum->pending_size += size;
+}
+
+static uint64_t graph_checksum_final(struct graph_checksum *checksum) {
+    uint64_t word = 0;
+
+    if (0 != checksum->pending_size) {
+        (void)memcpy(&word, checksum->pending, checksum->pending_size);
+        checksum->state = graph_checksum_mix(checksum->state, word);
+        checksum->pending_size = 0;
+    }
+
+    /* A final avalanche, so every input bit affects every output bit. */
+    word = checksum->state;
+    word ^= word >> 33;
+    word *= 0xff51afd7ed558ccdULL;
+    word ^= word >> 33;
+    return word;
+}
+
+/**
+ * @brief   The checksum of a header, covering every field before header_checksum.
+ */
+static uint64_t graph_file_header_checksum(const struct graph_file_header *header) {
+    struct graph_checksum checksum;
+
+    graph_checksum_init(&checksum);
+    graph_checksum_update(&checksum, header, offsetof(struct graph_file_header, header_checksum));
+    return graph_checksum_final(&checksum);
+}
+
+/**
+ * @brief   Compute the layout of the file of a snapshot.
+ */
+static void graph_file_compute_layout(uint64_t vertex_count, uint64_t edge_count, struct graph_file_layout *layout) {
+    layout->ids_offset = GRAPH_FILE_HEADER_SIZE;
+    layout->offsets_offset = GRAPH_FILE_ALIGN(layout->ids_offset + (sizeof(uint64_t) * vertex_count));
+    layout->targets_offset = GRAPH_FILE_ALIGN(layout->offsets_offset + (sizeof(uint64_t) * (vertex_count + 1)));
+    layout->weights_offset = GRAPH_FILE_ALIGN(layout->targets_offset + (sizeof(graph_index_t) * edge_count));
+    layout->file_size = GRAPH_FILE_ALIGN(layout->weights_offset + (sizeof(double) * edge_count));
+}
+
+/**
+ * @brief   Write a section to the file and pad it to the next section, updating the payload checksum.
+ * @param   file        The file.
+ * @param   checksum    The payload checksum.
+ * @param   data        The section.
+ * @param   size        The size of the section.
+ * @param   end         The offset the padding should reach.
+ * @param   position    The current offset in the file (updated).
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+static graph_res_t graph_file_write_section(FILE *file, struct graph_checksum *checksum, const void *data,
+                                            size_t size, uint64_t end, uint64_t *position) {
+    static const uint8_t padding[GRAPH_FILE_ALIGNMENT] = {0};
+    size_t padding_size = 0;
+
+    if ((0 != size) && (1 != fwrite(data, size, 1, file))) {
+        return GRAPH_ERR_IO;
+    }
+    graph_checksum_update(checksum, data, size);
+    *position += size;
+
+    padding_size = (size_t)(end - *position);
+    if ((0 != padding_size) && (1 != fwrite(padding, padding_size, 1, file))) {
+        return GRAPH_ERR_IO;
+    }
+    graph_checksum_update(checksum, padding, padding_size);
+    *position = end;
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph_file.h */
+graph_res_t GRAPH_csr_save(const struct graph_csr *csr, const char *path) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_file_header header;
+    struct graph_file_layout layout;
+    struct graph_checksum checksum;
+    uint8_t placeholder[GRAPH_FILE_HEADER_SIZE];
+    FILE *file = NULL;
+    uint64_t position = 0;
+
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == path)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+    if (!graph_file_is_little_endian()) {
+        res = GRAPH_ERR_FORMAT;
+        goto cleanup;
+    }
+
+    graph_file_compute_layout(csr->vertex_count, csr->edge_count, &layout);
+
+    file = fopen(path, "wb");
+    if (NULL == file) {
+        res = GRAPH_ERR_IO;
+        goto cleanup;
+    }
+
+    /* Reserve room for the header, it is written last, once the checksum is known. */
+    (void)memset(placeholder, 0, sizeof(placeholder));
+    if (1 != fwrite(placeholder, sizeof(placeholder), 1, file)) {
+        res = GRAPH_ERR_IO;
+        goto cleanup;
+    }
+    position = sizeof(placeholder);
+
+    graph_checksum_init(&checksum);
+    res = graph_file_write_section(file, &checksum, csr->ids, sizeof(*csr->ids) * csr->vertex_count,
+                                   layout.offsets_offset, &position);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    res = graph_file_write_section(file, &checksum, csr->offsets, sizeof(*csr->offsets) * (csr->vertex_count + 1),
+                                   layout.targets_offset, &position);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    res = graph_file_write_section(file, &checksum, csr->targets, sizeof(*csr->targets) * csr->edge_count,
+                                   layout.weights_offset, &position);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    res = graph_file_write_section(file, &checksum, csr->weights, sizeof(*csr->weights) * csr->edge_count,
+                                   layout.file_size, &position);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Fill and write the header. */
+    (void)memset(&header, 0, sizeof(header));
+    (void)memcpy(header.magic, GRAPH_FILE_MAGIC, sizeof(header.magic));
+    header.version = GRAPH_FILE_VERSION;
+    header.flags = csr->is_directional ? GRAPH_FILE_FLAG_DIRECTIONAL : 0;
+    header.vertex_count = csr->vertex_count;
+    header.edge_count = csr->edge_count;
+    header.ids_offset = layout.ids_offset;
+    header.offsets_offset = layout.offsets_offset;
+    header.targets_offset = layout.targets_offset;
+    header.weights_offset = layout.weights_offset;
+    header.file_size = layout.file_size;
+    header.payload_checksum = graph_checksum_final(&checksum);
+    header.header_checksum = graph_file_header_checksum(&header);
+
+    if ((0 != fseek(file, 0, SEEK_SET)) || (1 != fwrite(&header, sizeof(header), 1, file))) {
+        res = GRAPH_ERR_IO;
+        goto cleanup;
+    }
+
+    res = (0 == fclose(file)) ? GRAPH_ERR_SUCCESS : GRAPH_ERR_IO;
+    file = NULL;
+
+    cleanup:
+    if (NULL != file) {
+        (void)fclose(file);
+    }
+    return res;
+}
+
+/** @see graph_file.h */
+graph_res_t GRAPH_save(struct graph *g, const char *path) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_csr *csr = NULL;
+
+    /* Parameter check. */
+    if ((NULL == g) || (NULL == path)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    res = GRAPH_freeze(g, 0, &csr);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    res = GRAPH_csr_save(csr, path);
+
+    cleanup:
+    if (NULL != csr) {
+        (void)GRAPH_csr_destroy(csr);
+    }
+    return res;
+}
+
+/**
+ * @brief   Check that the header of a mapped file describes a layout that fits in it.
+ * @param   header      The header.
+ * @param   file_size   The size of the file.
+ * @return  GRAPH_ERR_SUCCESS if the header is valid, GRAPH_ERR_FORMAT otherwise.
+ */
+static graph_res_t graph_file_check_header(const struct graph_file_header *header, uint64_t file_size) {
+    struct graph_file_layout layout;
+
+    if ((0 != memcmp(header->magic, GRAPH_FILE_MAGIC, sizeof(header->magic))) ||
+        (GRAPH_FILE_VERSION != header->version) ||
+        (graph_file_header_checksum(header) != header->header_checksum) ||
+        (file_size != header->file_size)) {
+        return GRAPH_ERR_FORMAT;
+    }
+
+    /* Bound the counts before computing the layout from them, so it can't overflow. */
+    if ((header->vertex_count >= GRAPH_INDEX_NONE) || (header->edge_count > (file_size / sizeof(double)))) {
+        return GRAPH_ERR_FORMAT;
+    }
+    graph_file_compute_layout(header->vertex_count, header->edge_count, &layout);
+    if ((layout.ids_offset != header->ids_offset) || (layout.offsets_offset != header->offsets_offset) ||
+        (layout.targets_offset != header->targets_offset) || (layout.weights_offset != header->weights_offset) ||
+        (layout.file_size != header->file_size)) {
+        return GRAPH_ERR_FORMAT;
+    }
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/**
+ * @brief   Check the payload checksum and the structure of a mapped snapshot, in O(V+E).
+ * @param   header  The header of the file.
+ * @param   csr     The snapshot.
+ * @return  GRAPH_ERR_SUCCESS if the snapshot is valid, GRAPH_ERR_FORMAT otherwise.
+ */
+static graph_res_t graph_file_verify(const struct graph_file_header *header, const struct graph_csr *csr) {
+    struct graph_checksum checksum;
+    size_t i = 0;
+    uint64_t k = 0;
+
+    graph_checksum_init(&checksum);
+    graph_checksum_update(&checksum, (const uint8_t *)csr->mapping + GRAPH_FILE_HEADER_SIZE,
+                          (size_t)(header->file_size - GRAPH_FILE_HEADER_SIZE));
+    if (graph_checksum_final(&checksum) != header->payload_checksum) {
+        return GRAPH_ERR_FORMAT;
+    }
+
+    if ((0 != csr->offsets[0]) || (csr->edge_count != csr->offsets[csr->vertex_count])) {
+        return GRAPH_ERR_FORMAT;
+    }
+    for (i = 0; i < csr->vertex_count; ++i) {
+        if ((csr->offsets[i] > csr->offsets[i + 1]) || ((0 != i) && (csr->ids[i - 1] >= csr->ids[i]))) {
+            return GRAPH_ERR_FORMAT;
+        }
+    }
+    for (k = 0; k < csr->edge_count; ++k) {
+        if (csr->targets[k] >= csr->vertex_count) {
+            return GRAPH_ERR_FORMAT;
+        }
+    }
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph_file.h */
+graph_res_t GRAPH_load_mmap(const char *path, uint32_t flags, struct graph_csr **csr) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_csr *local_csr = NULL;
+    const struct graph_file_header *header = NULL;
+    struct stat st;
+    void *mapping = MAP_FAILED;
+    size_t mapping_size = 0;
+    int fd = -1;
+
+    /* Parameter check. */
+    if ((NULL == path) || (NULL == csr)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+    if (!graph_file_is_little_endian()) {
+        res = GRAPH_ERR_FORMAT;
+        goto cleanup;
+    }
+
+    /* Map the file. */
+    fd = open(path, O_RDONLY);
+    if ((fd < 0) || (0 != fstat(fd, &st))) {
+        res = GRAPH_ERR_IO;
+        goto cleanup;
+    }
+    if (st.st_size < (off_t)GRAPH_FILE_HEADER_SIZE) {
+        res = GRAPH_ERR_FORMAT;
+        goto cleanup;
+    }
+    mapping_size = (size_t)st.st_size;
+    mapping = mmap(NULL, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == mapping) {
+        res = GRAPH_ERR_IO;
+        goto cleanup;
+    }
+
+    header = mapping;
+    res = graph_file_check_header(header, mapping_size);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Point the snapshot into the mapping. */
+    local_csr = calloc(1, sizeof(*local_csr));
+    if (NULL == local_csr) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    local_csr->is_directional = (0 != (header->flags & GRAPH_FILE_FLAG_DIRECTIONAL));
+    local_csr->vertex_count = header->vertex_count;
+    local_csr->edge_count = header->edge_count;
+    local_csr->ids = (uint64_t *)((uint8_t *)mapping + header->ids_offset);
+    local_csr->offsets = (uint64_t *)((uint8_t *)mapping + header->offsets_offset);
+    local_csr->targets = (graph_index_t *)((uint8_t *)mapping + header->targets_offset);
+    local_csr->weights = (double *)((uint8_t *)mapping + header->weights_offset);
+    graph_hash_init(&local_csr->id_map, &graph_allocator_default);
+    local_csr->mapping = mapping;
+    local_csr->mapping_size = mapping_size;
+    mapping = MAP_FAILED;
+
+    if (0 != (flags & GRAPH_LOAD_VERIFY)) {
+        res = graph_file_verify(header, local_csr);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+    }
+
+    /* Transfer ownership and indicate success. */
+    *csr = local_csr;
+    local_csr = NULL;
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    if (NULL != local_csr) {
+        (void)GRAPH_csr_destroy(local_csr);
+    }
+    if (MAP_FAILED != mapping) {
+        (void)munmap(mapping, mapping_size);
+    }
+    if (fd >= 0) {
+        (void)close(fd);
+    }
+    return res;
+}
+
+/**
+ * @brief   The checksum of a contraction hierarchy header, covering every field before header_checksum.
+ */
+static uint64_t graph_ch_file_header_checksum(const struct graph_ch_file_header *header) {
+    struct graph_checksum checksum;
+
+    graph_checksum_init(&checksum);
+    graph_checksum_update(&checksum, header, offsetof(struct graph_ch_file_header, header_checksum));
+    return graph_checksum_final(&checksum);
+}
+
+/**
+ * @brief   Compute the layout of the file of a contraction hierarchy.
+ * @param   vertex_count    The amount of vertices.
+ * @param   forward_count   The amount of forward arcs.
+ * @param   backward_count  The amount of backward arcs.
+ * @param   sizes           The size of each section (out parameter).
+ * @param   offsets         The offset of each section (out parameter).
+ * @return  The size of the file.
+ */
+static uint64_t graph_ch_file_compute_layout(uint64_t vertex_count, uint64_t forward_count, uint64_t backward_count,
+                                             uint64_t *sizes, uint64_t *offsets) {
+    uint64_t offset = GRAPH_CH_FILE_HEADER_SIZE;
+    size_t i = 0;
+
+    sizes[GRAPH_CH_SECTION_IDS] = sizeof(uint64_t) * vertex_count;
+    sizes[GRAPH_CH_SECTION_RANKS] = sizeof(graph_index_t) * vertex_count;
+    sizes[GRAPH_CH_SECTION_FORWARD_OFFSETS] = sizeof(uint64_t) * (vertex_count + 1);
+    sizes[GRAPH_CH_SECTION_FORWARD_TARGETS] = sizeof(graph_index_t) * forward_count;
+    sizes[GRAPH_CH_SECTION_FORWARD_WEIGHTS] = sizeof(double) * forward_count;
+    sizes[GRAPH_CH_SECTION_FORWARD_MIDDLES] = sizeof(graph_index_t) * forward_count;
+    sizes[GRAPH_CH_SECTION_BACKWARD_OFFSETS] = sizeof(uint64_t) * (vertex_count + 1);
+    sizes[GRAPH_CH_SECTION_BACKWARD_TARGETS] = sizeof(graph_index_t) * backward_count;
+    sizes[GRAPH_CH_SECTION_BACKWARD_WEIGHTS] = sizeof(double) * backward_count;
+    sizes[GRAPH_CH_SECTION_BACKWARD_MIDDLES] = sizeof(graph_index_t) * backward_count;
+
+    for (i = 0; i < GRAPH_CH_SECTION_COUNT; ++i) {
+        offsets[i] = offset;
+        offset = GRAPH_FILE_ALIGN(offset + sizes[i]);
+    }
+
+    return offset;
+}
+
+/** @see graph_file.h */
+graph_res_t GRAPH_ch_save(const struct graph_ch *ch, const char *path) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_ch_file_header header;
+    struct graph_checksum checksum;
+    const void *sections[GRAPH_CH_SECTION_COUNT];
+    uint64_t sizes[GRAPH_CH_SECTION_COUNT];
+    uint64_t offsets[GRAPH_CH_SECTION_COUNT];
+    uint8_t placeholder[GRAPH_CH_FILE_HEADER_SIZE];
+    FILE *file = NULL;
+    uint64_t file_size = 0;
+    uint64_t position = 0;
+    size_t i = 0;
+
+    /* Parameter check. */
+    if ((NULL == ch) || (NULL == path)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+    if (!graph_file_is_little_endian()) {
+        res = GRAPH_ERR_FORMAT;
+        goto cleanup;
+    }
+
+    sections[GRAPH_CH_SECTION_IDS] = ch->ids;
+    sections[GRAPH_CH_SECTION_RANKS] = ch->ranks;
+    sections[GRAPH_CH_SECTION_FORWARD_OFFSETS] = ch->forward.offsets;
+    sections[GRAPH_CH_SECTION_FORWARD_TARGETS] = ch->forward.targets;
+    sections[GRAPH_CH_SECTION_FORWARD_WEIGHTS] = ch->forward.weights;
+    sections[GRAPH_CH_SECTION_FORWARD_MIDDLES] = ch->forward.middles;
+    sections[GRAPH_CH_SECTION_BACKWARD_OFFSETS] = ch->backward.offsets;
+    sections[GRAPH_CH_SECTION_BACKWARD_TARGETS] = ch->backward.targets;
+    sections[GRAPH_CH_SECTION_BACKWARD_WEIGHTS] = ch->backward.weights;
+    sections[GRAPH_CH_SECTION_BACKWARD_MIDDLES] = ch->backward.middles;
+    file_size = graph_ch_file_compute_layout(ch->vertex_count, ch->forward.arc_count, ch->backward.arc_count, sizes,
+                                             offsets);
+
+    file = fopen(path, "wb");
+    if (NULL == file) {
+        res = GRAPH_ERR_IO;
+        goto cleanup;
+    }
+
+    /* Reserve room for the header, it is written last, once the checksum is known. */
+    (void)memset(placeholder, 0, sizeof(placeholder));
+    if (1 != fwrite(placeholder, sizeof(placeholder), 1, file)) {
+        res = GRAPH_ERR_IO;
+        goto cleanup;
+    }
+    position = sizeof(placeholder);
+
+    graph_checksum_init(&checksum);
+    for (i = 0; i < GRAPH_CH_SECTION_COUNT; ++i) {
+        res = graph_file_write_section(file, &checksum, sections[i], (size_t)sizes[i],
+                                       (i + 1 < GRAPH_CH_SECTION_COUNT) ? offsets[i + 1] : file_size, &position);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+    }
+
+    /* Fill and write the header. */
+    (void)memset(&header, 0, sizeof(header));
+    (void)memcpy(header.magic, GRAPH_CH_FILE_MAGIC, sizeof(header.magic));
+    header.version = GRAPH_CH_FILE_VERSION;
+    header.vertex_count = ch->vertex_count;
+    header.forward_count = ch->forward.arc_count;
+    header.backward_count = ch->backward.arc_count;
+    header.shortcut_count = ch->shortcut_count;
+    (void)memcpy(header.section_offsets, offsets, sizeof(header.section_offsets));
+    header.file_size = file_size;
+    header.payload_checksum = graph_checksum_final(&checksum);
+    header.header_checksum = graph_ch_file_header_checksum(&header);
+
+    if ((0 != fseek(file, 0, SEEK_SET)) || (1 != fwrite(&header, sizeof(header), 1, file))) {
+        res = GRAPH_ERR_IO;
+        goto cleanup;
+    }
+
+    res = (0 == fclose(file)) ? GRAPH_ERR_SUCCESS : GRAPH_ERR_IO;
+    file = NULL;
+
+    cleanup:
+    if (NULL != file) {
+        (void)fclose(file);
+    }
+    return res;
+}
+
+/**
+ * @brief   Check that the header of a mapped contraction hierarchy file describes a layout that fits in it.
+ * @param   header      The header.
+ * @param   file_size   The size of the file.
+ * @return  GRAPH_ERR_SUCCESS if the header is valid, GRAPH_ERR_FORMAT otherwise.
+ */
+static graph_res_t graph_ch_file_check_header(const struct graph_ch_file_header *header, uint64_t file_size) {
+    uint64_t sizes[GRAPH_CH_SECTION_COUNT];
+    uint64_t offsets[GRAPH_CH_SECTION_COUNT];
+
+    if ((0 != memcmp(header->magic, GRAPH_CH_FILE_MAGIC, sizeof(header->magic))) ||
+        (GRAPH_CH_FILE_VERSION != header->version) ||
+        (graph_ch_file_header_checksum(header) != header->header_checksum) ||
+        (file_size != header->file_size)) {
+        return GRAPH_ERR_FORMAT;
+    }
+
+    /* Bound the counts before computing the layout from them, so it can't overflow. */
+    if ((header->vertex_count >= GRAPH_INDEX_NONE) || (header->forward_count > (file_size / sizeof(double))) ||
+        (header->backward_count > (file_size / sizeof(double)))) {
+        return GRAPH_ERR_FORMAT;
+    }
+    if ((graph_ch_file_compute_layout(header->vertex_count, header->forward_count, header->backward_count, sizes,
+                                      offsets) != header->file_size) ||
+        (0 != memcmp(offsets, header->section_offsets, sizeof(offsets)))) {
+        return GRAPH_ERR_FORMAT;
+    }
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/**
+ * @brief   Check the arcs of a mapped contraction hierarchy, in O(V+E).
+ */
+static graph_res_t graph_ch_file_verify_arcs(const struct graph_ch *ch, const struct graph_ch_arcs *arcs) {
+    size_t i = 0;
+    uint64_t k = 0;
+
+    if ((0 != arcs->offsets[0]) || (arcs->arc_count != arcs->offsets[ch->vertex_count])) {
+        return GRAPH_ERR_FORMAT;
+    }
+    for (i = 0; i < ch->vertex_count; ++i) {
+        if (arcs->offsets[i] > arcs->offsets[i + 1]) {
+            return GRAPH_ERR_FORMAT;
+        }
+    }
+    for (k = 0; k < arcs->arc_count; ++k) {
+        if ((arcs->targets[k] >= ch->vertex_count) ||
+            ((GRAPH_INDEX_NONE != arcs->middles[k]) && (arcs->middles[k] >= ch->vertex_count))) {
+            return GRAPH_ERR_FORMAT;
+        }
+    }
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/**
+ * @brief   Check the payload checksum and the structure of a mapped contraction hierarchy, in O(V+E).
+ * @param   header  The header of the file.
+ * @param   ch      The hierarchy.
+ * @return  GRAPH_ERR_SUCCESS if the hierarchy is valid, GRAPH_ERR_FORMAT otherwise.
+ */
+static graph_res_t graph_ch_file_verify(const struct graph_ch_file_header *header, const struct graph_ch *ch) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_checksum checksum;
+    size_t i = 0;
+
+    graph_checksum_init(&checksum);
+    graph_checksum_update(&checksum, (const uint8_t *)ch->mapping + GRAPH_CH_FILE_HEADER_SIZE,
+                          (size_t)(header->file_size - GRAPH_CH_FILE_HEADER_SIZE));
+    if (graph_checksum_final(&checksum) != header->payload_checksum) {
+        return GRAPH_ERR_FORMAT;
+    }
+
+    for (i = 0; i < ch->vertex_count; ++i) {
+        if ((ch->ranks[i] >= ch->vertex_count) || ((0 != i) && (ch->ids[i - 1] >= ch->ids[i]))) {
+            return GRAPH_ERR_FORMAT;
+        }
+    }
+    res = graph_ch_file_verify_arcs(ch, &ch->forward);
+    if (GRAPH_ERR_SUCCESS != res) {
+        return res;
+    }
+
+    return graph_ch_file_verify_arcs(ch, &ch->backward);
+}
+
+/** @see graph_file.h */
+graph_res_t GRAPH_ch_load_mmap(const char *path, uint32_t flags, struct graph_ch **ch) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_ch *local_ch = NULL;
+    const struct graph_ch_file_header *header = NULL;
+    const uint64_t *offsets = NULL;
+    uint8_t *base = NULL;
+    struct stat st;
+    void *mapping = MAP_FAILED;
+    size_t mapping_size = 0;
+    int fd = -1;
+
+    /* Parameter check. */
+    if ((NULL == path) || (NULL == ch)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+    if (!graph_file_is_little_endian()) {
+        res = GRAPH_ERR_FORMAT;
+        goto cleanup;
+    }
+
+    /* Map the file. */
+    fd = open(path, O_RDONLY);
+    if ((fd < 0) || (0 != fstat(fd, &st))) {
+        res = GRAPH_ERR_IO;
+        goto cleanup;
+    }
+    if (st.st_size < (off_t)GRAPH_CH_FILE_HEADER_SIZE) {
+        res = GRAPH_ERR_FORMAT;
+        goto cleanup;
+    }
+    mapping_size = (size_t)st.st_size;
+    mapping = mmap(NULL, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == mapping) {
+        res = GRAPH_ERR_IO;
+        goto cleanup;
+    }
+
+    header = mapping;
+    res = graph_ch_file_check_header(header, mapping_size);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Point the hierarchy into the mapping. */
+    local_ch = calloc(1, sizeof(*local_ch));
+    if (NULL == local_ch) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    base = mapping;
+    offsets = header->section_offsets;
+    local_ch->vertex_count = header->vertex_count;
+    local_ch->shortcut_count = header->shortcut_count;
+    local_ch->ids = (uint64_t *)(base + offsets[GRAPH_CH_SECTION_IDS]);
+    local_ch->ranks = (graph_index_t *)(base + offsets[GRAPH_CH_SECTION_RANKS]);
+    local_ch->forward.arc_count = header->forward_count;
+    local_ch->forward.offsets = (uint64_t *)(base + offsets[GRAPH_CH_SECTION_FORWARD_OFFSETS]);
+    local_ch->forward.targets = (graph_index_t *)(base + offsets[GRAPH_CH_SECTION_FORWARD_TARGETS]);
+    local_ch->forward.weights = (double *)(base + offsets[GRAPH_CH_SECTION_FORWARD_WEIGHTS]);
+    local_ch->forward.middles = (graph_index_t *)(base + offsets[GRAPH_CH_SECTION_FORWARD_MIDDLES]);
+    local_ch->backward.arc_count = header->backward_count;
+    local_ch->backward.offsets = (uint64_t *)(base + offsets[GRAPH_CH_SECTION_BACKWARD_OFFSETS]);
+    local_ch->backward.targets = (graph_index_t *)(base + offsets[GRAPH_CH_SECTION_BACKWARD_TARGETS]);
+    local_ch->backward.weights = (double *)(base + offsets[GRAPH_CH_SECTION_BACKWARD_WEIGHTS]);
+    local_ch->backward.middles = (graph_index_t *)(base + offsets[GRAPH_CH_SECTION_BACKWARD_MIDDLES]);
+    local_ch->mapping = mapping;
+    local_ch->mapping_size = mapping_size;
+    mapping = MAP_FAILED;
+
+    if (0 != (flags & GRAPH_LOAD_VERIFY)) {
+        res = graph_ch_file_verify(header, local_ch);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+    }
+
+    /* Transfer ownership and indicate success. */
+    *ch = local_ch;
+    local_ch = NULL;
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    if (NULL != local_ch) {
+        (void)GRAPH_ch_destroy(local_ch);
+    }
+    if (MAP_FAILED != mapping) {
+        (void)munmap(mapping, mapping_size);
+    }
+    if (fd >= 0) {
+        (void)close(fd);
+    }
+    return res;
+}
@@ -0,0 +1,176 @@
+#ifndef LIBGRAPH_GRAPH_FILE_H
+#define LIBGRAPH_GRAPH_FILE_H
+
+/******************************
+ * Includes
+ ******************************/
+#include <stdint.h>
+#include <stddef.h>
+
+#include "errors.h"
+#include "graph.h"
+#include "graph_csr.h"
+#include "graph_ch.h"
+
+/* The magic at the start of every graph file. */
+#define GRAPH_FILE_MAGIC            "LIBGRAPH"
+
+/* The current version of the graph file format. */
+#define GRAPH_FILE_VERSION          (1)
+
+/* The alignment of every section of a graph file. */
+#define GRAPH_FILE_ALIGNMENT        (64)
+
+/* Header flag: the graph is directional. */
+#define GRAPH_FILE_FLAG_DIRECTIONAL (1 << 0)
+
+/* The magic at the start of every contraction hierarchy file. */
+#define GRAPH_CH_FILE_MAGIC         "LIBGRPCH"
+
+/* The current version of the contraction hierarchy file format. */
+#define GRAPH_CH_FILE_VERSION       (1)
+
+/* GRAPH_load_mmap flag: verify the payload checksum and the structure of the snapshot (O(V+E)). */
+#define GRAPH_LOAD_VERIFY           (1 << 0)
+
+/**
+ * @brief   The header of a graph file. All the fields are little-endian.
+ *          The header is followed by the sections of a CSR snapshot (see struct graph_csr), each at a
+ *          GRAPH_FILE_ALIGNMENT aligned offset: ids (uint64_t[vertex_count]), offsets (uint64_t[vertex_count + 1]),
+ *          targets (uint32_t[edge_count]) and weights (double[edge_count]), so it can be mapped and used as is.
+ */
+struct graph_file_header {
+    /* GRAPH_FILE_MAGIC, not NUL terminated. */
+    char magic[8];
+
+    /* GRAPH_FILE_VERSION. */
+    uint32_t version;
+
+    /* GRAPH_FILE_FLAG_* flags. */
+    uint32_t flags;
+
+    /* The amount of vertices and of (directed) edges. */
+    uint64_t vertex_count;
+    uint64_t edge_count;
+
+    /* The offsets of the sections from the start of the file. */
+    uint64_t ids_offset;
+    uint64_t offsets_offset;
+    uint64_t targets_offset;
+    uint64_t weights_offset;
+
+    /* The size of the whole file. */
+    uint64_t file_size;
+
+    /* The checksum of everything after the header. */
+    uint64_t payload_checksum;
+
+    /* The checksum of the header up to this field. */
+    uint64_t header_checksum;
+};
+
+/**
+ * @brief   The sections of a contraction hierarchy file, in the order they appear (see struct graph_ch).
+ */
+typedef enum graph_ch_section_e {
+    GRAPH_CH_SECTION_IDS = 0,           /* uint64_t[vertex_count] */
+    GRAPH_CH_SECTION_RANKS,             /* uint32_t[vertex_count] */
+    GRAPH_CH_SECTION_FORWARD_OFFSETS,   /* uint64_t[vertex_count + 1] */
+    GRAPH_CH_SECTION_FORWARD_TARGETS,   /* uint32_t[forward_count] */
+    GRAPH_CH_SECTION_FORWARD_WEIGHTS,   /* double[forward_count] */
+    GRAPH_CH_SECTION_FORWARD_MIDDLES,   /* uint32_t[forward_count] */
+    GRAPH_CH_SECTION_BACKWARD_OFFSETS,  /* uint64_t[vertex_count + 1] */
+    GRAPH_CH_SECTION_BACKWARD_TARGETS,  /* uint32_t[backward_count] */
+    GRAPH_CH_SECTION_BACKWARD_WEIGHTS,  /* double[backward_count] */
+    GRAPH_CH_SECTION_BACKWARD_MIDDLES,  /* uint32_t[backward_count] */
+    GRAPH_CH_SECTION_COUNT,
+} graph_ch_section_t;
+
+/**
+ * @brief   The header of a contraction hierarchy file. All the fields are little-endian.
+ *          The header is followed by the sections, each at a GRAPH_FILE_ALIGNMENT aligned offset, so the file can
+ *          be mapped and queried as is.
+ */
+struct graph_ch_file_header {
+    /* GRAPH_CH_FILE_MAGIC, not NUL terminated. */
+    char magic[8];
+
+    /* GRAPH_CH_FILE_VERSION. */
+    uint32_t version;
+
+    /* No flags are defined yet. */
+    uint32_t flags;
+
+    /* The amount of vertices, of forward and backward arcs, and of shortcuts among them. */
+    uint64_t vertex_count;
+    uint64_t forward_count;
+    uint64_t backward_count;
+    uint64_t shortcut_count;
+
+    /* The offsets of the sections from the start of the file. */
+    uint64_t section_offsets[GRAPH_CH_SECTION_COUNT];
+
+    /* The size of the whole file. */
+    uint64_t file_size;
+
+    /* The checksum of everything after the header. */
+    uint64_t payload_checksum;
+
+    /* The checksum of the header up to this field. */
+    uint64_t header_checksum;
+};
+
+/**
+ * @brief   Save a snapshot to a graph file.
+ * @param   csr     The snapshot.
+ * @param   path    The path of the file, overwritten if it exists.
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_IO if the file can't be written.
+ */
+graph_res_t GRAPH_csr_save(const struct graph_csr *csr, const char *path);
+
+/**
+ * @brief   Save a graph to a graph file.
+ * @param   g       The graph.
+ * @param   path    The path of the file, overwritten if it exists.
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_IO if the file can't be written.
+ *
+ * @note    The graph is frozen (see GRAPH_freeze) and the snapshot is saved.
+ */
+graph_res_t GRAPH_save(struct graph *g, const char *path);
+
+/**
+ * @brief   Map a graph file as a read-only snapshot, without copying or parsing it.
+ * @param   path    The path of the file.
+ * @param   flags   GRAPH_LOAD_* flags.
+ * @param   csr     The snapshot (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_IO if the file can't be mapped,
+ *          GRAPH_ERR_FORMAT if it isn't a valid graph file (or the host isn't little-endian).
+ *
+ * @note    The header is always checked, the payload only with GRAPH_LOAD_VERIFY.
+ * @note    The snapshot has no id map, ids are binary searched. GRAPH_thaw turns it into a mutable graph.
+ * @note    GRAPH_csr_destroy should be called to unmap the file.
+ */
+graph_res_t GRAPH_load_mmap(const char *path, uint32_t flags, struct graph_csr **csr);
+
+/**
+ * @brief   Save a contraction hierarchy to a file.
+ * @param   ch      The hierarchy.
+ * @param   path    The path of the file, overwritten if it exists.
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_IO if the file can't be written.
+ */
+graph_res_t GRAPH_ch_save(const struct graph_ch *ch, const char *path);
+
+/**
+ * @brief   Map a contraction hierarchy file as a read-only hierarchy, without copying or parsing it.
+ * @param   path    The path of the file.
+ * @param   flags   GRAPH_LOAD_* flags.
+ * @param   ch      The hierarchy (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_IO if the file can't be mapped,
+ *          GRAPH_ERR_FORMAT if it isn't a valid contraction hierarchy file (or the host isn't little-endian).
+ *
+ * @note    The header is always checked, the payload only with GRAPH_LOAD_VERIFY.
+ * @note    GRAPH_ch_destroy should be called to unmap the file.
+ */
+graph_res_t GRAPH_ch_load_mmap(const char *path, uint32_t flags, struct graph_ch **ch);
+
+#endif //LIBGRAPH_GRAPH_FILE_H
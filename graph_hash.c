@@ -0,0 +1,211 @@
+#include <string.h>
+#include "graph_hash.h"
+
+/* The capacity of a table on its first allocation. */
+#define GRAPH_HASH_MIN_CAPACITY     (8)
+
+/* The table grows once it is more than 3/4 full. */
+#define GRAPH_HASH_MAX_LOAD(capacity)   (((capacity) / 4) * 3)
+
+/**
+ * @brief   Mix the bits of a key (the splitmix64 finalizer), so sequential ids spread over the table.
+ * @param   key The key.
+ * @return  The hash of the key.
+ */
+static uint64_t graph_hash_mix(uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+/**
+ * @brief   Reallocate the slots of the table and reinsert all the keys.
+ * @param   h           The hash table.
+ * @param   capacity    The new capacity (a power of 2, large enough for all the keys).
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+static graph_res_t graph_hash_rehash(struct graph_hash *h, size_t capacity) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_hash_entry *entries = NULL;
+    size_t mask = capacity - 1;
+    size_t i = 0;
+    size_t slot = 0;
+
+    entries = h->allocator->alloc(h->allocator->ctx, sizeof(*entries) * capacity);
+    if (NULL == entries) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    (void)memset(entries, 0, sizeof(*entries) * capacity);
+
+    /* Move all the occupied slots to the new table. */
+    for (i = 0; i < h->capacity; ++i) {
+        if (NULL == h->entries[i].value) {
+            continue;
+        }
+        slot = graph_hash_mix(h->entries[i].key) & mask;
+        while (NULL != entries[slot].value) {
+            slot = (slot + 1) & mask;
+        }
+        entries[slot] = h->entries[i];
+    }
+
+    /* Replace the slots. */
+    if (NULL != h->entries) {
+        h->allocator->free(h->allocator->ctx, h->entries, sizeof(*h->entries) * h->capacity);
+    }
+    h->entries = entries;
+    h->capacity = capacity;
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    return res;
+}
+
+/** @see graph_hash.h */
+void graph_hash_init(struct graph_hash *h, const struct graph_allocator *allocator) {
+    h->allocator = allocator;
+    h->entries = NULL;
+    h->capacity = 0;
+    h->count = 0;
+}
+
+/** @see graph_hash.h */
+void graph_hash_destroy(struct graph_hash *h) {
+    if (NULL != h->entries) {
+        h->allocator->free(h->allocator->ctx, h->entries, sizeof(*h->entries) * h->capacity);
+    }
+    graph_hash_init(h, h->allocator);
+}
+
+/** @see graph_hash.h */
+void graph_hash_clear(struct graph_hash *h) {
+    if (0 != h->count) {
+        (void)memset(h->entries, 0, sizeof(*h->entries) * h->capacity);
+        h->count = 0;
+    }
+}
+
+/** @see graph_hash.h */
+graph_res_t graph_hash_reserve(struct graph_hash *h, size_t count) {
+    size_t capacity = (0 == h->capacity) ? GRAPH_HASH_MIN_CAPACITY : h->capacity;
+
+    while (GRAPH_HASH_MAX_LOAD(capacity) < count) {
+        capacity *= 2;
+    }
+    if (capacity == h->capacity) {
+        return GRAPH_ERR_SUCCESS;
+    }
+
+    return graph_hash_rehash(h, capacity);
+}
+
+/** @see graph_hash.h */
+void *graph_hash_find(const struct graph_hash *h, uint64_t key) {
+    size_t mask = h->capacity - 1;
+    size_t slot = 0;
+
+    if (0 == h->count) {
+        return NULL;
+    }
+
+    /* Probe until the key or an empty slot is found, the table is never full so this terminates. */
+    slot = graph_hash_mix(key) & mask;
+    while (NULL != h->entries[slot].value) {
+        if (key == h->entries[slot].key) {
+            return h->entries[slot].value;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return NULL;
+}
+
+/** @see graph_hash.h */
+graph_res_t graph_hash_insert(struct graph_hash *h, uint64_t key, void *value) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    size_t mask = 0;
+    size_t slot = 0;
+
+    /* Parameter check. */
+    if (NULL == value) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    /* Grow the table if needed. */
+    res = graph_hash_reserve(h, h->count + 1);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Find either the key or the first empty slot of its probe sequence. */
+    mask = h->capacity - 1;
+    slot = graph_hash_mix(key) & mask;
+    while (NULL != h->entries[slot].value) {
+        if (key == h->entries[slot].key) {
+            res = GRAPH_ERR_FOUND;
+            goto cleanup;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    h->entries[slot].key = key;
+    h->entries[slot].value = value;
+    h->count++;
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    return res;
+}
+
+/** @see graph_hash.h */
+void *graph_hash_remove(struct graph_hash *h, uint64_t key) {
+    void *value = NULL;
+    size_t mask = h->capacity - 1;
+    size_t slot = 0;
+    size_t next = 0;
+    size_t home = 0;
+
+    if (0 == h->count) {
+        goto cleanup;
+    }
+
+    /* Find the slot of the key. */
+    slot = graph_hash_mix(key) & mask;
+    while (NULL != h->entries[slot].value) {
+        if (key == h->entries[slot].key) {
+            value = h->entries[slot].value;
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    if (NULL == value) {
+        goto cleanup;
+    }
+
+    /*
+     * Backward shift deletion: pull back every following entry of the cluster whose home slot
+     * is not between the hole and itself, so no tombstones are needed.
+     */
+    next = (slot + 1) & mask;
+    while (NULL != h->entries[next].value) {
+        home = graph_hash_mix(h->entries[next].key) & mask;
+        if (((next - home) & mask) >= ((next - slot) & mask)) {
+            h->entries[slot] = h->entries[next];
+            slot = next;
+        }
+        next = (next + 1) & mask;
+    }
+    h->entries[slot].key = 0;
+    h->entries[slot].value = NULL;
+    h->count--;
+
+    cleanup:
+    return value;
+}
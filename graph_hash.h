@@ -0,0 +1,93 @@
+#ifndef LIBGRAPH_GRAPH_HASH_H
+#define LIBGRAPH_GRAPH_HASH_H
+
+/******************************
+ * Includes
+ ******************************/
+#include <stdint.h>
+#include <stddef.h>
+
+#include "errors.h"
+#include "graph_alloc.h"
+
+/**
+ * @brief   A single slot of the hash table, a slot is empty iff its value is NULL.
+ */
+struct graph_hash_entry {
+    /* The key of the slot. */
+    uint64_t key;
+
+    /* The value mapped to the key (never NULL for an occupied slot). */
+    void *value;
+};
+
+/**
+ * @brief   An open-addressing (linear probing) hash table from uint64_t keys to non-NULL pointers.
+ */
+struct graph_hash {
+    /* The allocator of the slots. */
+    const struct graph_allocator *allocator;
+
+    /* The slots of the table, NULL while the table has no capacity. */
+    struct graph_hash_entry *entries;
+
+    /* The amount of slots (always 0 or a power of 2). */
+    size_t capacity;
+
+    /* The amount of occupied slots. */
+    size_t count;
+};
+
+/**
+ * @brief   Initialize an empty hash table, no memory is allocated until the first insertion.
+ * @param   h           The hash table.
+ * @param   allocator   The allocator of the slots.
+ */
+void graph_hash_init(struct graph_hash *h, const struct graph_allocator *allocator);
+
+/**
+ * @brief   Release the memory of the hash table, the table is empty after the call.
+ * @param   h   The hash table.
+ */
+void graph_hash_destroy(struct graph_hash *h);
+
+/**
+ * @brief   Remove all the keys from the hash table while keeping its capacity.
+ * @param   h   The hash table.
+ */
+void graph_hash_clear(struct graph_hash *h);
+
+/**
+ * @brief   Make sure the hash table can hold count keys without growing.
+ * @param   h       The hash table.
+ * @param   count   The amount of keys to reserve room for.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t graph_hash_reserve(struct graph_hash *h, size_t count);
+
+/**
+ * @brief   Find the value mapped to a key.
+ * @param   h   The hash table.
+ * @param   key The key.
+ * @return  The value, or NULL if the key is not in the table.
+ */
+void *graph_hash_find(const struct graph_hash *h, uint64_t key);
+
+/**
+ * @brief   Map a key to a value.
+ * @param   h       The hash table.
+ * @param   key     The key.
+ * @param   value   The value (must not be NULL).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_FOUND if the key is already in the table.
+ */
+graph_res_t graph_hash_insert(struct graph_hash *h, uint64_t key, void *value);
+
+/**
+ * @brief   Remove a key from the hash table.
+ * @param   h   The hash table.
+ * @param   key The key.
+ * @return  The value that was mapped to the key, or NULL if the key was not in the table.
+ */
+void *graph_hash_remove(struct graph_hash *h, uint64_t key);
+
+#endif //LIBGRAPH_GRAPH_HASH_H
@@ -0,0 +1,284 @@
+#include <malloc.h>
+#include <string.h>
+#include "graph_heap.h"
+
+/** @see graph_heap.h */
+void graph_dary_heap_init(struct graph_dary_heap *heap) {
+    (void)memset(heap, 0, sizeof(*heap));
+}
+
+/** @see graph_heap.h */
+void graph_dary_heap_destroy(struct graph_dary_heap *heap) {
+    if (NULL != heap->nodes) {
+        free(heap->nodes);
+    }
+    if (NULL != heap->keys) {
+        free(heap->keys);
+    }
+    if (NULL != heap->positions) {
+        free(heap->positions);
+    }
+    graph_dary_heap_init(heap);
+}
+
+/** @see graph_heap.h */
+graph_res_t graph_dary_heap_reserve(struct graph_dary_heap *heap, size_t capacity) {
+    graph_index_t *nodes = NULL;
+    double *keys = NULL;
+    graph_index_t *positions = NULL;
+    size_t i = 0;
+
+    if (capacity <= heap->capacity) {
+        return GRAPH_ERR_SUCCESS;
+    }
+
+    nodes = realloc(heap->nodes, sizeof(*nodes) * capacity);
+    if (NULL == nodes) {
+        return GRAPH_ERR_MEM;
+    }
+    heap->nodes = nodes;
+    keys = realloc(heap->keys, sizeof(*keys) * capacity);
+    if (NULL == keys) {
+        return GRAPH_ERR_MEM;
+    }
+    heap->keys = keys;
+    positions = realloc(heap->positions, sizeof(*positions) * capacity);
+    if (NULL == positions) {
+        return GRAPH_ERR_MEM;
+    }
+    heap->positions = positions;
+
+    for (i = heap->capacity; i < capacity; ++i) {
+        heap->positions[i] = GRAPH_INDEX_NONE;
+    }
+    heap->capacity = capacity;
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph_heap.h */
+void graph_dary_heap_clear(struct graph_dary_heap *heap) {
+    size_t i = 0;
+
+    for (i = 0; i < heap->count; ++i) {
+        heap->positions[heap->nodes[i]] = GRAPH_INDEX_NONE;
+    }
+    heap->count = 0;
+}
+
+/**
+ * @brief   Move a node up from a position until its parent's key isn't higher.
+ */
+static void graph_dary_heap_sift_up(struct graph_dary_heap *heap, size_t position, graph_index_t node, double key) {
+    size_t parent = 0;
+
+    while (position > 0) {
+        parent = (position - 1) / GRAPH_HEAP_ARITY;
+        if (heap->keys[parent] <= key) {
+            break;
+        }
+        heap->nodes[position] = heap->nodes[parent];
+        heap->keys[position] = heap->keys[parent];
+        heap->positions[heap->nodes[position]] = (graph_index_t)position;
+        position = parent;
+    }
+    heap->nodes[position] = node;
+    heap->keys[position] = key;
+    heap->positions[node] = (graph_index_t)position;
+}
+
+/**
+ * @brief   Move a node down from a position until none of its children has a lower key.
+ */
+static void graph_dary_heap_sift_down(struct graph_dary_heap *heap, size_t position, graph_index_t node,
+                                      double key) {
+    size_t first_child = 0;
+    size_t last_child = 0;
+    size_t best = 0;
+    size_t child = 0;
+
+    while ((first_child = (position * GRAPH_HEAP_ARITY) + 1) < heap->count) {
+        last_child = first_child + GRAPH_HEAP_ARITY;
+        if (last_child > heap->count) {
+            last_child = heap->count;
+        }
+        best = first_child;
+        for (child = first_child + 1; child < last_child; ++child) {
+            if (heap->keys[child] < heap->keys[best]) {
+                best = child;
+            }
+        }
+        if (heap->keys[best] >= key) {
+            break;
+        }
+        heap->nodes[position] = heap->nodes[best];
+        heap->keys[position] = heap->keys[best];
+        heap->positions[heap->nodes[position]] = (graph_index_t)position;
+        position = best;
+    }
+    heap->nodes[position] = node;
+    heap->keys[position] = key;
+    heap->positions[node] = (graph_index_t)position;
+}
+
+/** @see graph_heap.h */
+void graph_dary_heap_push(struct graph_dary_heap *heap, graph_index_t node, double key) {
+    graph_index_t position = heap->positions[node];
+
+    if (GRAPH_INDEX_NONE == position) {
+        graph_dary_heap_sift_up(heap, heap->count++, node, key);
+    } else if (key < heap->keys[position]) {
+        graph_dary_heap_sift_up(heap, position, node, key);
+    }
+}
+
+/** @see graph_heap.h */
+graph_index_t graph_dary_heap_pop(struct graph_dary_heap *heap, double *key) {
+    graph_index_t node = heap->nodes[0];
+
+    if (NULL != key) {
+        *key = heap->keys[0];
+    }
+    heap->positions[node] = GRAPH_INDEX_NONE;
+    heap->count--;
+    if (0 != heap->count) {
+        graph_dary_heap_sift_down(heap, 0, heap->nodes[heap->count], heap->keys[heap->count]);
+    }
+
+    return node;
+}
+
+/**
+ * @brief   The bucket of a key relative to the last key popped.
+ */
+static inline size_t graph_radix_heap_bucket(uint64_t last, uint64_t key) {
+    return (key == last) ? 0 : (size_t)(64 - __builtin_clzll(key ^ last));
+}
+
+static graph_res_t graph_radix_bucket_reserve(struct graph_radix_bucket *bucket, size_t capacity) {
+    uint64_t *keys = NULL;
+    graph_index_t *nodes = NULL;
+
+    if (capacity <= bucket->capacity) {
+        return GRAPH_ERR_SUCCESS;
+    }
+    if (capacity < ((bucket->capacity * 2) + 16)) {
+        capacity = (bucket->capacity * 2) + 16;
+    }
+
+    keys = realloc(bucket->keys, sizeof(*keys) * capacity);
+    if (NULL == keys) {
+        return GRAPH_ERR_MEM;
+    }
+    bucket->keys = keys;
+    nodes = realloc(bucket->nodes, sizeof(*nodes) * capacity);
+    if (NULL == nodes) {
+        return GRAPH_ERR_MEM;
+    }
+    bucket->nodes = nodes;
+    bucket->capacity = capacity;
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph_heap.h */
+void graph_radix_heap_init(struct graph_radix_heap *heap) {
+    (void)memset(heap, 0, sizeof(*heap));
+}
+
+/** @see graph_heap.h */
+void graph_radix_heap_destroy(struct graph_radix_heap *heap) {
+    size_t i = 0;
+
+    for (i = 0; i < GRAPH_RADIX_BUCKETS; ++i) {
+        if (NULL != heap->buckets[i].keys) {
+            free(heap->buckets[i].keys);
+        }
+        if (NULL != heap->buckets[i].nodes) {
+            free(heap->buckets[i].nodes);
+        }
+    }
+    graph_radix_heap_init(heap);
+}
+
+/** @see graph_heap.h */
+void graph_radix_heap_clear(struct graph_radix_heap *heap) {
+    size_t i = 0;
+
+    for (i = 0; i < GRAPH_RADIX_BUCKETS; ++i) {
+        heap->buckets[i].count = 0;
+    }
+    heap->last = 0;
+    heap->count = 0;
+}
+
+/** @see graph_heap.h */
+graph_res_t graph_radix_heap_push(struct graph_radix_heap *heap, graph_index_t node, uint64_t key) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_radix_bucket *bucket = &heap->buckets[graph_radix_heap_bucket(heap->last, key)];
+
+    res = graph_radix_bucket_reserve(bucket, bucket->count + 1);
+    if (GRAPH_ERR_SUCCESS != res) {
+        return res;
+    }
+    bucket->keys[bucket->count] = key;
+    bucket->nodes[bucket->count] = node;
+    bucket->count++;
+    heap->count++;
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph_heap.h */
+graph_res_t graph_radix_heap_pop(struct graph_radix_heap *heap, graph_index_t *node, uint64_t *key) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_radix_bucket *bucket = &heap->buckets[0];
+    struct graph_radix_bucket *target = NULL;
+    size_t moved[GRAPH_RADIX_BUCKETS];
+    uint64_t minimum = 0;
+    size_t i = 0;
+    size_t j = 0;
+
+    if (0 == bucket->count) {
+        /* Refill the lower buckets from the first non-empty bucket, around its minimum. */
+        for (i = 1; 0 == heap->buckets[i].count; ++i);
+        bucket = &heap->buckets[i];
+        minimum = bucket->keys[0];
+        for (j = 1; j < bucket->count; ++j) {
+            if (bucket->keys[j] < minimum) {
+                minimum = bucket->keys[j];
+            }
+        }
+
+        /* Make room first, so a failed allocation leaves the heap as it was. */
+        (void)memset(moved, 0, sizeof(moved));
+        for (j = 0; j < bucket->count; ++j) {
+            moved[graph_radix_heap_bucket(minimum, bucket->keys[j])]++;
+        }
+        for (j = 0; j < i; ++j) {
+            res = graph_radix_bucket_reserve(&heap->buckets[j], heap->buckets[j].count + moved[j]);
+            if (GRAPH_ERR_SUCCESS != res) {
+                return res;
+            }
+        }
+
+        /* Every entry lands in a bucket below i. */
+        heap->last = minimum;
+        for (j = 0; j < bucket->count; ++j) {
+            target = &heap->buckets[graph_radix_heap_bucket(minimum, bucket->keys[j])];
+            target->keys[target->count] = bucket->keys[j];
+            target->nodes[target->count] = bucket->nodes[j];
+            target->count++;
+        }
+        bucket->count = 0;
+        bucket = &heap->buckets[0];
+    }
+
+    bucket->count--;
+    heap->count--;
+    *node = bucket->nodes[bucket->count];
+    if (NULL != key) {
+        *key = bucket->keys[bucket->count];
+    }
+    return GRAPH_ERR_SUCCESS;
+}
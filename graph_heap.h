@@ -0,0 +1,141 @@
+#ifndef LIBGRAPH_GRAPH_HEAP_H
+#define LIBGRAPH_GRAPH_HEAP_H
+
+/******************************
+ * Includes
+ ******************************/
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "errors.h"
+#include "graph_csr.h"
+
+/* The amount of children of a node of a d-ary heap, 4 keeps the children of a node in one cache line. */
+#define GRAPH_HEAP_ARITY        (4)
+
+/* The amount of buckets of a radix heap, one per bit of a key plus one for the keys equal to the last minimum. */
+#define GRAPH_RADIX_BUCKETS     (65)
+
+/**
+ * @brief   An indexed d-ary min-heap of vertex indexes keyed by doubles, with decrease-key.
+ *          The keys are kept in their own array alongside the nodes so the children scan touches only keys.
+ */
+struct graph_dary_heap {
+    /* The nodes and their keys, in heap order. */
+    graph_index_t *nodes;
+    double *keys;
+
+    /* The position of each vertex in the heap, GRAPH_INDEX_NONE if it isn't in it. */
+    graph_index_t *positions;
+
+    /* The amount of nodes in the heap, and the amount of vertices it can index. */
+    size_t count;
+    size_t capacity;
+};
+
+/**
+ * @brief   A bucket of a radix heap, an unordered list of (key, node) pairs.
+ */
+struct graph_radix_bucket {
+    uint64_t *keys;
+    graph_index_t *nodes;
+    size_t count;
+    size_t capacity;
+};
+
+/**
+ * @brief   A monotone radix min-heap of vertex indexes keyed by integers.
+ *          Keys pushed must not be below the last key popped; a vertex may be pushed several times, stale
+ *          entries are left for the caller to skip.
+ */
+struct graph_radix_heap {
+    /* Bucket i > 0 holds the keys whose highest bit differing from last is bit i - 1. */
+    struct graph_radix_bucket buckets[GRAPH_RADIX_BUCKETS];
+
+    /* The last key popped. */
+    uint64_t last;
+
+    /* The amount of entries in the heap. */
+    size_t count;
+};
+
+/**
+ * @brief   Initialize an empty d-ary heap, no memory is allocated until it is reserved.
+ * @param   heap    The heap.
+ */
+void graph_dary_heap_init(struct graph_dary_heap *heap);
+
+/**
+ * @brief   Release the memory of a d-ary heap.
+ * @param   heap    The heap.
+ */
+void graph_dary_heap_destroy(struct graph_dary_heap *heap);
+
+/**
+ * @brief   Make a d-ary heap able to index the vertices [0, capacity).
+ * @param   heap        The heap.
+ * @param   capacity    The amount of vertices.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t graph_dary_heap_reserve(struct graph_dary_heap *heap, size_t capacity);
+
+/**
+ * @brief   Remove all the nodes from a d-ary heap, in O(count).
+ * @param   heap    The heap.
+ */
+void graph_dary_heap_clear(struct graph_dary_heap *heap);
+
+/**
+ * @brief   Insert a vertex, or lower its key if it is already in the heap with a higher key.
+ * @param   heap    The heap.
+ * @param   node    The vertex, below the capacity of the heap.
+ * @param   key     The key of the vertex.
+ */
+void graph_dary_heap_push(struct graph_dary_heap *heap, graph_index_t node, double key);
+
+/**
+ * @brief   Remove the vertex with the minimal key from a non-empty d-ary heap.
+ * @param   heap    The heap.
+ * @param   key     The key of the vertex (out parameter, optional).
+ * @return  The vertex.
+ */
+graph_index_t graph_dary_heap_pop(struct graph_dary_heap *heap, double *key);
+
+/**
+ * @brief   Initialize an empty radix heap.
+ * @param   heap    The heap.
+ */
+void graph_radix_heap_init(struct graph_radix_heap *heap);
+
+/**
+ * @brief   Release the memory of a radix heap.
+ * @param   heap    The heap.
+ */
+void graph_radix_heap_destroy(struct graph_radix_heap *heap);
+
+/**
+ * @brief   Remove all the entries from a radix heap while keeping its memory, last is reset to 0.
+ * @param   heap    The heap.
+ */
+void graph_radix_heap_clear(struct graph_radix_heap *heap);
+
+/**
+ * @brief   Insert an entry into a radix heap.
+ * @param   heap    The heap.
+ * @param   node    The vertex.
+ * @param   key     The key, not below the last key popped.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t graph_radix_heap_push(struct graph_radix_heap *heap, graph_index_t node, uint64_t key);
+
+/**
+ * @brief   Remove an entry with the minimal key from a non-empty radix heap, in amortized O(log(C)).
+ * @param   heap    The heap.
+ * @param   node    The vertex of the entry (out parameter).
+ * @param   key     The key of the entry (out parameter, optional).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_MEM if the buckets couldn't be refilled (the heap is unchanged).
+ */
+graph_res_t graph_radix_heap_pop(struct graph_radix_heap *heap, graph_index_t *node, uint64_t *key);
+
+#endif //LIBGRAPH_GRAPH_HEAP_H
@@ -0,0 +1,289 @@
+#include <malloc.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include "graph_parallel.h"
+
+/**
+ * @brief   A parallel region, its threads wait on it until the final amount of threads is known.
+ */
+struct graph_parallel_region {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+
+    /* Have all the threads been created. */
+    bool started;
+
+    /* The amount of threads actually running the task. */
+    size_t thread_count;
+
+    graph_parallel_task_t task;
+    void *ctx;
+};
+
+/**
+ * @brief   The arguments of a thread of a parallel region.
+ */
+struct graph_parallel_thread {
+    pthread_t thread;
+    struct graph_parallel_region *region;
+    size_t thread_id;
+};
+
+/**
+ * @brief   The context of a parallel loop.
+ */
+struct graph_parallel_loop {
+    size_t count;
+    graph_parallel_range_t task;
+    void *ctx;
+
+    /* The chunk size and the next index to hand out, for dynamic loops. */
+    size_t chunk;
+    size_t next;
+};
+
+static void *graph_parallel_thread_main(void *arg) {
+    struct graph_parallel_thread *thread = arg;
+    struct graph_parallel_region *region = thread->region;
+
+    /* Wait for the final thread count. */
+    (void)pthread_mutex_lock(&region->lock);
+    while (!region->started) {
+        (void)pthread_cond_wait(&region->cond, &region->lock);
+    }
+    (void)pthread_mutex_unlock(&region->lock);
+
+    region->task(region->ctx, thread->thread_id, region->thread_count);
+
+    return NULL;
+}
+
+static void graph_parallel_loop_task(void *ctx, size_t thread_id, size_t thread_count) {
+    struct graph_parallel_loop *loop = ctx;
+    size_t begin = (loop->count * thread_id) / thread_count;
+    size_t end = (loop->count * (thread_id + 1)) / thread_count;
+
+    if (begin < end) {
+        loop->task(loop->ctx, begin, end, thread_id);
+    }
+}
+
+static void graph_parallel_dynamic_loop_task(void *ctx, size_t thread_id, size_t thread_count) {
+    struct graph_parallel_loop *loop = ctx;
+    size_t begin = 0;
+    size_t end = 0;
+
+    (void)thread_count;
+    for (;;) {
+        begin = __atomic_fetch_add(&loop->next, loop->chunk, __ATOMIC_RELAXED);
+        if (begin >= loop->count) {
+            break;
+        }
+        end = ((loop->count - begin) > loop->chunk) ? (begin + loop->chunk) : loop->count;
+        loop->task(loop->ctx, begin, end, thread_id);
+    }
+}
+
+/** @see graph_parallel.h */
+size_t graph_parallel_thread_count(size_t requested) {
+    long online = 0;
+
+    if (0 != requested) {
+        return requested;
+    }
+
+    online = sysconf(_SC_NPROCESSORS_ONLN);
+    return (online > 0) ? (size_t)online : 1;
+}
+
+/** @see graph_parallel.h */
+graph_res_t graph_parallel_run(size_t thread_count, graph_parallel_task_t task, void *ctx) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_parallel_region region;
+    struct graph_parallel_thread *threads = NULL;
+    bool is_region_initialized = false;
+    size_t started = 1;
+    size_t i = 0;
+
+    /* Parameter check. */
+    if (NULL == task) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    thread_count = graph_parallel_thread_count(thread_count);
+    if (1 == thread_count) {
+        task(ctx, 0, 1);
+        res = GRAPH_ERR_SUCCESS;
+        goto cleanup;
+    }
+
+    threads = malloc(sizeof(*threads) * thread_count);
+    if (NULL == threads) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    if (0 != pthread_mutex_init(&region.lock, NULL)) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    if (0 != pthread_cond_init(&region.cond, NULL)) {
+        (void)pthread_mutex_destroy(&region.lock);
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    is_region_initialized = true;
+    region.started = false;
+    region.task = task;
+    region.ctx = ctx;
+
+    /* Create the threads, the region shrinks to the threads that could be created. */
+    for (started = 1; started < thread_count; ++started) {
+        threads[started].region = &region;
+        threads[started].thread_id = started;
+        if (0 != pthread_create(&threads[started].thread, NULL, graph_parallel_thread_main, &threads[started])) {
+            break;
+        }
+    }
+
+    /* Release the threads, the calling thread is thread 0. */
+    (void)pthread_mutex_lock(&region.lock);
+    region.thread_count = started;
+    region.started = true;
+    (void)pthread_cond_broadcast(&region.cond);
+    (void)pthread_mutex_unlock(&region.lock);
+
+    task(ctx, 0, started);
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    for (i = 1; i < started; ++i) {
+        (void)pthread_join(threads[i].thread, NULL);
+    }
+    if (is_region_initialized) {
+        (void)pthread_cond_destroy(&region.cond);
+        (void)pthread_mutex_destroy(&region.lock);
+    }
+    if (NULL != threads) {
+        free(threads);
+    }
+    return res;
+}
+
+/** @see graph_parallel.h */
+graph_res_t graph_parallel_for(size_t count, size_t thread_count, size_t grain, graph_parallel_range_t task,
+                               void *ctx) {
+    struct graph_parallel_loop loop = {count, task, ctx, 0, 0};
+
+    /* Parameter check. */
+    if (NULL == task) {
+        return GRAPH_ERR_PARAMS;
+    }
+    if (0 == count) {
+        return GRAPH_ERR_SUCCESS;
+    }
+
+    /* Don't spawn threads that would have too little work. */
+    thread_count = graph_parallel_thread_count(thread_count);
+    if (0 == grain) {
+        grain = 1;
+    }
+    if (thread_count > ((count + grain - 1) / grain)) {
+        thread_count = (count + grain - 1) / grain;
+    }
+    if (1 == thread_count) {
+        task(ctx, 0, count, 0);
+        return GRAPH_ERR_SUCCESS;
+    }
+
+    return graph_parallel_run(thread_count, graph_parallel_loop_task, &loop);
+}
+
+/** @see graph_parallel.h */
+graph_res_t graph_parallel_for_dynamic(size_t count, size_t thread_count, size_t chunk, graph_parallel_range_t task,
+                                       void *ctx) {
+    struct graph_parallel_loop loop = {count, task, ctx, chunk, 0};
+
+    /* Parameter check. */
+    if (NULL == task) {
+        return GRAPH_ERR_PARAMS;
+    }
+    if (0 == count) {
+        return GRAPH_ERR_SUCCESS;
+    }
+
+    thread_count = graph_parallel_thread_count(thread_count);
+    if (0 == loop.chunk) {
+        loop.chunk = 1;
+    }
+    if (thread_count > ((count + loop.chunk - 1) / loop.chunk)) {
+        thread_count = (count + loop.chunk - 1) / loop.chunk;
+    }
+    if (1 == thread_count) {
+        task(ctx, 0, count, 0);
+        return GRAPH_ERR_SUCCESS;
+    }
+
+    return graph_parallel_run(thread_count, graph_parallel_dynamic_loop_task, &loop);
+}
+
+/** @see graph_parallel.h */
+graph_res_t graph_barrier_init(struct graph_barrier *barrier, size_t thread_count) {
+    if (0 != pthread_mutex_init(&barrier->lock, NULL)) {
+        return GRAPH_ERR_MEM;
+    }
+    if (0 != pthread_cond_init(&barrier->cond, NULL)) {
+        (void)pthread_mutex_destroy(&barrier->lock);
+        return GRAPH_ERR_MEM;
+    }
+
+    barrier->thread_count = thread_count;
+    barrier->waiting = 0;
+    barrier->phase = 0;
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph_parallel.h */
+void graph_barrier_resize(struct graph_barrier *barrier, size_t thread_count) {
+    (void)pthread_mutex_lock(&barrier->lock);
+
+    barrier->thread_count = thread_count;
+    if ((0 != barrier->waiting) && (barrier->waiting >= thread_count)) {
+        /* Everybody is already waiting. */
+        barrier->waiting = 0;
+        barrier->phase++;
+        (void)pthread_cond_broadcast(&barrier->cond);
+    }
+
+    (void)pthread_mutex_unlock(&barrier->lock);
+}
+
+/** @see graph_parallel.h */
+void graph_barrier_destroy(struct graph_barrier *barrier) {
+    (void)pthread_cond_destroy(&barrier->cond);
+    (void)pthread_mutex_destroy(&barrier->lock);
+}
+
+/** @see graph_parallel.h */
+void graph_barrier_wait(struct graph_barrier *barrier) {
+    size_t phase = 0;
+
+    (void)pthread_mutex_lock(&barrier->lock);
+
+    phase = barrier->phase;
+    barrier->waiting++;
+    if (barrier->thread_count == barrier->waiting) {
+        /* The last thread opens the barrier. */
+        barrier->waiting = 0;
+        barrier->phase++;
+        (void)pthread_cond_broadcast(&barrier->cond);
+    } else {
+        while (phase == barrier->phase) {
+            (void)pthread_cond_wait(&barrier->cond, &barrier->lock);
+        }
+    }
+
+    (void)pthread_mutex_unlock(&barrier->lock);
+}
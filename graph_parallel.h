@@ -0,0 +1,121 @@
+#ifndef LIBGRAPH_GRAPH_PARALLEL_H
+#define LIBGRAPH_GRAPH_PARALLEL_H
+
+/******************************
+ * Includes
+ ******************************/
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "errors.h"
+
+/**
+ * @brief   A task run by every thread of a parallel region.
+ * @param   ctx             The context of the region.
+ * @param   thread_id       The id of the running thread, in [0, thread_count).
+ * @param   thread_count    The amount of threads in the region.
+ */
+typedef void (*graph_parallel_task_t)(void *ctx, size_t thread_id, size_t thread_count);
+
+/**
+ * @brief   A task run over a range of a parallel loop.
+ * @param   ctx         The context of the loop.
+ * @param   begin       The first index of the range.
+ * @param   end         One past the last index of the range.
+ * @param   thread_id   The id of the running thread.
+ */
+typedef void (*graph_parallel_range_t)(void *ctx, size_t begin, size_t end, size_t thread_id);
+
+/**
+ * @brief   A reusable barrier for the threads of a parallel region.
+ */
+struct graph_barrier {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+
+    /* The amount of threads synchronizing on the barrier. */
+    size_t thread_count;
+
+    /* The amount of threads waiting in the current phase. */
+    size_t waiting;
+
+    /* Incremented every time the barrier opens. */
+    size_t phase;
+};
+
+/**
+ * @brief   Resolve the amount of threads to use.
+ * @param   requested   The amount of threads requested, 0 for one per online CPU.
+ * @return  The amount of threads (at least 1).
+ */
+size_t graph_parallel_thread_count(size_t requested);
+
+/**
+ * @brief   Run a task on thread_count threads (the calling thread is one of them) and wait for all of them.
+ * @param   thread_count    The amount of threads (0 for one per online CPU).
+ * @param   task            The task.
+ * @param   ctx             The context passed to the task.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    If some threads can't be created the region runs with fewer threads, so the task must
+ *          only rely on the thread_count it is given (which is the same for all the threads).
+ */
+graph_res_t graph_parallel_run(size_t thread_count, graph_parallel_task_t task, void *ctx);
+
+/**
+ * @brief   Run a task over [0, count) split into one contiguous range per thread.
+ * @param   count           The amount of indexes.
+ * @param   thread_count    The amount of threads (0 for one per online CPU).
+ * @param   grain           The minimal amount of indexes worth a thread of its own.
+ * @param   task            The task.
+ * @param   ctx             The context passed to the task.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t graph_parallel_for(size_t count, size_t thread_count, size_t grain, graph_parallel_range_t task,
+                               void *ctx);
+
+/**
+ * @brief   Run a task over [0, count) handed out in chunks to the threads as they finish their previous chunk,
+ *          for loops whose iterations vary a lot in cost.
+ * @param   count           The amount of indexes.
+ * @param   thread_count    The amount of threads (0 for one per online CPU).
+ * @param   chunk           The amount of indexes in a chunk (0 for 1).
+ * @param   task            The task, run once per chunk.
+ * @param   ctx             The context passed to the task.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t graph_parallel_for_dynamic(size_t count, size_t thread_count, size_t chunk, graph_parallel_range_t task,
+                                       void *ctx);
+
+/**
+ * @brief   Initialize a barrier.
+ * @param   barrier         The barrier.
+ * @param   thread_count    The amount of threads synchronizing on it.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t graph_barrier_init(struct graph_barrier *barrier, size_t thread_count);
+
+/**
+ * @brief   Change the amount of threads synchronizing on a barrier, for a region that started with fewer threads
+ *          than the barrier was initialized for.
+ * @param   barrier         The barrier.
+ * @param   thread_count    The amount of threads synchronizing on it.
+ *
+ * @note    Must be called by one of the threads before it first waits on the barrier.
+ */
+void graph_barrier_resize(struct graph_barrier *barrier, size_t thread_count);
+
+/**
+ * @brief   Destroy a barrier.
+ * @param   barrier The barrier.
+ */
+void graph_barrier_destroy(struct graph_barrier *barrier);
+
+/**
+ * @brief   Wait until all the threads of the barrier reach it.
+ * @param   barrier The barrier.
+ */
+void graph_barrier_wait(struct graph_barrier *barrier);
+
+#endif //LIBGRAPH_GRAPH_PARALLEL_H
@@ -0,0 +1,1012 @@
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "graph_parse.h"
+#include "graph_parallel.h"
+#include "graph_sort.h"
+
+/* The minimal size of a chunk of the file worth a parse task of its own. */
+#define GRAPH_PARSE_MIN_CHUNK           (1 << 20)
+
+/* Chunks per thread, so uneven chunks still keep every thread busy. */
+#define GRAPH_PARSE_CHUNKS_PER_THREAD   (4)
+
+/* The longest number handed to the slow path of the float parser. */
+#define GRAPH_PARSE_MAX_TOKEN           (64)
+
+/* The minimal amount of edges worth a thread of their own when indexing them. */
+#define GRAPH_PARSE_GRAIN               (1 << 16)
+
+/* The banner at the start of a Matrix Market file. */
+#define GRAPH_PARSE_MATRIX_MARKET_BANNER    "%%MatrixMarket"
+
+/* Mantissas up to 2^53 and powers of ten up to 1e22 are exact doubles, so their product is correctly rounded. */
+#define GRAPH_PARSE_EXACT_MANTISSA      (1ULL << 53)
+#define GRAPH_PARSE_EXACT_EXPONENT      (22)
+
+static const double graph_parse_pow10[GRAPH_PARSE_EXACT_EXPONENT + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/**
+ * @brief   A growable list of edges.
+ */
+struct graph_parse_edges {
+    uint64_t *s_ids;
+    uint64_t *d_ids;
+    double *weights;
+    size_t count;
+    size_t capacity;
+};
+
+/**
+ * @brief   The file being parsed and what its header says about it.
+ */
+struct graph_parse_input {
+    const char *data;
+    size_t size;
+
+    /* The mapping of the file, NULL for an empty file. */
+    void *mapping;
+
+    graph_text_format_t format;
+
+    /* The first line after the header. */
+    const char *body;
+    size_t header_lines;
+
+    /* Matrix Market only: must every line have a weight, should the edges be mirrored, and the declared sizes. */
+    bool has_weights;
+    bool is_symmetric;
+    uint64_t rows;
+    uint64_t columns;
+    uint64_t entries;
+};
+
+/**
+ * @brief   A range of whole lines of the file, and the edges parsed from it.
+ */
+struct graph_parse_chunk {
+    const char *begin;
+    const char *end;
+    struct graph_parse_edges edges;
+    size_t lines;
+    graph_res_t res;
+};
+
+/**
+ * @brief   The context of the parallel steps of a load.
+ */
+struct graph_parse_ctx {
+    const struct graph_parse_input *input;
+    struct graph_parse_chunk *chunks;
+
+    /* The position of the edges of each chunk in the merged list. */
+    size_t *first;
+    struct graph_parse_edges *merged;
+
+    /* Snapshot builds only: the snapshot and the index of each end of every edge. */
+    const struct graph_csr *csr;
+    graph_index_t *s_indexes;
+    graph_index_t *d_indexes;
+};
+
+/**
+ * @brief   The outcome of parsing a file, before it is turned into a graph or a snapshot.
+ */
+struct graph_parse_result {
+    struct graph_parse_edges edges;
+
+    /* The vertices, ascending. */
+    uint64_t *ids;
+    size_t vertex_count;
+
+    size_t bytes;
+    size_t lines;
+    size_t parsed_edges;
+    size_t thread_count;
+};
+
+static double graph_parse_now(void) {
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1e9);
+}
+
+static inline bool graph_parse_is_blank(char c) {
+    return (' ' == c) || ('\t' == c) || ('\r' == c);
+}
+
+static inline bool graph_parse_is_digit(char c) {
+    return (c >= '0') && (c <= '9');
+}
+
+static inline const char *graph_parse_skip_blanks(const char *p, const char *end) {
+    while ((p < end) && graph_parse_is_blank(*p)) {
+        p++;
+    }
+    return p;
+}
+
+static inline const char *graph_parse_token_end(const char *p, const char *end) {
+    while ((p < end) && !graph_parse_is_blank(*p)) {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * @brief   Parse an unsigned decimal integer token.
+ * @param   p       The start of the token (updated past it).
+ * @param   end     The end of the line.
+ * @param   value   The value (out parameter).
+ * @return  Was the token a number that fits.
+ */
+static inline bool graph_parse_u64(const char **p, const char *end, uint64_t *value) {
+    const char *s = *p;
+    uint64_t result = 0;
+    uint64_t digit = 0;
+
+    if ((s == end) || !graph_parse_is_digit(*s)) {
+        return false;
+    }
+    for (; (s < end) && graph_parse_is_digit(*s); ++s) {
+        digit = (uint64_t)(*s - '0');
+        if (result > ((UINT64_MAX - digit) / 10)) {
+            return false;
+        }
+        result = (result * 10) + digit;
+    }
+    if ((s < end) && !graph_parse_is_blank(*s)) {
+        return false;
+    }
+
+    *value = result;
+    *p = s;
+    return true;
+}
+
+/**
+ * @brief   Parse a floating point token.
+ *          Plain decimals with up to 19 significant digits and a small exponent are computed exactly from a
+ *          mantissa and a power of ten, anything else (long mantissas, huge exponents, inf, nan) goes to strtod.
+ * @param   p       The start of the token (updated past it).
+ * @param   end     The end of the line.
+ * @param   value   The value (out parameter).
+ * @return  Was the token a number.
+ */
+static bool graph_parse_double(const char **p, const char *end, double *value) {
+    char token[GRAPH_PARSE_MAX_TOKEN];
+    const char *token_end = graph_parse_token_end(*p, end);
+    const char *s = *p;
+    char *parsed_end = NULL;
+    uint64_t mantissa = 0;
+    size_t digits = 0;
+    size_t length = 0;
+    int64_t exponent = 0;
+    int64_t explicit_exponent = 0;
+    bool is_negative = false;
+    bool is_exponent_negative = false;
+    bool has_digits = false;
+    bool is_truncated = false;
+    double result = 0;
+
+    if ((s < token_end) && (('-' == *s) || ('+' == *s))) {
+        is_negative = ('-' == *s);
+        s++;
+    }
+    for (; (s < token_end) && graph_parse_is_digit(*s); ++s) {
+        has_digits = true;
+        if (digits < 19) {
+            mantissa = (mantissa * 10) + (uint64_t)(*s - '0');
+            digits += (0 != mantissa);
+        } else {
+            is_truncated = true;
+            exponent++;
+        }
+    }
+    if ((s < token_end) && ('.' == *s)) {
+        for (s++; (s < token_end) && graph_parse_is_digit(*s); ++s) {
+            has_digits = true;
+            if (digits < 19) {
+                mantissa = (mantissa * 10) + (uint64_t)(*s - '0');
+                digits += (0 != mantissa);
+                exponent--;
+            } else {
+                is_truncated = true;
+            }
+        }
+    }
+    if (has_digits && (s < token_end) && (('e' == *s) || ('E' == *s))) {
+        s++;
+        if ((s < token_end) && (('-' == *s) || ('+' == *s))) {
+            is_exponent_negative = ('-' == *s);
+            s++;
+        }
+        if ((s == token_end) || !graph_parse_is_digit(*s)) {
+            has_digits = false;
+        }
+        for (; (s < token_end) && graph_parse_is_digit(*s); ++s) {
+            if (explicit_exponent < 100000) {
+                explicit_exponent = (explicit_exponent * 10) + (*s - '0');
+            }
+        }
+        exponent += is_exponent_negative ? -explicit_exponent : explicit_exponent;
+    }
+
+    if (has_digits && (s == token_end) && !is_truncated && (mantissa <= GRAPH_PARSE_EXACT_MANTISSA) &&
+        (exponent >= -GRAPH_PARSE_EXACT_EXPONENT) && (exponent <= GRAPH_PARSE_EXACT_EXPONENT)) {
+        result = (double)mantissa;
+        result = (exponent < 0) ? (result / graph_parse_pow10[-exponent]) : (result * graph_parse_pow10[exponent]);
+    } else {
+        /* The slow path needs a terminated copy of the token. */
+        length = (size_t)(token_end - *p);
+        if ((0 == length) || (length >= sizeof(token))) {
+            return false;
+        }
+        (void)memcpy(token, *p, length);
+        token[length] = '\0';
+        result = strtod(token, &parsed_end);
+        if (parsed_end != (token + length)) {
+            return false;
+        }
+        is_negative = false;
+    }
+
+    *value = is_negative ? -result : result;
+    *p = token_end;
+    return true;
+}
+
+static void graph_parse_edges_release(struct graph_parse_edges *edges) {
+    if (NULL != edges->s_ids) {
+        free(edges->s_ids);
+    }
+    if (NULL != edges->d_ids) {
+        free(edges->d_ids);
+    }
+    if (NULL != edges->weights) {
+        free(edges->weights);
+    }
+    (void)memset(edges, 0, sizeof(*edges));
+}
+
+/**
+ * @brief   Make room for at least capacity edges in a list.
+ */
+static graph_res_t graph_parse_edges_reserve(struct graph_parse_edges *edges, size_t capacity) {
+    uint64_t *s_ids = NULL;
+    uint64_t *d_ids = NULL;
+    double *weights = NULL;
+
+    if (capacity <= edges->capacity) {
+        return GRAPH_ERR_SUCCESS;
+    }
+
+    s_ids = realloc(edges->s_ids, sizeof(*s_ids) * capacity);
+    if (NULL == s_ids) {
+        return GRAPH_ERR_MEM;
+    }
+    edges->s_ids = s_ids;
+    d_ids = realloc(edges->d_ids, sizeof(*d_ids) * capacity);
+    if (NULL == d_ids) {
+        return GRAPH_ERR_MEM;
+    }
+    edges->d_ids = d_ids;
+    weights = realloc(edges->weights, sizeof(*weights) * capacity);
+    if (NULL == weights) {
+        return GRAPH_ERR_MEM;
+    }
+    edges->weights = weights;
+    edges->capacity = capacity;
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+static inline graph_res_t graph_parse_edges_push(struct graph_parse_edges *edges, uint64_t s_id, uint64_t d_id,
+                                                 double weight) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+
+    if (edges->count == edges->capacity) {
+        res = graph_parse_edges_reserve(edges, (edges->capacity * 2) + 64);
+        if (GRAPH_ERR_SUCCESS != res) {
+            return res;
+        }
+    }
+    edges->s_ids[edges->count] = s_id;
+    edges->d_ids[edges->count] = d_id;
+    edges->weights[edges->count] = weight;
+    edges->count++;
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/**
+ * @brief   Parse the edge lines of a chunk.
+ * @param   input   The file.
+ * @param   chunk   The chunk, its edges, lines and result are filled.
+ */
+static void graph_parse_chunk_lines(const struct graph_parse_input *input, struct graph_parse_chunk *chunk) {
+    const char *p = chunk->begin;
+    const char *line_end = NULL;
+    uint64_t s_id = 0;
+    uint64_t d_id = 0;
+    double weight = 0;
+    bool is_matrix_market = (GRAPH_TEXT_MATRIX_MARKET == input->format);
+
+    /* A line is about a dozen bytes, a guess that saves most of the regrowth. */
+    chunk->res = graph_parse_edges_reserve(&chunk->edges, ((size_t)(chunk->end - chunk->begin) / 12) + 64);
+    if (GRAPH_ERR_SUCCESS != chunk->res) {
+        return;
+    }
+
+    while (p < chunk->end) {
+        line_end = memchr(p, '\n', (size_t)(chunk->end - p));
+        if (NULL == line_end) {
+            line_end = chunk->end;
+        }
+        chunk->lines++;
+
+        p = graph_parse_skip_blanks(p, line_end);
+        if ((p < line_end) && ('#' != *p) && ('%' != *p)) {
+            weight = 1;
+            if (!graph_parse_u64(&p, line_end, &s_id)) {
+                chunk->res = GRAPH_ERR_FORMAT;
+                return;
+            }
+            p = graph_parse_skip_blanks(p, line_end);
+            if (!graph_parse_u64(&p, line_end, &d_id)) {
+                chunk->res = GRAPH_ERR_FORMAT;
+                return;
+            }
+            p = graph_parse_skip_blanks(p, line_end);
+            if (p < line_end) {
+                if (!graph_parse_double(&p, line_end, &weight)) {
+                    chunk->res = GRAPH_ERR_FORMAT;
+                    return;
+                }
+                p = graph_parse_skip_blanks(p, line_end);
+            } else if (input->has_weights) {
+                chunk->res = GRAPH_ERR_FORMAT;
+                return;
+            }
+            if ((p != line_end) ||
+                (is_matrix_market && ((0 == s_id) || (s_id > input->rows) || (0 == d_id) || (d_id > input->columns)))) {
+                chunk->res = GRAPH_ERR_FORMAT;
+                return;
+            }
+
+            chunk->res = graph_parse_edges_push(&chunk->edges, s_id, d_id, weight);
+            if (GRAPH_ERR_SUCCESS != chunk->res) {
+                return;
+            }
+        }
+
+        p = (line_end < chunk->end) ? (line_end + 1) : chunk->end;
+    }
+
+    chunk->res = GRAPH_ERR_SUCCESS;
+}
+
+static void graph_parse_chunks_range(void *ctx, size_t begin, size_t end, size_t thread_id) {
+    struct graph_parse_ctx *parse = ctx;
+    size_t i = 0;
+
+    (void)thread_id;
+    for (i = begin; i < end; ++i) {
+        graph_parse_chunk_lines(parse->input, &parse->chunks[i]);
+    }
+}
+
+/**
+ * @brief   Copy the edges of a range of chunks to their place in the merged list.
+ */
+static void graph_parse_merge_range(void *ctx, size_t begin, size_t end, size_t thread_id) {
+    struct graph_parse_ctx *parse = ctx;
+    struct graph_parse_edges *edges = NULL;
+    size_t first = 0;
+    size_t i = 0;
+
+    (void)thread_id;
+    for (i = begin; i < end; ++i) {
+        edges = &parse->chunks[i].edges;
+        first = parse->first[i];
+        (void)memcpy(parse->merged->s_ids + first, edges->s_ids, sizeof(*edges->s_ids) * edges->count);
+        (void)memcpy(parse->merged->d_ids + first, edges->d_ids, sizeof(*edges->d_ids) * edges->count);
+        (void)memcpy(parse->merged->weights + first, edges->weights, sizeof(*edges->weights) * edges->count);
+        graph_parse_edges_release(edges);
+    }
+}
+
+/**
+ * @brief   Move to the start of the line a position is in the middle of (the next line, unless it starts one).
+ */
+static const char *graph_parse_line_start(const char *p, const char *body, const char *end) {
+    const char *newline = NULL;
+
+    if (p <= body) {
+        return body;
+    }
+    newline = memchr(p - 1, '\n', (size_t)(end - (p - 1)));
+    return (NULL == newline) ? end : (newline + 1);
+}
+
+/**
+ * @brief   Get the next whitespace separated token of a line.
+ */
+static const char *graph_parse_next_token(const char **p, const char *end, size_t *length) {
+    const char *token = graph_parse_skip_blanks(*p, end);
+
+    *p = graph_parse_token_end(token, end);
+    *length = (size_t)(*p - token);
+    return token;
+}
+
+static bool graph_parse_token_equals(const char *token, size_t length, const char *expected) {
+    return (strlen(expected) == length) && (0 == strncasecmp(token, expected, length));
+}
+
+/**
+ * @brief   Detect the format of the file and parse the Matrix Market header if there is one.
+ * @param   input   The file, the format and header fields are filled.
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_FORMAT if the header is invalid or unsupported.
+ */
+static graph_res_t graph_parse_header(struct graph_parse_input *input) {
+    const char *end = input->data + input->size;
+    const char *p = input->data;
+    const char *line_end = NULL;
+    const char *token = NULL;
+    size_t length = 0;
+
+    input->body = input->data;
+    if (GRAPH_TEXT_AUTO == input->format) {
+        length = strlen(GRAPH_PARSE_MATRIX_MARKET_BANNER);
+        input->format = ((input->size >= length) && (0 == memcmp(input->data, GRAPH_PARSE_MATRIX_MARKET_BANNER, length))) ?
+                        GRAPH_TEXT_MATRIX_MARKET : GRAPH_TEXT_EDGE_LIST;
+    }
+    if (GRAPH_TEXT_MATRIX_MARKET != input->format) {
+        return GRAPH_ERR_SUCCESS;
+    }
+
+    /* The banner: %%MatrixMarket matrix coordinate <real|integer|pattern> <general|symmetric>. */
+    line_end = memchr(p, '\n', (size_t)(end - p));
+    line_end = (NULL == line_end) ? end : line_end;
+    token = graph_parse_next_token(&p, line_end, &length);
+    if (!graph_parse_token_equals(token, length, GRAPH_PARSE_MATRIX_MARKET_BANNER)) {
+        return GRAPH_ERR_FORMAT;
+    }
+    token = graph_parse_next_token(&p, line_end, &length);
+    if (!graph_parse_token_equals(token, length, "matrix")) {
+        return GRAPH_ERR_FORMAT;
+    }
+    token = graph_parse_next_token(&p, line_end, &length);
+    if (!graph_parse_token_equals(token, length, "coordinate")) {
+        return GRAPH_ERR_FORMAT;
+    }
+    token = graph_parse_next_token(&p, line_end, &length);
+    if (graph_parse_token_equals(token, length, "real") || graph_parse_token_equals(token, length, "integer")) {
+        input->has_weights = true;
+    } else if (!graph_parse_token_equals(token, length, "pattern")) {
+        return GRAPH_ERR_FORMAT;
+    }
+    token = graph_parse_next_token(&p, line_end, &length);
+    if (graph_parse_token_equals(token, length, "symmetric")) {
+        input->is_symmetric = true;
+    } else if (!graph_parse_token_equals(token, length, "general")) {
+        return GRAPH_ERR_FORMAT;
+    }
+    input->header_lines = 1;
+
+    /* Comments, then the size line: rows columns entries. */
+    for (p = line_end; p < end; p = line_end) {
+        p++;
+        line_end = memchr(p, '\n', (size_t)(end - p));
+        line_end = (NULL == line_end) ? end : line_end;
+        input->header_lines++;
+
+        p = graph_parse_skip_blanks(p, line_end);
+        if ((p == line_end) || ('%' == *p)) {
+            continue;
+        }
+        if (!graph_parse_u64(&p, line_end, &input->rows)) {
+            return GRAPH_ERR_FORMAT;
+        }
+        p = graph_parse_skip_blanks(p, line_end);
+        if (!graph_parse_u64(&p, line_end, &input->columns)) {
+            return GRAPH_ERR_FORMAT;
+        }
+        p = graph_parse_skip_blanks(p, line_end);
+        if (!graph_parse_u64(&p, line_end, &input->entries)) {
+            return GRAPH_ERR_FORMAT;
+        }
+        if (graph_parse_skip_blanks(p, line_end) != line_end) {
+            return GRAPH_ERR_FORMAT;
+        }
+
+        input->body = (line_end < end) ? (line_end + 1) : end;
+        return GRAPH_ERR_SUCCESS;
+    }
+
+    /* No size line. */
+    return GRAPH_ERR_FORMAT;
+}
+
+/**
+ * @brief   Parse the edges of the file in parallel chunks and merge them.
+ * @param   input           The file.
+ * @param   is_directional  Is the graph directional.
+ * @param   thread_count    The amount of threads to parse with.
+ * @param   result          The result, its edges and statistics are filled.
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_FORMAT if a line can't be parsed.
+ */
+static graph_res_t graph_parse_body(const struct graph_parse_input *input, bool is_directional, size_t thread_count,
+                                    struct graph_parse_result *result) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_parse_ctx parse;
+    const char *end = input->data + input->size;
+    size_t body_size = (size_t)(end - input->body);
+    size_t chunk_count = 0;
+    size_t total = 0;
+    size_t count = 0;
+    size_t i = 0;
+
+    (void)memset(&parse, 0, sizeof(parse));
+    parse.input = input;
+    parse.merged = &result->edges;
+
+    /* Split the body at line boundaries. */
+    chunk_count = thread_count * GRAPH_PARSE_CHUNKS_PER_THREAD;
+    if (chunk_count > (body_size / GRAPH_PARSE_MIN_CHUNK)) {
+        chunk_count = body_size / GRAPH_PARSE_MIN_CHUNK;
+    }
+    if (0 == chunk_count) {
+        chunk_count = 1;
+    }
+    parse.chunks = calloc(chunk_count, sizeof(*parse.chunks));
+    parse.first = malloc(sizeof(*parse.first) * (chunk_count + 1));
+    if ((NULL == parse.chunks) || (NULL == parse.first)) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    for (i = 0; i < chunk_count; ++i) {
+        parse.chunks[i].begin = graph_parse_line_start(input->body + ((body_size / chunk_count) * i), input->body, end);
+        parse.chunks[i].res = GRAPH_ERR_UNDEFINED;
+    }
+    for (i = 0; i < chunk_count; ++i) {
+        parse.chunks[i].end = ((i + 1) < chunk_count) ? parse.chunks[i + 1].begin : end;
+    }
+
+    res = graph_parallel_for(chunk_count, thread_count, 1, graph_parse_chunks_range, &parse);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* The first failing chunk decides the result. */
+    for (i = 0; i < chunk_count; ++i) {
+        if (GRAPH_ERR_SUCCESS != parse.chunks[i].res) {
+            res = parse.chunks[i].res;
+            goto cleanup;
+        }
+        parse.first[i] = total;
+        total += parse.chunks[i].edges.count;
+        result->lines += parse.chunks[i].lines;
+    }
+    result->parsed_edges = total;
+    if ((GRAPH_TEXT_MATRIX_MARKET == input->format) && (total != input->entries)) {
+        res = GRAPH_ERR_FORMAT;
+        goto cleanup;
+    }
+
+    /* Merge the chunks, with room for the mirrored edges of a symmetric matrix. */
+    count = (is_directional && input->is_symmetric) ? (total * 2) : total;
+    res = graph_parse_edges_reserve(&result->edges, count + 1);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    res = graph_parallel_for(chunk_count, thread_count, 1, graph_parse_merge_range, &parse);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    result->edges.count = total;
+
+    if (is_directional && input->is_symmetric) {
+        for (i = 0; i < total; ++i) {
+            if (result->edges.s_ids[i] != result->edges.d_ids[i]) {
+                (void)graph_parse_edges_push(&result->edges, result->edges.d_ids[i], result->edges.s_ids[i],
+                                             result->edges.weights[i]);
+            }
+        }
+    }
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    if (NULL != parse.chunks) {
+        for (i = 0; i < chunk_count; ++i) {
+            graph_parse_edges_release(&parse.chunks[i].edges);
+        }
+        free(parse.chunks);
+    }
+    if (NULL != parse.first) {
+        free(parse.first);
+    }
+    return res;
+}
+
+/**
+ * @brief   Collect the vertices of the parsed edges: the declared rows of a Matrix Market file (isolated
+ *          vertices included), or every id an edge list mentions.
+ */
+static graph_res_t graph_parse_collect_ids(const struct graph_parse_input *input, struct graph_parse_result *result) {
+    struct graph_parse_edges *edges = &result->edges;
+    uint64_t vertex_count = 0;
+    size_t count = 0;
+    size_t i = 0;
+
+    if (GRAPH_TEXT_MATRIX_MARKET == input->format) {
+        vertex_count = (input->rows > input->columns) ? input->rows : input->columns;
+        if (vertex_count >= GRAPH_INDEX_NONE) {
+            return GRAPH_ERR_OVERFLOW;
+        }
+        result->ids = malloc(sizeof(*result->ids) * (vertex_count + 1));
+        if (NULL == result->ids) {
+            return GRAPH_ERR_MEM;
+        }
+        for (i = 0; i < vertex_count; ++i) {
+            result->ids[i] = i + 1;
+        }
+        result->vertex_count = vertex_count;
+        return GRAPH_ERR_SUCCESS;
+    }
+
+    result->ids = malloc(sizeof(*result->ids) * ((edges->count * 2) + 1));
+    if (NULL == result->ids) {
+        return GRAPH_ERR_MEM;
+    }
+    (void)memcpy(result->ids, edges->s_ids, sizeof(*edges->s_ids) * edges->count);
+    (void)memcpy(result->ids + edges->count, edges->d_ids, sizeof(*edges->d_ids) * edges->count);
+    if (GRAPH_ERR_SUCCESS != graph_sort_u64(result->ids, NULL, edges->count * 2, &graph_allocator_default)) {
+        return GRAPH_ERR_MEM;
+    }
+    for (i = 0; i < (edges->count * 2); ++i) {
+        if ((0 == count) || (result->ids[count - 1] != result->ids[i])) {
+            result->ids[count++] = result->ids[i];
+        }
+    }
+    result->vertex_count = count;
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/**
+ * @brief   Map a file and parse it into a list of edges and vertices.
+ * @param   path            The path of the file.
+ * @param   format          The format of the file.
+ * @param   is_directional  Is the graph directional.
+ * @param   thread_count    The amount of threads to parse with (0 for one per online CPU).
+ * @param   result          The result (out parameter), graph_parse_result_release should be called on it.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+static graph_res_t graph_parse_file(const char *path, graph_text_format_t format, bool is_directional,
+                                    size_t thread_count, struct graph_parse_result *result) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_parse_input input;
+    struct stat st;
+    int fd = -1;
+
+    (void)memset(&input, 0, sizeof(input));
+    input.format = format;
+    input.data = "";
+
+    fd = open(path, O_RDONLY);
+    if ((fd < 0) || (0 != fstat(fd, &st))) {
+        res = GRAPH_ERR_IO;
+        goto cleanup;
+    }
+    input.size = (size_t)st.st_size;
+    if (0 != input.size) {
+        input.mapping = mmap(NULL, input.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (MAP_FAILED == input.mapping) {
+            input.mapping = NULL;
+            res = GRAPH_ERR_IO;
+            goto cleanup;
+        }
+        (void)madvise(input.mapping, input.size, MADV_SEQUENTIAL);
+        input.data = input.mapping;
+    }
+
+    result->bytes = input.size;
+    result->thread_count = graph_parallel_thread_count(thread_count);
+
+    res = graph_parse_header(&input);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    res = graph_parse_body(&input, is_directional, result->thread_count, result);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    result->lines += input.header_lines;
+
+    res = graph_parse_collect_ids(&input, result);
+
+    cleanup:
+    if (NULL != input.mapping) {
+        (void)munmap(input.mapping, input.size);
+    }
+    if (fd >= 0) {
+        (void)close(fd);
+    }
+    return res;
+}
+
+static void graph_parse_result_release(struct graph_parse_result *result) {
+    graph_parse_edges_release(&result->edges);
+    if (NULL != result->ids) {
+        free(result->ids);
+    }
+    (void)memset(result, 0, sizeof(*result));
+}
+
+static void graph_parse_fill_stats(const struct graph_parse_result *result, double start,
+                                   struct graph_parse_stats *stats) {
+    if (NULL == stats) {
+        return;
+    }
+    stats->bytes = result->bytes;
+    stats->lines = result->lines;
+    stats->edge_count = result->parsed_edges;
+    stats->thread_count = result->thread_count;
+    stats->seconds = graph_parse_now() - start;
+    stats->edges_per_second = (stats->seconds > 0) ? ((double)stats->edge_count / stats->seconds) : 0;
+}
+
+/** @see graph_parse.h */
+graph_res_t GRAPH_load_text(const char *path, graph_text_format_t format, bool is_directional, size_t thread_count,
+                            struct graph **g, struct graph_parse_stats *stats) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_parse_result result;
+    struct graph *local_graph = NULL;
+    graph_res_t *results = NULL;
+    double start = graph_parse_now();
+    size_t i = 0;
+
+    (void)memset(&result, 0, sizeof(result));
+
+    /* Parameter check. */
+    if ((NULL == path) || (NULL == g)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    res = graph_parse_file(path, format, is_directional, thread_count, &result);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    res = GRAPH_init(is_directional, &local_graph);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    res = GRAPH_add_vertices(local_graph, result.ids, result.vertex_count, NULL);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Repeated edges are expected, only other failures count. */
+    results = malloc(sizeof(*results) * (result.edges.count + 1));
+    if (NULL == results) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    res = GRAPH_add_edges(local_graph, result.edges.s_ids, result.edges.d_ids, result.edges.weights,
+                          result.edges.count, 0, results);
+    if (GRAPH_ERR_SUCCESS != res) {
+        res = GRAPH_ERR_SUCCESS;
+        for (i = 0; (i < result.edges.count) && (GRAPH_ERR_SUCCESS == res); ++i) {
+            if (GRAPH_ERR_FOUND != results[i]) {
+                res = results[i];
+            }
+        }
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+    }
+
+    /* Transfer ownership and indicate success. */
+    *g = local_graph;
+    local_graph = NULL;
+    graph_parse_fill_stats(&result, start, stats);
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    if (NULL != results) {
+        free(results);
+    }
+    if (NULL != local_graph) {
+        (void)GRAPH_destroy(local_graph);
+    }
+    graph_parse_result_release(&result);
+    return res;
+}
+
+/**
+ * @brief   Resolve the indexes of the ends of a range of edges.
+ */
+static void graph_parse_index_range(void *ctx, size_t begin, size_t end, size_t thread_id) {
+    struct graph_parse_ctx *parse = ctx;
+    const struct graph_csr *csr = parse->csr;
+    uint64_t *id = NULL;
+    size_t k = 0;
+
+    (void)thread_id;
+    for (k = begin; k < end; ++k) {
+        id = graph_hash_find(&csr->id_map, parse->merged->s_ids[k]);
+        parse->s_indexes[k] = (graph_index_t)(id - csr->ids);
+        id = graph_hash_find(&csr->id_map, parse->merged->d_ids[k]);
+        parse->d_indexes[k] = (graph_index_t)(id - csr->ids);
+    }
+}
+
+/**
+ * @brief   Build a snapshot from parsed edges, the way GRAPH_freeze lays out a graph.
+ * @param   is_directional  Is the graph directional.
+ * @param   thread_count    The amount of threads to build with.
+ * @param   result          The parsed edges and vertices.
+ * @param   csr             The snapshot (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+static graph_res_t graph_parse_build_csr(bool is_directional, size_t thread_count, struct graph_parse_result *result,
+                                         struct graph_csr **csr) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_csr *local_csr = NULL;
+    struct graph_parse_ctx parse;
+    struct graph_parse_edges *edges = &result->edges;
+    uint64_t *cursors = NULL;
+    uint64_t row_begin = 0;
+    uint64_t row_end = 0;
+    uint64_t out = 0;
+    uint64_t k = 0;
+    size_t entry_count = is_directional ? edges->count : (edges->count * 2);
+    size_t i = 0;
+
+    (void)memset(&parse, 0, sizeof(parse));
+
+    res = graph_csr_alloc(is_directional, result->vertex_count, entry_count, &local_csr);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    (void)memcpy(local_csr->ids, result->ids, sizeof(*result->ids) * result->vertex_count);
+    res = graph_csr_build_id_map(local_csr);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Resolve the ends of every edge in parallel, the id map is only read. */
+    parse.csr = local_csr;
+    parse.merged = edges;
+    parse.s_indexes = malloc(sizeof(*parse.s_indexes) * (edges->count + 1));
+    parse.d_indexes = malloc(sizeof(*parse.d_indexes) * (edges->count + 1));
+    cursors = malloc(sizeof(*cursors) * (result->vertex_count + 1));
+    if ((NULL == parse.s_indexes) || (NULL == parse.d_indexes) || (NULL == cursors)) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    res = graph_parallel_for(edges->count, thread_count, GRAPH_PARSE_GRAIN, graph_parse_index_range, &parse);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Count the degrees, an undirectional edge lands in both rows (a loop only in one). */
+    (void)memset(local_csr->offsets, 0, sizeof(*local_csr->offsets) * (result->vertex_count + 1));
+    for (k = 0; k < edges->count; ++k) {
+        local_csr->offsets[parse.s_indexes[k] + 1]++;
+        if ((!is_directional) && (parse.s_indexes[k] != parse.d_indexes[k])) {
+            local_csr->offsets[parse.d_indexes[k] + 1]++;
+        }
+    }
+    for (i = 0; i < result->vertex_count; ++i) {
+        local_csr->offsets[i + 1] += local_csr->offsets[i];
+        cursors[i] = local_csr->offsets[i];
+    }
+
+    /* Scatter the edges to their rows. */
+    for (k = 0; k < edges->count; ++k) {
+        local_csr->targets[cursors[parse.s_indexes[k]]] = parse.d_indexes[k];
+        local_csr->weights[cursors[parse.s_indexes[k]]++] = edges->weights[k];
+        if ((!is_directional) && (parse.s_indexes[k] != parse.d_indexes[k])) {
+            local_csr->targets[cursors[parse.d_indexes[k]]] = parse.s_indexes[k];
+            local_csr->weights[cursors[parse.d_indexes[k]]++] = edges->weights[k];
+        }
+    }
+
+    /*
+     * Drop repeated edges while the rows are still in input order, so the first occurrence wins as it does when
+     * adding edges one by one (sorting first would leave the survivor up to an unstable sort, and the two rows of an
+     * undirectional edge could disagree on its weight). The cursors are free by now, they mark the row each target
+     * was last seen in.
+     */
+    for (i = 0; i < result->vertex_count; ++i) {
+        cursors[i] = UINT64_MAX;
+    }
+    for (i = 0; i < result->vertex_count; ++i) {
+        row_end = local_csr->offsets[i + 1];
+        local_csr->offsets[i] = out;
+        for (k = row_begin; k < row_end; ++k) {
+            if (cursors[local_csr->targets[k]] != i) {
+                cursors[local_csr->targets[k]] = i;
+                local_csr->targets[out] = local_csr->targets[k];
+                local_csr->weights[out] = local_csr->weights[k];
+                out++;
+            }
+        }
+        row_begin = row_end;
+    }
+    local_csr->offsets[result->vertex_count] = out;
+    local_csr->edge_count = out;
+
+    res = graph_csr_sort_rows(local_csr, thread_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Transfer ownership and indicate success. */
+    *csr = local_csr;
+    local_csr = NULL;
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    if (NULL != parse.s_indexes) {
+        free(parse.s_indexes);
+    }
+    if (NULL != parse.d_indexes) {
+        free(parse.d_indexes);
+    }
+    if (NULL != cursors) {
+        free(cursors);
+    }
+    if (NULL != local_csr) {
+        (void)GRAPH_csr_destroy(local_csr);
+    }
+    return res;
+}
+
+/** @see graph_parse.h */
+graph_res_t GRAPH_load_text_csr(const char *path, graph_text_format_t format, bool is_directional,
+                                size_t thread_count, struct graph_csr **csr, struct graph_parse_stats *stats) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_parse_result result;
+    double start = graph_parse_now();
+
+    (void)memset(&result, 0, sizeof(result));
+
+    /* Parameter check. */
+    if ((NULL == path) || (NULL == csr)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    res = graph_parse_file(path, format, is_directional, thread_count, &result);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    res = graph_parse_build_csr(is_directional, result.thread_count, &result, csr);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    graph_parse_fill_stats(&result, start, stats);
+
+    cleanup:
+    graph_parse_result_release(&result);
+    return res;
+}
@@ -0,0 +1,82 @@
+#ifndef LIBGRAPH_GRAPH_PARSE_H
+#define LIBGRAPH_GRAPH_PARSE_H
+
+/******************************
+ * Includes
+ ******************************/
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "errors.h"
+#include "graph.h"
+#include "graph_csr.h"
+
+/**
+ * @brief   The format of a text graph file.
+ */
+typedef enum graph_text_format_e {
+    /* Matrix Market if the file starts with its banner, an edge list otherwise. */
+    GRAPH_TEXT_AUTO = 0,
+
+    /* A SNAP style edge list: a "source destination [weight]" line per edge, '#' or '%' start a comment line. */
+    GRAPH_TEXT_EDGE_LIST,
+
+    /* A Matrix Market coordinate matrix (real, integer or pattern; general or symmetric), ids are the 1-based rows. */
+    GRAPH_TEXT_MATRIX_MARKET,
+} graph_text_format_t;
+
+/**
+ * @brief   Statistics of a text graph load.
+ */
+struct graph_parse_stats {
+    /* The size of the file and the amount of lines in it. */
+    size_t bytes;
+    size_t lines;
+
+    /* The amount of edge lines parsed. */
+    size_t edge_count;
+
+    /* The amount of threads the file was parsed with. */
+    size_t thread_count;
+
+    /* The time the whole load took, and the parsed edges per second it amounts to. */
+    double seconds;
+    double edges_per_second;
+};
+
+/**
+ * @brief   Load a text graph file into a graph.
+ * @param   path            The path of the file.
+ * @param   format          The format of the file.
+ * @param   is_directional  Is the graph directional.
+ * @param   thread_count    The amount of threads to parse with (0 for one per online CPU).
+ * @param   g               The graph generated (out parameter).
+ * @param   stats           The statistics of the load (out parameter, optional).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_IO if the file can't be read,
+ *          GRAPH_ERR_FORMAT if a line can't be parsed.
+ *
+ * @note    The file is mapped and split into chunks at line boundaries, parsed in parallel and then
+ *          loaded with the batch API. Edges without a weight weigh 1.
+ * @note    Repeated edges are loaded once, keeping one of their weights.
+ * @note    A symmetric Matrix Market file loaded into a directional graph gets the mirrored edges too.
+ */
+graph_res_t GRAPH_load_text(const char *path, graph_text_format_t format, bool is_directional, size_t thread_count,
+                            struct graph **g, struct graph_parse_stats *stats);
+
+/**
+ * @brief   Load a text graph file straight into a CSR snapshot, without building a graph.
+ * @param   path            The path of the file.
+ * @param   format          The format of the file.
+ * @param   is_directional  Is the graph directional.
+ * @param   thread_count    The amount of threads to parse with (0 for one per online CPU).
+ * @param   csr             The snapshot (out parameter).
+ * @param   stats           The statistics of the load (out parameter, optional).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_OVERFLOW if there are too many vertices (see GRAPH_load_text).
+ *
+ * @note    The snapshot is the one GRAPH_freeze would make of the graph GRAPH_load_text loads.
+ */
+graph_res_t GRAPH_load_text_csr(const char *path, graph_text_format_t format, bool is_directional,
+                                size_t thread_count, struct graph_csr **csr, struct graph_parse_stats *stats);
+
+#endif //LIBGRAPH_GRAPH_PARSE_H
@@ -0,0 +1,143 @@
+#include <string.h>
+#include "graph_sort.h"
+
+/* The width of a digit of the radix sort. */
+#define GRAPH_SORT_DIGIT_BITS   (11)
+#define GRAPH_SORT_BUCKETS      (1 << GRAPH_SORT_DIGIT_BITS)
+#define GRAPH_SORT_DIGIT(key, shift) ((size_t)(((key) >> (shift)) & (GRAPH_SORT_BUCKETS - 1)))
+
+/* Below this size an insertion sort beats the radix passes. */
+#define GRAPH_SORT_SMALL        (64)
+
+/**
+ * @brief   Sort a small amount of keys with an insertion sort.
+ * @see     graph_sort_u64
+ */
+static void graph_sort_insertion(uint64_t *keys, uint64_t *values, size_t count) {
+    uint64_t key = 0;
+    uint64_t value = 0;
+    size_t i = 0;
+    size_t j = 0;
+
+    for (i = 1; i < count; ++i) {
+        key = keys[i];
+        value = (NULL != values) ? values[i] : 0;
+        for (j = i; (j > 0) && (keys[j - 1] > key); --j) {
+            keys[j] = keys[j - 1];
+            if (NULL != values) {
+                values[j] = values[j - 1];
+            }
+        }
+        keys[j] = key;
+        if (NULL != values) {
+            values[j] = value;
+        }
+    }
+}
+
+/** @see graph_sort.h */
+graph_res_t graph_sort_u64(uint64_t *keys, uint64_t *values, size_t count, const struct graph_allocator *allocator) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    size_t *histogram = NULL;
+    uint64_t *key_buffer = NULL;
+    uint64_t *value_buffer = NULL;
+    uint64_t *src_keys = keys;
+    uint64_t *src_values = values;
+    uint64_t *dst_keys = NULL;
+    uint64_t *dst_values = NULL;
+    uint64_t *swap = NULL;
+    uint64_t differing = 0;
+    size_t shift = 0;
+    size_t sum = 0;
+    size_t bucket = 0;
+    size_t i = 0;
+
+    /* Parameter check. */
+    if (((NULL == keys) && (0 != count)) || (NULL == allocator)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    if (count <= GRAPH_SORT_SMALL) {
+        graph_sort_insertion(keys, values, count);
+        res = GRAPH_ERR_SUCCESS;
+        goto cleanup;
+    }
+
+    /* Only the bits in which some keys differ need a pass. */
+    for (i = 1; i < count; ++i) {
+        differing |= keys[i] ^ keys[0];
+    }
+
+    histogram = allocator->alloc(allocator->ctx, sizeof(*histogram) * GRAPH_SORT_BUCKETS);
+    key_buffer = allocator->alloc(allocator->ctx, sizeof(*key_buffer) * count);
+    if ((NULL == histogram) || (NULL == key_buffer)) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    if (NULL != values) {
+        value_buffer = allocator->alloc(allocator->ctx, sizeof(*value_buffer) * count);
+        if (NULL == value_buffer) {
+            res = GRAPH_ERR_MEM;
+            goto cleanup;
+        }
+    }
+    dst_keys = key_buffer;
+    dst_values = value_buffer;
+
+    for (shift = 0; shift < 64; shift += GRAPH_SORT_DIGIT_BITS) {
+        if (0 == GRAPH_SORT_DIGIT(differing, shift)) {
+            continue;
+        }
+
+        /* Count the digits and turn the counts into the first position of each bucket. */
+        (void)memset(histogram, 0, sizeof(*histogram) * GRAPH_SORT_BUCKETS);
+        for (i = 0; i < count; ++i) {
+            histogram[GRAPH_SORT_DIGIT(src_keys[i], shift)]++;
+        }
+        sum = 0;
+        for (bucket = 0; bucket < GRAPH_SORT_BUCKETS; ++bucket) {
+            i = histogram[bucket];
+            histogram[bucket] = sum;
+            sum += i;
+        }
+
+        /* Scatter. */
+        for (i = 0; i < count; ++i) {
+            bucket = histogram[GRAPH_SORT_DIGIT(src_keys[i], shift)]++;
+            dst_keys[bucket] = src_keys[i];
+            if (NULL != values) {
+                dst_values[bucket] = src_values[i];
+            }
+        }
+
+        swap = src_keys;
+        src_keys = dst_keys;
+        dst_keys = swap;
+        swap = src_values;
+        src_values = dst_values;
+        dst_values = swap;
+    }
+
+    /* After an odd amount of passes the result is in the buffers. */
+    if (src_keys != keys) {
+        (void)memcpy(keys, src_keys, sizeof(*keys) * count);
+        if (NULL != values) {
+            (void)memcpy(values, src_values, sizeof(*values) * count);
+        }
+    }
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    if (NULL != histogram) {
+        allocator->free(allocator->ctx, histogram, sizeof(*histogram) * GRAPH_SORT_BUCKETS);
+    }
+    if (NULL != key_buffer) {
+        allocator->free(allocator->ctx, key_buffer, sizeof(*key_buffer) * count);
+    }
+    if (NULL != value_buffer) {
+        allocator->free(allocator->ctx, value_buffer, sizeof(*value_buffer) * count);
+    }
+    return res;
+}
@@ -0,0 +1,25 @@
+#ifndef LIBGRAPH_GRAPH_SORT_H
+#define LIBGRAPH_GRAPH_SORT_H
+
+/******************************
+ * Includes
+ ******************************/
+#include <stdint.h>
+#include <stddef.h>
+
+#include "errors.h"
+#include "graph_alloc.h"
+
+/**
+ * @brief   Sort uint64_t keys in ascending order, moving a payload along with them (LSD radix sort).
+ * @param   keys        The keys.
+ * @param   values      The payload of each key (optional).
+ * @param   count       The amount of keys.
+ * @param   allocator   The allocator the scratch buffers are taken from.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    The sort is stable and takes O(count) time, digits all the keys share are skipped.
+ */
+graph_res_t graph_sort_u64(uint64_t *keys, uint64_t *values, size_t count, const struct graph_allocator *allocator);
+
+#endif //LIBGRAPH_GRAPH_SORT_H
@@ -2,8 +2,3648 @@
 // Created by User on 26/06/2019.
 //
 
+#include <malloc.h>
+#include <string.h>
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include "graph_utils.h"
 #include "graph.h"
+#include "graph_parallel.h"
+#include "graph_sort.h"
 
+/* Integral weights and distances up to this bound are exact doubles. */
+#define GRAPH_SSSP_MAX_INTEGRAL     ((double)(1ULL << 53))
 
+/* The most buckets delta-stepping keeps at once, delta is raised if the weights would need more. */
+#define GRAPH_DELTA_MAX_BUCKETS     (1 << 16)
 
+/* The amount of frontier vertices a thread takes at once. */
+#define GRAPH_DELTA_CHUNK           (64)
+
+/* No bucket. */
+#define GRAPH_DELTA_NO_BUCKET       (UINT64_MAX)
+
+/* Beamer's switch heuristic: go bottom-up once the frontier's edges exceed 1/alpha of the unexplored edges, and
+ * back top-down once the frontier shrinks below 1/beta of the vertices. */
+#define GRAPH_BFS_ALPHA             (15)
+#define GRAPH_BFS_BETA              (18)
+
+/* The amount of frontier vertices a thread takes at once in a top-down step. */
+#define GRAPH_BFS_CHUNK             (64)
+
+/* The amount of first neighbors of every vertex Afforest links before sampling the largest component. */
+#define GRAPH_CC_NEIGHBOR_ROUNDS    (2)
+
+/* The amount of vertices sampled to find the largest component. */
+#define GRAPH_CC_SAMPLES            (1024)
+
+/* The minimal amount of vertices worth a thread of their own when linking and compressing. */
+#define GRAPH_CC_GRAIN              (4096)
+
+/* The amount of vertices in a chunk of a parallel pass over the undirected adjacency. */
+#define GRAPH_TRIANGLES_GRAIN       (4096)
+
+/* The amount of vertices handed out at once when counting triangles. */
+#define GRAPH_TRIANGLES_CHUNK       (64)
+
+/* Intersections gallop over the longer list when it is at least that many times longer. */
+#define GRAPH_GALLOP_RATIO          (32)
+
+/* The side of a tile of blocked Floyd-Warshall, three tiles of doubles fit in L2. */
+#define GRAPH_FW_TILE               (64)
+
+/* No edge picked by a component of Boruvka. */
+#define GRAPH_MSF_NO_EDGE           (UINT64_MAX)
+
+/* The amount of vertices handed out at once when collecting strongly connected components. */
+#define GRAPH_SCC_CHUNK             (1024)
+
+/* The size of a cache line, to keep per-thread partial sums apart. */
+#define GRAPH_CACHE_LINE            (64)
+
+/* The amount of vertices in a word of a bitmap. */
+#define GRAPH_BITMAP_WORD_BITS      (64)
+
+/**
+ * @brief   A growable list of vertex indexes.
+ */
+struct graph_index_list {
+    graph_index_t *items;
+    size_t count;
+    size_t capacity;
+};
+
+/**
+ * @brief   The state of one thread of delta-stepping.
+ */
+struct graph_delta_thread {
+    /* The thread's buckets, a ring indexed by bucket modulo the ring size. */
+    struct graph_index_list *ring;
+
+    /* The vertices the thread settled in the current bucket, their heavy edges are relaxed once it empties. */
+    struct graph_index_list settled;
+
+    /* Where the thread's share of the current bucket goes in the frontier. */
+    size_t frontier_offset;
+
+    /* The weight statistics of the thread's share of the edges. */
+    double max_weight;
+    double weight_sum;
+    bool has_negative_weight;
+};
+
+/**
+ * @brief   The state of one thread of a BFS.
+ */
+struct graph_bfs_thread {
+    /* The vertices the thread discovered in the current step. */
+    struct graph_index_list discovered;
+
+    /* The sum of their out-degrees. */
+    uint64_t scout_count;
+
+    /* Where the discovered vertices go in the next frontier. */
+    size_t queue_offset;
+};
+
+/**
+ * @brief   The shared state of a BFS.
+ */
+struct graph_bfs_ctx {
+    const struct graph_csr *csr;
+
+    /* The in-edges of the vertices, for the bottom-up steps. */
+    const struct graph_csr *transpose;
+
+    struct graph_bfs *bfs;
+    graph_index_t source;
+
+    struct graph_bfs_thread *threads;
+    struct graph_barrier barrier;
+
+    /* The frontier, as a queue and (in bottom-up steps) as a bitmap. */
+    size_t queue_count;
+    size_t next_item;
+    bool is_bottom_up;
+
+    /* The level of the frontier. */
+    uint32_t level;
+
+    /* Beamer's counters: the edges of the frontier, the edges left to explore, and the last frontier sizes. */
+    uint64_t scout_count;
+    uint64_t edges_to_check;
+    size_t awake_count;
+    size_t previous_awake_count;
+
+    /* Set once a thread fails an allocation, all the threads stop at the next barrier. */
+    bool is_failed;
+};
+
+/**
+ * @brief   The context of the parallel steps of Afforest.
+ */
+struct graph_cc_ctx {
+    const struct graph_csr *csr;
+
+    /* The union-find parent of each vertex, links always go from a higher index to a lower one. */
+    graph_index_t *parents;
+
+    /* The neighbor round being linked, or the first edge to link in the final pass. */
+    uint64_t round;
+
+    /* The sampled largest component, skipped in the final pass (GRAPH_INDEX_NONE to skip nothing). */
+    graph_index_t skipped;
+};
+
+/**
+ * @brief   The shared state of triangle counting: a sorted simple undirected adjacency built from a snapshot.
+ */
+struct graph_triangles_ctx {
+    const struct graph_csr *csr;
+
+    /* The transpose of a directional snapshot, NULL otherwise. */
+    struct graph_csr *transpose;
+
+    /* Only keep the neighbors that come after the vertex in the (degree, index) order. */
+    bool is_oriented;
+
+    /* The undirected degree of each vertex. */
+    uint64_t *degrees;
+
+    /* The adjacency, rows sorted by vertex index. */
+    uint64_t *offsets;
+    graph_index_t *targets;
+
+    /* The results: per vertex counts, or only the total. */
+    uint64_t *triangles;
+    uint64_t triangle_count;
+};
+
+/**
+ * @brief   The shared state of blocked Floyd-Warshall.
+ */
+struct graph_fw_ctx {
+    double **matrix;
+    size_t size;
+
+    /* The amount of tiles in a row (and column) of the matrix. */
+    size_t tile_count;
+
+    struct graph_barrier barrier;
+};
+
+/**
+ * @brief   The shared state of Boruvka.
+ */
+struct graph_msf_ctx {
+    const struct graph_csr *csr;
+    struct graph_spanning_forest *forest;
+
+    /* The source of each edge of the snapshot. */
+    graph_index_t *sources;
+
+    /* The component of each vertex, the component of a root is itself. */
+    graph_index_t *labels;
+
+    /* The lightest edge out of each component, and a bound on its weight to skip most offers with. */
+    uint64_t *lightest;
+    double *bounds;
+
+    /* The components the roots hook to, double buffered for pointer jumping. */
+    graph_index_t *parents[2];
+
+    /* Did any thread vote for, a ring so a slot is reset two votes before it's used again. */
+    bool votes[3];
+
+    struct graph_barrier barrier;
+};
+
+/**
+ * @brief   The shared state of the coloring search for strongly connected components.
+ */
+struct graph_scc_ctx {
+    const struct graph_csr *csr;
+    const struct graph_csr *transpose;
+
+    /* The representative of the component of each vertex, GRAPH_INDEX_NONE while it has none. */
+    graph_index_t *labels;
+
+    /* The amount of in and out neighbors of each vertex that weren't trimmed. */
+    graph_index_t *in_degrees;
+    graph_index_t *out_degrees;
+
+    /* The color of each vertex, the highest index that reaches it. */
+    graph_index_t *colors;
+
+    /* The work stack of each thread. */
+    struct graph_index_list *stacks;
+
+    /* The amount of vertices with a component. */
+    size_t assigned;
+
+    bool is_failed;
+    struct graph_barrier barrier;
+};
+
+/**
+ * @brief   The partial sums of one thread of PageRank, a cache line of its own.
+ */
+struct graph_pagerank_thread {
+    double dangling;
+    double residual;
+    uint8_t padding[GRAPH_CACHE_LINE - (2 * sizeof(double))];
+};
+
+/**
+ * @brief   The shared state of PageRank.
+ */
+struct graph_pagerank_ctx {
+    const struct graph_csr *csr;
+    const struct graph_csr *transpose;
+    const struct graph_pagerank_params *params;
+    struct graph_pagerank *pagerank;
+
+    /* The vertices without out-edges. */
+    graph_index_t *dangling;
+    size_t dangling_count;
+
+    struct graph_pagerank_thread *threads;
+    struct graph_barrier barrier;
+};
+
+/**
+ * @brief   The shared state of delta-stepping.
+ */
+struct graph_delta_ctx {
+    const struct graph_csr *csr;
+    double *distances;
+
+    /* The bucket each vertex was last settled in, plus one (0 if it wasn't). */
+    uint64_t *stamps;
+
+    graph_index_t source;
+    double delta;
+    size_t ring_size;
+
+    struct graph_delta_thread *threads;
+    struct graph_barrier barrier;
+
+    /* The current bucket, gathered from all the threads. */
+    graph_index_t *frontier;
+    size_t frontier_capacity;
+    size_t frontier_count;
+    size_t next_item;
+
+    /*
+     * The lowest non-empty bucket after the current one. Double buffered by the parity of the step: the threads
+     * read one entry after a step while the other is reset for the next.
+     */
+    uint64_t next_bucket[2];
+
+    /* Set once a thread fails an allocation, all the threads stop at the next barrier. */
+    bool is_failed;
+    graph_res_t res;
+};
+
+/**
+ * @brief   Forget the previous search of a context and make it able to hold a snapshot's vertices.
+ * @param   sssp            The context.
+ * @param   vertex_count    The amount of vertices of the snapshot.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+static graph_res_t graph_sssp_prepare(struct graph_sssp *sssp, size_t vertex_count) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    double *distances = NULL;
+    graph_index_t *predecessors = NULL;
+    graph_index_t *reached = NULL;
+    uint8_t *settled = NULL;
+    graph_index_t v = 0;
+    size_t i = 0;
+
+    /* Reset only what the previous search touched. */
+    for (i = 0; i < sssp->reached_count; ++i) {
+        v = sssp->reached[i];
+        sssp->distances[v] = GRAPH_DISTANCE_INFINITY;
+        sssp->predecessors[v] = GRAPH_INDEX_NONE;
+        sssp->settled[v] = 0;
+    }
+    sssp->reached_count = 0;
+    graph_dary_heap_clear(&sssp->dary_heap);
+    graph_radix_heap_clear(&sssp->radix_heap);
+
+    if (vertex_count > sssp->capacity) {
+        distances = realloc(sssp->distances, sizeof(*distances) * vertex_count);
+        if (NULL == distances) {
+            return GRAPH_ERR_MEM;
+        }
+        sssp->distances = distances;
+        predecessors = realloc(sssp->predecessors, sizeof(*predecessors) * vertex_count);
+        if (NULL == predecessors) {
+            return GRAPH_ERR_MEM;
+        }
+        sssp->predecessors = predecessors;
+        reached = realloc(sssp->reached, sizeof(*reached) * vertex_count);
+        if (NULL == reached) {
+            return GRAPH_ERR_MEM;
+        }
+        sssp->reached = reached;
+        settled = realloc(sssp->settled, sizeof(*settled) * vertex_count);
+        if (NULL == settled) {
+            return GRAPH_ERR_MEM;
+        }
+        sssp->settled = settled;
+
+        for (i = sssp->capacity; i < vertex_count; ++i) {
+            sssp->distances[i] = GRAPH_DISTANCE_INFINITY;
+            sssp->predecessors[i] = GRAPH_INDEX_NONE;
+            sssp->settled[i] = 0;
+        }
+        sssp->capacity = vertex_count;
+    }
+
+    res = graph_dary_heap_reserve(&sssp->dary_heap, vertex_count);
+
+    return res;
+}
+
+/** @see graph_utils.h */
+void GRAPH_sssp_init(struct graph_sssp *sssp) {
+    (void)memset(sssp, 0, sizeof(*sssp));
+    graph_dary_heap_init(&sssp->dary_heap);
+    graph_radix_heap_init(&sssp->radix_heap);
+}
+
+/** @see graph_utils.h */
+void GRAPH_sssp_destroy(struct graph_sssp *sssp) {
+    if (NULL != sssp->distances) {
+        free(sssp->distances);
+    }
+    if (NULL != sssp->predecessors) {
+        free(sssp->predecessors);
+    }
+    if (NULL != sssp->reached) {
+        free(sssp->reached);
+    }
+    if (NULL != sssp->settled) {
+        free(sssp->settled);
+    }
+    graph_dary_heap_destroy(&sssp->dary_heap);
+    graph_radix_heap_destroy(&sssp->radix_heap);
+    GRAPH_sssp_init(sssp);
+}
+
+/**
+ * @brief   Dijkstra with the d-ary heap: every vertex is in the heap at most once, relaxations decrease its key.
+ */
+static graph_res_t graph_sssp_dijkstra_dary(const struct graph_csr *csr, graph_index_t target,
+                                            struct graph_sssp *sssp) {
+    struct graph_dary_heap *heap = &sssp->dary_heap;
+    graph_index_t u = 0;
+    graph_index_t v = 0;
+    double distance = 0;
+    double candidate = 0;
+    uint64_t k = 0;
+
+    while (0 != heap->count) {
+        u = graph_dary_heap_pop(heap, &distance);
+        sssp->settled[u] = 1;
+        if (u == target) {
+            break;
+        }
+
+        for (k = csr->offsets[u]; k < csr->offsets[u + 1]; ++k) {
+            if (csr->weights[k] < 0) {
+                return GRAPH_ERR_PARAMS;
+            }
+            v = csr->targets[k];
+            candidate = distance + csr->weights[k];
+            if (candidate < sssp->distances[v]) {
+                if (GRAPH_DISTANCE_INFINITY == sssp->distances[v]) {
+                    sssp->reached[sssp->reached_count++] = v;
+                }
+                sssp->distances[v] = candidate;
+                sssp->predecessors[v] = u;
+                graph_dary_heap_push(heap, v, candidate);
+            }
+        }
+    }
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/**
+ * @brief   Dijkstra with the radix heap: a vertex is pushed on every improvement, stale entries are skipped.
+ */
+static graph_res_t graph_sssp_dijkstra_radix(const struct graph_csr *csr, graph_index_t target,
+                                             struct graph_sssp *sssp) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_radix_heap *heap = &sssp->radix_heap;
+    graph_index_t u = 0;
+    graph_index_t v = 0;
+    uint64_t distance = 0;
+    double candidate = 0;
+    double weight = 0;
+    uint64_t k = 0;
+
+    while (0 != heap->count) {
+        res = graph_radix_heap_pop(heap, &u, &distance);
+        if (GRAPH_ERR_SUCCESS != res) {
+            return res;
+        }
+        if (sssp->settled[u]) {
+            continue;
+        }
+        sssp->settled[u] = 1;
+        if (u == target) {
+            break;
+        }
+
+        for (k = csr->offsets[u]; k < csr->offsets[u + 1]; ++k) {
+            weight = csr->weights[k];
+            if ((weight < 0) || (weight >= GRAPH_SSSP_MAX_INTEGRAL) || (weight != (double)(uint64_t)weight)) {
+                return GRAPH_ERR_PARAMS;
+            }
+            v = csr->targets[k];
+            candidate = (double)distance + weight;
+            if (candidate < sssp->distances[v]) {
+                /* The distance would leave the exact range of the keys, and dropping it would leave v unreached. */
+                if (candidate >= GRAPH_SSSP_MAX_INTEGRAL) {
+                    return GRAPH_ERR_OVERFLOW;
+                }
+                if (GRAPH_DISTANCE_INFINITY == sssp->distances[v]) {
+                    sssp->reached[sssp->reached_count++] = v;
+                }
+                sssp->distances[v] = candidate;
+                sssp->predecessors[v] = u;
+                res = graph_radix_heap_push(heap, v, (uint64_t)candidate);
+                if (GRAPH_ERR_SUCCESS != res) {
+                    return res;
+                }
+            }
+        }
+    }
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph_utils.h */
+graph_res_t GRAPH_sssp_dijkstra(const struct graph_csr *csr, graph_index_t source, graph_index_t target,
+                                graph_sssp_queue_t queue, struct graph_sssp *sssp) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == sssp) || (source >= csr->vertex_count) ||
+        ((GRAPH_INDEX_NONE != target) && (target >= csr->vertex_count))) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    res = graph_sssp_prepare(sssp, csr->vertex_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    sssp->distances[source] = 0;
+    sssp->reached[sssp->reached_count++] = source;
+
+    switch (queue) {
+        case GRAPH_SSSP_QUEUE_DARY_HEAP:
+            graph_dary_heap_push(&sssp->dary_heap, source, 0);
+            res = graph_sssp_dijkstra_dary(csr, target, sssp);
+            break;
+        case GRAPH_SSSP_QUEUE_RADIX_HEAP:
+            res = graph_radix_heap_push(&sssp->radix_heap, source, 0);
+            if (GRAPH_ERR_SUCCESS == res) {
+                res = graph_sssp_dijkstra_radix(csr, target, sssp);
+            }
+            break;
+        default:
+            res = GRAPH_ERR_PARAMS;
+            break;
+    }
+
+    cleanup:
+    return res;
+}
+
+static graph_res_t graph_index_list_push(struct graph_index_list *list, graph_index_t item) {
+    graph_index_t *items = NULL;
+    size_t capacity = 0;
+
+    if (list->count == list->capacity) {
+        capacity = (list->capacity * 2) + 64;
+        items = realloc(list->items, sizeof(*items) * capacity);
+        if (NULL == items) {
+            return GRAPH_ERR_MEM;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = item;
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+static inline uint64_t graph_delta_bucket(const struct graph_delta_ctx *delta, double distance) {
+    return (uint64_t)(distance / delta->delta);
+}
+
+/**
+ * @brief   Lower the distance of a vertex if a candidate is shorter (an atomic min), and queue it in the
+ *          relaxing thread's bucket of the new distance.
+ */
+static void graph_delta_relax(struct graph_delta_ctx *delta, struct graph_delta_thread *thread, graph_index_t v,
+                              double candidate) {
+    double current = 0;
+
+    __atomic_load(&delta->distances[v], &current, __ATOMIC_RELAXED);
+    while (candidate < current) {
+        if (__atomic_compare_exchange(&delta->distances[v], &current, &candidate, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            if (GRAPH_ERR_SUCCESS != graph_index_list_push(
+                    &thread->ring[graph_delta_bucket(delta, candidate) % delta->ring_size], v)) {
+                __atomic_store_n(&delta->is_failed, true, __ATOMIC_RELAXED);
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * @brief   Relax the light (weight <= delta) or the heavy edges of a vertex.
+ */
+static void graph_delta_relax_edges(struct graph_delta_ctx *delta, struct graph_delta_thread *thread,
+                                    graph_index_t u, bool is_light) {
+    const struct graph_csr *csr = delta->csr;
+    double distance = 0;
+    uint64_t k = 0;
+
+    __atomic_load(&delta->distances[u], &distance, __ATOMIC_RELAXED);
+    for (k = csr->offsets[u]; k < csr->offsets[u + 1]; ++k) {
+        if ((csr->weights[k] <= delta->delta) == is_light) {
+            graph_delta_relax(delta, thread, csr->targets[k], distance + csr->weights[k]);
+        }
+    }
+}
+
+/**
+ * @brief   Pick delta from the weight statistics of the threads (thread 0 only).
+ */
+static void graph_delta_tune(struct graph_delta_ctx *delta, size_t thread_count) {
+    const struct graph_csr *csr = delta->csr;
+    double max_weight = 0;
+    double weight_sum = 0;
+    double average_degree = 0;
+    size_t i = 0;
+
+    for (i = 0; i < thread_count; ++i) {
+        if (delta->threads[i].has_negative_weight) {
+            delta->res = GRAPH_ERR_PARAMS;
+        }
+        if (delta->threads[i].max_weight > max_weight) {
+            max_weight = delta->threads[i].max_weight;
+        }
+        weight_sum += delta->threads[i].weight_sum;
+    }
+
+    /*
+     * About one bucket per light edge of an average vertex: delta = max weight / average degree (Meyer and Sanders),
+     * but never below the mean weight, so light phases get enough work.
+     */
+    if (delta->delta <= 0) {
+        average_degree = (0 != csr->vertex_count) ? ((double)csr->edge_count / (double)csr->vertex_count) : 0;
+        delta->delta = (average_degree > 1) ? (max_weight / average_degree) : max_weight;
+        if ((0 != csr->edge_count) && (delta->delta < (weight_sum / (double)csr->edge_count))) {
+            delta->delta = weight_sum / (double)csr->edge_count;
+        }
+    }
+    if (delta->delta < (max_weight / (GRAPH_DELTA_MAX_BUCKETS - 2))) {
+        delta->delta = max_weight / (GRAPH_DELTA_MAX_BUCKETS - 2);
+    }
+    if (delta->delta <= 0) {
+        delta->delta = 1;
+    }
+
+    /* A relaxation from bucket b lands at most max_weight / delta + 1 buckets ahead. */
+    delta->ring_size = (size_t)(max_weight / delta->delta) + 2;
+}
+
+/**
+ * @brief   Gather the current bucket of all the threads into the frontier (thread 0 only).
+ */
+static size_t graph_delta_gather(struct graph_delta_ctx *delta, size_t thread_count, size_t slot) {
+    graph_index_t *frontier = NULL;
+    size_t total = 0;
+    size_t i = 0;
+
+    for (i = 0; i < thread_count; ++i) {
+        delta->threads[i].frontier_offset = total;
+        total += delta->threads[i].ring[slot].count;
+    }
+    if (total > delta->frontier_capacity) {
+        frontier = realloc(delta->frontier, sizeof(*frontier) * total);
+        if (NULL == frontier) {
+            delta->is_failed = true;
+            return 0;
+        }
+        delta->frontier = frontier;
+        delta->frontier_capacity = total;
+    }
+    delta->frontier_count = total;
+    delta->next_item = 0;
+
+    return total;
+}
+
+/**
+ * @brief   A thread of delta-stepping. The threads walk the buckets in lockstep: each bucket is emptied by
+ *          rounds of light edge relaxations over the gathered bucket, then the heavy edges of the vertices it
+ *          settled are relaxed once, and the lowest non-empty bucket of any thread is next.
+ */
+static void graph_delta_task(void *ctx, size_t thread_id, size_t thread_count) {
+    struct graph_delta_ctx *delta = ctx;
+    const struct graph_csr *csr = delta->csr;
+    struct graph_delta_thread *thread = &delta->threads[thread_id];
+    struct graph_index_list *bucket = NULL;
+    uint64_t edge_begin = (csr->edge_count * thread_id) / thread_count;
+    uint64_t edge_end = (csr->edge_count * (thread_id + 1)) / thread_count;
+    uint64_t current = 0;
+    uint64_t candidate = 0;
+    uint64_t *next_bucket = NULL;
+    size_t step = 0;
+    size_t slot = 0;
+    size_t begin = 0;
+    size_t end = 0;
+    size_t i = 0;
+    graph_index_t v = 0;
+    double distance = 0;
+    uint64_t k = 0;
+
+    if (0 == thread_id) {
+        graph_barrier_resize(&delta->barrier, thread_count);
+    }
+
+    /* Weight statistics of the thread's share of the edges. */
+    for (k = edge_begin; k < edge_end; ++k) {
+        if (csr->weights[k] < 0) {
+            thread->has_negative_weight = true;
+        }
+        if (csr->weights[k] > thread->max_weight) {
+            thread->max_weight = csr->weights[k];
+        }
+        thread->weight_sum += csr->weights[k];
+    }
+    graph_barrier_wait(&delta->barrier);
+    if (0 == thread_id) {
+        graph_delta_tune(delta, thread_count);
+    }
+    graph_barrier_wait(&delta->barrier);
+    if (GRAPH_ERR_SUCCESS != delta->res) {
+        return;
+    }
+
+    thread->ring = calloc(delta->ring_size, sizeof(*thread->ring));
+    if (NULL == thread->ring) {
+        __atomic_store_n(&delta->is_failed, true, __ATOMIC_RELAXED);
+    } else if ((0 == thread_id) && (GRAPH_ERR_SUCCESS != graph_index_list_push(&thread->ring[0], delta->source))) {
+        __atomic_store_n(&delta->is_failed, true, __ATOMIC_RELAXED);
+    }
+    graph_barrier_wait(&delta->barrier);
+    if (delta->is_failed) {
+        return;
+    }
+
+    for (current = 0; GRAPH_DELTA_NO_BUCKET != current; current = *next_bucket, ++step) {
+        slot = current % delta->ring_size;
+        next_bucket = &delta->next_bucket[step % 2];
+
+        /* Light phases, until no thread has anything left in the bucket. */
+        for (;;) {
+            if (0 == thread_id) {
+                (void)graph_delta_gather(delta, thread_count, slot);
+            }
+            graph_barrier_wait(&delta->barrier);
+            if (0 == thread_id) {
+                /* Everybody has read the entry of the previous step by now, and nobody writes it this step. */
+                delta->next_bucket[(step + 1) % 2] = GRAPH_DELTA_NO_BUCKET;
+            }
+            if (delta->is_failed) {
+                return;
+            }
+            if (0 == delta->frontier_count) {
+                break;
+            }
+
+            bucket = &thread->ring[slot];
+            if (0 != bucket->count) {
+                (void)memcpy(delta->frontier + thread->frontier_offset, bucket->items,
+                             sizeof(*bucket->items) * bucket->count);
+                bucket->count = 0;
+            }
+            graph_barrier_wait(&delta->barrier);
+
+            while ((begin = __atomic_fetch_add(&delta->next_item, GRAPH_DELTA_CHUNK, __ATOMIC_RELAXED)) <
+                   delta->frontier_count) {
+                end = begin + GRAPH_DELTA_CHUNK;
+                if (end > delta->frontier_count) {
+                    end = delta->frontier_count;
+                }
+                for (i = begin; i < end; ++i) {
+                    v = delta->frontier[i];
+
+                    /* Skip vertices that moved to a lower bucket since they were queued. */
+                    __atomic_load(&delta->distances[v], &distance, __ATOMIC_RELAXED);
+                    if (graph_delta_bucket(delta, distance) != current) {
+                        continue;
+                    }
+                    if ((current + 1) != __atomic_exchange_n(&delta->stamps[v], current + 1, __ATOMIC_RELAXED)) {
+                        if (GRAPH_ERR_SUCCESS != graph_index_list_push(&thread->settled, v)) {
+                            __atomic_store_n(&delta->is_failed, true, __ATOMIC_RELAXED);
+                        }
+                    }
+                    graph_delta_relax_edges(delta, thread, v, true);
+                }
+            }
+            graph_barrier_wait(&delta->barrier);
+        }
+
+        /* The heavy phase, heavy edges only reach later buckets. */
+        for (i = 0; i < thread->settled.count; ++i) {
+            graph_delta_relax_edges(delta, thread, thread->settled.items[i], false);
+        }
+        thread->settled.count = 0;
+
+        /* Find the next bucket. */
+        for (i = 1; i < delta->ring_size; ++i) {
+            if (0 != thread->ring[(current + i) % delta->ring_size].count) {
+                candidate = current + i;
+                /* An atomic min. */
+                k = __atomic_load_n(next_bucket, __ATOMIC_RELAXED);
+                while ((candidate < k) &&
+                       !__atomic_compare_exchange_n(next_bucket, &k, candidate, true,
+                                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+                break;
+            }
+        }
+        graph_barrier_wait(&delta->barrier);
+    }
+}
+
+/** @see graph_utils.h */
+graph_res_t GRAPH_sssp_delta_stepping(const struct graph_csr *csr, graph_index_t source, double delta,
+                                      size_t thread_count, struct graph_sssp *sssp) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_delta_ctx ctx;
+    bool is_barrier_initialized = false;
+    graph_index_t u = 0;
+    graph_index_t v = 0;
+    size_t head = 0;
+    size_t i = 0;
+    uint64_t k = 0;
+
+    (void)memset(&ctx, 0, sizeof(ctx));
+
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == sssp) || (source >= csr->vertex_count)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    res = graph_sssp_prepare(sssp, csr->vertex_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    thread_count = graph_parallel_thread_count(thread_count);
+    ctx.csr = csr;
+    ctx.distances = sssp->distances;
+    ctx.source = source;
+    ctx.delta = delta;
+    ctx.res = GRAPH_ERR_SUCCESS;
+    ctx.next_bucket[0] = GRAPH_DELTA_NO_BUCKET;
+    ctx.next_bucket[1] = GRAPH_DELTA_NO_BUCKET;
+    ctx.stamps = calloc(csr->vertex_count, sizeof(*ctx.stamps));
+    ctx.threads = calloc(thread_count, sizeof(*ctx.threads));
+    if ((NULL == ctx.stamps) || (NULL == ctx.threads)) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    res = graph_barrier_init(&ctx.barrier, thread_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    is_barrier_initialized = true;
+
+    sssp->distances[source] = 0;
+    res = graph_parallel_run(thread_count, graph_delta_task, &ctx);
+    if (GRAPH_ERR_SUCCESS == res) {
+        res = ctx.is_failed ? GRAPH_ERR_MEM : ctx.res;
+    }
+    if (GRAPH_ERR_SUCCESS != res) {
+        /* Leave the context clean, the distances may have been written anywhere. */
+        for (i = 0; i < csr->vertex_count; ++i) {
+            sssp->distances[i] = GRAPH_DISTANCE_INFINITY;
+        }
+        goto cleanup;
+    }
+
+    /*
+     * The threads only settle distances, predecessors come from a search over the tight edges
+     * (dist[u] + w == dist[v]) from the source, which also lists the reached vertices.
+     */
+    sssp->reached[sssp->reached_count++] = source;
+    sssp->settled[source] = 1;
+    for (head = 0; head < sssp->reached_count; ++head) {
+        u = sssp->reached[head];
+        for (k = csr->offsets[u]; k < csr->offsets[u + 1]; ++k) {
+            v = csr->targets[k];
+            if ((!sssp->settled[v]) && ((sssp->distances[u] + csr->weights[k]) == sssp->distances[v])) {
+                sssp->settled[v] = 1;
+                sssp->predecessors[v] = u;
+                sssp->reached[sssp->reached_count++] = v;
+            }
+        }
+    }
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    if (is_barrier_initialized) {
+        graph_barrier_destroy(&ctx.barrier);
+    }
+    if (NULL != ctx.threads) {
+        for (i = 0; i < thread_count; ++i) {
+            if (NULL != ctx.threads[i].ring) {
+                for (k = 0; k < ctx.ring_size; ++k) {
+                    if (NULL != ctx.threads[i].ring[k].items) {
+                        free(ctx.threads[i].ring[k].items);
+                    }
+                }
+                free(ctx.threads[i].ring);
+            }
+            if (NULL != ctx.threads[i].settled.items) {
+                free(ctx.threads[i].settled.items);
+            }
+        }
+        free(ctx.threads);
+    }
+    if (NULL != ctx.stamps) {
+        free(ctx.stamps);
+    }
+    if (NULL != ctx.frontier) {
+        free(ctx.frontier);
+    }
+    return res;
+}
+
+/** @see graph_utils.h */
+void GRAPH_bfs_init(struct graph_bfs *bfs) {
+    (void)memset(bfs, 0, sizeof(*bfs));
+}
+
+/** @see graph_utils.h */
+void GRAPH_bfs_destroy(struct graph_bfs *bfs) {
+    if (NULL != bfs->levels) {
+        free(bfs->levels);
+    }
+    if (NULL != bfs->parents) {
+        free(bfs->parents);
+    }
+    if (NULL != bfs->queue) {
+        free(bfs->queue);
+    }
+    if (NULL != bfs->bitmap) {
+        free(bfs->bitmap);
+    }
+    GRAPH_bfs_init(bfs);
+}
+
+/**
+ * @brief   Make a BFS context able to hold a snapshot's vertices.
+ */
+static graph_res_t graph_bfs_reserve(struct graph_bfs *bfs, size_t vertex_count) {
+    uint32_t *levels = NULL;
+    graph_index_t *parents = NULL;
+    graph_index_t *queue = NULL;
+    uint64_t *bitmap = NULL;
+
+    if (vertex_count <= bfs->capacity) {
+        return GRAPH_ERR_SUCCESS;
+    }
+
+    levels = realloc(bfs->levels, sizeof(*levels) * vertex_count);
+    if (NULL == levels) {
+        return GRAPH_ERR_MEM;
+    }
+    bfs->levels = levels;
+    parents = realloc(bfs->parents, sizeof(*parents) * vertex_count);
+    if (NULL == parents) {
+        return GRAPH_ERR_MEM;
+    }
+    bfs->parents = parents;
+    queue = realloc(bfs->queue, sizeof(*queue) * vertex_count);
+    if (NULL == queue) {
+        return GRAPH_ERR_MEM;
+    }
+    bfs->queue = queue;
+    bitmap = realloc(bfs->bitmap, sizeof(*bitmap) * ((vertex_count + GRAPH_BITMAP_WORD_BITS - 1) /
+                                                     GRAPH_BITMAP_WORD_BITS));
+    if (NULL == bitmap) {
+        return GRAPH_ERR_MEM;
+    }
+    bfs->bitmap = bitmap;
+    bfs->capacity = vertex_count;
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/**
+ * @brief   Pick the direction of the next step by Beamer's heuristic (thread 0 only).
+ */
+static void graph_bfs_choose_direction(struct graph_bfs_ctx *search) {
+    if (!search->is_bottom_up) {
+        if (search->scout_count > (search->edges_to_check / GRAPH_BFS_ALPHA)) {
+            search->is_bottom_up = true;
+            search->awake_count = search->queue_count;
+            search->previous_awake_count = 0;
+        }
+    } else if ((search->awake_count < search->previous_awake_count) &&
+               (search->awake_count <= (search->csr->vertex_count / GRAPH_BFS_BETA))) {
+        search->is_bottom_up = false;
+
+        /* The out-degrees of the frontier weren't counted bottom-up, start over. */
+        search->scout_count = 1;
+    }
+}
+
+/**
+ * @brief   A top-down step: the threads take chunks of the frontier and claim the unvisited neighbors.
+ */
+static void graph_bfs_top_down(struct graph_bfs_ctx *search, struct graph_bfs_thread *thread) {
+    const struct graph_csr *csr = search->csr;
+    struct graph_bfs *bfs = search->bfs;
+    graph_index_t expected = GRAPH_INDEX_NONE;
+    graph_index_t u = 0;
+    graph_index_t v = 0;
+    size_t begin = 0;
+    size_t end = 0;
+    size_t i = 0;
+    uint64_t k = 0;
+
+    while ((begin = __atomic_fetch_add(&search->next_item, GRAPH_BFS_CHUNK, __ATOMIC_RELAXED)) < search->queue_count) {
+        end = begin + GRAPH_BFS_CHUNK;
+        if (end > search->queue_count) {
+            end = search->queue_count;
+        }
+        for (i = begin; i < end; ++i) {
+            u = bfs->queue[i];
+            for (k = csr->offsets[u]; k < csr->offsets[u + 1]; ++k) {
+                v = csr->targets[k];
+                if (GRAPH_INDEX_NONE != __atomic_load_n(&bfs->parents[v], __ATOMIC_RELAXED)) {
+                    continue;
+                }
+                expected = GRAPH_INDEX_NONE;
+                if (__atomic_compare_exchange_n(&bfs->parents[v], &expected, u, false,
+                                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                    bfs->levels[v] = search->level + 1;
+                    thread->scout_count += csr->offsets[v + 1] - csr->offsets[v];
+                    if (GRAPH_ERR_SUCCESS != graph_index_list_push(&thread->discovered, v)) {
+                        __atomic_store_n(&search->is_failed, true, __ATOMIC_RELAXED);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief   A bottom-up step over the thread's range of vertices: each unvisited vertex takes the first of its
+ *          in-neighbors found in the frontier bitmap as its parent. Only the thread writes its vertices.
+ */
+static void graph_bfs_bottom_up(struct graph_bfs_ctx *search, struct graph_bfs_thread *thread, size_t vertex_begin,
+                                size_t vertex_end) {
+    const struct graph_csr *transpose = search->transpose;
+    struct graph_bfs *bfs = search->bfs;
+    graph_index_t u = 0;
+    size_t v = 0;
+    uint64_t k = 0;
+
+    for (v = vertex_begin; v < vertex_end; ++v) {
+        if (GRAPH_INDEX_NONE != bfs->parents[v]) {
+            continue;
+        }
+        for (k = transpose->offsets[v]; k < transpose->offsets[v + 1]; ++k) {
+            u = transpose->targets[k];
+            if (0 != (bfs->bitmap[u / GRAPH_BITMAP_WORD_BITS] & (1ULL << (u % GRAPH_BITMAP_WORD_BITS)))) {
+                bfs->parents[v] = u;
+                bfs->levels[v] = search->level + 1;
+                if (GRAPH_ERR_SUCCESS != graph_index_list_push(&thread->discovered, (graph_index_t)v)) {
+                    __atomic_store_n(&search->is_failed, true, __ATOMIC_RELAXED);
+                }
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief   Make the discovered vertices of all the threads the next frontier, and update the counters
+ *          (thread 0 only).
+ */
+static void graph_bfs_advance(struct graph_bfs_ctx *search, size_t thread_count) {
+    size_t total = 0;
+    uint64_t scout_count = 0;
+    size_t i = 0;
+
+    for (i = 0; i < thread_count; ++i) {
+        search->threads[i].queue_offset = total;
+        total += search->threads[i].discovered.count;
+        scout_count += search->threads[i].scout_count;
+        search->threads[i].scout_count = 0;
+    }
+
+    if (search->is_bottom_up) {
+        search->bfs->bottom_up_steps++;
+        search->previous_awake_count = search->awake_count;
+        search->awake_count = total;
+    } else {
+        search->bfs->top_down_steps++;
+        search->edges_to_check -= (search->scout_count < search->edges_to_check) ?
+                                  search->scout_count : search->edges_to_check;
+        search->scout_count = scout_count;
+    }
+    search->queue_count = total;
+    search->next_item = 0;
+    search->level++;
+}
+
+/**
+ * @brief   A thread of a BFS. The bitmap words (and so the vertices) are split in contiguous ranges between the
+ *          threads, so bottom-up steps never share a word; top-down steps take chunks of the frontier.
+ */
+static void graph_bfs_task(void *ctx, size_t thread_id, size_t thread_count) {
+    struct graph_bfs_ctx *search = ctx;
+    const struct graph_csr *csr = search->csr;
+    struct graph_bfs *bfs = search->bfs;
+    struct graph_bfs_thread *thread = &search->threads[thread_id];
+    size_t word_count = (csr->vertex_count + GRAPH_BITMAP_WORD_BITS - 1) / GRAPH_BITMAP_WORD_BITS;
+    size_t word_begin = (word_count * thread_id) / thread_count;
+    size_t word_end = (word_count * (thread_id + 1)) / thread_count;
+    size_t vertex_begin = word_begin * GRAPH_BITMAP_WORD_BITS;
+    size_t vertex_end = word_end * GRAPH_BITMAP_WORD_BITS;
+    size_t item_begin = 0;
+    size_t item_end = 0;
+    graph_index_t u = 0;
+    size_t i = 0;
+
+    if (0 == thread_id) {
+        graph_barrier_resize(&search->barrier, thread_count);
+    }
+    if (vertex_end > csr->vertex_count) {
+        vertex_end = csr->vertex_count;
+    }
+
+    for (i = vertex_begin; i < vertex_end; ++i) {
+        bfs->levels[i] = GRAPH_BFS_UNREACHED;
+        bfs->parents[i] = GRAPH_INDEX_NONE;
+    }
+    graph_barrier_wait(&search->barrier);
+    if (0 == thread_id) {
+        bfs->parents[search->source] = search->source;
+        bfs->levels[search->source] = 0;
+    }
+
+    while (0 != search->queue_count) {
+        if (0 == thread_id) {
+            graph_bfs_choose_direction(search);
+        }
+        graph_barrier_wait(&search->barrier);
+
+        if (search->is_bottom_up) {
+            /* Turn the frontier into a bitmap. */
+            (void)memset(bfs->bitmap + word_begin, 0, sizeof(*bfs->bitmap) * (word_end - word_begin));
+            graph_barrier_wait(&search->barrier);
+            item_begin = (search->queue_count * thread_id) / thread_count;
+            item_end = (search->queue_count * (thread_id + 1)) / thread_count;
+            for (i = item_begin; i < item_end; ++i) {
+                u = bfs->queue[i];
+                (void)__atomic_fetch_or(&bfs->bitmap[u / GRAPH_BITMAP_WORD_BITS],
+                                        1ULL << (u % GRAPH_BITMAP_WORD_BITS), __ATOMIC_RELAXED);
+            }
+            graph_barrier_wait(&search->barrier);
+
+            graph_bfs_bottom_up(search, thread, vertex_begin, vertex_end);
+        } else {
+            graph_bfs_top_down(search, thread);
+        }
+        graph_barrier_wait(&search->barrier);
+
+        if (0 == thread_id) {
+            graph_bfs_advance(search, thread_count);
+        }
+        graph_barrier_wait(&search->barrier);
+        if (search->is_failed) {
+            return;
+        }
+
+        /* The frontier was fully read before the last barrier, it can be overwritten. */
+        if (0 != thread->discovered.count) {
+            (void)memcpy(bfs->queue + thread->queue_offset, thread->discovered.items,
+                         sizeof(*thread->discovered.items) * thread->discovered.count);
+            thread->discovered.count = 0;
+        }
+        graph_barrier_wait(&search->barrier);
+    }
+}
+
+/** @see graph_utils.h */
+graph_res_t GRAPH_bfs(const struct graph_csr *csr, const struct graph_csr *transpose, graph_index_t source,
+                      size_t thread_count, struct graph_bfs *bfs) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_bfs_ctx ctx;
+    struct graph_csr *local_transpose = NULL;
+    bool is_barrier_initialized = false;
+    size_t i = 0;
+
+    (void)memset(&ctx, 0, sizeof(ctx));
+
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == bfs) || (source >= csr->vertex_count) ||
+        ((NULL != transpose) && (transpose->vertex_count != csr->vertex_count))) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    if (NULL == transpose) {
+        if (csr->is_directional) {
+            res = GRAPH_csr_transpose(csr, &local_transpose);
+            if (GRAPH_ERR_SUCCESS != res) {
+                goto cleanup;
+            }
+            transpose = local_transpose;
+        } else {
+            transpose = csr;
+        }
+    }
+
+    res = graph_bfs_reserve(bfs, csr->vertex_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    thread_count = graph_parallel_thread_count(thread_count);
+    ctx.csr = csr;
+    ctx.transpose = transpose;
+    ctx.bfs = bfs;
+    ctx.source = source;
+    ctx.threads = calloc(thread_count, sizeof(*ctx.threads));
+    if (NULL == ctx.threads) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    res = graph_barrier_init(&ctx.barrier, thread_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    is_barrier_initialized = true;
+
+    /* The source is the first frontier, it is its own parent while searching so nobody claims it. */
+    bfs->top_down_steps = 0;
+    bfs->bottom_up_steps = 0;
+    bfs->queue[0] = source;
+    ctx.queue_count = 1;
+    ctx.scout_count = csr->offsets[source + 1] - csr->offsets[source];
+    ctx.edges_to_check = csr->edge_count;
+
+    res = graph_parallel_run(thread_count, graph_bfs_task, &ctx);
+    if ((GRAPH_ERR_SUCCESS == res) && ctx.is_failed) {
+        res = GRAPH_ERR_MEM;
+    }
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    bfs->parents[source] = GRAPH_INDEX_NONE;
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    if (is_barrier_initialized) {
+        graph_barrier_destroy(&ctx.barrier);
+    }
+    if (NULL != ctx.threads) {
+        for (i = 0; i < thread_count; ++i) {
+            if (NULL != ctx.threads[i].discovered.items) {
+                free(ctx.threads[i].discovered.items);
+            }
+        }
+        free(ctx.threads);
+    }
+    if (NULL != local_transpose) {
+        (void)GRAPH_csr_destroy(local_transpose);
+    }
+    return res;
+}
+
+/** @see graph_utils.h */
+void GRAPH_components_init(struct graph_components *components) {
+    (void)memset(components, 0, sizeof(*components));
+}
+
+/** @see graph_utils.h */
+void GRAPH_components_destroy(struct graph_components *components) {
+    if (NULL != components->labels) {
+        free(components->labels);
+    }
+    if (NULL != components->sizes) {
+        free(components->sizes);
+    }
+    GRAPH_components_init(components);
+}
+
+/**
+ * @brief   Join the trees of two vertices of a concurrent union-find, by pointing the higher root at the lower one.
+ */
+static void graph_cc_link(graph_index_t *parents, graph_index_t u, graph_index_t v) {
+    graph_index_t p1 = __atomic_load_n(&parents[u], __ATOMIC_RELAXED);
+    graph_index_t p2 = __atomic_load_n(&parents[v], __ATOMIC_RELAXED);
+    graph_index_t high = 0;
+    graph_index_t low = 0;
+    graph_index_t parent_high = 0;
+    graph_index_t expected = 0;
+
+    while (p1 != p2) {
+        high = (p1 > p2) ? p1 : p2;
+        low = (p1 > p2) ? p2 : p1;
+        parent_high = __atomic_load_n(&parents[high], __ATOMIC_RELAXED);
+
+        /* Done if high already points at low, or if high is a root and the link succeeds. */
+        expected = high;
+        if ((parent_high == low) ||
+            ((parent_high == high) && __atomic_compare_exchange_n(&parents[high], &expected, low, false,
+                                                                  __ATOMIC_RELAXED, __ATOMIC_RELAXED))) {
+            break;
+        }
+        p1 = __atomic_load_n(&parents[__atomic_load_n(&parents[high], __ATOMIC_RELAXED)], __ATOMIC_RELAXED);
+        p2 = __atomic_load_n(&parents[low], __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief   Link every vertex of a range to its round-th neighbor.
+ */
+static void graph_cc_link_round_range(void *ctx, size_t begin, size_t end, size_t thread_id) {
+    struct graph_cc_ctx *cc = ctx;
+    const struct graph_csr *csr = cc->csr;
+    size_t u = 0;
+
+    (void)thread_id;
+    for (u = begin; u < end; ++u) {
+        if ((csr->offsets[u] + cc->round) < csr->offsets[u + 1]) {
+            graph_cc_link(cc->parents, (graph_index_t)u, csr->targets[csr->offsets[u] + cc->round]);
+        }
+    }
+}
+
+/**
+ * @brief   Link the remaining edges of the vertices of a range that aren't in the skipped component.
+ */
+static void graph_cc_link_rest_range(void *ctx, size_t begin, size_t end, size_t thread_id) {
+    struct graph_cc_ctx *cc = ctx;
+    const struct graph_csr *csr = cc->csr;
+    size_t u = 0;
+    uint64_t k = 0;
+
+    (void)thread_id;
+    for (u = begin; u < end; ++u) {
+        if (__atomic_load_n(&cc->parents[u], __ATOMIC_RELAXED) == cc->skipped) {
+            continue;
+        }
+        for (k = csr->offsets[u] + cc->round; k < csr->offsets[u + 1]; ++k) {
+            graph_cc_link(cc->parents, (graph_index_t)u, csr->targets[k]);
+        }
+    }
+}
+
+/**
+ * @brief   Point every vertex of a range straight at its root.
+ */
+static void graph_cc_compress_range(void *ctx, size_t begin, size_t end, size_t thread_id) {
+    struct graph_cc_ctx *cc = ctx;
+    graph_index_t parent = 0;
+    graph_index_t grandparent = 0;
+    size_t u = 0;
+
+    (void)thread_id;
+    for (u = begin; u < end; ++u) {
+        parent = __atomic_load_n(&cc->parents[u], __ATOMIC_RELAXED);
+        while (parent != (grandparent = __atomic_load_n(&cc->parents[parent], __ATOMIC_RELAXED))) {
+            __atomic_store_n(&cc->parents[u], grandparent, __ATOMIC_RELAXED);
+            parent = grandparent;
+        }
+    }
+}
+
+/**
+ * @brief   Find the most frequent root among a sample of the vertices.
+ * @param   parents         The compressed union-find.
+ * @param   vertex_count    The amount of vertices.
+ * @param   root            The most frequent root (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+static graph_res_t graph_cc_sample_largest(const graph_index_t *parents, size_t vertex_count, graph_index_t *root) {
+    uint64_t samples[GRAPH_CC_SAMPLES];
+    uint64_t seed = 0x2545f4914f6cdd1dULL;
+    size_t best_count = 0;
+    size_t run = 0;
+    size_t i = 0;
+
+    for (i = 0; i < GRAPH_CC_SAMPLES; ++i) {
+        seed = (seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+        samples[i] = parents[(seed >> 32) % vertex_count];
+    }
+    if (GRAPH_ERR_SUCCESS != graph_sort_u64(samples, NULL, GRAPH_CC_SAMPLES, &graph_allocator_default)) {
+        return GRAPH_ERR_MEM;
+    }
+
+    for (i = 0; i < GRAPH_CC_SAMPLES; i += run) {
+        for (run = 1; ((i + run) < GRAPH_CC_SAMPLES) && (samples[i + run] == samples[i]); ++run);
+        if (run > best_count) {
+            best_count = run;
+            *root = (graph_index_t)samples[i];
+        }
+    }
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/**
+ * @brief   Make a components context able to hold a snapshot's vertices.
+ */
+static graph_res_t graph_components_reserve(struct graph_components *components, size_t vertex_count) {
+    graph_index_t *labels = NULL;
+    size_t *sizes = NULL;
+
+    if (vertex_count <= components->capacity) {
+        return GRAPH_ERR_SUCCESS;
+    }
+
+    labels = realloc(components->labels, sizeof(*labels) * vertex_count);
+    if (NULL == labels) {
+        return GRAPH_ERR_MEM;
+    }
+    components->labels = labels;
+    sizes = realloc(components->sizes, sizeof(*sizes) * vertex_count);
+    if (NULL == sizes) {
+        return GRAPH_ERR_MEM;
+    }
+    components->sizes = sizes;
+    components->capacity = vertex_count;
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph_utils.h */
+graph_res_t GRAPH_connected_components(const struct graph_csr *csr, size_t thread_count,
+                                       struct graph_components *components) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_cc_ctx cc;
+    graph_index_t root = 0;
+    size_t v = 0;
+
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == components)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    res = graph_components_reserve(components, csr->vertex_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    components->component_count = 0;
+    if (0 == csr->vertex_count) {
+        goto cleanup;
+    }
+
+    cc.csr = csr;
+    cc.parents = components->labels;
+    cc.skipped = GRAPH_INDEX_NONE;
+    for (v = 0; v < csr->vertex_count; ++v) {
+        cc.parents[v] = (graph_index_t)v;
+    }
+
+    /* Link the first neighbors of every vertex, that is usually enough to form the largest component. */
+    for (cc.round = 0; cc.round < GRAPH_CC_NEIGHBOR_ROUNDS; ++cc.round) {
+        res = graph_parallel_for(csr->vertex_count, thread_count, GRAPH_CC_GRAIN, graph_cc_link_round_range, &cc);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+        res = graph_parallel_for(csr->vertex_count, thread_count, GRAPH_CC_GRAIN, graph_cc_compress_range, &cc);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+    }
+
+    /*
+     * Link the rest of the edges. The vertices of the largest component can be skipped in an undirectional
+     * snapshot: any of their edges to another component is also an edge of a vertex of that component.
+     */
+    if (!csr->is_directional) {
+        res = graph_cc_sample_largest(cc.parents, csr->vertex_count, &cc.skipped);
+        if (GRAPH_ERR_SUCCESS != res) {
+            goto cleanup;
+        }
+    }
+    res = graph_parallel_for(csr->vertex_count, thread_count, GRAPH_CC_GRAIN, graph_cc_link_rest_range, &cc);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    res = graph_parallel_for(csr->vertex_count, thread_count, GRAPH_CC_GRAIN, graph_cc_compress_range, &cc);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Number the components by their root, the lowest vertex in them, which comes before the rest. */
+    for (v = 0; v < csr->vertex_count; ++v) {
+        root = components->labels[v];
+        if (root == v) {
+            components->labels[v] = (graph_index_t)components->component_count;
+            components->sizes[components->component_count++] = 0;
+        } else {
+            components->labels[v] = components->labels[root];
+        }
+        components->sizes[components->labels[v]]++;
+    }
+
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    return res;
+}
+
+/** @see graph_utils.h */
+void GRAPH_pagerank_params_init(struct graph_pagerank_params *params) {
+    params->damping = GRAPH_PAGERANK_DEFAULT_DAMPING;
+    params->tolerance = GRAPH_PAGERANK_DEFAULT_TOLERANCE;
+    params->max_iterations = GRAPH_PAGERANK_DEFAULT_MAX_ITERATIONS;
+    params->personalization = NULL;
+    params->thread_count = 0;
+}
+
+/** @see graph_utils.h */
+void GRAPH_pagerank_init(struct graph_pagerank *pagerank) {
+    (void)memset(pagerank, 0, sizeof(*pagerank));
+}
+
+/** @see graph_utils.h */
+void GRAPH_pagerank_destroy(struct graph_pagerank *pagerank) {
+    if (NULL != pagerank->ranks) {
+        free(pagerank->ranks);
+    }
+    if (NULL != pagerank->residuals) {
+        free(pagerank->residuals);
+    }
+    if (NULL != pagerank->next_ranks) {
+        free(pagerank->next_ranks);
+    }
+    if (NULL != pagerank->contributions) {
+        free(pagerank->contributions);
+    }
+    if (NULL != pagerank->inverse_degrees) {
+        free(pagerank->inverse_degrees);
+    }
+    if (NULL != pagerank->teleports) {
+        free(pagerank->teleports);
+    }
+    GRAPH_pagerank_init(pagerank);
+}
+
+/**
+ * @brief   Make a PageRank context able to hold a snapshot's vertices and a run's iterations.
+ */
+static graph_res_t graph_pagerank_reserve(struct graph_pagerank *pagerank, size_t vertex_count,
+                                          size_t iteration_count) {
+    double **arrays[] = {&pagerank->ranks, &pagerank->next_ranks, &pagerank->contributions,
+                         &pagerank->inverse_degrees, &pagerank->teleports};
+    double *array = NULL;
+    size_t i = 0;
+
+    if (vertex_count > pagerank->capacity) {
+        for (i = 0; i < (sizeof(arrays) / sizeof(arrays[0])); ++i) {
+            array = realloc(*arrays[i], sizeof(*array) * vertex_count);
+            if (NULL == array) {
+                return GRAPH_ERR_MEM;
+            }
+            *arrays[i] = array;
+        }
+        pagerank->capacity = vertex_count;
+    }
+    if (iteration_count > pagerank->residuals_capacity) {
+        array = realloc(pagerank->residuals, sizeof(*array) * iteration_count);
+        if (NULL == array) {
+            return GRAPH_ERR_MEM;
+        }
+        pagerank->residuals = array;
+        pagerank->residuals_capacity = iteration_count;
+    }
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/**
+ * @brief   Compute the contributions (rank / out-degree) of a range of vertices.
+ */
+static void graph_pagerank_contribute(const double *ranks, const double *inverse_degrees, double *contributions,
+                                      size_t begin, size_t end) {
+    size_t i = begin;
+
+#if defined(__AVX__)
+    for (; (i + 4) <= end; i += 4) {
+        _mm256_storeu_pd(contributions + i, _mm256_mul_pd(_mm256_loadu_pd(ranks + i),
+                                                          _mm256_loadu_pd(inverse_degrees + i)));
+    }
+#elif defined(__SSE2__)
+    for (; (i + 2) <= end; i += 2) {
+        _mm_storeu_pd(contributions + i, _mm_mul_pd(_mm_loadu_pd(ranks + i), _mm_loadu_pd(inverse_degrees + i)));
+    }
+#endif
+    for (; i < end; ++i) {
+        contributions[i] = ranks[i] * inverse_degrees[i];
+    }
+}
+
+/**
+ * @brief   Sum the contributions of a row of in-neighbors.
+ */
+static double graph_pagerank_gather(const double *contributions, const graph_index_t *sources, size_t count,
+                                    bool is_gather_safe) {
+    double sum = 0;
+    double sum_odd = 0;
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    __m256d sums = _mm256_setzero_pd();
+    __m128d half = _mm_setzero_pd();
+
+    /* The gather takes signed 32 bit indexes. */
+    if (is_gather_safe) {
+        for (; (i + 4) <= count; i += 4) {
+            sums = _mm256_add_pd(sums, _mm256_i32gather_pd(contributions,
+                                                           _mm_loadu_si128((const __m128i *)(sources + i)), 8));
+        }
+        half = _mm_add_pd(_mm256_castpd256_pd128(sums), _mm256_extractf128_pd(sums, 1));
+        sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+#else
+    (void)is_gather_safe;
+#endif
+    /* Two chains of additions, so consecutive loads don't wait on each other. */
+    for (; (i + 2) <= count; i += 2) {
+        sum += contributions[sources[i]];
+        sum_odd += contributions[sources[i + 1]];
+    }
+    sum += sum_odd;
+    for (; i < count; ++i) {
+        sum += contributions[sources[i]];
+    }
+
+    return sum;
+}
+
+/**
+ * @brief   The first row of a thread's block, blocks are balanced by rows plus edges.
+ */
+static size_t graph_csr_block_start(const struct graph_csr *csr, size_t thread_id, size_t thread_count) {
+    uint64_t goal = ((csr->vertex_count + csr->edge_count) * thread_id) / thread_count;
+    size_t low = 0;
+    size_t high = csr->vertex_count;
+    size_t middle = 0;
+
+    /* The first row v with v + offsets[v] >= goal. */
+    while (low < high) {
+        middle = low + ((high - low) / 2);
+        if ((middle + csr->offsets[middle]) < goal) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/**
+ * @brief   A thread of PageRank, it owns a block of rows, and a share of the dangling vertices.
+ */
+static void graph_pagerank_task(void *ctx, size_t thread_id, size_t thread_count) {
+    struct graph_pagerank_ctx *run = ctx;
+    const struct graph_csr *transpose = run->transpose;
+    struct graph_pagerank *pagerank = run->pagerank;
+    double damping = run->params->damping;
+    bool is_gather_safe = (transpose->vertex_count <= INT32_MAX);
+    double *ranks = pagerank->ranks;
+    double *next_ranks = pagerank->next_ranks;
+    double *swap = NULL;
+    size_t begin = graph_csr_block_start(transpose, thread_id, thread_count);
+    size_t end = graph_csr_block_start(transpose, thread_id + 1, thread_count);
+    size_t dangling_begin = (run->dangling_count * thread_id) / thread_count;
+    size_t dangling_end = (run->dangling_count * (thread_id + 1)) / thread_count;
+    size_t iteration = 0;
+    double dangling = 0;
+    double residual = 0;
+    double rank = 0;
+    double change = 0;
+    size_t i = 0;
+    size_t v = 0;
+
+    if (0 == thread_id) {
+        graph_barrier_resize(&run->barrier, thread_count);
+    }
+
+    for (iteration = 0; iteration < run->params->max_iterations; ++iteration) {
+        graph_pagerank_contribute(ranks, pagerank->inverse_degrees, pagerank->contributions, begin, end);
+        dangling = 0;
+        for (i = dangling_begin; i < dangling_end; ++i) {
+            dangling += ranks[run->dangling[i]];
+        }
+        run->threads[thread_id].dangling = dangling;
+        graph_barrier_wait(&run->barrier);
+
+        /* Every thread sums the partials in the same order, so they all agree. */
+        dangling = 0;
+        for (i = 0; i < thread_count; ++i) {
+            dangling += run->threads[i].dangling;
+        }
+
+        residual = 0;
+        for (v = begin; v < end; ++v) {
+            rank = pagerank->teleports[v] * ((1 - damping) + (damping * dangling));
+            rank += damping * graph_pagerank_gather(pagerank->contributions,
+                                                    transpose->targets + transpose->offsets[v],
+                                                    (size_t)(transpose->offsets[v + 1] - transpose->offsets[v]),
+                                                    is_gather_safe);
+            next_ranks[v] = rank;
+            change = rank - ranks[v];
+            residual += (change < 0) ? -change : change;
+        }
+        run->threads[thread_id].residual = residual;
+        graph_barrier_wait(&run->barrier);
+
+        residual = 0;
+        for (i = 0; i < thread_count; ++i) {
+            residual += run->threads[i].residual;
+        }
+        if (0 == thread_id) {
+            pagerank->residuals[iteration] = residual;
+            pagerank->iteration_count = iteration + 1;
+        }
+
+        swap = ranks;
+        ranks = next_ranks;
+        next_ranks = swap;
+        if (residual < run->params->tolerance) {
+            if (0 == thread_id) {
+                pagerank->is_converged = true;
+            }
+            break;
+        }
+    }
+
+    /* The last ranks may be in the scratch array. */
+    if ((0 == thread_id) && (ranks != pagerank->ranks)) {
+        pagerank->next_ranks = pagerank->ranks;
+        pagerank->ranks = ranks;
+    }
+}
+
+/** @see graph_utils.h */
+graph_res_t GRAPH_pagerank(const struct graph_csr *csr, const struct graph_csr *transpose,
+                           const struct graph_pagerank_params *params, struct graph_pagerank *pagerank) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_pagerank_ctx ctx;
+    struct graph_csr *local_transpose = NULL;
+    bool is_barrier_initialized = false;
+    size_t thread_count = 0;
+    double total = 0;
+    uint64_t degree = 0;
+    size_t v = 0;
+
+    (void)memset(&ctx, 0, sizeof(ctx));
+
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == params) || (NULL == pagerank) || (params->damping < 0) || (params->damping >= 1) ||
+        ((NULL != transpose) && (transpose->vertex_count != csr->vertex_count))) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    res = graph_pagerank_reserve(pagerank, csr->vertex_count, params->max_iterations);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    pagerank->iteration_count = 0;
+    pagerank->is_converged = false;
+    if (0 == csr->vertex_count) {
+        pagerank->is_converged = true;
+        goto cleanup;
+    }
+
+    /* The teleport vector, which is also where the ranks start. */
+    if (NULL != params->personalization) {
+        for (v = 0; v < csr->vertex_count; ++v) {
+            if (params->personalization[v] < 0) {
+                res = GRAPH_ERR_PARAMS;
+                goto cleanup;
+            }
+            total += params->personalization[v];
+        }
+        if (total <= 0) {
+            res = GRAPH_ERR_PARAMS;
+            goto cleanup;
+        }
+    }
+    for (v = 0; v < csr->vertex_count; ++v) {
+        pagerank->teleports[v] = (NULL != params->personalization) ?
+                                 (params->personalization[v] / total) : (1 / (double)csr->vertex_count);
+        pagerank->ranks[v] = pagerank->teleports[v];
+    }
+
+    if (NULL == transpose) {
+        if (csr->is_directional) {
+            res = GRAPH_csr_transpose(csr, &local_transpose);
+            if (GRAPH_ERR_SUCCESS != res) {
+                goto cleanup;
+            }
+            transpose = local_transpose;
+        } else {
+            transpose = csr;
+        }
+    }
+
+    /* The inverse out-degrees, and the vertices without out-edges. */
+    ctx.dangling = malloc(sizeof(*ctx.dangling) * csr->vertex_count);
+    if (NULL == ctx.dangling) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    for (v = 0; v < csr->vertex_count; ++v) {
+        degree = csr->offsets[v + 1] - csr->offsets[v];
+        pagerank->inverse_degrees[v] = (0 != degree) ? (1 / (double)degree) : 0;
+        if (0 == degree) {
+            ctx.dangling[ctx.dangling_count++] = (graph_index_t)v;
+        }
+    }
+
+    thread_count = graph_parallel_thread_count(params->thread_count);
+    ctx.csr = csr;
+    ctx.transpose = transpose;
+    ctx.params = params;
+    ctx.pagerank = pagerank;
+    ctx.threads = calloc(thread_count, sizeof(*ctx.threads));
+    if (NULL == ctx.threads) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    res = graph_barrier_init(&ctx.barrier, thread_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    is_barrier_initialized = true;
+
+    res = graph_parallel_run(thread_count, graph_pagerank_task, &ctx);
+
+    cleanup:
+    if (is_barrier_initialized) {
+        graph_barrier_destroy(&ctx.barrier);
+    }
+    if (NULL != ctx.threads) {
+        free(ctx.threads);
+    }
+    if (NULL != ctx.dangling) {
+        free(ctx.dangling);
+    }
+    if (NULL != local_transpose) {
+        (void)GRAPH_csr_destroy(local_transpose);
+    }
+    return res;
+}
+
+/** @see graph_utils.h */
+void GRAPH_clustering_init(struct graph_clustering *clustering) {
+    (void)memset(clustering, 0, sizeof(*clustering));
+}
+
+/** @see graph_utils.h */
+void GRAPH_clustering_destroy(struct graph_clustering *clustering) {
+    if (NULL != clustering->triangles) {
+        free(clustering->triangles);
+    }
+    if (NULL != clustering->coefficients) {
+        free(clustering->coefficients);
+    }
+    GRAPH_clustering_init(clustering);
+}
+
+/**
+ * @brief   Walk the neighbors of a vertex in the simple undirected graph, in ascending order.
+ * @param   ctx     The state of the run.
+ * @param   v       The vertex.
+ * @param   out     Where to write the neighbors, NULL to only count them.
+ * @return  The amount of neighbors.
+ */
+static size_t graph_triangles_row(const struct graph_triangles_ctx *ctx, size_t v, graph_index_t *out) {
+    const graph_index_t *out_edges = ctx->csr->targets + ctx->csr->offsets[v];
+    const graph_index_t *in_edges = NULL;
+    size_t out_count = (size_t)(ctx->csr->offsets[v + 1] - ctx->csr->offsets[v]);
+    size_t in_count = 0;
+    graph_index_t last = GRAPH_INDEX_NONE;
+    graph_index_t u = 0;
+    size_t count = 0;
+    size_t i = 0;
+    size_t j = 0;
+
+    if (NULL != ctx->transpose) {
+        in_edges = ctx->transpose->targets + ctx->transpose->offsets[v];
+        in_count = (size_t)(ctx->transpose->offsets[v + 1] - ctx->transpose->offsets[v]);
+    }
+
+    /* Merge both sorted rows, the duplicates are next to each other. */
+    while ((i < out_count) || (j < in_count)) {
+        if ((j >= in_count) || ((i < out_count) && (out_edges[i] <= in_edges[j]))) {
+            u = out_edges[i++];
+        } else {
+            u = in_edges[j++];
+        }
+        if ((u == v) || (u == last)) {
+            continue;
+        }
+        last = u;
+        if (ctx->is_oriented && ((ctx->degrees[u] < ctx->degrees[v]) ||
+                                 ((ctx->degrees[u] == ctx->degrees[v]) && (u < v)))) {
+            continue;
+        }
+        if (NULL != out) {
+            out[count] = u;
+        }
+        ++count;
+    }
+
+    return count;
+}
+
+static void graph_triangles_degree_range(void *ctx, size_t begin, size_t end, size_t thread_id) {
+    struct graph_triangles_ctx *run = ctx;
+    size_t v = 0;
+
+    (void)thread_id;
+    for (v = begin; v < end; ++v) {
+        run->degrees[v] = graph_triangles_row(run, v, NULL);
+    }
+}
+
+static void graph_triangles_count_range(void *ctx, size_t begin, size_t end, size_t thread_id) {
+    struct graph_triangles_ctx *run = ctx;
+    size_t v = 0;
+
+    (void)thread_id;
+    for (v = begin; v < end; ++v) {
+        run->offsets[v + 1] = run->is_oriented ? graph_triangles_row(run, v, NULL) : run->degrees[v];
+    }
+}
+
+static void graph_triangles_fill_range(void *ctx, size_t begin, size_t end, size_t thread_id) {
+    struct graph_triangles_ctx *run = ctx;
+    size_t v = 0;
+
+    (void)thread_id;
+    for (v = begin; v < end; ++v) {
+        (void)graph_triangles_row(run, v, run->targets + run->offsets[v]);
+    }
+}
+
+/**
+ * @brief   Count the common elements of two sorted lists, the short one searched in the long one.
+ */
+static uint64_t graph_intersect_gallop(const graph_index_t *small, size_t small_count, const graph_index_t *large,
+                                       size_t large_count) {
+    uint64_t count = 0;
+    size_t low = 0;
+    size_t high = 0;
+    size_t middle = 0;
+    size_t bound = 0;
+    size_t i = 0;
+
+    for (i = 0; (i < small_count) && (low < large_count); ++i) {
+        /* Double the step until it passes the element, everything before low is smaller than it. */
+        for (bound = 1; ((low + bound) <= large_count) && (large[low + bound - 1] < small[i]); bound <<= 1) {
+            low += bound;
+        }
+        high = ((low + bound) <= large_count) ? (low + bound) : large_count;
+        while (low < high) {
+            middle = low + ((high - low) / 2);
+            if (large[middle] < small[i]) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        if ((low < large_count) && (large[low] == small[i])) {
+            ++count;
+            ++low;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief   Count the common elements of two sorted lists of unique elements by merging them.
+ */
+static uint64_t graph_intersect_merge(const graph_index_t *a, size_t a_count, const graph_index_t *b,
+                                      size_t b_count) {
+    uint64_t count = 0;
+    size_t i = 0;
+    size_t j = 0;
+
+#if defined(__SSE2__)
+    __m128i a_block;
+    __m128i b_block;
+    __m128i matches;
+    graph_index_t a_last = 0;
+    graph_index_t b_last = 0;
+
+    /* Compare blocks of 4 against every rotation of each other, then skip the block with the lower maximum. */
+    while (((i + 4) <= a_count) && ((j + 4) <= b_count)) {
+        a_block = _mm_loadu_si128((const __m128i *)(a + i));
+        b_block = _mm_loadu_si128((const __m128i *)(b + j));
+        matches = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi32(a_block, b_block),
+                             _mm_cmpeq_epi32(a_block, _mm_shuffle_epi32(b_block, _MM_SHUFFLE(0, 3, 2, 1)))),
+                _mm_or_si128(_mm_cmpeq_epi32(a_block, _mm_shuffle_epi32(b_block, _MM_SHUFFLE(1, 0, 3, 2))),
+                             _mm_cmpeq_epi32(a_block, _mm_shuffle_epi32(b_block, _MM_SHUFFLE(2, 1, 0, 3)))));
+        count += (uint64_t)__builtin_popcount((unsigned int)_mm_movemask_ps(_mm_castsi128_ps(matches)));
+        a_last = a[i + 3];
+        b_last = b[j + 3];
+        if (a_last <= b_last) {
+            i += 4;
+        }
+        if (b_last <= a_last) {
+            j += 4;
+        }
+    }
+#endif
+    while ((i < a_count) && (j < b_count)) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (a[i] > b[j]) {
+            ++j;
+        } else {
+            ++count;
+            ++i;
+            ++j;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief   Count the common neighbors of two vertices of the adjacency.
+ */
+static uint64_t graph_triangles_intersect(const struct graph_triangles_ctx *ctx, graph_index_t v, graph_index_t u) {
+    const graph_index_t *a = ctx->targets + ctx->offsets[v];
+    const graph_index_t *b = ctx->targets + ctx->offsets[u];
+    size_t a_count = (size_t)(ctx->offsets[v + 1] - ctx->offsets[v]);
+    size_t b_count = (size_t)(ctx->offsets[u + 1] - ctx->offsets[u]);
+
+    if ((0 == a_count) || (0 == b_count)) {
+        return 0;
+    }
+    if ((a_count / b_count) >= GRAPH_GALLOP_RATIO) {
+        return graph_intersect_gallop(b, b_count, a, a_count);
+    }
+    if ((b_count / a_count) >= GRAPH_GALLOP_RATIO) {
+        return graph_intersect_gallop(a, a_count, b, b_count);
+    }
+    return graph_intersect_merge(a, a_count, b, b_count);
+}
+
+/**
+ * @brief   Count the triangles each vertex closes with its oriented neighbors, so each triangle once.
+ */
+static void graph_triangles_total_range(void *ctx, size_t begin, size_t end, size_t thread_id) {
+    struct graph_triangles_ctx *run = ctx;
+    uint64_t count = 0;
+    uint64_t i = 0;
+    size_t v = 0;
+
+    (void)thread_id;
+    for (v = begin; v < end; ++v) {
+        for (i = run->offsets[v]; i < run->offsets[v + 1]; ++i) {
+            count += graph_triangles_intersect(run, (graph_index_t)v, run->targets[i]);
+        }
+    }
+    (void)__atomic_fetch_add(&run->triangle_count, count, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief   Count the triangles of each vertex, every one is seen through both of its other vertices.
+ */
+static void graph_triangles_vertex_range(void *ctx, size_t begin, size_t end, size_t thread_id) {
+    struct graph_triangles_ctx *run = ctx;
+    uint64_t count = 0;
+    uint64_t i = 0;
+    size_t v = 0;
+
+    (void)thread_id;
+    for (v = begin; v < end; ++v) {
+        count = 0;
+        for (i = run->offsets[v]; i < run->offsets[v + 1]; ++i) {
+            count += graph_triangles_intersect(run, (graph_index_t)v, run->targets[i]);
+        }
+        run->triangles[v] = count / 2;
+    }
+}
+
+/**
+ * @brief   Release the adjacency of a triangle counting run.
+ */
+static void graph_triangles_release(struct graph_triangles_ctx *ctx) {
+    if (NULL != ctx->transpose) {
+        (void)GRAPH_csr_destroy(ctx->transpose);
+    }
+    if (NULL != ctx->degrees) {
+        free(ctx->degrees);
+    }
+    if (NULL != ctx->offsets) {
+        free(ctx->offsets);
+    }
+    if (NULL != ctx->targets) {
+        free(ctx->targets);
+    }
+}
+
+/**
+ * @brief   Build the sorted simple undirected adjacency of a snapshot, oriented by degree or not.
+ */
+static graph_res_t graph_triangles_build(struct graph_triangles_ctx *ctx, const struct graph_csr *csr,
+                                         size_t thread_count, bool is_oriented) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    size_t v = 0;
+
+    (void)memset(ctx, 0, sizeof(*ctx));
+    ctx->csr = csr;
+    if (csr->is_directional) {
+        res = GRAPH_csr_transpose(csr, &ctx->transpose);
+        if (GRAPH_ERR_SUCCESS != res) {
+            return res;
+        }
+    }
+    ctx->degrees = malloc(sizeof(*ctx->degrees) * (csr->vertex_count + 1));
+    ctx->offsets = malloc(sizeof(*ctx->offsets) * (csr->vertex_count + 1));
+    if ((NULL == ctx->degrees) || (NULL == ctx->offsets)) {
+        return GRAPH_ERR_MEM;
+    }
+
+    /* The degrees first, the orientation depends on them. */
+    res = graph_parallel_for(csr->vertex_count, thread_count, GRAPH_TRIANGLES_GRAIN, graph_triangles_degree_range,
+                             ctx);
+    if (GRAPH_ERR_SUCCESS != res) {
+        return res;
+    }
+    ctx->is_oriented = is_oriented;
+    res = graph_parallel_for(csr->vertex_count, thread_count, GRAPH_TRIANGLES_GRAIN, graph_triangles_count_range,
+                             ctx);
+    if (GRAPH_ERR_SUCCESS != res) {
+        return res;
+    }
+    ctx->offsets[0] = 0;
+    for (v = 0; v < csr->vertex_count; ++v) {
+        ctx->offsets[v + 1] += ctx->offsets[v];
+    }
+
+    ctx->targets = malloc(sizeof(*ctx->targets) * (size_t)(ctx->offsets[csr->vertex_count] + 1));
+    if (NULL == ctx->targets) {
+        return GRAPH_ERR_MEM;
+    }
+    return graph_parallel_for(csr->vertex_count, thread_count, GRAPH_TRIANGLES_GRAIN, graph_triangles_fill_range,
+                              ctx);
+}
+
+/** @see graph_utils.h */
+graph_res_t GRAPH_count_triangles(const struct graph_csr *csr, size_t thread_count, uint64_t *triangle_count) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_triangles_ctx ctx;
+
+    (void)memset(&ctx, 0, sizeof(ctx));
+
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == triangle_count)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    res = graph_triangles_build(&ctx, csr, thread_count, true);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    res = graph_parallel_for_dynamic(csr->vertex_count, thread_count, GRAPH_TRIANGLES_CHUNK,
+                                     graph_triangles_total_range, &ctx);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    *triangle_count = ctx.triangle_count;
+
+    cleanup:
+    graph_triangles_release(&ctx);
+    return res;
+}
+
+/** @see graph_utils.h */
+graph_res_t GRAPH_clustering_coefficients(const struct graph_csr *csr, size_t thread_count,
+                                          struct graph_clustering *clustering) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_triangles_ctx ctx;
+    uint64_t *triangles = NULL;
+    double *coefficients = NULL;
+    double total = 0;
+    uint64_t degree = 0;
+    size_t v = 0;
+
+    (void)memset(&ctx, 0, sizeof(ctx));
+
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == clustering)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    if (csr->vertex_count > clustering->capacity) {
+        triangles = realloc(clustering->triangles, sizeof(*triangles) * csr->vertex_count);
+        if (NULL == triangles) {
+            res = GRAPH_ERR_MEM;
+            goto cleanup;
+        }
+        clustering->triangles = triangles;
+        coefficients = realloc(clustering->coefficients, sizeof(*coefficients) * csr->vertex_count);
+        if (NULL == coefficients) {
+            res = GRAPH_ERR_MEM;
+            goto cleanup;
+        }
+        clustering->coefficients = coefficients;
+        clustering->capacity = csr->vertex_count;
+    }
+
+    /* Every vertex needs all its neighbors, so the adjacency isn't oriented. */
+    res = graph_triangles_build(&ctx, csr, thread_count, false);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    ctx.triangles = clustering->triangles;
+    res = graph_parallel_for_dynamic(csr->vertex_count, thread_count, GRAPH_TRIANGLES_CHUNK,
+                                     graph_triangles_vertex_range, &ctx);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    clustering->triangle_count = 0;
+    for (v = 0; v < csr->vertex_count; ++v) {
+        degree = ctx.degrees[v];
+        clustering->triangle_count += clustering->triangles[v];
+        clustering->coefficients[v] = 0;
+        if (degree >= 2) {
+            clustering->coefficients[v] = (2 * (double)clustering->triangles[v]) /
+                                          ((double)degree * (double)(degree - 1));
+        }
+        total += clustering->coefficients[v];
+    }
+    clustering->triangle_count /= 3;
+    clustering->average_coefficient = (0 != csr->vertex_count) ? (total / (double)csr->vertex_count) : 0;
+
+    cleanup:
+    graph_triangles_release(&ctx);
+    return res;
+}
+
+/**
+ * @brief   Relax the entries of a tile through the vertices of a range, in order:
+ *          matrix[i][j] = min(matrix[i][j], matrix[i][k] + matrix[k][j]).
+ */
+static void graph_fw_tile(double **matrix, size_t row_begin, size_t row_end, size_t column_begin,
+                          size_t column_end, size_t k_begin, size_t k_end) {
+    const double *through = NULL;
+    double *row = NULL;
+    double first = 0;
+    size_t i = 0;
+    size_t j = 0;
+    size_t k = 0;
+
+    for (k = k_begin; k < k_end; ++k) {
+        through = matrix[k];
+        for (i = row_begin; i < row_end; ++i) {
+            first = matrix[i][k];
+            if (__builtin_inf() == first) {
+                continue;
+            }
+            row = matrix[i];
+            j = column_begin;
+#if defined(__AVX__)
+            __m256d firsts = _mm256_set1_pd(first);
+
+            for (; (j + 4) <= column_end; j += 4) {
+                _mm256_storeu_pd(row + j, _mm256_min_pd(_mm256_loadu_pd(row + j),
+                                                        _mm256_add_pd(firsts, _mm256_loadu_pd(through + j))));
+            }
+#elif defined(__SSE2__)
+            __m128d firsts = _mm_set1_pd(first);
+
+            for (; (j + 2) <= column_end; j += 2) {
+                _mm_storeu_pd(row + j, _mm_min_pd(_mm_loadu_pd(row + j),
+                                                  _mm_add_pd(firsts, _mm_loadu_pd(through + j))));
+            }
+#endif
+            for (; j < column_end; ++j) {
+                if ((first + through[j]) < row[j]) {
+                    row[j] = first + through[j];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief   Replace one value of a range of rows with another.
+ */
+static void graph_fw_replace(double **matrix, size_t size, size_t row_begin, size_t row_end, double from,
+                             double to) {
+    size_t i = 0;
+    size_t j = 0;
+
+    for (i = row_begin; i < row_end; ++i) {
+        for (j = 0; j < size; ++j) {
+            if (from == matrix[i][j]) {
+                matrix[i][j] = to;
+            }
+        }
+    }
+}
+
+/**
+ * @brief   A thread of blocked Floyd-Warshall, the tiles of each phase are dealt round robin.
+ */
+static void graph_fw_task(void *ctx, size_t thread_id, size_t thread_count) {
+    struct graph_fw_ctx *fw = ctx;
+    size_t tile_count = fw->tile_count;
+    size_t size = fw->size;
+    size_t row_begin = (size * thread_id) / thread_count;
+    size_t row_end = (size * (thread_id + 1)) / thread_count;
+    size_t k_begin = 0;
+    size_t k_end = 0;
+    size_t tile = 0;
+    size_t other = 0;
+    size_t other_begin = 0;
+    size_t other_end = 0;
+    size_t kb = 0;
+    size_t ib = 0;
+    size_t jb = 0;
+
+    if (0 == thread_id) {
+        graph_barrier_resize(&fw->barrier, thread_count);
+    }
+
+    /* Infinite sums stay infinite, where GRAPH_DISTANCE_INFINITY plus a negative weight wouldn't. */
+    graph_fw_replace(fw->matrix, size, row_begin, row_end, GRAPH_DISTANCE_INFINITY, __builtin_inf());
+    graph_barrier_wait(&fw->barrier);
+
+    for (kb = 0; kb < tile_count; ++kb) {
+        k_begin = kb * GRAPH_FW_TILE;
+        k_end = ((size - k_begin) > GRAPH_FW_TILE) ? (k_begin + GRAPH_FW_TILE) : size;
+
+        /* The diagonal tile only depends on itself. */
+        if (0 == thread_id) {
+            graph_fw_tile(fw->matrix, k_begin, k_end, k_begin, k_end, k_begin, k_end);
+        }
+        graph_barrier_wait(&fw->barrier);
+
+        /* The tiles of its row and column depend on it and on themselves. */
+        for (tile = thread_id; tile < (2 * tile_count); tile += thread_count) {
+            other = tile / 2;
+            if (other == kb) {
+                continue;
+            }
+            other_begin = other * GRAPH_FW_TILE;
+            other_end = ((size - other_begin) > GRAPH_FW_TILE) ? (other_begin + GRAPH_FW_TILE) : size;
+            if (0 == (tile % 2)) {
+                graph_fw_tile(fw->matrix, k_begin, k_end, other_begin, other_end, k_begin, k_end);
+            } else {
+                graph_fw_tile(fw->matrix, other_begin, other_end, k_begin, k_end, k_begin, k_end);
+            }
+        }
+        graph_barrier_wait(&fw->barrier);
+
+        /* The rest only depend on those, so they are independent of each other. */
+        for (tile = thread_id; tile < (tile_count * tile_count); tile += thread_count) {
+            ib = tile / tile_count;
+            jb = tile % tile_count;
+            if ((ib == kb) || (jb == kb)) {
+                continue;
+            }
+            graph_fw_tile(fw->matrix, ib * GRAPH_FW_TILE,
+                          ((size - (ib * GRAPH_FW_TILE)) > GRAPH_FW_TILE) ? ((ib + 1) * GRAPH_FW_TILE) : size,
+                          jb * GRAPH_FW_TILE,
+                          ((size - (jb * GRAPH_FW_TILE)) > GRAPH_FW_TILE) ? ((jb + 1) * GRAPH_FW_TILE) : size,
+                          k_begin, k_end);
+        }
+        graph_barrier_wait(&fw->barrier);
+    }
+
+    graph_fw_replace(fw->matrix, size, row_begin, row_end, __builtin_inf(), GRAPH_DISTANCE_INFINITY);
+}
+
+/** @see graph_utils.h */
+graph_res_t GRAPH_floyd_warshall(double **matrix, size_t size, size_t thread_count) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_fw_ctx fw;
+    size_t tile_count = 0;
+
+    /* Parameter check. */
+    if ((NULL == matrix) && (0 != size)) {
+        return GRAPH_ERR_PARAMS;
+    }
+    if (0 == size) {
+        return GRAPH_ERR_SUCCESS;
+    }
+
+    /* More threads than the tiles of a row and column would mostly wait. */
+    tile_count = (size + GRAPH_FW_TILE - 1) / GRAPH_FW_TILE;
+    thread_count = graph_parallel_thread_count(thread_count);
+    if (thread_count > (tile_count * tile_count)) {
+        thread_count = tile_count * tile_count;
+    }
+
+    fw.matrix = matrix;
+    fw.size = size;
+    fw.tile_count = tile_count;
+    res = graph_barrier_init(&fw.barrier, thread_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        return res;
+    }
+    res = graph_parallel_run(thread_count, graph_fw_task, &fw);
+    graph_barrier_destroy(&fw.barrier);
+
+    return res;
+}
+
+/** @see graph_utils.h */
+graph_res_t GRAPH_all_pairs_shortest_paths(struct graph *g, size_t thread_count, double ***distances, size_t *size,
+                                           uint64_t **ids) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    double **matrix = NULL;
+    uint64_t *local_ids = NULL;
+    size_t local_size = 0;
+    size_t i = 0;
+
+    /* Parameter check. */
+    if ((NULL == g) || (NULL == distances) || (NULL == size)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    res = GRAPH_get_weight_matrix(g, thread_count, GRAPH_DISTANCE_INFINITY, &matrix, &local_size, &local_ids);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* A vertex is at distance 0 from itself, unless it has a negative self loop. */
+    for (i = 0; i < local_size; ++i) {
+        if (matrix[i][i] > 0) {
+            matrix[i][i] = 0;
+        }
+    }
+
+    res = GRAPH_floyd_warshall(matrix, local_size, thread_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Transfer ownership. */
+    *distances = matrix;
+    *size = local_size;
+    matrix = NULL;
+    if (NULL != ids) {
+        *ids = local_ids;
+        local_ids = NULL;
+    }
+
+    cleanup:
+    if (NULL != matrix) {
+        (void)GRAPH_free_adjecency_matrix(g, matrix);
+    }
+    if (NULL != local_ids) {
+        free(local_ids);
+    }
+    return res;
+}
+
+/** @see graph_utils.h */
+void GRAPH_spanning_forest_init(struct graph_spanning_forest *forest) {
+    (void)memset(forest, 0, sizeof(*forest));
+}
+
+/** @see graph_utils.h */
+void GRAPH_spanning_forest_destroy(struct graph_spanning_forest *forest) {
+    if (NULL != forest->sources) {
+        free(forest->sources);
+    }
+    if (NULL != forest->targets) {
+        free(forest->targets);
+    }
+    if (NULL != forest->weights) {
+        free(forest->weights);
+    }
+    GRAPH_spanning_forest_init(forest);
+}
+
+/**
+ * @brief   Is an edge lighter than another, ties broken by the (lower, higher) indexes of their vertices.
+ */
+static inline bool graph_msf_is_lighter(const struct graph_msf_ctx *msf, uint64_t edge, uint64_t other) {
+    graph_index_t low = 0;
+    graph_index_t high = 0;
+    graph_index_t other_low = 0;
+    graph_index_t other_high = 0;
+
+    if (GRAPH_MSF_NO_EDGE == other) {
+        return true;
+    }
+    if (msf->csr->weights[edge] != msf->csr->weights[other]) {
+        return msf->csr->weights[edge] < msf->csr->weights[other];
+    }
+
+    low = msf->sources[edge];
+    high = msf->csr->targets[edge];
+    if (low > high) {
+        low = msf->csr->targets[edge];
+        high = msf->sources[edge];
+    }
+    other_low = msf->sources[other];
+    other_high = msf->csr->targets[other];
+    if (other_low > other_high) {
+        other_low = msf->csr->targets[other];
+        other_high = msf->sources[other];
+    }
+
+    return (low < other_low) || ((low == other_low) && (high < other_high));
+}
+
+/**
+ * @brief   Offer an edge as the lightest out of a component.
+ */
+static inline void graph_msf_offer(const struct graph_msf_ctx *msf, graph_index_t component, uint64_t edge) {
+    double weight = msf->csr->weights[edge];
+    double bound = 0;
+    uint64_t current = 0;
+
+    /* The bound is the weight of some earlier lightest edge, so never below the current one. */
+    __atomic_load(&msf->bounds[component], &bound, __ATOMIC_RELAXED);
+    if (weight > bound) {
+        return;
+    }
+
+    current = __atomic_load_n(&msf->lightest[component], __ATOMIC_RELAXED);
+    while (graph_msf_is_lighter(msf, edge, current)) {
+        if (__atomic_compare_exchange_n(&msf->lightest[component], &current, edge, true, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED)) {
+            __atomic_store(&msf->bounds[component], &weight, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief   The component at the other end of the lightest edge out of a component.
+ */
+static inline graph_index_t graph_msf_across(const struct graph_msf_ctx *msf, graph_index_t component) {
+    uint64_t edge = msf->lightest[component];
+    graph_index_t source_component = msf->labels[msf->sources[edge]];
+
+    return (source_component == component) ? msf->labels[msf->csr->targets[edge]] : source_component;
+}
+
+/**
+ * @brief   Did any thread vote for, all the threads must vote.
+ */
+static bool graph_msf_vote(struct graph_msf_ctx *msf, size_t *vote, bool value, size_t thread_id) {
+    size_t slot = *vote % 3;
+
+    if (value) {
+        __atomic_store_n(&msf->votes[slot], true, __ATOMIC_RELAXED);
+    }
+    graph_barrier_wait(&msf->barrier);
+    value = __atomic_load_n(&msf->votes[slot], __ATOMIC_RELAXED);
+
+    /* Every thread is done reading that slot, and won't write it before the next barrier. */
+    if (0 == thread_id) {
+        __atomic_store_n(&msf->votes[(*vote + 2) % 3], false, __ATOMIC_RELAXED);
+    }
+    ++*vote;
+
+    return value;
+}
+
+/**
+ * @brief   A thread of Boruvka, it owns a block of vertices balanced by edges.
+ */
+static void graph_msf_task(void *ctx, size_t thread_id, size_t thread_count) {
+    struct graph_msf_ctx *msf = ctx;
+    const struct graph_csr *csr = msf->csr;
+    struct graph_spanning_forest *forest = msf->forest;
+    graph_index_t *parents = msf->parents[0];
+    graph_index_t *jumps = msf->parents[1];
+    graph_index_t *swap = NULL;
+    size_t begin = graph_csr_block_start(csr, thread_id, thread_count);
+    size_t end = graph_csr_block_start(csr, thread_id + 1, thread_count);
+    graph_index_t component = 0;
+    graph_index_t other = 0;
+    graph_index_t parent = 0;
+    uint64_t edge = 0;
+    size_t slot = 0;
+    size_t vote = 0;
+    bool has_hooked = false;
+    bool has_jumped = false;
+    uint64_t i = 0;
+    size_t v = 0;
+
+    if (0 == thread_id) {
+        graph_barrier_resize(&msf->barrier, thread_count);
+    }
+
+    for (v = begin; v < end; ++v) {
+        msf->labels[v] = (graph_index_t)v;
+        for (i = csr->offsets[v]; i < csr->offsets[v + 1]; ++i) {
+            msf->sources[i] = (graph_index_t)v;
+        }
+    }
+
+    for (;;) {
+        for (v = begin; v < end; ++v) {
+            if (msf->labels[v] == v) {
+                msf->lightest[v] = GRAPH_MSF_NO_EDGE;
+                msf->bounds[v] = __builtin_inf();
+            }
+        }
+        graph_barrier_wait(&msf->barrier);
+
+        /* Offer every edge between components to its component, an undirectional edge is also in the row of the
+         * other one, a directional one is offered to both. */
+        for (v = begin; v < end; ++v) {
+            component = msf->labels[v];
+            for (i = csr->offsets[v]; i < csr->offsets[v + 1]; ++i) {
+                other = msf->labels[csr->targets[i]];
+                if (other != component) {
+                    graph_msf_offer(msf, component, i);
+                    if (csr->is_directional) {
+                        graph_msf_offer(msf, other, i);
+                    }
+                }
+            }
+        }
+        graph_barrier_wait(&msf->barrier);
+
+        /* Hook each component along its edge, when two pick the same edge the lower one stays a root. */
+        has_hooked = false;
+        for (v = begin; v < end; ++v) {
+            if (msf->labels[v] != v) {
+                continue;
+            }
+            parents[v] = (graph_index_t)v;
+            edge = msf->lightest[v];
+            if (GRAPH_MSF_NO_EDGE == edge) {
+                continue;
+            }
+            other = graph_msf_across(msf, (graph_index_t)v);
+            if ((graph_msf_across(msf, other) == v) && (v < other)) {
+                continue;
+            }
+            parents[v] = other;
+            slot = __atomic_fetch_add(&forest->edge_count, 1, __ATOMIC_RELAXED);
+            forest->sources[slot] = msf->sources[edge];
+            forest->targets[slot] = csr->targets[edge];
+            forest->weights[slot] = csr->weights[edge];
+            has_hooked = true;
+        }
+        if (!graph_msf_vote(msf, &vote, has_hooked, thread_id)) {
+            break;
+        }
+
+        /* Point every root to the root of its tree of hooks. */
+        do {
+            has_jumped = false;
+            for (v = begin; v < end; ++v) {
+                if (msf->labels[v] != v) {
+                    continue;
+                }
+                parent = parents[v];
+                jumps[v] = parents[parent];
+                has_jumped |= (jumps[v] != parent);
+            }
+            swap = parents;
+            parents = jumps;
+            jumps = swap;
+        } while (graph_msf_vote(msf, &vote, has_jumped, thread_id));
+
+        for (v = begin; v < end; ++v) {
+            msf->labels[v] = parents[msf->labels[v]];
+        }
+        graph_barrier_wait(&msf->barrier);
+    }
+}
+
+/** @see graph_utils.h */
+graph_res_t GRAPH_minimum_spanning_forest(const struct graph_csr *csr, size_t thread_count,
+                                          struct graph_spanning_forest *forest) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_msf_ctx msf;
+    bool is_barrier_initialized = false;
+    graph_index_t *indexes = NULL;
+    double *weights = NULL;
+    size_t i = 0;
+
+    (void)memset(&msf, 0, sizeof(msf));
+
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == forest)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    /* A forest has less edges than vertices. */
+    if (csr->vertex_count > forest->capacity) {
+        indexes = realloc(forest->sources, sizeof(*indexes) * csr->vertex_count);
+        if (NULL == indexes) {
+            res = GRAPH_ERR_MEM;
+            goto cleanup;
+        }
+        forest->sources = indexes;
+        indexes = realloc(forest->targets, sizeof(*indexes) * csr->vertex_count);
+        if (NULL == indexes) {
+            res = GRAPH_ERR_MEM;
+            goto cleanup;
+        }
+        forest->targets = indexes;
+        weights = realloc(forest->weights, sizeof(*weights) * csr->vertex_count);
+        if (NULL == weights) {
+            res = GRAPH_ERR_MEM;
+            goto cleanup;
+        }
+        forest->weights = weights;
+        forest->capacity = csr->vertex_count;
+    }
+    forest->edge_count = 0;
+    forest->total_weight = 0;
+    forest->tree_count = csr->vertex_count;
+    if (0 == csr->vertex_count) {
+        res = GRAPH_ERR_SUCCESS;
+        goto cleanup;
+    }
+
+    msf.csr = csr;
+    msf.forest = forest;
+    msf.sources = malloc(sizeof(*msf.sources) * (csr->edge_count + 1));
+    msf.labels = malloc(sizeof(*msf.labels) * csr->vertex_count);
+    msf.lightest = malloc(sizeof(*msf.lightest) * csr->vertex_count);
+    msf.bounds = malloc(sizeof(*msf.bounds) * csr->vertex_count);
+    msf.parents[0] = malloc(sizeof(*msf.parents[0]) * csr->vertex_count);
+    msf.parents[1] = malloc(sizeof(*msf.parents[1]) * csr->vertex_count);
+    if ((NULL == msf.sources) || (NULL == msf.labels) || (NULL == msf.lightest) || (NULL == msf.bounds) ||
+        (NULL == msf.parents[0]) || (NULL == msf.parents[1])) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+
+    thread_count = graph_parallel_thread_count(thread_count);
+    res = graph_barrier_init(&msf.barrier, thread_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    is_barrier_initialized = true;
+
+    res = graph_parallel_run(thread_count, graph_msf_task, &msf);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    for (i = 0; i < forest->edge_count; ++i) {
+        forest->total_weight += forest->weights[i];
+    }
+    forest->tree_count = csr->vertex_count - forest->edge_count;
+
+    cleanup:
+    if (is_barrier_initialized) {
+        graph_barrier_destroy(&msf.barrier);
+    }
+    if (NULL != msf.sources) {
+        free(msf.sources);
+    }
+    if (NULL != msf.labels) {
+        free(msf.labels);
+    }
+    if (NULL != msf.lightest) {
+        free(msf.lightest);
+    }
+    if (NULL != msf.bounds) {
+        free(msf.bounds);
+    }
+    if (NULL != msf.parents[0]) {
+        free(msf.parents[0]);
+    }
+    if (NULL != msf.parents[1]) {
+        free(msf.parents[1]);
+    }
+    return res;
+}
+
+/** @see graph_utils.h */
+void GRAPH_scc_init(struct graph_scc *scc) {
+    (void)memset(scc, 0, sizeof(*scc));
+}
+
+/** @see graph_utils.h */
+void GRAPH_scc_destroy(struct graph_scc *scc) {
+    if (NULL != scc->labels) {
+        free(scc->labels);
+    }
+    if (NULL != scc->sizes) {
+        free(scc->sizes);
+    }
+    GRAPH_scc_init(scc);
+}
+
+/**
+ * @brief   Number the components by their lowest vertex index and count their sizes.
+ * @param   scc         The context, its labels hold any distinct value in [0, vertex_count) per component.
+ * @param   count       The amount of vertices.
+ * @param   numbers     Scratch space for count entries.
+ */
+static void graph_scc_number(struct graph_scc *scc, size_t count, graph_index_t *numbers) {
+    size_t v = 0;
+
+    for (v = 0; v < count; ++v) {
+        numbers[v] = GRAPH_INDEX_NONE;
+    }
+    scc->component_count = 0;
+    for (v = 0; v < count; ++v) {
+        if (GRAPH_INDEX_NONE == numbers[scc->labels[v]]) {
+            scc->sizes[scc->component_count] = 0;
+            numbers[scc->labels[v]] = (graph_index_t)scc->component_count++;
+        }
+        scc->labels[v] = numbers[scc->labels[v]];
+        scc->sizes[scc->labels[v]]++;
+    }
+}
+
+/**
+ * @brief   Tarjan's algorithm, the recursion unrolled on explicit stacks.
+ *          A vertex that was visited and has no component yet is on the component stack.
+ */
+static graph_res_t graph_scc_tarjan(const struct graph_csr *csr, struct graph_scc *scc) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    graph_index_t *indexes = NULL;
+    graph_index_t *lows = NULL;
+    graph_index_t *calls = NULL;
+    uint64_t *cursors = NULL;
+    graph_index_t *stack = NULL;
+    graph_index_t next_index = 0;
+    graph_index_t component = 0;
+    size_t call_count = 0;
+    size_t stack_count = 0;
+    graph_index_t u = 0;
+    graph_index_t v = 0;
+    graph_index_t w = 0;
+    size_t s = 0;
+
+    indexes = malloc(sizeof(*indexes) * csr->vertex_count);
+    lows = malloc(sizeof(*lows) * csr->vertex_count);
+    calls = malloc(sizeof(*calls) * csr->vertex_count);
+    cursors = malloc(sizeof(*cursors) * csr->vertex_count);
+    stack = malloc(sizeof(*stack) * csr->vertex_count);
+    if ((NULL == indexes) || (NULL == lows) || (NULL == calls) || (NULL == cursors) || (NULL == stack)) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    for (s = 0; s < csr->vertex_count; ++s) {
+        indexes[s] = GRAPH_INDEX_NONE;
+        scc->labels[s] = GRAPH_INDEX_NONE;
+    }
+
+    for (s = 0; s < csr->vertex_count; ++s) {
+        if (GRAPH_INDEX_NONE != indexes[s]) {
+            continue;
+        }
+
+        /* Visit the root. */
+        indexes[s] = next_index;
+        lows[s] = next_index++;
+        stack[stack_count++] = (graph_index_t)s;
+        calls[0] = (graph_index_t)s;
+        cursors[0] = csr->offsets[s];
+        call_count = 1;
+
+        while (0 != call_count) {
+            v = calls[call_count - 1];
+            if (cursors[call_count - 1] < csr->offsets[v + 1]) {
+                w = csr->targets[cursors[call_count - 1]++];
+                if (GRAPH_INDEX_NONE == indexes[w]) {
+                    /* Descend into the neighbor. */
+                    indexes[w] = next_index;
+                    lows[w] = next_index++;
+                    stack[stack_count++] = w;
+                    calls[call_count] = w;
+                    cursors[call_count++] = csr->offsets[w];
+                } else if ((GRAPH_INDEX_NONE == scc->labels[w]) && (indexes[w] < lows[v])) {
+                    lows[v] = indexes[w];
+                }
+                continue;
+            }
+
+            /* Return from the vertex, it closes a component if nothing below it reached higher. */
+            --call_count;
+            if (lows[v] == indexes[v]) {
+                do {
+                    u = stack[--stack_count];
+                    scc->labels[u] = component;
+                } while (u != v);
+                ++component;
+            }
+            if ((0 != call_count) && (lows[v] < lows[calls[call_count - 1]])) {
+                lows[calls[call_count - 1]] = lows[v];
+            }
+        }
+    }
+
+    graph_scc_number(scc, csr->vertex_count, indexes);
+    res = GRAPH_ERR_SUCCESS;
+
+    cleanup:
+    if (NULL != indexes) {
+        free(indexes);
+    }
+    if (NULL != lows) {
+        free(lows);
+    }
+    if (NULL != calls) {
+        free(calls);
+    }
+    if (NULL != cursors) {
+        free(cursors);
+    }
+    if (NULL != stack) {
+        free(stack);
+    }
+    return res;
+}
+
+/**
+ * @brief   Give a vertex a component of its own, and queue it to trim its neighbors.
+ */
+static void graph_scc_trim_claim(struct graph_scc_ctx *ctx, struct graph_index_list *stack, graph_index_t v) {
+    graph_index_t expected = GRAPH_INDEX_NONE;
+
+    if (__atomic_compare_exchange_n(&ctx->labels[v], &expected, v, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        (void)__atomic_fetch_add(&ctx->assigned, 1, __ATOMIC_RELAXED);
+        if (GRAPH_ERR_SUCCESS != graph_index_list_push(stack, v)) {
+            __atomic_store_n(&ctx->is_failed, true, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * @brief   Trim the vertices without in or out neighbors, a vertex left without any is trimmed by the thread
+ *          that removed its last neighbor, so chains are followed without synchronizing.
+ */
+static void graph_scc_trim_task(void *ctx, size_t thread_id, size_t thread_count) {
+    struct graph_scc_ctx *run = ctx;
+    struct graph_index_list *stack = &run->stacks[thread_id];
+    size_t begin = graph_csr_block_start(run->csr, thread_id, thread_count);
+    size_t end = graph_csr_block_start(run->csr, thread_id + 1, thread_count);
+    graph_index_t u = 0;
+    graph_index_t v = 0;
+    uint64_t i = 0;
+
+    stack->count = 0;
+    for (v = (graph_index_t)begin; v < end; ++v) {
+        if ((0 == __atomic_load_n(&run->in_degrees[v], __ATOMIC_RELAXED)) ||
+            (0 == __atomic_load_n(&run->out_degrees[v], __ATOMIC_RELAXED))) {
+            graph_scc_trim_claim(run, stack, v);
+        }
+    }
+
+    while (0 != stack->count) {
+        v = stack->items[--stack->count];
+        for (i = run->csr->offsets[v]; i < run->csr->offsets[v + 1]; ++i) {
+            u = run->csr->targets[i];
+            if ((u != v) && (1 == __atomic_fetch_sub(&run->in_degrees[u], 1, __ATOMIC_RELAXED))) {
+                graph_scc_trim_claim(run, stack, u);
+            }
+        }
+        for (i = run->transpose->offsets[v]; i < run->transpose->offsets[v + 1]; ++i) {
+            u = run->transpose->targets[i];
+            if ((u != v) && (1 == __atomic_fetch_sub(&run->out_degrees[u], 1, __ATOMIC_RELAXED))) {
+                graph_scc_trim_claim(run, stack, u);
+            }
+        }
+    }
+}
+
+/**
+ * @brief   Spread the highest index reaching each vertex without a component, each thread works off its own
+ *          stack of vertices whose color rose.
+ */
+static void graph_scc_color_task(void *ctx, size_t thread_id, size_t thread_count) {
+    struct graph_scc_ctx *run = ctx;
+    struct graph_index_list *stack = &run->stacks[thread_id];
+    size_t begin = graph_csr_block_start(run->csr, thread_id, thread_count);
+    size_t end = graph_csr_block_start(run->csr, thread_id + 1, thread_count);
+    graph_index_t current = 0;
+    graph_index_t color = 0;
+    graph_index_t u = 0;
+    graph_index_t v = 0;
+    uint64_t i = 0;
+
+    if (0 == thread_id) {
+        graph_barrier_resize(&run->barrier, thread_count);
+    }
+
+    stack->count = 0;
+    for (v = (graph_index_t)begin; v < end; ++v) {
+        if (GRAPH_INDEX_NONE == run->labels[v]) {
+            run->colors[v] = v;
+            if (GRAPH_ERR_SUCCESS != graph_index_list_push(stack, v)) {
+                __atomic_store_n(&run->is_failed, true, __ATOMIC_RELAXED);
+            }
+        }
+    }
+    graph_barrier_wait(&run->barrier);
+
+    while (0 != stack->count) {
+        v = stack->items[--stack->count];
+        color = __atomic_load_n(&run->colors[v], __ATOMIC_RELAXED);
+        for (i = run->csr->offsets[v]; i < run->csr->offsets[v + 1]; ++i) {
+            u = run->csr->targets[i];
+            if (GRAPH_INDEX_NONE != run->labels[u]) {
+                continue;
+            }
+            current = __atomic_load_n(&run->colors[u], __ATOMIC_RELAXED);
+            while (current < color) {
+                if (__atomic_compare_exchange_n(&run->colors[u], &current, color, true, __ATOMIC_RELAXED,
+                                                __ATOMIC_RELAXED)) {
+                    if (GRAPH_ERR_SUCCESS != graph_index_list_push(stack, u)) {
+                        __atomic_store_n(&run->is_failed, true, __ATOMIC_RELAXED);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief   Collect the component of each vertex that kept its own color, backwards among the vertices of its
+ *          color. The colors are settled, and only the search of a color touches the labels of its vertices.
+ */
+static void graph_scc_collect_range(void *ctx, size_t begin, size_t end, size_t thread_id) {
+    struct graph_scc_ctx *run = ctx;
+    struct graph_index_list *stack = &run->stacks[thread_id];
+    size_t collected = 0;
+    graph_index_t root = 0;
+    graph_index_t u = 0;
+    graph_index_t v = 0;
+    uint64_t i = 0;
+
+    for (root = (graph_index_t)begin; root < end; ++root) {
+        if ((root != run->colors[root]) || (GRAPH_INDEX_NONE != run->labels[root])) {
+            continue;
+        }
+        run->labels[root] = root;
+        ++collected;
+        stack->count = 0;
+        v = root;
+        for (;;) {
+            for (i = run->transpose->offsets[v]; i < run->transpose->offsets[v + 1]; ++i) {
+                u = run->transpose->targets[i];
+                if ((root == run->colors[u]) && (GRAPH_INDEX_NONE == run->labels[u])) {
+                    run->labels[u] = root;
+                    ++collected;
+                    if (GRAPH_ERR_SUCCESS != graph_index_list_push(stack, u)) {
+                        __atomic_store_n(&run->is_failed, true, __ATOMIC_RELAXED);
+                    }
+                }
+            }
+            if (0 == stack->count) {
+                break;
+            }
+            v = stack->items[--stack->count];
+        }
+    }
+    (void)__atomic_fetch_add(&run->assigned, collected, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief   The component of the pivot, the vertices both reached from it and reaching it.
+ */
+static graph_res_t graph_scc_pivot(struct graph_scc_ctx *ctx, size_t thread_count) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_bfs forward;
+    struct graph_bfs backward;
+    graph_index_t pivot = GRAPH_INDEX_NONE;
+    uint64_t best = 0;
+    uint64_t score = 0;
+    size_t v = 0;
+
+    GRAPH_bfs_init(&forward);
+    GRAPH_bfs_init(&backward);
+
+    /* The pivot most likely in the largest component. */
+    for (v = 0; v < ctx->csr->vertex_count; ++v) {
+        score = (uint64_t)ctx->in_degrees[v] * ctx->out_degrees[v];
+        if ((GRAPH_INDEX_NONE == ctx->labels[v]) && ((GRAPH_INDEX_NONE == pivot) || (score > best))) {
+            pivot = (graph_index_t)v;
+            best = score;
+        }
+    }
+    if (GRAPH_INDEX_NONE == pivot) {
+        res = GRAPH_ERR_SUCCESS;
+        goto cleanup;
+    }
+
+    res = GRAPH_bfs(ctx->csr, ctx->transpose, pivot, thread_count, &forward);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    res = GRAPH_bfs(ctx->transpose, ctx->csr, pivot, thread_count, &backward);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    for (v = 0; v < ctx->csr->vertex_count; ++v) {
+        if ((GRAPH_INDEX_NONE == ctx->labels[v]) && (GRAPH_BFS_UNREACHED != forward.levels[v]) &&
+            (GRAPH_BFS_UNREACHED != backward.levels[v])) {
+            ctx->labels[v] = pivot;
+            ctx->assigned++;
+        }
+    }
+
+    cleanup:
+    GRAPH_bfs_destroy(&backward);
+    GRAPH_bfs_destroy(&forward);
+    return res;
+}
+
+/**
+ * @brief   The coloring search, see GRAPH_strongly_connected_components.
+ */
+static graph_res_t graph_scc_coloring(const struct graph_csr *csr, const struct graph_csr *transpose,
+                                      size_t thread_count, struct graph_scc *scc) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_scc_ctx ctx;
+    struct graph_csr *local_transpose = NULL;
+    bool is_barrier_initialized = false;
+    size_t i = 0;
+    size_t v = 0;
+
+    (void)memset(&ctx, 0, sizeof(ctx));
+
+    if (NULL == transpose) {
+        if (csr->is_directional) {
+            res = GRAPH_csr_transpose(csr, &local_transpose);
+            if (GRAPH_ERR_SUCCESS != res) {
+                goto cleanup;
+            }
+            transpose = local_transpose;
+        } else {
+            transpose = csr;
+        }
+    }
+
+    thread_count = graph_parallel_thread_count(thread_count);
+    ctx.csr = csr;
+    ctx.transpose = transpose;
+    ctx.labels = scc->labels;
+    ctx.in_degrees = malloc(sizeof(*ctx.in_degrees) * csr->vertex_count);
+    ctx.out_degrees = malloc(sizeof(*ctx.out_degrees) * csr->vertex_count);
+    ctx.colors = malloc(sizeof(*ctx.colors) * csr->vertex_count);
+    ctx.stacks = calloc(thread_count, sizeof(*ctx.stacks));
+    if ((NULL == ctx.in_degrees) || (NULL == ctx.out_degrees) || (NULL == ctx.colors) || (NULL == ctx.stacks)) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    res = graph_barrier_init(&ctx.barrier, thread_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    is_barrier_initialized = true;
+
+    for (v = 0; v < csr->vertex_count; ++v) {
+        ctx.labels[v] = GRAPH_INDEX_NONE;
+        ctx.colors[v] = GRAPH_INDEX_NONE;
+        ctx.in_degrees[v] = (graph_index_t)(transpose->offsets[v + 1] - transpose->offsets[v]);
+        ctx.out_degrees[v] = (graph_index_t)(csr->offsets[v + 1] - csr->offsets[v]);
+    }
+
+    res = graph_parallel_run(thread_count, graph_scc_trim_task, &ctx);
+    if ((GRAPH_ERR_SUCCESS != res) || ctx.is_failed) {
+        goto cleanup;
+    }
+    res = graph_scc_pivot(&ctx, thread_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Every round settles at least the component of the highest vertex left. */
+    while (ctx.assigned < csr->vertex_count) {
+        res = graph_parallel_run(thread_count, graph_scc_color_task, &ctx);
+        if ((GRAPH_ERR_SUCCESS != res) || ctx.is_failed) {
+            goto cleanup;
+        }
+        res = graph_parallel_for_dynamic(csr->vertex_count, thread_count, GRAPH_SCC_CHUNK, graph_scc_collect_range,
+                                         &ctx);
+        if ((GRAPH_ERR_SUCCESS != res) || ctx.is_failed) {
+            goto cleanup;
+        }
+    }
+
+    graph_scc_number(scc, csr->vertex_count, ctx.colors);
+
+    cleanup:
+    if ((GRAPH_ERR_SUCCESS == res) && ctx.is_failed) {
+        res = GRAPH_ERR_MEM;
+    }
+    if (is_barrier_initialized) {
+        graph_barrier_destroy(&ctx.barrier);
+    }
+    if (NULL != ctx.stacks) {
+        for (i = 0; i < thread_count; ++i) {
+            if (NULL != ctx.stacks[i].items) {
+                free(ctx.stacks[i].items);
+            }
+        }
+        free(ctx.stacks);
+    }
+    if (NULL != ctx.colors) {
+        free(ctx.colors);
+    }
+    if (NULL != ctx.out_degrees) {
+        free(ctx.out_degrees);
+    }
+    if (NULL != ctx.in_degrees) {
+        free(ctx.in_degrees);
+    }
+    if (NULL != local_transpose) {
+        (void)GRAPH_csr_destroy(local_transpose);
+    }
+    return res;
+}
+
+/** @see graph_utils.h */
+graph_res_t GRAPH_strongly_connected_components(const struct graph_csr *csr, const struct graph_csr *transpose,
+                                                graph_scc_method_t method, size_t thread_count,
+                                                struct graph_scc *scc) {
+    graph_index_t *labels = NULL;
+    size_t *sizes = NULL;
+
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == scc) || ((GRAPH_SCC_TARJAN != method) && (GRAPH_SCC_COLORING != method)) ||
+        ((NULL != transpose) && (transpose->vertex_count != csr->vertex_count))) {
+        return GRAPH_ERR_PARAMS;
+    }
+
+    if (csr->vertex_count > scc->capacity) {
+        labels = realloc(scc->labels, sizeof(*labels) * csr->vertex_count);
+        if (NULL == labels) {
+            return GRAPH_ERR_MEM;
+        }
+        scc->labels = labels;
+        sizes = realloc(scc->sizes, sizeof(*sizes) * csr->vertex_count);
+        if (NULL == sizes) {
+            return GRAPH_ERR_MEM;
+        }
+        scc->sizes = sizes;
+        scc->capacity = csr->vertex_count;
+    }
+    scc->component_count = 0;
+    if (0 == csr->vertex_count) {
+        return GRAPH_ERR_SUCCESS;
+    }
+
+    if (GRAPH_SCC_TARJAN == method) {
+        return graph_scc_tarjan(csr, scc);
+    }
+    return graph_scc_coloring(csr, transpose, thread_count, scc);
+}
+
+/** @see graph_utils.h */
+graph_res_t GRAPH_condensation(const struct graph_csr *csr, const struct graph_scc *scc,
+                               struct graph **condensation) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph *local_graph = NULL;
+    uint64_t *keys = NULL;
+    uint64_t *edges = NULL;
+    uint64_t *s_ids = NULL;
+    uint64_t *d_ids = NULL;
+    double *weights = NULL;
+    size_t key_count = 0;
+    size_t edge_count = 0;
+    uint64_t i = 0;
+    size_t v = 0;
+
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == scc) || (NULL == condensation) || (scc->capacity < csr->vertex_count) ||
+        ((0 != csr->vertex_count) && (0 == scc->component_count))) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    res = GRAPH_init(true, &local_graph);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    s_ids = malloc(sizeof(*s_ids) * (scc->component_count + 1));
+    if (NULL == s_ids) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    for (v = 0; v < scc->component_count; ++v) {
+        s_ids[v] = v;
+    }
+    res = GRAPH_add_vertices(local_graph, s_ids, scc->component_count, NULL);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+    free(s_ids);
+    s_ids = NULL;
+
+    /* The edges between components, sorted by (source, destination) with the edge as payload. */
+    keys = malloc(sizeof(*keys) * (csr->edge_count + 1));
+    edges = malloc(sizeof(*edges) * (csr->edge_count + 1));
+    if ((NULL == keys) || (NULL == edges)) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    for (v = 0; v < csr->vertex_count; ++v) {
+        for (i = csr->offsets[v]; i < csr->offsets[v + 1]; ++i) {
+            if (scc->labels[v] != scc->labels[csr->targets[i]]) {
+                keys[key_count] = ((uint64_t)scc->labels[v] << 32) | scc->labels[csr->targets[i]];
+                edges[key_count++] = i;
+            }
+        }
+    }
+    res = graph_sort_u64(keys, edges, key_count, &graph_allocator_default);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* One edge per pair of components, the lightest. */
+    s_ids = malloc(sizeof(*s_ids) * (key_count + 1));
+    d_ids = malloc(sizeof(*d_ids) * (key_count + 1));
+    weights = malloc(sizeof(*weights) * (key_count + 1));
+    if ((NULL == s_ids) || (NULL == d_ids) || (NULL == weights)) {
+        res = GRAPH_ERR_MEM;
+        goto cleanup;
+    }
+    for (i = 0; i < key_count; ++i) {
+        if ((0 == i) || (keys[i] != keys[i - 1])) {
+            s_ids[edge_count] = keys[i] >> 32;
+            d_ids[edge_count] = keys[i] & UINT32_MAX;
+            weights[edge_count++] = csr->weights[edges[i]];
+        } else if (csr->weights[edges[i]] < weights[edge_count - 1]) {
+            weights[edge_count - 1] = csr->weights[edges[i]];
+        }
+    }
+    res = GRAPH_add_edges(local_graph, s_ids, d_ids, weights, edge_count, GRAPH_ADD_EDGES_SKIP_DUPLICATE_CHECK,
+                          NULL);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    /* Transfer ownership. */
+    *condensation = local_graph;
+    local_graph = NULL;
+
+    cleanup:
+    if (NULL != local_graph) {
+        (void)GRAPH_destroy(local_graph);
+    }
+    if (NULL != keys) {
+        free(keys);
+    }
+    if (NULL != edges) {
+        free(edges);
+    }
+    if (NULL != s_ids) {
+        free(s_ids);
+    }
+    if (NULL != d_ids) {
+        free(d_ids);
+    }
+    if (NULL != weights) {
+        free(weights);
+    }
+    return res;
+}
+
+/** @see graph_utils.h */
+void GRAPH_path_query_init(struct graph_path_query *query) {
+    (void)memset(query, 0, sizeof(*query));
+    query->distance = GRAPH_DISTANCE_INFINITY;
+    graph_dary_heap_init(&query->heaps[0]);
+    graph_dary_heap_init(&query->heaps[1]);
+}
+
+/** @see graph_utils.h */
+void GRAPH_path_query_destroy(struct graph_path_query *query) {
+    size_t side = 0;
+
+    if (NULL != query->path) {
+        free(query->path);
+    }
+    if (NULL != query->stamps) {
+        free(query->stamps);
+    }
+    if (NULL != query->stack) {
+        free(query->stack);
+    }
+    for (side = 0; side < 2; ++side) {
+        if (NULL != query->distances[side]) {
+            free(query->distances[side]);
+        }
+        if (NULL != query->predecessors[side]) {
+            free(query->predecessors[side]);
+        }
+        graph_dary_heap_destroy(&query->heaps[side]);
+    }
+    GRAPH_path_query_init(query);
+}
+
+/**
+ * @see     graph_utils.h
+ * @note    Forgetting the previous query only bumps the stamp, growing the context or the stamp wrapping around
+ *          are the only times all the vertices are touched.
+ */
+graph_res_t graph_path_prepare(struct graph_path_query *query, size_t vertex_count) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    uint32_t *stamps = NULL;
+    double *distances = NULL;
+    graph_index_t *predecessors = NULL;
+    size_t side = 0;
+
+    query->distance = GRAPH_DISTANCE_INFINITY;
+    query->path_length = 0;
+    query->settled_count = 0;
+    graph_dary_heap_clear(&query->heaps[0]);
+    graph_dary_heap_clear(&query->heaps[1]);
+
+    if (vertex_count > query->capacity) {
+        stamps = realloc(query->stamps, sizeof(*stamps) * vertex_count);
+        if (NULL == stamps) {
+            return GRAPH_ERR_MEM;
+        }
+        query->stamps = stamps;
+        (void)memset(query->stamps + query->capacity, 0, sizeof(*stamps) * (vertex_count - query->capacity));
+        for (side = 0; side < 2; ++side) {
+            distances = realloc(query->distances[side], sizeof(*distances) * vertex_count);
+            if (NULL == distances) {
+                return GRAPH_ERR_MEM;
+            }
+            query->distances[side] = distances;
+            predecessors = realloc(query->predecessors[side], sizeof(*predecessors) * vertex_count);
+            if (NULL == predecessors) {
+                return GRAPH_ERR_MEM;
+            }
+            query->predecessors[side] = predecessors;
+        }
+        query->capacity = vertex_count;
+    }
+
+    ++query->stamp;
+    if (0 == query->stamp) {
+        /* Wrapped around, a stale stamp could be mistaken for the new one. */
+        (void)memset(query->stamps, 0, sizeof(*query->stamps) * query->capacity);
+        query->stamp = 1;
+    }
+
+    res = graph_dary_heap_reserve(&query->heaps[0], vertex_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        return res;
+    }
+    res = graph_dary_heap_reserve(&query->heaps[1], vertex_count);
+
+    return res;
+}
+
+/**
+ * @brief   Bidirectional Dijkstra, the forward search over the snapshot and the backward one over its transpose.
+ * @param   meeting     The vertex on the shortest path where the searches met (out parameter).
+ */
+static graph_res_t graph_path_bidirectional(const struct graph_csr *csr, const struct graph_csr *transpose,
+                                            graph_index_t source, graph_index_t target,
+                                            struct graph_path_query *query, graph_index_t *meeting) {
+    const struct graph_csr *graphs[2] = {csr, transpose};
+    const struct graph_csr *graph = NULL;
+    struct graph_dary_heap *heaps = query->heaps;
+    double *distances = NULL;
+    double *other = NULL;
+    double best = GRAPH_DISTANCE_INFINITY;
+    double distance = 0;
+    double candidate = 0;
+    graph_index_t u = 0;
+    graph_index_t v = 0;
+    size_t side = 0;
+    uint64_t k = 0;
+
+    graph_path_touch(query, source);
+    graph_path_touch(query, target);
+    query->distances[0][source] = 0;
+    query->distances[1][target] = 0;
+    graph_dary_heap_push(&heaps[0], source, 0);
+    graph_dary_heap_push(&heaps[1], target, 0);
+    *meeting = GRAPH_INDEX_NONE;
+    if (source == target) {
+        best = 0;
+        *meeting = source;
+    }
+
+    while ((0 != heaps[0].count) && (0 != heaps[1].count)) {
+        /* No path through an unsettled vertex can be shorter than the two closest of them combined. */
+        if (heaps[0].keys[0] + heaps[1].keys[0] >= best) {
+            break;
+        }
+        side = (heaps[0].keys[0] <= heaps[1].keys[0]) ? 0 : 1;
+        graph = graphs[side];
+        distances = query->distances[side];
+        other = query->distances[1 - side];
+
+        u = graph_dary_heap_pop(&heaps[side], &distance);
+        ++query->settled_count;
+        for (k = graph->offsets[u]; k < graph->offsets[u + 1]; ++k) {
+            if (graph->weights[k] < 0) {
+                return GRAPH_ERR_PARAMS;
+            }
+            v = graph->targets[k];
+            graph_path_touch(query, v);
+            candidate = distance + graph->weights[k];
+            if (candidate < distances[v]) {
+                distances[v] = candidate;
+                query->predecessors[side][v] = u;
+                graph_dary_heap_push(&heaps[side], v, candidate);
+            }
+            if ((GRAPH_DISTANCE_INFINITY != other[v]) && (distances[v] + other[v] < best)) {
+                best = distances[v] + other[v];
+                *meeting = v;
+            }
+        }
+    }
+
+    query->distance = best;
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/**
+ * @brief   A* from the source, a vertex is pushed again whenever its distance improves, even after it was settled.
+ */
+static graph_res_t graph_path_astar(const struct graph_csr *csr, graph_index_t source, graph_index_t target,
+                                    graph_heuristic_t heuristic, void *heuristic_ctx,
+                                    struct graph_path_query *query) {
+    struct graph_dary_heap *heap = &query->heaps[0];
+    double *distances = query->distances[0];
+    double estimate = 0;
+    double candidate = 0;
+    graph_index_t u = 0;
+    graph_index_t v = 0;
+    uint64_t k = 0;
+
+    graph_path_touch(query, source);
+    graph_path_touch(query, target);
+    distances[source] = 0;
+    graph_dary_heap_push(heap, source, (NULL == heuristic) ? 0 : heuristic(source, target, heuristic_ctx));
+
+    while (0 != heap->count) {
+        u = graph_dary_heap_pop(heap, &estimate);
+        ++query->settled_count;
+        if (u == target) {
+            break;
+        }
+
+        for (k = csr->offsets[u]; k < csr->offsets[u + 1]; ++k) {
+            if (csr->weights[k] < 0) {
+                return GRAPH_ERR_PARAMS;
+            }
+            v = csr->targets[k];
+            graph_path_touch(query, v);
+            candidate = distances[u] + csr->weights[k];
+            if (candidate < distances[v]) {
+                distances[v] = candidate;
+                query->predecessors[0][v] = u;
+                estimate = (NULL == heuristic) ? 0 : heuristic(v, target, heuristic_ctx);
+                graph_dary_heap_push(heap, v, candidate + estimate);
+            }
+        }
+    }
+
+    query->distance = distances[target];
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph_utils.h */
+graph_res_t graph_path_build(struct graph_path_query *query, graph_index_t meeting) {
+    graph_index_t *path = NULL;
+    size_t forward_length = 0;
+    size_t length = 0;
+    size_t i = 0;
+    graph_index_t v = 0;
+
+    for (v = meeting; GRAPH_INDEX_NONE != v; v = query->predecessors[0][v]) {
+        ++forward_length;
+    }
+    length = forward_length;
+    for (v = query->predecessors[1][meeting]; GRAPH_INDEX_NONE != v; v = query->predecessors[1][v]) {
+        ++length;
+    }
+
+    if (length > query->path_capacity) {
+        path = realloc(query->path, sizeof(*path) * length);
+        if (NULL == path) {
+            return GRAPH_ERR_MEM;
+        }
+        query->path = path;
+        query->path_capacity = length;
+    }
+
+    i = forward_length;
+    for (v = meeting; GRAPH_INDEX_NONE != v; v = query->predecessors[0][v]) {
+        query->path[--i] = v;
+    }
+    i = forward_length;
+    for (v = query->predecessors[1][meeting]; GRAPH_INDEX_NONE != v; v = query->predecessors[1][v]) {
+        query->path[i++] = v;
+    }
+    query->path_length = length;
+
+    return GRAPH_ERR_SUCCESS;
+}
+
+/** @see graph_utils.h */
+graph_res_t GRAPH_shortest_path(const struct graph_csr *csr, const struct graph_csr *transpose, graph_index_t source,
+                                graph_index_t target, graph_path_method_t method, graph_heuristic_t heuristic,
+                                void *heuristic_ctx, struct graph_path_query *query) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    graph_index_t meeting = GRAPH_INDEX_NONE;
+
+    /* Parameter check. */
+    if ((NULL == csr) || (NULL == query) || (source >= csr->vertex_count) || (target >= csr->vertex_count)) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+    if (GRAPH_PATH_BIDIRECTIONAL == method) {
+        if (NULL == transpose) {
+            if (csr->is_directional) {
+                res = GRAPH_ERR_PARAMS;
+                goto cleanup;
+            }
+            transpose = csr;
+        } else if (transpose->vertex_count != csr->vertex_count) {
+            res = GRAPH_ERR_PARAMS;
+            goto cleanup;
+        }
+    } else if (GRAPH_PATH_ASTAR != method) {
+        res = GRAPH_ERR_PARAMS;
+        goto cleanup;
+    }
+
+    res = graph_path_prepare(query, csr->vertex_count);
+    if (GRAPH_ERR_SUCCESS != res) {
+        goto cleanup;
+    }
+
+    if (GRAPH_PATH_BIDIRECTIONAL == method) {
+        res = graph_path_bidirectional(csr, transpose, source, target, query, &meeting);
+    } else {
+        res = graph_path_astar(csr, source, target, heuristic, heuristic_ctx, query);
+        meeting = target;
+    }
+    if (GRAPH_ERR_SUCCESS != res) {
+        query->distance = GRAPH_DISTANCE_INFINITY;
+        goto cleanup;
+    }
+
+    if (GRAPH_DISTANCE_INFINITY != query->distance) {
+        res = graph_path_build(query, meeting);
+    }
+
+    cleanup:
+    return res;
+}
@@ -5,9 +5,632 @@
 #ifndef LIBGRAPH_GRAPH_UTILS_H
 #define LIBGRAPH_GRAPH_UTILS_H
 
+/******************************
+ * Includes
+ ******************************/
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <float.h>
+
+#include "errors.h"
+#include "graph_csr.h"
+#include "graph_heap.h"
+
 /* Infinity, used for algorithms requiring some maximum initial value. */
 #define INFINITY    ((uint64_t)-1)
 
+/* The distance of a vertex that wasn't reached. */
+#define GRAPH_DISTANCE_INFINITY     (DBL_MAX)
+
+/**
+ * @brief   The priority queue of a shortest paths search.
+ */
+typedef enum graph_sssp_queue_e {
+    /* An indexed 4-ary heap with decrease-key, for any non negative weights. */
+    GRAPH_SSSP_QUEUE_DARY_HEAP = 0,
+
+    /*
+     * A monotone radix heap, for non negative integral weights. Weights and distances must stay below 2^53 so they
+     * are exact, a search reaching a longer distance fails with GRAPH_ERR_OVERFLOW.
+     */
+    GRAPH_SSSP_QUEUE_RADIX_HEAP,
+} graph_sssp_queue_t;
+
+/**
+ * @brief   The results and scratch buffers of single-source shortest paths searches.
+ *          A context is reused across searches (of snapshots of any size), only the vertices the previous
+ *          search reached are reset, so a search that exits early costs what it touched and not O(V).
+ */
+struct graph_sssp {
+    /* The distance of each vertex from the source, GRAPH_DISTANCE_INFINITY if it wasn't reached. */
+    double *distances;
+
+    /* The previous vertex on the shortest path to each vertex, GRAPH_INDEX_NONE for the source and unreached. */
+    graph_index_t *predecessors;
+
+    /* The amount of vertices the arrays hold. */
+    size_t capacity;
+
+    /* The vertices the last search reached, in the order they were reached. */
+    graph_index_t *reached;
+    size_t reached_count;
+
+    /* Which of the reached vertices were settled (their distance is final). */
+    uint8_t *settled;
+
+    /* The queues. */
+    struct graph_dary_heap dary_heap;
+    struct graph_radix_heap radix_heap;
+};
+
+/* The level of a vertex a BFS didn't reach. */
+#define GRAPH_BFS_UNREACHED         (UINT32_MAX)
+
+/**
+ * @brief   The results and scratch buffers of breadth-first searches, reusable across searches.
+ */
+struct graph_bfs {
+    /* The hop distance of each vertex from the source, GRAPH_BFS_UNREACHED if it wasn't reached. */
+    uint32_t *levels;
+
+    /* The parent of each vertex in the BFS tree, GRAPH_INDEX_NONE for the source and unreached. */
+    graph_index_t *parents;
+
+    /* The amount of vertices the arrays hold. */
+    size_t capacity;
+
+    /* The frontier, as a queue and as a bitmap. */
+    graph_index_t *queue;
+    uint64_t *bitmap;
+
+    /* The amount of top-down and bottom-up steps the last search took. */
+    size_t top_down_steps;
+    size_t bottom_up_steps;
+};
+
+/**
+ * @brief   The connected components of a snapshot, reusable across runs.
+ */
+struct graph_components {
+    /* The component of each vertex, in [0, component_count), numbered by their lowest vertex index. */
+    graph_index_t *labels;
+
+    /* The amount of vertices in each component. */
+    size_t *sizes;
+
+    size_t component_count;
+
+    /* The amount of vertices the arrays hold. */
+    size_t capacity;
+};
+
+/* The usual PageRank parameters. */
+#define GRAPH_PAGERANK_DEFAULT_DAMPING          (0.85)
+#define GRAPH_PAGERANK_DEFAULT_TOLERANCE        (1e-6)
+#define GRAPH_PAGERANK_DEFAULT_MAX_ITERATIONS   (100)
+
+/**
+ * @brief   The parameters of a PageRank run.
+ */
+struct graph_pagerank_params {
+    /* The probability to follow an edge rather than teleport. */
+    double damping;
+
+    /* The run stops once the L1 change of the ranks in an iteration drops below it. */
+    double tolerance;
+
+    size_t max_iterations;
+
+    /* The teleport weight of each vertex (normalized to sum to 1), NULL for uniform teleports. */
+    const double *personalization;
+
+    /* The amount of threads to run with (0 for one per online CPU). */
+    size_t thread_count;
+};
+
+/**
+ * @brief   The results and scratch buffers of PageRank runs, reusable across runs.
+ */
+struct graph_pagerank {
+    /* The rank of each vertex, they sum to 1. */
+    double *ranks;
+
+    /* The L1 change of the ranks in each iteration (max_iterations entries). */
+    double *residuals;
+    size_t iteration_count;
+    bool is_converged;
+
+    /* The amount of vertices and iterations the arrays hold. */
+    size_t capacity;
+    size_t residuals_capacity;
+
+    /* Scratch: the next ranks, the contribution of each vertex to its out-neighbors and the teleport vector. */
+    double *next_ranks;
+    double *contributions;
+    double *inverse_degrees;
+    double *teleports;
+};
+
+/**
+ * @brief   The triangles and local clustering coefficients of the vertices of a snapshot, reusable across runs.
+ */
+struct graph_clustering {
+    /* The amount of triangles each vertex is part of. */
+    uint64_t *triangles;
+
+    /* The local clustering coefficient of each vertex, 0 for vertices with less than 2 neighbors. */
+    double *coefficients;
+
+    /* The amount of triangles in the snapshot, and the mean of the coefficients. */
+    uint64_t triangle_count;
+    double average_coefficient;
+
+    /* The amount of vertices the arrays hold. */
+    size_t capacity;
+};
+
+/**
+ * @brief   A minimum spanning forest of a snapshot, reusable across runs.
+ */
+struct graph_spanning_forest {
+    /* The edges of the forest (vertex indexes and weight), in no particular order. */
+    graph_index_t *sources;
+    graph_index_t *targets;
+    double *weights;
+    size_t edge_count;
+
+    double total_weight;
+
+    /* The amount of trees, one per connected component. */
+    size_t tree_count;
+
+    /* The amount of edges the arrays hold. */
+    size_t capacity;
+};
+
+/**
+ * @brief   The algorithm finding strongly connected components.
+ */
+typedef enum graph_scc_method_e {
+    /* Tarjan with explicit stacks, a single thread, linear time at any depth. */
+    GRAPH_SCC_TARJAN,
+
+    /* Parallel: trimming, a forward-backward search for the largest component, then coloring for the rest.
+     * Best on large graphs of low diameter. */
+    GRAPH_SCC_COLORING,
+} graph_scc_method_t;
+
+/**
+ * @brief   The strongly connected components of a snapshot, reusable across runs.
+ */
+struct graph_scc {
+    /* The component of each vertex, in [0, component_count), numbered by their lowest vertex index. */
+    graph_index_t *labels;
+
+    /* The amount of vertices in each component. */
+    size_t *sizes;
+
+    size_t component_count;
+
+    /* The amount of vertices the arrays hold. */
+    size_t capacity;
+};
+
+/**
+ * @brief   An estimate of the distance between two vertices of a snapshot, for A*.
+ *          It should never exceed the real distance (admissible), or the path found might not be the shortest.
+ * @param   vertex  The index of the vertex.
+ * @param   target  The index of the target.
+ * @param   ctx     The context given with the heuristic.
+ * @return  The estimate, non negative.
+ */
+typedef double (*graph_heuristic_t)(graph_index_t vertex, graph_index_t target, void *ctx);
+
+/**
+ * @brief   The algorithm of a point-to-point shortest path query.
+ */
+typedef enum graph_path_method_e {
+    /* Dijkstra from both ends at once, meeting in the middle. Directional snapshots need their transpose. */
+    GRAPH_PATH_BIDIRECTIONAL = 0,
+
+    /* Dijkstra from the source ordered by distance plus the estimate of a heuristic to the target. */
+    GRAPH_PATH_ASTAR,
+} graph_path_method_t;
+
+/**
+ * @brief   The result and scratch buffers of point-to-point shortest path queries.
+ *          The state of a vertex is only valid while its stamp is the query's, so starting a query just bumps the
+ *          stamp and a query costs the vertices it touches, not O(V). A context serves a single query at a time,
+ *          each thread querying a shared snapshot should have its own.
+ */
+struct graph_path_query {
+    /* The length of the shortest path, GRAPH_DISTANCE_INFINITY if the target can't be reached. */
+    double distance;
+
+    /* The vertices of the path, from the source to the target (empty if the target can't be reached). */
+    graph_index_t *path;
+    size_t path_length;
+    size_t path_capacity;
+
+    /* The amount of vertices the last query settled, in both directions. */
+    size_t settled_count;
+
+    /* The stamp of the current query, and of the last query that touched each vertex. */
+    uint32_t stamp;
+    uint32_t *stamps;
+
+    /* The distances and predecessors of both directions (forward from the source, backward from the target). */
+    double *distances[2];
+    graph_index_t *predecessors[2];
+
+    /* The queues of both directions. */
+    struct graph_dary_heap heaps[2];
+
+    /* The amount of vertices the arrays hold. */
+    size_t capacity;
+
+    /* The vertices left to unpack into the path, for queries of a contraction hierarchy. */
+    graph_index_t *stack;
+    size_t stack_capacity;
+};
+
+/**
+ * @brief   Initialize an empty shortest paths context, no memory is allocated until the first search.
+ * @param   sssp    The context.
+ */
+void GRAPH_sssp_init(struct graph_sssp *sssp);
+
+/**
+ * @brief   Release the memory of a shortest paths context.
+ * @param   sssp    The context.
+ */
+void GRAPH_sssp_destroy(struct graph_sssp *sssp);
+
+/**
+ * @brief   Dijkstra's single-source shortest paths over a snapshot.
+ * @param   csr     The snapshot.
+ * @param   source  The index of the source vertex (see GRAPH_csr_find_index).
+ * @param   target  The index of a vertex to stop at once its distance is final, GRAPH_INDEX_NONE to search all.
+ * @param   queue   The priority queue to search with.
+ * @param   sssp    The context, its distances and predecessors hold the result (indexed by vertex index).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_PARAMS if a reached edge has a negative weight (or a
+ *          non integral one with GRAPH_SSSP_QUEUE_RADIX_HEAP), GRAPH_ERR_OVERFLOW if a distance reaches 2^53 with
+ *          GRAPH_SSSP_QUEUE_RADIX_HEAP.
+ *
+ * @note    With a target, only the distance of the target and of the vertices settled before it are final.
+ * @note    The result is valid until the next search with the context, on failure the contents of the context are
+ *          undefined.
+ */
+graph_res_t GRAPH_sssp_dijkstra(const struct graph_csr *csr, graph_index_t source, graph_index_t target,
+                                graph_sssp_queue_t queue, struct graph_sssp *sssp);
+
+/**
+ * @brief   Parallel delta-stepping single-source shortest paths over a snapshot.
+ *          Vertices are kept in buckets of width delta; each bucket is emptied by parallel rounds relaxing the
+ *          light edges (weight <= delta) of its vertices, then the heavy edges of the vertices it settled are
+ *          relaxed once. Distances are lowered with atomic min updates, buckets are thread-local.
+ * @param   csr             The snapshot.
+ * @param   source          The index of the source vertex (see GRAPH_csr_find_index).
+ * @param   delta           The width of a bucket, 0 to pick it from the weights (max weight / average degree,
+ *                          at least the mean weight).
+ * @param   thread_count    The amount of threads to search with (0 for one per online CPU).
+ * @param   sssp            The context, its distances and predecessors hold the result (as GRAPH_sssp_dijkstra).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_PARAMS if an edge has a negative weight.
+ *
+ * @note    delta is raised if the weights would need more than 64K buckets ahead of the current one.
+ * @note    The predecessors are found in a serial O(V+E) pass once the distances are settled.
+ */
+graph_res_t GRAPH_sssp_delta_stepping(const struct graph_csr *csr, graph_index_t source, double delta,
+                                      size_t thread_count, struct graph_sssp *sssp);
+
+/**
+ * @brief   Initialize an empty BFS context, no memory is allocated until the first search.
+ * @param   bfs The context.
+ */
+void GRAPH_bfs_init(struct graph_bfs *bfs);
+
+/**
+ * @brief   Release the memory of a BFS context.
+ * @param   bfs The context.
+ */
+void GRAPH_bfs_destroy(struct graph_bfs *bfs);
+
+/**
+ * @brief   Parallel direction-optimizing breadth-first search over a snapshot.
+ *          Each level is expanded either top-down (the frontier queue claims its unvisited neighbors) or
+ *          bottom-up (every unvisited vertex looks for a parent among its in-edges in a frontier bitmap),
+ *          switching by Beamer's heuristic on the edges of the frontier against the edges left unexplored.
+ * @param   csr             The snapshot.
+ * @param   transpose       The transpose of the snapshot (see GRAPH_csr_transpose), NULL to use the snapshot itself
+ *                          if it is undirectional, or to build one for the search if it isn't.
+ * @param   source          The index of the source vertex (see GRAPH_csr_find_index).
+ * @param   thread_count    The amount of threads to search with (0 for one per online CPU).
+ * @param   bfs             The context, its levels and parents hold the result (indexed by vertex index).
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    The tree found depends on the scheduling of the threads, the levels don't.
+ */
+graph_res_t GRAPH_bfs(const struct graph_csr *csr, const struct graph_csr *transpose, graph_index_t source,
+                      size_t thread_count, struct graph_bfs *bfs);
+
+/**
+ * @brief   Initialize an empty components context, no memory is allocated until the first run.
+ * @param   components  The context.
+ */
+void GRAPH_components_init(struct graph_components *components);
+
+/**
+ * @brief   Release the memory of a components context.
+ * @param   components  The context.
+ */
+void GRAPH_components_destroy(struct graph_components *components);
+
+/**
+ * @brief   Parallel connected components of a snapshot (Afforest).
+ *          A concurrent union-find links every vertex to its first neighbors with CAS, compresses the trees,
+ *          samples the largest component and then links the remaining edges of the vertices outside of it only.
+ * @param   csr             The snapshot.
+ * @param   thread_count    The amount of threads to run with (0 for one per online CPU).
+ * @param   components      The context, it holds the result.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    The components of a directional snapshot are its weakly connected components, found without
+ *          skipping the largest component (its edges aren't symmetric).
+ */
+graph_res_t GRAPH_connected_components(const struct graph_csr *csr, size_t thread_count,
+                                       struct graph_components *components);
+
+/**
+ * @brief   Fill PageRank parameters with the defaults (uniform teleports, every online CPU).
+ * @param   params  The parameters.
+ */
+void GRAPH_pagerank_params_init(struct graph_pagerank_params *params);
+
+/**
+ * @brief   Initialize an empty PageRank context, no memory is allocated until the first run.
+ * @param   pagerank    The context.
+ */
+void GRAPH_pagerank_init(struct graph_pagerank *pagerank);
+
+/**
+ * @brief   Release the memory of a PageRank context.
+ * @param   pagerank    The context.
+ */
+void GRAPH_pagerank_destroy(struct graph_pagerank *pagerank);
+
+/**
+ * @brief   Parallel pull-based PageRank over a snapshot.
+ *          Every iteration computes the contribution (rank / out-degree) of each vertex, then each vertex sums the
+ *          contributions of its in-neighbors; the threads own blocks of rows balanced by edges. The rank of the
+ *          dangling vertices (no out-edges) is spread by the teleport vector.
+ * @param   csr         The snapshot (edge weights are ignored).
+ * @param   transpose   The transpose of the snapshot (see GRAPH_csr_transpose), NULL to use the snapshot itself
+ *                      if it is undirectional, or to build one for the run if it isn't.
+ * @param   params      The parameters.
+ * @param   pagerank    The context, it holds the ranks and the residual of every iteration.
+ * @return  GRAPH_ERR_SUCCESS on success (converged or not, see is_converged), GRAPH_ERR_PARAMS if the damping
+ *          isn't in [0, 1) or the personalization has a negative entry or sums to 0.
+ *
+ * @note    Contributions and the in-neighbor sums are vectorized with AVX/AVX2 (gathers) or SSE2 when available.
+ */
+graph_res_t GRAPH_pagerank(const struct graph_csr *csr, const struct graph_csr *transpose,
+                           const struct graph_pagerank_params *params, struct graph_pagerank *pagerank);
+
+/**
+ * @brief   Initialize an empty clustering context, no memory is allocated until the first run.
+ * @param   clustering  The context.
+ */
+void GRAPH_clustering_init(struct graph_clustering *clustering);
+
+/**
+ * @brief   Release the memory of a clustering context.
+ * @param   clustering  The context.
+ */
+void GRAPH_clustering_destroy(struct graph_clustering *clustering);
+
+/**
+ * @brief   Count the triangles of a snapshot, seen as a simple undirected graph (edge directions, self loops and
+ *          weights are ignored).
+ *          Every edge is oriented from its endpoint of lower degree to the other one, and each vertex intersects
+ *          its sorted oriented neighbors with those of its neighbors, so every triangle is found once.
+ * @param   csr             The snapshot.
+ * @param   thread_count    The amount of threads (0 for one per online CPU), vertices are handed out dynamically.
+ * @param   triangle_count  The amount of triangles.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    Intersections are SSE2 block merges, or gallop over the longer list when the lengths are far apart.
+ */
+graph_res_t GRAPH_count_triangles(const struct graph_csr *csr, size_t thread_count, uint64_t *triangle_count);
+
+/**
+ * @brief   Compute the triangles and the local clustering coefficient of every vertex of a snapshot, seen as a
+ *          simple undirected graph (see GRAPH_count_triangles).
+ * @param   csr             The snapshot.
+ * @param   thread_count    The amount of threads (0 for one per online CPU), vertices are handed out dynamically.
+ * @param   clustering      The context, it holds the results.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t GRAPH_clustering_coefficients(const struct graph_csr *csr, size_t thread_count,
+                                          struct graph_clustering *clustering);
+
+/**
+ * @brief   Blocked Floyd-Warshall over a dense distance matrix, in place.
+ *          Each round solves a diagonal tile, then the tiles of its row and column, then every other tile, the
+ *          threads split the tiles of a phase between them.
+ * @param   matrix          The rows of the matrix (such as from GRAPH_get_weight_matrix): the weight of each edge,
+ *                          GRAPH_DISTANCE_INFINITY where there's none and usually 0 on the diagonal. It ends up
+ *                          holding the distances, GRAPH_DISTANCE_INFINITY for unreachable pairs.
+ * @param   size            The amount of rows (and columns) of the matrix.
+ * @param   thread_count    The amount of threads (0 for one per online CPU).
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    A negative entry on the diagonal afterwards means the vertex is on a negative cycle, and the distances
+ *          through it are meaningless.
+ * @note    The min-plus kernels are vectorized with AVX or SSE2 when available.
+ */
+graph_res_t GRAPH_floyd_warshall(double **matrix, size_t size, size_t thread_count);
+
+/**
+ * @brief   The distances between all the pairs of vertices of a graph (see GRAPH_floyd_warshall).
+ * @param   g               The graph.
+ * @param   thread_count    The amount of threads (0 for one per online CPU).
+ * @param   distances       The distance matrix, rows and columns in the order of ids, GRAPH_DISTANCE_INFINITY for
+ *                          unreachable pairs (out parameter).
+ * @param   size            The size of the col/row of the matrix.
+ * @param   ids             The id of the vertex of each row/col (optional, out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_OVERFLOW if the matrix can't be addressed.
+ *
+ * @note    GRAPH_free_adjecency_matrix should be called on the matrix to free it, and free on ids.
+ */
+graph_res_t GRAPH_all_pairs_shortest_paths(struct graph *g, size_t thread_count, double ***distances, size_t *size,
+                                           uint64_t **ids);
+
+/**
+ * @brief   Initialize an empty spanning forest, no memory is allocated until the first run.
+ * @param   forest  The forest.
+ */
+void GRAPH_spanning_forest_init(struct graph_spanning_forest *forest);
+
+/**
+ * @brief   Release the memory of a spanning forest.
+ * @param   forest  The forest.
+ */
+void GRAPH_spanning_forest_destroy(struct graph_spanning_forest *forest);
+
+/**
+ * @brief   Parallel Boruvka minimum spanning forest of a snapshot, seen as undirected (an edge in either direction
+ *          links its vertices, self loops are ignored).
+ *          Every round, each component picks its lightest outgoing edge (with an atomic minimum), the components
+ *          are hooked along these edges and flattened by pointer jumping, until no edge leaves a component.
+ * @param   csr             The snapshot.
+ * @param   thread_count    The amount of threads (0 for one per online CPU).
+ * @param   forest          The forest.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    Ties are broken by the indexes of the vertices, so the forest is unique and the same for any amount of
+ *          threads (up to the order of its edges).
+ * @note    Each row of an undirectional snapshot only offers its copy of an edge, both copies should have the same
+ *          weight (as GRAPH_freeze makes them).
+ */
+graph_res_t GRAPH_minimum_spanning_forest(const struct graph_csr *csr, size_t thread_count,
+                                          struct graph_spanning_forest *forest);
+
+/**
+ * @brief   Initialize an empty strongly connected components context, no memory is allocated until the first run.
+ * @param   scc     The context.
+ */
+void GRAPH_scc_init(struct graph_scc *scc);
+
+/**
+ * @brief   Release the memory of a strongly connected components context.
+ * @param   scc     The context.
+ */
+void GRAPH_scc_destroy(struct graph_scc *scc);
+
+/**
+ * @brief   Find the strongly connected components of a snapshot.
+ *          Tarjan keeps its call stack and component stack in arrays sized once for all the vertices, so deep
+ *          graphs (long chains) don't grow the thread's stack.
+ *          Coloring first trims the vertices without in or out neighbors left (each thread follows the chains it
+ *          trims on its own), takes the component of the pivot of highest in * out degree as the intersection of a
+ *          forward and a backward BFS, then repeats: every vertex takes the highest index reaching it, and each
+ *          vertex keeping its own index collects its component backwards among the vertices of its color.
+ * @param   csr             The snapshot (in an undirectional one the components are the connected components).
+ * @param   transpose       The transpose of the snapshot, for coloring (see GRAPH_csr_transpose), NULL to use the
+ *                          snapshot itself if it is undirectional, or to build one for the run if it isn't.
+ * @param   method          The algorithm.
+ * @param   thread_count    The amount of threads for coloring (0 for one per online CPU).
+ * @param   scc             The context, it holds the components.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    Both algorithms number the components the same way, so their results are identical.
+ */
+graph_res_t GRAPH_strongly_connected_components(const struct graph_csr *csr, const struct graph_csr *transpose,
+                                                graph_scc_method_t method, size_t thread_count,
+                                                struct graph_scc *scc);
+
+/**
+ * @brief   Build the condensation of a snapshot: a directional graph with a vertex per strongly connected
+ *          component (its id is the component's number) and an edge between two components whenever an edge of
+ *          the snapshot joins them, weighted as the lightest of those edges. It has no cycles.
+ * @param   csr             The snapshot.
+ * @param   scc             Its strongly connected components.
+ * @param   condensation    The new graph (out parameter).
+ * @return  GRAPH_ERR_SUCCESS on success.
+ *
+ * @note    GRAPH_destroy should be called to release the graph.
+ */
+graph_res_t GRAPH_condensation(const struct graph_csr *csr, const struct graph_scc *scc,
+                               struct graph **condensation);
+
+/**
+ * @brief   Initialize an empty point-to-point query context, no memory is allocated until the first query.
+ * @param   query   The context.
+ */
+void GRAPH_path_query_init(struct graph_path_query *query);
+
+/**
+ * @brief   Release the memory of a point-to-point query context.
+ * @param   query   The context.
+ */
+void GRAPH_path_query_destroy(struct graph_path_query *query);
+
+/**
+ * @brief   Find the shortest path between two vertices of a snapshot, with non negative weights.
+ *          The bidirectional search alternates between the directions by their closest unsettled vertex, and
+ *          stops once the two closest sum up to the shortest path seen where the searches met.
+ * @param   csr             The snapshot.
+ * @param   transpose       The transpose of the snapshot, for the backward search (see GRAPH_csr_transpose), NULL
+ *                          to use the snapshot itself if it is undirectional. Ignored by A*.
+ * @param   source          The index of the source.
+ * @param   target          The index of the target.
+ * @param   method          The algorithm.
+ * @param   heuristic       The heuristic of A* (NULL for none, making it Dijkstra). Ignored by the bidirectional
+ *                          search.
+ * @param   heuristic_ctx   The context passed to the heuristic.
+ * @param   query           The context, it holds the distance and the path.
+ * @return  GRAPH_ERR_SUCCESS on success, GRAPH_ERR_PARAMS for a directional snapshot without its transpose for
+ *          the bidirectional search, or on a negative weight.
+ *
+ * @note    A* reopens vertices whose distance improves after they were settled, so an admissible heuristic that
+ *          isn't consistent still finds the shortest path.
+ */
+graph_res_t GRAPH_shortest_path(const struct graph_csr *csr, const struct graph_csr *transpose, graph_index_t source,
+                                graph_index_t target, graph_path_method_t method, graph_heuristic_t heuristic,
+                                void *heuristic_ctx, struct graph_path_query *query);
+
+/**
+ * @brief   Start a new point-to-point query: forget the previous one and make the context able to hold a
+ *          snapshot's vertices.
+ * @param   query           The context.
+ * @param   vertex_count    The amount of vertices of the snapshot.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t graph_path_prepare(struct graph_path_query *query, size_t vertex_count);
+
+/**
+ * @brief   Make the state of a vertex valid for the current query, resetting it if a previous query left it.
+ * @param   query   The context.
+ * @param   v       The index of the vertex.
+ */
+static inline void graph_path_touch(struct graph_path_query *query, graph_index_t v) {
+    if (query->stamps[v] != query->stamp) {
+        query->stamps[v] = query->stamp;
+        query->distances[0][v] = GRAPH_DISTANCE_INFINITY;
+        query->distances[1][v] = GRAPH_DISTANCE_INFINITY;
+        query->predecessors[0][v] = GRAPH_INDEX_NONE;
+        query->predecessors[1][v] = GRAPH_INDEX_NONE;
+    }
+}
 
+/**
+ * @brief   Write the path of a query through the vertex where its searches met: the forward predecessors back to
+ *          the source, then the backward ones on to the target.
+ * @param   query   The context.
+ * @param   meeting The vertex.
+ * @return  GRAPH_ERR_SUCCESS on success.
+ */
+graph_res_t graph_path_build(struct graph_path_query *query, graph_index_t meeting);
 
 #endif //LIBGRAPH_GRAPH_UTILS_H
@@ -1,8 +1,45 @@
 //
 // Created by User on 25/06/2019.
 //
+#include <malloc.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
 #include "tests.h"
 #include "graph.h"
+#include "graph_ch.h"
+#include "graph_csr.h"
+#include "graph_export.h"
+#include "graph_file.h"
+#include "graph_parse.h"
+#include "graph_utils.h"
+
+/**
+ * @brief   Allocator statistics of a counting allocator.
+ */
+struct counting_allocator_stats {
+    size_t allocations;
+    size_t live_blocks;
+    size_t live_bytes;
+};
+
+static void *counting_alloc(void *ctx, size_t size) {
+    struct counting_allocator_stats *stats = ctx;
+
+    stats->allocations++;
+    stats->live_blocks++;
+    stats->live_bytes += size;
+    return malloc(size);
+}
+
+static void counting_free(void *ctx, void *ptr, size_t size) {
+    struct counting_allocator_stats *stats = ctx;
+
+    stats->live_blocks--;
+    stats->live_bytes -= size;
+    free(ptr);
+}
 
 bool test_graph_init_happy_flow() {
     struct graph *g = NULL;
@@ -146,6 +183,129 @@ bool test_graph_get_adj_matrix() {
     return true;
 }
 
+bool test_graph_get_adj_matrix_ids() {
+    struct graph *g = NULL;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    double **adj = NULL;
+    uint64_t *ids = NULL;
+    size_t size = 0;
+    size_t i = 0;
+    size_t j = 0;
+    size_t edges = 0;
+    bool has_edge = false;
+    double weight = 0;
+
+    res = GRAPH_init(true, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    for (i = 0; i < 1500; i++) {
+        res = GRAPH_add_vertex(g, i * 3);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    for (i = 0; i < 1500; i++) {
+        res = GRAPH_add_edge(g, i * 3, ((i * 31 + 7) % 1500) * 3, (double)i);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        res = GRAPH_add_edge(g, i * 3, ((i + 1) % 1500) * 3, 0.5);
+        ASSERT_TRUE((GRAPH_ERR_SUCCESS == res) || (GRAPH_ERR_FOUND == res));
+    }
+
+    res = GRAPH_get_adjecency_matrix_ex(g, 4, &adj, &size, &ids);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(size, 1500);
+
+    /* Every entry matches the edge between the vertices of its row and column. */
+    for (i = 0; i < size; i++) {
+        for (j = 0; j < size; j++) {
+            res = GRAPH_has_edge(g, ids[i], ids[j], &has_edge);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            if (has_edge) {
+                res = GRAPH_get_edge_weight(g, ids[i], ids[j], &weight);
+                ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+                ASSERT_EQUAL(adj[i][j], weight);
+                edges++;
+            } else {
+                ASSERT_EQUAL(adj[i][j], -1);
+            }
+        }
+    }
+    ASSERT_TRUE(edges > 1500);
+
+    free(ids);
+    res = GRAPH_free_adjecency_matrix(g, adj);
+    ASSERT_EQUAL(res , GRAPH_ERR_SUCCESS);
+
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    return true;
+}
+
+bool test_graph_get_adjacency_sparse() {
+    struct graph *g = NULL;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_adjacency_csr *csr = NULL;
+    struct graph_adjacency_coo *coo = NULL;
+    double **adj = NULL;
+    size_t size = 0;
+    size_t i = 0;
+    uint32_t k = 0;
+    uint64_t row = 0;
+    uint64_t column = 0;
+
+    res = GRAPH_init(false, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    for (i = 0; i < 50; i++) {
+        res = GRAPH_add_vertex(g, i + 100);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    for (i = 0; i < 50; i++) {
+        res = GRAPH_add_edge(g, i + 100, ((i * 7) % 50) + 100, (double)i + 0.5);
+        ASSERT_TRUE((GRAPH_ERR_SUCCESS == res) || (GRAPH_ERR_FOUND == res));
+    }
+    res = GRAPH_get_adjecency_matrix(g, &adj, &size);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    /* 32 bit indexes with float values. */
+    res = GRAPH_get_adjacency_csr(g, GRAPH_INDEX_WIDTH_32, GRAPH_WEIGHT_FLOAT, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(csr->size, size);
+    ASSERT_EQUAL(((uint32_t *)csr->row_offsets)[size], csr->entry_count);
+    for (row = 0; row < size; row++) {
+        for (k = ((uint32_t *)csr->row_offsets)[row]; k < ((uint32_t *)csr->row_offsets)[row + 1]; k++) {
+            column = ((uint32_t *)csr->columns)[k];
+            ASSERT_EQUAL(((float *)csr->values)[k], (float)adj[row][column]);
+        }
+    }
+
+    /* 64 bit indexes with double values. */
+    res = GRAPH_get_adjacency_coo(g, GRAPH_INDEX_WIDTH_64, GRAPH_WEIGHT_DOUBLE, &coo);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(coo->entry_count, csr->entry_count);
+    for (i = 0; i < coo->entry_count; i++) {
+        row = ((uint64_t *)coo->rows)[i];
+        column = ((uint64_t *)coo->columns)[i];
+        ASSERT_EQUAL(coo->ids[row], csr->ids[row]);
+        ASSERT_EQUAL(((double *)coo->values)[i], adj[row][column]);
+    }
+    res = GRAPH_free_adjacency_coo(coo);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    /* Structure only. */
+    res = GRAPH_get_adjacency_coo(g, GRAPH_INDEX_WIDTH_32, GRAPH_WEIGHT_NONE, &coo);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(coo->values, NULL);
+    res = GRAPH_free_adjacency_coo(coo);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    res = GRAPH_free_adjacency_csr(csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_free_adjecency_matrix(g, adj);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    return true;
+}
+
 bool test_graph_add_edge_multiple() {
     struct graph *g = NULL;
     graph_res_t res = GRAPH_ERR_UNDEFINED;
@@ -215,19 +375,2732 @@ bool test_graph_add_edge_happy_flow() {
     return true;
 }
 
-int main() {
-    SUITE_INIT(Sanity)
-        ASSERT_TEST(test_graph_init_happy_flow);
-        ASSERT_TEST(test_graph_init_bad_params);
+bool test_graph_vertex_index_many() {
+    struct graph *g = NULL;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    uint64_t i = 0;
 
-        ASSERT_TEST(test_graph_add_vertex_happy_flow);
-        ASSERT_TEST(test_graph_add_vertex_already_exists);
-        ASSERT_TEST(test_graph_add_vertex_multiple);
+    res = GRAPH_init(true, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
 
-        ASSERT_TEST(test_graph_add_edge_happy_flow);
-        ASSERT_TEST(test_graph_add_edge_multiple);
+    for (i = 0; i < 10000; i++) {
+        res = GRAPH_add_vertex(g, i * 7919);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    ASSERT_EQUAL(g->vertex_count, 10000);
+    ASSERT_EQUAL(g->vertex_index.count, 10000);
 
-        ASSERT_TEST(test_graph_get_adj_matrix);
+    /* Remove every odd vertex, the rest must still be found. */
+    for (i = 1; i < 10000; i += 2) {
+        res = GRAPH_remove_vertex(g, i * 7919);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    ASSERT_EQUAL(g->vertex_count, 5000);
+
+    for (i = 0; i < 10000; i++) {
+        res = GRAPH_add_vertex(g, i * 7919);
+        ASSERT_EQUAL(res, (0 == (i % 2)) ? GRAPH_ERR_FOUND : GRAPH_ERR_SUCCESS);
+    }
+    ASSERT_EQUAL(g->vertex_count, 10000);
+
+    res = GRAPH_add_edge(g, 0, 7919, 1);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_add_edge(g, 0, 1, 1);
+    ASSERT_EQUAL(res, GRAPH_ERR_NOT_FOUND);
+    res = GRAPH_remove_edge(g, 0, 7919);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    return true;
+}
+
+bool test_graph_add_batches() {
+    struct graph *g = NULL;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    uint64_t ids[1000];
+    uint64_t s_ids[3000];
+    uint64_t d_ids[3000];
+    double weights[3000];
+    graph_res_t results[3000];
+    uint64_t vertices[] = {5, 6, 5, 7};
+    graph_res_t vertex_results[4];
+    struct counting_allocator_stats stats = {0};
+    struct graph_allocator allocator = {counting_alloc, counting_free, &stats};
+    bool has_edge = false;
+    double weight = 0;
+    size_t i = 0;
+
+    res = GRAPH_init_ex(false, &allocator, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    /* Vertices, one repeated. */
+    res = GRAPH_add_vertices(g, vertices, 4, vertex_results);
+    ASSERT_EQUAL(res, GRAPH_ERR_FOUND);
+    ASSERT_EQUAL(vertex_results[0], GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(vertex_results[1], GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(vertex_results[2], GRAPH_ERR_FOUND);
+    ASSERT_EQUAL(vertex_results[3], GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(g->vertex_count, 3);
+
+    for (i = 0; i < 1000; i++) {
+        ids[i] = i + 10;
+    }
+    res = GRAPH_add_vertices(g, ids, 1000, NULL);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(g->vertex_count, 1003);
+
+    /* Edges: a hub, a chain, repeated and mirrored edges, and a missing vertex. */
+    for (i = 0; i < 1000; i++) {
+        s_ids[i] = 10;
+        d_ids[i] = i + 10;
+        weights[i] = (double)i;
+        s_ids[i + 1000] = i + 10;
+        d_ids[i + 1000] = ((i + 1) % 1000) + 10;
+        weights[i + 1000] = 0.25;
+        s_ids[i + 2000] = ((i + 1) % 1000) + 10;
+        d_ids[i + 2000] = i + 10;
+        weights[i + 2000] = 0.5;
+    }
+    s_ids[2999] = 1;
+    res = GRAPH_add_edges(g, s_ids, d_ids, weights, 3000, 0, results);
+    ASSERT_TRUE(GRAPH_ERR_SUCCESS != res);
+    for (i = 0; i < 1000; i++) {
+        ASSERT_EQUAL(results[i], GRAPH_ERR_SUCCESS);
+    }
+    /* The chain edges touching the hub already exist as hub edges. */
+    ASSERT_EQUAL(results[1000], GRAPH_ERR_FOUND);
+    ASSERT_EQUAL(results[1001], GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(results[1999], GRAPH_ERR_FOUND);
+    for (i = 2000; i < 2999; i++) {
+        ASSERT_EQUAL(results[i], GRAPH_ERR_FOUND);
+    }
+    ASSERT_EQUAL(results[2999], GRAPH_ERR_NOT_FOUND);
+
+    res = GRAPH_get_edge_weight(g, 10, 500, &weight);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(weight, 490);
+    res = GRAPH_get_edge_weight(g, 501, 500, &weight);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(weight, 0.25);
+
+    /* Trusted batches skip the duplicate check. */
+    s_ids[0] = 5;
+    d_ids[0] = 6;
+    s_ids[1] = 5;
+    d_ids[1] = 7;
+    res = GRAPH_add_edges(g, s_ids, d_ids, NULL, 2, GRAPH_ADD_EDGES_SKIP_DUPLICATE_CHECK, NULL);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_get_edge_weight(g, 7, 5, &weight);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(weight, 0);
+
+    /* An edge repeated in the other direction keeps the weight it was first given in the batch. */
+    s_ids[0] = 7;
+    d_ids[0] = 6;
+    weights[0] = 1;
+    s_ids[1] = 6;
+    d_ids[1] = 7;
+    weights[1] = 2;
+    res = GRAPH_add_edges(g, s_ids, d_ids, weights, 2, 0, results);
+    ASSERT_EQUAL(res, GRAPH_ERR_FOUND);
+    ASSERT_EQUAL(results[0], GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(results[1], GRAPH_ERR_FOUND);
+    res = GRAPH_get_edge_weight(g, 6, 7, &weight);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(weight, 1);
+
+    /* A repeated edge slipped into a trusted batch, caught by the hashed index of the hub, leaves no half behind. */
+    s_ids[0] = 12;
+    d_ids[0] = 10;
+    res = GRAPH_add_edges(g, s_ids, d_ids, NULL, 1, GRAPH_ADD_EDGES_SKIP_DUPLICATE_CHECK, NULL);
+    ASSERT_EQUAL(res, GRAPH_ERR_FOUND);
+    res = GRAPH_remove_edge(g, 12, 10);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_has_edge(g, 10, 12, &has_edge);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_TRUE(!has_edge);
+    res = GRAPH_has_edge(g, 12, 10, &has_edge);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_TRUE(!has_edge);
+
+    /* The scratch of the batches, sort buffers included, came from the allocator of the graph too. */
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(stats.live_blocks, 0);
+    ASSERT_EQUAL(stats.live_bytes, 0);
+
+    return true;
+}
+
+bool test_graph_has_edge_hub() {
+    struct graph *g = NULL;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    bool has_edge = false;
+    double weight = 0;
+    uint64_t i = 0;
+
+    res = GRAPH_init(false, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    for (i = 0; i <= 100; i++) {
+        res = GRAPH_add_vertex(g, i);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+
+    /* Vertex 0 is a hub, its index moves from the inline array to a hash table. */
+    for (i = 1; i <= 100; i++) {
+        res = GRAPH_add_edge(g, 0, i, (double)i);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    res = GRAPH_add_edge(g, 50, 0, 1);
+    ASSERT_EQUAL(res, GRAPH_ERR_FOUND);
+
+    for (i = 1; i <= 100; i++) {
+        res = GRAPH_has_edge(g, i, 0, &has_edge);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_TRUE(has_edge);
+
+        res = GRAPH_get_edge_weight(g, 0, i, &weight);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_EQUAL(weight, (double)i);
+    }
+    res = GRAPH_has_edge(g, 1, 2, &has_edge);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_TRUE(!has_edge);
+    res = GRAPH_has_edge(g, 1, 1000, &has_edge);
+    ASSERT_EQUAL(res, GRAPH_ERR_NOT_FOUND);
+    res = GRAPH_get_edge_weight(g, 1, 2, &weight);
+    ASSERT_EQUAL(res, GRAPH_ERR_NOT_FOUND);
+
+    /* Shrink the hub back below the threshold. */
+    for (i = 1; i <= 98; i++) {
+        res = GRAPH_remove_edge(g, i, 0);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    res = GRAPH_has_edge(g, 0, 99, &has_edge);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_TRUE(has_edge);
+    res = GRAPH_has_edge(g, 0, 98, &has_edge);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_TRUE(!has_edge);
+
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    return true;
+}
+
+bool test_graph_init_ex_allocator() {
+    struct graph *g = NULL;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct counting_allocator_stats stats = {0};
+    struct graph_allocator allocator = {counting_alloc, counting_free, &stats};
+    uint64_t i = 0;
+
+    res = GRAPH_init_ex(true, &allocator, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(stats.live_blocks, 1);
+
+    for (i = 0; i < 1000; i++) {
+        res = GRAPH_add_vertex(g, i);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    for (i = 1; i < 1000; i++) {
+        res = GRAPH_add_edge(g, i - 1, i, 1);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+
+    /* Vertices and edges come from slabs, not from an allocation each. */
+    ASSERT_TRUE(stats.allocations < 100);
+
+    /* Removed nodes are reused. */
+    for (i = 0; i < 500; i++) {
+        res = GRAPH_remove_vertex(g, i);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        res = GRAPH_add_vertex(g, i + 1000);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    ASSERT_TRUE(stats.allocations < 100);
+
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(stats.live_blocks, 0);
+    ASSERT_EQUAL(stats.live_bytes, 0);
+
+    res = GRAPH_init_ex(true, NULL, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    return true;
+}
+
+bool test_graph_clear() {
+    struct graph *g = NULL;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct counting_allocator_stats stats = {0};
+    struct graph_allocator allocator = {counting_alloc, counting_free, &stats};
+    size_t allocations = 0;
+    uint64_t round = 0;
+    uint64_t i = 0;
+    bool has_edge = false;
+
+    res = GRAPH_init_ex(false, &allocator, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    for (round = 0; round < 3; round++) {
+        for (i = 0; i < 2000; i++) {
+            res = GRAPH_add_vertex(g, i);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        }
+        for (i = 1; i < 2000; i++) {
+            res = GRAPH_add_edge(g, 0, i, 1);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        }
+
+        /* After the first round the graph is refilled without new allocations (but for the hub's index). */
+        if (0 == round) {
+            allocations = stats.allocations;
+        } else {
+            ASSERT_TRUE(stats.allocations - allocations <= 10);
+            allocations = stats.allocations;
+        }
+
+        res = GRAPH_clear(g);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_EQUAL(g->vertex_count, 0);
+        ASSERT_TRUE(LIST_EMPTY(&g->vertices));
+        res = GRAPH_has_edge(g, 0, 1, &has_edge);
+        ASSERT_EQUAL(res, GRAPH_ERR_NOT_FOUND);
+    }
+
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(stats.live_blocks, 0);
+
+    return true;
+}
+
+bool test_graph_remove_vertex_edges() {
+    struct graph *g = NULL;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph_vertex *v = NULL;
+    bool has_edge = false;
+    uint64_t i = 0;
+
+    /* Undirectional: removing the hub removes the mirror edges from its neighbors. */
+    res = GRAPH_init(false, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    for (i = 0; i <= 50; i++) {
+        res = GRAPH_add_vertex(g, i);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    for (i = 1; i <= 50; i++) {
+        res = GRAPH_add_edge(g, i, 0, 1);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    res = GRAPH_add_edge(g, 1, 1, 1);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_add_edge(g, 1, 2, 1);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    res = GRAPH_remove_vertex(g, 0);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    LIST_FOREACH(v, &g->vertices, next) {
+        ASSERT_EQUAL(v->neighbor_count, ((1 == v->id) ? 2 : ((2 == v->id) ? 1 : 0)));
+    }
+    res = GRAPH_remove_edge(g, 2, 1);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_remove_edge(g, 1, 2);
+    ASSERT_EQUAL(res, GRAPH_ERR_NOT_FOUND);
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    /* Directional: removing a vertex removes the edges ending at it as well. */
+    res = GRAPH_init(true, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    for (i = 0; i < 3; i++) {
+        res = GRAPH_add_vertex(g, i);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    res = GRAPH_add_edge(g, 0, 1, 1);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_add_edge(g, 2, 1, 1);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_add_edge(g, 1, 2, 1);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_add_edge(g, 1, 1, 1);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    res = GRAPH_remove_vertex(g, 1);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    LIST_FOREACH(v, &g->vertices, next) {
+        ASSERT_EQUAL(v->neighbor_count, 0);
+        ASSERT_EQUAL(v->in_neighbor_count, 0);
+    }
+    res = GRAPH_add_vertex(g, 1);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_has_edge(g, 0, 1, &has_edge);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_TRUE(!has_edge);
+
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    return true;
+}
+
+bool test_graph_freeze() {
+    struct graph *g = NULL;
+    struct graph_csr *csr = NULL;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    const graph_index_t *targets = NULL;
+    const double *weights = NULL;
+    graph_index_t index = 0;
+    size_t count = 0;
+    size_t edge_count = 0;
+    bool has_edge = false;
+    bool expected = false;
+    double weight = 0;
+    uint64_t i = 0;
+    uint64_t j = 0;
+
+    res = GRAPH_init(false, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    for (i = 0; i < 20000; i++) {
+        res = GRAPH_add_vertex(g, (i * 7) % 20000);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    for (i = 0; i < 20000; i++) {
+        for (j = 1; j <= 3; j++) {
+            res = GRAPH_add_edge(g, i, (i * j + 13) % 20000, (double)(i + j));
+            ASSERT_TRUE((GRAPH_ERR_SUCCESS == res) || (GRAPH_ERR_FOUND == res));
+        }
+    }
+
+    res = GRAPH_freeze(g, 4, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(csr->vertex_count, 20000);
+
+    for (i = 0; i < csr->vertex_count; i++) {
+        /* Vertices are numbered by ascending id. */
+        ASSERT_EQUAL(csr->ids[i], i);
+        res = GRAPH_csr_find_index(csr, i, &index);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_EQUAL(index, i);
+
+        res = GRAPH_csr_neighbors(csr, (graph_index_t)i, &targets, &weights, &count);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        edge_count += count;
+        for (j = 0; j < count; j++) {
+            ASSERT_TRUE((0 == j) || (targets[j - 1] < targets[j]));
+            res = GRAPH_get_edge_weight(g, i, csr->ids[targets[j]], &weight);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            ASSERT_EQUAL(weight, weights[j]);
+        }
+    }
+    ASSERT_EQUAL(edge_count, csr->edge_count);
+
+    for (i = 0; i < 20000; i += 97) {
+        for (j = 0; j < 20000; j += 89) {
+            res = GRAPH_csr_has_edge(csr, i, j, &has_edge);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            res = GRAPH_has_edge(g, i, j, &expected);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            ASSERT_EQUAL(has_edge, expected);
+        }
+    }
+    res = GRAPH_csr_has_edge(csr, 0, 13, &has_edge);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_TRUE(has_edge);
+    res = GRAPH_csr_get_edge_weight(csr, 13, 0, &weight);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(weight, 1);
+    res = GRAPH_csr_has_edge(csr, 0, 20000, &has_edge);
+    ASSERT_EQUAL(res, GRAPH_ERR_NOT_FOUND);
+
+    res = GRAPH_csr_destroy(csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    return true;
+}
+
+bool test_graph_save_load() {
+    char path[] = "/tmp/libgraph_sanity_XXXXXX";
+    struct graph *g = NULL;
+    struct graph *thawed = NULL;
+    struct graph_csr *csr = NULL;
+    struct graph_csr *loaded = NULL;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    bool has_edge = false;
+    bool expected = false;
+    double weight = 0;
+    FILE *file = NULL;
+    uint64_t i = 0;
+    uint64_t j = 0;
+    int fd = -1;
+
+    fd = mkstemp(path);
+    ASSERT_TRUE(fd >= 0);
+    (void)close(fd);
+
+    res = GRAPH_init(true, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    for (i = 0; i < 3000; i++) {
+        res = GRAPH_add_vertex(g, i * 3);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    for (i = 0; i < 3000; i++) {
+        for (j = 1; j <= 4; j++) {
+            res = GRAPH_add_edge(g, i * 3, ((i * j + 7) % 3000) * 3, (double)i / (double)j);
+            ASSERT_TRUE((GRAPH_ERR_SUCCESS == res) || (GRAPH_ERR_FOUND == res));
+        }
+    }
+
+    res = GRAPH_save(g, path);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_load_mmap(path, GRAPH_LOAD_VERIFY, &loaded);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_freeze(g, 0, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    /* The mapped snapshot is the frozen one. */
+    ASSERT_TRUE(loaded->is_directional);
+    ASSERT_EQUAL(loaded->vertex_count, csr->vertex_count);
+    ASSERT_EQUAL(loaded->edge_count, csr->edge_count);
+    ASSERT_EQUAL(0, memcmp(loaded->ids, csr->ids, sizeof(*csr->ids) * csr->vertex_count));
+    ASSERT_EQUAL(0, memcmp(loaded->offsets, csr->offsets, sizeof(*csr->offsets) * (csr->vertex_count + 1)));
+    ASSERT_EQUAL(0, memcmp(loaded->targets, csr->targets, sizeof(*csr->targets) * csr->edge_count));
+    ASSERT_EQUAL(0, memcmp(loaded->weights, csr->weights, sizeof(*csr->weights) * csr->edge_count));
+
+    for (i = 0; i < 9000; i += 7) {
+        for (j = 0; j < 9000; j += 11) {
+            res = GRAPH_csr_has_edge(loaded, i, j, &has_edge);
+            if (0 != (i % 3) || 0 != (j % 3)) {
+                ASSERT_EQUAL(res, GRAPH_ERR_NOT_FOUND);
+                continue;
+            }
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            res = GRAPH_has_edge(g, i, j, &expected);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            ASSERT_EQUAL(has_edge, expected);
+        }
+    }
+
+    /* Thawing gives back the graph. */
+    res = GRAPH_thaw(loaded, &thawed);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(thawed->vertex_count, g->vertex_count);
+    for (i = 0; i < 3000; i++) {
+        res = GRAPH_get_edge_weight(thawed, i * 3, ((i * 2 + 7) % 3000) * 3, &weight);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_EQUAL(weight, (double)i / 2);
+    }
+
+    res = GRAPH_csr_destroy(loaded);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    loaded = NULL;
+
+    /* A corrupted payload is only caught when verifying. */
+    file = fopen(path, "r+b");
+    ASSERT_TRUE(NULL != file);
+    ASSERT_EQUAL(0, fseek(file, -8, SEEK_END));
+    ASSERT_EQUAL(EOF != fputc(0x5a, file), true);
+    ASSERT_EQUAL(0, fclose(file));
+    res = GRAPH_load_mmap(path, 0, &loaded);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_csr_destroy(loaded);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    loaded = NULL;
+    res = GRAPH_load_mmap(path, GRAPH_LOAD_VERIFY, &loaded);
+    ASSERT_EQUAL(res, GRAPH_ERR_FORMAT);
+
+    /* A corrupted header never loads. */
+    file = fopen(path, "r+b");
+    ASSERT_TRUE(NULL != file);
+    ASSERT_EQUAL(0, fseek(file, 16, SEEK_SET));
+    ASSERT_EQUAL(EOF != fputc(0x5a, file), true);
+    ASSERT_EQUAL(0, fclose(file));
+    res = GRAPH_load_mmap(path, 0, &loaded);
+    ASSERT_EQUAL(res, GRAPH_ERR_FORMAT);
+
+    (void)unlink(path);
+    res = GRAPH_load_mmap(path, 0, &loaded);
+    ASSERT_EQUAL(res, GRAPH_ERR_IO);
+
+    res = GRAPH_csr_destroy(csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_destroy(thawed);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    return true;
+}
+
+static bool write_text_file(const char *path, const char *text) {
+    FILE *file = fopen(path, "wb");
+
+    if (NULL == file) {
+        return false;
+    }
+    if ((0 != strlen(text)) && (1 != fwrite(text, strlen(text), 1, file))) {
+        (void)fclose(file);
+        return false;
+    }
+    return (0 == fclose(file));
+}
+
+static bool csr_equal(const struct graph_csr *a, const struct graph_csr *b) {
+    return (a->is_directional == b->is_directional) && (a->vertex_count == b->vertex_count) &&
+           (a->edge_count == b->edge_count) &&
+           (0 == memcmp(a->ids, b->ids, sizeof(*a->ids) * a->vertex_count)) &&
+           (0 == memcmp(a->offsets, b->offsets, sizeof(*a->offsets) * (a->vertex_count + 1))) &&
+           (0 == memcmp(a->targets, b->targets, sizeof(*a->targets) * a->edge_count)) &&
+           (0 == memcmp(a->weights, b->weights, sizeof(*a->weights) * a->edge_count));
+}
+
+bool test_graph_load_text() {
+    char path[] = "/tmp/libgraph_sanity_XXXXXX";
+    struct graph *g = NULL;
+    struct graph_csr *csr = NULL;
+    struct graph_csr *frozen = NULL;
+    struct graph_parse_stats stats;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    bool has_edge = false;
+    double weight = 0;
+    FILE *file = NULL;
+    uint64_t i = 0;
+    int fd = -1;
+
+    fd = mkstemp(path);
+    ASSERT_TRUE(fd >= 0);
+    (void)close(fd);
+
+    /* An edge list with comments, blank lines, CRLF endings and assorted weights. */
+    ASSERT_TRUE(write_text_file(path, "# FromNodeId\tToNodeId\n"
+                                      "1\t2\n"
+                                      "\n"
+                                      "  2 3 2.5e-1\r\n"
+                                      "% another comment\n"
+                                      "3 1 -4.75\n"
+                                      "4 4 1E3\n"
+                                      "1 5 0.1\n"
+                                      "5 1 0.1\n"
+                                      "6 7 12345678901234567890.5"));
+    res = GRAPH_load_text(path, GRAPH_TEXT_AUTO, false, 2, &g, &stats);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(stats.edge_count, 7);
+    ASSERT_EQUAL(stats.lines, 10);
+    ASSERT_EQUAL(g->vertex_count, 7);
+    res = GRAPH_get_edge_weight(g, 2, 1, &weight);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(weight, 1);
+    res = GRAPH_get_edge_weight(g, 3, 2, &weight);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(weight, 0.25);
+    res = GRAPH_get_edge_weight(g, 1, 3, &weight);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(weight, -4.75);
+    res = GRAPH_get_edge_weight(g, 4, 4, &weight);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(weight, 1000);
+    res = GRAPH_get_edge_weight(g, 5, 1, &weight);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(weight, 0.1);
+    res = GRAPH_get_edge_weight(g, 7, 6, &weight);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(weight, 12345678901234567890.5);
+
+    /* Loading straight into a snapshot gives the frozen graph. */
+    res = GRAPH_load_text_csr(path, GRAPH_TEXT_EDGE_LIST, false, 2, &csr, NULL);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_freeze(g, 1, &frozen);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_TRUE(csr_equal(csr, frozen));
+    (void)GRAPH_csr_destroy(csr);
+    (void)GRAPH_csr_destroy(frozen);
+    (void)GRAPH_destroy(g);
+
+    /* A symmetric Matrix Market file, mirrored into a directional graph, with an isolated vertex. */
+    ASSERT_TRUE(write_text_file(path, "%%MatrixMarket matrix coordinate real symmetric\n"
+                                      "% comment\n"
+                                      "5 5 3\n"
+                                      "2 1 1.5\n"
+                                      "3 3 2\n"
+                                      "4 2 -1\n"));
+    res = GRAPH_load_text(path, GRAPH_TEXT_AUTO, true, 1, &g, NULL);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(g->vertex_count, 5);
+    res = GRAPH_has_edge(g, 1, 2, &has_edge);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_TRUE(has_edge);
+    res = GRAPH_get_edge_weight(g, 2, 4, &weight);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(weight, -1);
+    res = GRAPH_load_text_csr(path, GRAPH_TEXT_MATRIX_MARKET, true, 1, &csr, NULL);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(csr->edge_count, 5);
+    res = GRAPH_freeze(g, 1, &frozen);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_TRUE(csr_equal(csr, frozen));
+    (void)GRAPH_csr_destroy(csr);
+    (void)GRAPH_csr_destroy(frozen);
+    (void)GRAPH_destroy(g);
+
+    /* A hub with more neighbors than a row sorted in place, each edge repeated with other weights: the first wins. */
+    file = fopen(path, "wb");
+    ASSERT_TRUE(NULL != file);
+    for (i = 40; i > 0; i--) {
+        ASSERT_TRUE(fprintf(file, "1000 %lu %lu\n", (unsigned long)i, (unsigned long)i) > 0);
+    }
+    for (i = 1; i <= 40; i++) {
+        ASSERT_TRUE(fprintf(file, "%lu 1000 %lu\n1000 %lu %lu\n", (unsigned long)i, (unsigned long)(i + 100),
+                            (unsigned long)i, (unsigned long)(i + 200)) > 0);
+    }
+    ASSERT_EQUAL(0, fclose(file));
+    res = GRAPH_load_text_csr(path, GRAPH_TEXT_EDGE_LIST, false, 2, &csr, NULL);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(csr->edge_count, 80);
+    for (i = 1; i <= 40; i++) {
+        res = GRAPH_csr_get_edge_weight(csr, 1000, i, &weight);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_EQUAL(weight, (double)i);
+        res = GRAPH_csr_get_edge_weight(csr, i, 1000, &weight);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_EQUAL(weight, (double)i);
+    }
+    res = GRAPH_load_text(path, GRAPH_TEXT_EDGE_LIST, false, 2, &g, NULL);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_freeze(g, 1, &frozen);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_TRUE(csr_equal(csr, frozen));
+    (void)GRAPH_csr_destroy(csr);
+    (void)GRAPH_csr_destroy(frozen);
+    (void)GRAPH_destroy(g);
+    res = GRAPH_load_text_csr(path, GRAPH_TEXT_EDGE_LIST, true, 2, &csr, NULL);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(csr->edge_count, 80);
+    for (i = 1; i <= 40; i++) {
+        res = GRAPH_csr_get_edge_weight(csr, 1000, i, &weight);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_EQUAL(weight, (double)i);
+        res = GRAPH_csr_get_edge_weight(csr, i, 1000, &weight);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_EQUAL(weight, (double)(i + 100));
+    }
+    (void)GRAPH_csr_destroy(csr);
+
+    /* Malformed files. */
+    ASSERT_TRUE(write_text_file(path, "1 2\n3 x\n"));
+    res = GRAPH_load_text(path, GRAPH_TEXT_AUTO, false, 1, &g, NULL);
+    ASSERT_EQUAL(res, GRAPH_ERR_FORMAT);
+    ASSERT_TRUE(write_text_file(path, "%%MatrixMarket matrix coordinate real general\n3 3 2\n1 2 1\n"));
+    res = GRAPH_load_text_csr(path, GRAPH_TEXT_AUTO, false, 1, &csr, NULL);
+    ASSERT_EQUAL(res, GRAPH_ERR_FORMAT);
+    ASSERT_TRUE(write_text_file(path, "%%MatrixMarket matrix coordinate real general\n3 3 1\n1 4 1\n"));
+    res = GRAPH_load_text_csr(path, GRAPH_TEXT_AUTO, false, 1, &csr, NULL);
+    ASSERT_EQUAL(res, GRAPH_ERR_FORMAT);
+
+    /* A file big enough to be split between threads. */
+    file = fopen(path, "wb");
+    ASSERT_TRUE(NULL != file);
+    for (i = 0; i < 200000; i++) {
+        ASSERT_TRUE(fprintf(file, "%lu %lu %lu.5\n", (unsigned long)(i % 50000), (unsigned long)((i * 7919) % 50000),
+                            (unsigned long)(i % 50000)) > 0);
+    }
+    ASSERT_EQUAL(0, fclose(file));
+    res = GRAPH_load_text_csr(path, GRAPH_TEXT_AUTO, true, 4, &csr, &stats);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(stats.edge_count, 200000);
+    ASSERT_EQUAL(stats.lines, 200000);
+    ASSERT_TRUE(stats.edges_per_second > 0);
+    res = GRAPH_load_text(path, GRAPH_TEXT_AUTO, true, 4, &g, NULL);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_freeze(g, 4, &frozen);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_TRUE(csr_equal(csr, frozen));
+    (void)GRAPH_csr_destroy(csr);
+    (void)GRAPH_csr_destroy(frozen);
+    (void)GRAPH_destroy(g);
+
+    (void)unlink(path);
+    res = GRAPH_load_text(path, GRAPH_TEXT_AUTO, false, 1, &g, NULL);
+    ASSERT_EQUAL(res, GRAPH_ERR_IO);
+
+    return true;
+}
+
+/**
+ * @brief   Shortest distances by Bellman-Ford, the reference for the searches.
+ */
+static void reference_distances(const struct graph_csr *csr, graph_index_t source, double *distances) {
+    bool changed = true;
+    size_t i = 0;
+    uint64_t k = 0;
+
+    for (i = 0; i < csr->vertex_count; i++) {
+        distances[i] = GRAPH_DISTANCE_INFINITY;
+    }
+    distances[source] = 0;
+    while (changed) {
+        changed = false;
+        for (i = 0; i < csr->vertex_count; i++) {
+            if (GRAPH_DISTANCE_INFINITY == distances[i]) {
+                continue;
+            }
+            for (k = csr->offsets[i]; k < csr->offsets[i + 1]; k++) {
+                if (distances[i] + csr->weights[k] < distances[csr->targets[k]]) {
+                    distances[csr->targets[k]] = distances[i] + csr->weights[k];
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+bool test_graph_sssp_dijkstra() {
+    struct graph *g = NULL;
+    struct graph_csr *csr = NULL;
+    struct graph_sssp sssp;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    double *expected = NULL;
+    graph_index_t v = 0;
+    double path = 0;
+    double weight = 0;
+    uint64_t seed = 12345;
+    uint64_t i = 0;
+    uint64_t source = 0;
+
+    res = GRAPH_init(true, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    for (i = 0; i < 2000; i++) {
+        res = GRAPH_add_vertex(g, i);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    for (i = 0; i < 12000; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        (void)GRAPH_add_edge(g, (seed >> 33) % 2000, (seed >> 13) % 2000, (double)((seed >> 50) % 20));
+    }
+    res = GRAPH_freeze(g, 1, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    expected = malloc(sizeof(*expected) * csr->vertex_count);
+    ASSERT_TRUE(NULL != expected);
+
+    GRAPH_sssp_init(&sssp);
+    for (source = 0; source < 2000; source += 397) {
+        reference_distances(csr, (graph_index_t)source, expected);
+
+        res = GRAPH_sssp_dijkstra(csr, (graph_index_t)source, GRAPH_INDEX_NONE, GRAPH_SSSP_QUEUE_DARY_HEAP, &sssp);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        for (i = 0; i < csr->vertex_count; i++) {
+            ASSERT_EQUAL(sssp.distances[i], expected[i]);
+
+            /* The predecessors spell out a path of the same length. */
+            if ((GRAPH_DISTANCE_INFINITY != expected[i]) && (i != source)) {
+                path = 0;
+                for (v = (graph_index_t)i; v != source; v = sssp.predecessors[v]) {
+                    res = GRAPH_csr_get_edge_weight(csr, csr->ids[sssp.predecessors[v]], csr->ids[v], &weight);
+                    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+                    path += weight;
+                }
+                ASSERT_EQUAL(path, expected[i]);
+            }
+        }
+
+        res = GRAPH_sssp_dijkstra(csr, (graph_index_t)source, GRAPH_INDEX_NONE, GRAPH_SSSP_QUEUE_RADIX_HEAP, &sssp);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        for (i = 0; i < csr->vertex_count; i++) {
+            ASSERT_EQUAL(sssp.distances[i], expected[i]);
+        }
+
+        /* Stopping at a target still gets its distance right. */
+        res = GRAPH_sssp_dijkstra(csr, (graph_index_t)source, 1999, GRAPH_SSSP_QUEUE_DARY_HEAP, &sssp);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_EQUAL(sssp.distances[1999], expected[1999]);
+        res = GRAPH_sssp_dijkstra(csr, (graph_index_t)source, 1999, GRAPH_SSSP_QUEUE_RADIX_HEAP, &sssp);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_EQUAL(sssp.distances[1999], expected[1999]);
+    }
+    (void)GRAPH_csr_destroy(csr);
+
+    /* Negative weights are refused, fractional ones only by the radix heap. */
+    (void)GRAPH_remove_edge(g, 0, 1);
+    res = GRAPH_add_edge(g, 0, 1, 0.5);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_freeze(g, 1, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_sssp_dijkstra(csr, 0, GRAPH_INDEX_NONE, GRAPH_SSSP_QUEUE_DARY_HEAP, &sssp);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_sssp_dijkstra(csr, 0, GRAPH_INDEX_NONE, GRAPH_SSSP_QUEUE_RADIX_HEAP, &sssp);
+    ASSERT_EQUAL(res, GRAPH_ERR_PARAMS);
+    (void)GRAPH_csr_destroy(csr);
+    (void)GRAPH_remove_edge(g, 0, 1);
+    res = GRAPH_add_edge(g, 0, 1, -1);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_freeze(g, 1, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_sssp_dijkstra(csr, 0, GRAPH_INDEX_NONE, GRAPH_SSSP_QUEUE_DARY_HEAP, &sssp);
+    ASSERT_EQUAL(res, GRAPH_ERR_PARAMS);
+    res = GRAPH_sssp_dijkstra(csr, 2000, GRAPH_INDEX_NONE, GRAPH_SSSP_QUEUE_DARY_HEAP, &sssp);
+    ASSERT_EQUAL(res, GRAPH_ERR_PARAMS);
+    (void)GRAPH_csr_destroy(csr);
+
+    /* Integral weights that each fit the radix heap but add up past its exact range. */
+    (void)GRAPH_clear(g);
+    for (i = 0; i < 3; i++) {
+        res = GRAPH_add_vertex(g, i);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    (void)GRAPH_add_edge(g, 0, 1, (double)(1ULL << 52));
+    (void)GRAPH_add_edge(g, 1, 2, (double)(1ULL << 52));
+    res = GRAPH_freeze(g, 1, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_sssp_dijkstra(csr, 0, GRAPH_INDEX_NONE, GRAPH_SSSP_QUEUE_RADIX_HEAP, &sssp);
+    ASSERT_EQUAL(res, GRAPH_ERR_OVERFLOW);
+    res = GRAPH_sssp_dijkstra(csr, 0, GRAPH_INDEX_NONE, GRAPH_SSSP_QUEUE_DARY_HEAP, &sssp);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    GRAPH_sssp_destroy(&sssp);
+    free(expected);
+    (void)GRAPH_csr_destroy(csr);
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    return true;
+}
+
+bool test_graph_sssp_delta_stepping() {
+    struct graph *g = NULL;
+    struct graph_csr *csr = NULL;
+    struct graph_sssp expected;
+    struct graph_sssp sssp;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    double deltas[] = {0, 0.05, 3, 1000};
+    size_t threads[] = {1, 3, 8};
+    graph_index_t v = 0;
+    double path = 0;
+    double weight = 0;
+    uint64_t seed = 777;
+    uint64_t i = 0;
+    size_t d = 0;
+    size_t t = 0;
+
+    res = GRAPH_init(false, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    for (i = 0; i < 5000; i++) {
+        res = GRAPH_add_vertex(g, i);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    for (i = 0; i < 20000; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        /* Some zero weights and a few heavy edges. */
+        weight = (double)((seed >> 40) % 100) / 8;
+        if (0 == (i % 97)) {
+            weight *= 50;
+        }
+        (void)GRAPH_add_edge(g, (seed >> 20) % 4800, (seed >> 7) % 4800, weight);
+    }
+    res = GRAPH_freeze(g, 2, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    GRAPH_sssp_init(&expected);
+    GRAPH_sssp_init(&sssp);
+    res = GRAPH_sssp_dijkstra(csr, 17, GRAPH_INDEX_NONE, GRAPH_SSSP_QUEUE_DARY_HEAP, &expected);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    for (d = 0; d < sizeof(deltas) / sizeof(deltas[0]); d++) {
+        for (t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            res = GRAPH_sssp_delta_stepping(csr, 17, deltas[d], threads[t], &sssp);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            for (i = 0; i < csr->vertex_count; i++) {
+                ASSERT_EQUAL(sssp.distances[i], expected.distances[i]);
+                if ((GRAPH_DISTANCE_INFINITY == sssp.distances[i]) || (17 == i)) {
+                    ASSERT_EQUAL(sssp.predecessors[i], GRAPH_INDEX_NONE);
+                    continue;
+                }
+                path = 0;
+                for (v = (graph_index_t)i; v != 17; v = sssp.predecessors[v]) {
+                    res = GRAPH_csr_get_edge_weight(csr, csr->ids[sssp.predecessors[v]], csr->ids[v], &weight);
+                    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+                    path += weight;
+                }
+                ASSERT_EQUAL(path, sssp.distances[i]);
+            }
+        }
+    }
+
+    /* The isolated vertices past 4800 are never reached, and the context still serves Dijkstra. */
+    ASSERT_EQUAL(sssp.distances[4999], GRAPH_DISTANCE_INFINITY);
+    res = GRAPH_sssp_dijkstra(csr, 17, 18, GRAPH_SSSP_QUEUE_DARY_HEAP, &sssp);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(sssp.distances[18], expected.distances[18]);
+    (void)GRAPH_csr_destroy(csr);
+
+    /* Negative weights are refused. */
+    res = GRAPH_add_edge(g, 4900, 4901, -2);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_freeze(g, 2, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_sssp_delta_stepping(csr, 0, 0, 4, &sssp);
+    ASSERT_EQUAL(res, GRAPH_ERR_PARAMS);
+
+    GRAPH_sssp_destroy(&sssp);
+    GRAPH_sssp_destroy(&expected);
+    (void)GRAPH_csr_destroy(csr);
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    return true;
+}
+
+/**
+ * @brief   Hop distances by a plain queue BFS, the reference for the searches.
+ */
+static void reference_levels(const struct graph_csr *csr, graph_index_t source, uint32_t *levels,
+                             graph_index_t *queue) {
+    size_t head = 0;
+    size_t tail = 0;
+    graph_index_t u = 0;
+    size_t i = 0;
+    uint64_t k = 0;
+
+    for (i = 0; i < csr->vertex_count; i++) {
+        levels[i] = GRAPH_BFS_UNREACHED;
+    }
+    levels[source] = 0;
+    queue[tail++] = source;
+    while (head < tail) {
+        u = queue[head++];
+        for (k = csr->offsets[u]; k < csr->offsets[u + 1]; k++) {
+            if (GRAPH_BFS_UNREACHED == levels[csr->targets[k]]) {
+                levels[csr->targets[k]] = levels[u] + 1;
+                queue[tail++] = csr->targets[k];
+            }
+        }
+    }
+}
+
+bool test_graph_bfs() {
+    struct graph *g = NULL;
+    struct graph_csr *csr = NULL;
+    struct graph_csr *transpose = NULL;
+    struct graph_bfs bfs;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    uint32_t *expected = NULL;
+    graph_index_t *queue = NULL;
+    size_t threads[] = {1, 4};
+    size_t degrees[] = {2, 40};
+    bool has_edge = false;
+    bool is_directional = false;
+    uint64_t seed = 99;
+    uint64_t i = 0;
+    size_t d = 0;
+    size_t t = 0;
+    size_t source = 0;
+
+    GRAPH_bfs_init(&bfs);
+    expected = malloc(sizeof(*expected) * 3000);
+    queue = malloc(sizeof(*queue) * 3000);
+    ASSERT_TRUE((NULL != expected) && (NULL != queue));
+
+    for (d = 0; d < 4; d++) {
+        /* Sparse and dense graphs, so both directions get used, directional and not. */
+        is_directional = (0 != (d % 2));
+        res = GRAPH_init(is_directional, &g);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        for (i = 0; i < 3000; i++) {
+            res = GRAPH_add_vertex(g, i);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        }
+        for (i = 0; i < 3000 * degrees[d / 2]; i++) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            (void)GRAPH_add_edge(g, (seed >> 20) % 2900, (seed >> 40) % 2900, 1);
+        }
+        res = GRAPH_freeze(g, 2, &csr);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        res = GRAPH_csr_transpose(csr, &transpose);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_EQUAL(transpose->edge_count, csr->edge_count);
+
+        for (source = 0; source < 3000; source += 1499) {
+            reference_levels(csr, (graph_index_t)source, expected, queue);
+            for (t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+                res = GRAPH_bfs(csr, (0 == t) ? NULL : transpose, (graph_index_t)source, threads[t], &bfs);
+                ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+                if ((1 == (d / 2)) && (source < 2900)) {
+                    ASSERT_TRUE(0 != bfs.bottom_up_steps);
+                }
+                for (i = 0; i < csr->vertex_count; i++) {
+                    ASSERT_EQUAL(bfs.levels[i], expected[i]);
+                    if ((GRAPH_BFS_UNREACHED == expected[i]) || (i == source)) {
+                        ASSERT_EQUAL(bfs.parents[i], GRAPH_INDEX_NONE);
+                        continue;
+                    }
+                    /* The parent is one level up and has an edge to the vertex. */
+                    ASSERT_EQUAL(bfs.levels[bfs.parents[i]] + 1, bfs.levels[i]);
+                    res = GRAPH_csr_has_edge(csr, csr->ids[bfs.parents[i]], csr->ids[i], &has_edge);
+                    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+                    ASSERT_TRUE(has_edge);
+                }
+            }
+        }
+
+        (void)GRAPH_csr_destroy(transpose);
+        (void)GRAPH_csr_destroy(csr);
+        res = GRAPH_destroy(g);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+
+    free(expected);
+    free(queue);
+    GRAPH_bfs_destroy(&bfs);
+
+    return true;
+}
+
+bool test_graph_connected_components() {
+    struct graph *g = NULL;
+    struct graph_csr *csr = NULL;
+    struct graph_csr *symmetric = NULL;
+    struct graph_components components;
+    struct graph_bfs bfs;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    size_t threads[] = {1, 4};
+    uint64_t seed = 4242;
+    size_t total = 0;
+    uint64_t i = 0;
+    size_t d = 0;
+    size_t t = 0;
+    size_t v = 0;
+
+    GRAPH_components_init(&components);
+    GRAPH_bfs_init(&bfs);
+    for (d = 0; d < 2; d++) {
+        /* A giant component, a few small ones made of vertices 10000+ and isolated vertices. */
+        res = GRAPH_init(1 == d, &g);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        for (i = 0; i < 12000; i++) {
+            res = GRAPH_add_vertex(g, i);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        }
+        for (i = 0; i < 30000; i++) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            (void)GRAPH_add_edge(g, (seed >> 20) % 10000, (seed >> 40) % 10000, 1);
+        }
+        for (i = 10000; i < 11900; i++) {
+            if (0 != (i % 10)) {
+                (void)GRAPH_add_edge(g, i + 1, i, 1);
+            }
+        }
+        res = GRAPH_freeze(g, 2, &csr);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        (void)GRAPH_destroy(g);
+
+        /* The reference: BFS over the undirectional version of the snapshot. */
+        res = GRAPH_init(false, &g);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        res = GRAPH_add_vertices(g, csr->ids, csr->vertex_count, NULL);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        for (v = 0; v < csr->vertex_count; v++) {
+            for (i = csr->offsets[v]; i < csr->offsets[v + 1]; i++) {
+                (void)GRAPH_add_edge(g, csr->ids[v], csr->ids[csr->targets[i]], 1);
+            }
+        }
+        res = GRAPH_freeze(g, 2, &symmetric);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        (void)GRAPH_destroy(g);
+
+        for (t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            res = GRAPH_connected_components(csr, threads[t], &components);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+            /* Numbered by their lowest vertex: the giant component first, and the right sizes. */
+            ASSERT_EQUAL(components.labels[0], 0);
+            total = 0;
+            for (i = 0; i < components.component_count; i++) {
+                total += components.sizes[i];
+            }
+            ASSERT_EQUAL(total, csr->vertex_count);
+
+            for (v = 0; v < csr->vertex_count; v += 250) {
+                res = GRAPH_bfs(symmetric, NULL, (graph_index_t)v, 1, &bfs);
+                ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+                total = 0;
+                for (i = 0; i < csr->vertex_count; i++) {
+                    ASSERT_EQUAL(components.labels[i] == components.labels[v], GRAPH_BFS_UNREACHED != bfs.levels[i]);
+                    total += (GRAPH_BFS_UNREACHED != bfs.levels[i]);
+                }
+                ASSERT_EQUAL(total, components.sizes[components.labels[v]]);
+            }
+        }
+        /* 1900 chain vertices in 190 chains, 100 isolated vertices, and the rest. */
+        ASSERT_TRUE(components.component_count >= 291);
+
+        (void)GRAPH_csr_destroy(symmetric);
+        (void)GRAPH_csr_destroy(csr);
+    }
+    GRAPH_bfs_destroy(&bfs);
+    GRAPH_components_destroy(&components);
+
+    return true;
+}
+
+/**
+ * @brief   Serial push-based PageRank, the reference for GRAPH_pagerank.
+ */
+static void reference_pagerank(const struct graph_csr *csr, const double *teleports, double damping,
+                               size_t iterations, double *ranks, double *next) {
+    double dangling = 0;
+    uint64_t degree = 0;
+    size_t n = 0;
+    uint64_t i = 0;
+    size_t v = 0;
+
+    for (v = 0; v < csr->vertex_count; v++) {
+        ranks[v] = teleports[v];
+    }
+    for (n = 0; n < iterations; n++) {
+        dangling = 0;
+        for (v = 0; v < csr->vertex_count; v++) {
+            next[v] = 0;
+            if (csr->offsets[v] == csr->offsets[v + 1]) {
+                dangling += ranks[v];
+            }
+        }
+        for (v = 0; v < csr->vertex_count; v++) {
+            degree = csr->offsets[v + 1] - csr->offsets[v];
+            for (i = csr->offsets[v]; i < csr->offsets[v + 1]; i++) {
+                next[csr->targets[i]] += ranks[v] / (double)degree;
+            }
+        }
+        for (v = 0; v < csr->vertex_count; v++) {
+            ranks[v] = (teleports[v] * ((1 - damping) + (damping * dangling))) + (damping * next[v]);
+        }
+    }
+}
+
+bool test_graph_pagerank() {
+    struct graph *g = NULL;
+    struct graph_csr *csr = NULL;
+    struct graph_pagerank_params params;
+    struct graph_pagerank pagerank;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    size_t threads[] = {1, 4};
+    double *teleports = NULL;
+    double *expected = NULL;
+    double *scratch = NULL;
+    double *personalization = NULL;
+    uint64_t seed = 777;
+    double total = 0;
+    double diff = 0;
+    uint64_t i = 0;
+    size_t d = 0;
+    size_t t = 0;
+    size_t v = 0;
+
+    GRAPH_pagerank_init(&pagerank);
+    GRAPH_pagerank_params_init(&params);
+    params.tolerance = 1e-13;
+    params.max_iterations = 500;
+    for (d = 0; d < 2; d++) {
+        /* Random edges between the first 2500 vertices, the last 500 are dangling (when directional). */
+        res = GRAPH_init(0 == d, &g);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        for (i = 0; i < 3000; i++) {
+            res = GRAPH_add_vertex(g, i);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        }
+        for (i = 0; i < 20000; i++) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            (void)GRAPH_add_edge(g, (seed >> 20) % 2500, (seed >> 40) % 3000, 1);
+        }
+        res = GRAPH_freeze(g, 2, &csr);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        (void)GRAPH_destroy(g);
+
+        teleports = malloc(sizeof(*teleports) * csr->vertex_count);
+        expected = malloc(sizeof(*expected) * csr->vertex_count);
+        scratch = malloc(sizeof(*scratch) * csr->vertex_count);
+        personalization = calloc(csr->vertex_count, sizeof(*personalization));
+        ASSERT_TRUE((NULL != teleports) && (NULL != expected) && (NULL != scratch) && (NULL != personalization));
+        for (v = 0; v < csr->vertex_count; v++) {
+            teleports[v] = 1 / (double)csr->vertex_count;
+        }
+        reference_pagerank(csr, teleports, params.damping, 500, expected, scratch);
+
+        for (t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            params.thread_count = threads[t];
+            params.personalization = NULL;
+            res = GRAPH_pagerank(csr, NULL, &params, &pagerank);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            ASSERT_TRUE(pagerank.is_converged);
+            ASSERT_TRUE(pagerank.iteration_count > 1);
+            ASSERT_TRUE(pagerank.residuals[pagerank.iteration_count - 1] < params.tolerance);
+            ASSERT_TRUE(pagerank.residuals[pagerank.iteration_count - 1] < pagerank.residuals[0]);
+            total = 0;
+            for (v = 0; v < csr->vertex_count; v++) {
+                diff = pagerank.ranks[v] - expected[v];
+                ASSERT_TRUE((diff < 1e-10) && (diff > -1e-10));
+                total += pagerank.ranks[v];
+            }
+            ASSERT_TRUE((total > 1 - 1e-9) && (total < 1 + 1e-9));
+
+            /* Teleporting only to vertices 0 and 1, in a 3:1 ratio. */
+            personalization[0] = 3;
+            personalization[1] = 1;
+            (void)memset(teleports, 0, sizeof(*teleports) * csr->vertex_count);
+            teleports[0] = 0.75;
+            teleports[1] = 0.25;
+            reference_pagerank(csr, teleports, params.damping, 500, expected, scratch);
+            params.personalization = personalization;
+            res = GRAPH_pagerank(csr, NULL, &params, &pagerank);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            ASSERT_TRUE(pagerank.is_converged);
+            for (v = 0; v < csr->vertex_count; v++) {
+                diff = pagerank.ranks[v] - expected[v];
+                ASSERT_TRUE((diff < 1e-10) && (diff > -1e-10));
+            }
+            for (v = 0; v < csr->vertex_count; v++) {
+                teleports[v] = 1 / (double)csr->vertex_count;
+            }
+            reference_pagerank(csr, teleports, params.damping, 500, expected, scratch);
+        }
+
+        /* Stopping early reports every iteration. */
+        params.personalization = NULL;
+        params.max_iterations = 3;
+        res = GRAPH_pagerank(csr, NULL, &params, &pagerank);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_TRUE(!pagerank.is_converged);
+        ASSERT_EQUAL(pagerank.iteration_count, 3);
+        params.max_iterations = 500;
+
+        /* Invalid personalization and damping. */
+        (void)memset(personalization, 0, sizeof(*personalization) * csr->vertex_count);
+        params.personalization = personalization;
+        res = GRAPH_pagerank(csr, NULL, &params, &pagerank);
+        ASSERT_EQUAL(res, GRAPH_ERR_PARAMS);
+        personalization[0] = -1;
+        personalization[1] = 2;
+        res = GRAPH_pagerank(csr, NULL, &params, &pagerank);
+        ASSERT_EQUAL(res, GRAPH_ERR_PARAMS);
+        params.personalization = NULL;
+        params.damping = 1;
+        res = GRAPH_pagerank(csr, NULL, &params, &pagerank);
+        ASSERT_EQUAL(res, GRAPH_ERR_PARAMS);
+        params.damping = GRAPH_PAGERANK_DEFAULT_DAMPING;
+
+        free(personalization);
+        free(scratch);
+        free(expected);
+        free(teleports);
+        (void)GRAPH_csr_destroy(csr);
+    }
+    GRAPH_pagerank_destroy(&pagerank);
+
+    return true;
+}
+
+bool test_graph_triangles() {
+    struct graph *g = NULL;
+    struct graph_csr *csr = NULL;
+    struct graph_clustering clustering;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    size_t threads[] = {1, 4};
+    bool *adjacent = NULL;
+    uint64_t *expected = NULL;
+    uint64_t seed = 99;
+    uint64_t expected_total = 0;
+    uint64_t triangle_count = 0;
+    uint64_t degree = 0;
+    double coefficient = 0;
+    size_t n = 400;
+    uint64_t i = 0;
+    uint64_t j = 0;
+    size_t d = 0;
+    size_t t = 0;
+    size_t u = 0;
+    size_t v = 0;
+    size_t w = 0;
+
+    GRAPH_clustering_init(&clustering);
+    adjacent = calloc(n * n, sizeof(*adjacent));
+    expected = malloc(sizeof(*expected) * n);
+    ASSERT_TRUE((NULL != adjacent) && (NULL != expected));
+    for (d = 0; d < 2; d++) {
+        /* Random edges (with self loops and both directions), a hub linked to everyone and a clique. */
+        res = GRAPH_init(1 == d, &g);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        for (i = 0; i < n; i++) {
+            res = GRAPH_add_vertex(g, i);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        }
+        for (i = 0; i < 2000; i++) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            (void)GRAPH_add_edge(g, (seed >> 20) % n, (seed >> 40) % n, 1);
+        }
+        for (i = 1; i < n; i++) {
+            (void)GRAPH_add_edge(g, (0 == (i % 2)) ? 0 : i, (0 == (i % 2)) ? i : 0, 1);
+        }
+        for (i = 300; i < 320; i++) {
+            for (j = i + 1; j < 320; j++) {
+                (void)GRAPH_add_edge(g, i, j, 1);
+            }
+        }
+        res = GRAPH_freeze(g, 2, &csr);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        (void)GRAPH_destroy(g);
+        ASSERT_EQUAL(csr->vertex_count, n);
+
+        /* The reference: the adjacency matrix of the simple undirected graph. */
+        (void)memset(adjacent, 0, sizeof(*adjacent) * n * n);
+        for (v = 0; v < n; v++) {
+            for (i = csr->offsets[v]; i < csr->offsets[v + 1]; i++) {
+                if (csr->targets[i] != v) {
+                    adjacent[(v * n) + csr->targets[i]] = true;
+                    adjacent[(csr->targets[i] * n) + v] = true;
+                }
+            }
+        }
+        (void)memset(expected, 0, sizeof(*expected) * n);
+        expected_total = 0;
+        for (u = 0; u < n; u++) {
+            for (v = u + 1; v < n; v++) {
+                if (!adjacent[(u * n) + v]) {
+                    continue;
+                }
+                for (w = v + 1; w < n; w++) {
+                    if (adjacent[(u * n) + w] && adjacent[(v * n) + w]) {
+                        expected[u]++;
+                        expected[v]++;
+                        expected[w]++;
+                        expected_total++;
+                    }
+                }
+            }
+        }
+        ASSERT_TRUE(expected_total > 1140);
+
+        for (t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            res = GRAPH_count_triangles(csr, threads[t], &triangle_count);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            ASSERT_EQUAL(triangle_count, expected_total);
+
+            res = GRAPH_clustering_coefficients(csr, threads[t], &clustering);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            ASSERT_EQUAL(clustering.triangle_count, expected_total);
+            for (v = 0; v < n; v++) {
+                ASSERT_EQUAL(clustering.triangles[v], expected[v]);
+                degree = 0;
+                for (u = 0; u < n; u++) {
+                    degree += adjacent[(v * n) + u];
+                }
+                coefficient = (degree < 2) ? 0 : ((2.0 * (double)expected[v]) / (double)(degree * (degree - 1)));
+                ASSERT_TRUE((clustering.coefficients[v] - coefficient < 1e-12) &&
+                            (coefficient - clustering.coefficients[v] < 1e-12));
+            }
+            ASSERT_TRUE(clustering.average_coefficient > 0);
+        }
+        (void)GRAPH_csr_destroy(csr);
+    }
+    free(expected);
+    free(adjacent);
+    GRAPH_clustering_destroy(&clustering);
+
+    return true;
+}
+
+bool test_graph_all_pairs_shortest_paths() {
+    struct graph *g = NULL;
+    double **distances = NULL;
+    double **expected = NULL;
+    uint64_t *ids = NULL;
+    uint64_t *expected_ids = NULL;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    size_t threads[] = {1, 4};
+    uint64_t seed = 31337;
+    uint64_t s = 0;
+    uint64_t d = 0;
+    size_t size = 0;
+    size_t expected_size = 0;
+    size_t n = 150;
+    size_t i = 0;
+    size_t j = 0;
+    size_t k = 0;
+    size_t t = 0;
+
+    /* Positive weights, and negative ones out of vertex 0 which can't be on a cycle. */
+    res = GRAPH_init(true, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    for (i = 0; i < n; i++) {
+        res = GRAPH_add_vertex(g, i);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    for (i = 0; i < 900; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        s = (seed >> 20) % n;
+        d = (seed >> 40) % n;
+        if ((0 != d) && (s != d)) {
+            (void)GRAPH_add_edge(g, s, d, (double)(1 + ((seed >> 8) % 20)));
+        }
+    }
+    for (i = 1; i < n; i += 7) {
+        (void)GRAPH_add_edge(g, 0, i, -7);
+    }
+
+    /* The reference: the plain triple loop. */
+    res = GRAPH_get_adjecency_matrix_ex(g, 1, &expected, &expected_size, &expected_ids);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(expected_size, n);
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) {
+            if (-1 == expected[i][j]) {
+                expected[i][j] = GRAPH_DISTANCE_INFINITY;
+            }
+        }
+        expected[i][i] = 0;
+    }
+    for (k = 0; k < n; k++) {
+        for (i = 0; i < n; i++) {
+            for (j = 0; j < n; j++) {
+                if ((GRAPH_DISTANCE_INFINITY != expected[i][k]) && (GRAPH_DISTANCE_INFINITY != expected[k][j]) &&
+                    ((expected[i][k] + expected[k][j]) < expected[i][j])) {
+                    expected[i][j] = expected[i][k] + expected[k][j];
+                }
+            }
+        }
+    }
+
+    for (t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        res = GRAPH_all_pairs_shortest_paths(g, threads[t], &distances, &size, &ids);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_EQUAL(size, n);
+        for (i = 0; i < n; i++) {
+            ASSERT_EQUAL(ids[i], expected_ids[i]);
+            for (j = 0; j < n; j++) {
+                ASSERT_TRUE(distances[i][j] == expected[i][j]);
+            }
+        }
+        (void)GRAPH_free_adjecency_matrix(g, distances);
+        free(ids);
+    }
+
+    (void)GRAPH_free_adjecency_matrix(g, expected);
+    free(expected_ids);
+    (void)GRAPH_destroy(g);
+
+    return true;
+}
+
+/**
+ * @brief   An undirected edge of the Kruskal reference.
+ */
+struct test_edge {
+    double weight;
+    graph_index_t low;
+    graph_index_t high;
+};
+
+static int compare_test_edges(const void *a, const void *b) {
+    const struct test_edge *first = a;
+    const struct test_edge *second = b;
+
+    if (first->weight != second->weight) {
+        return (first->weight < second->weight) ? -1 : 1;
+    }
+    if (first->low != second->low) {
+        return (first->low < second->low) ? -1 : 1;
+    }
+    return (first->high < second->high) ? -1 : (first->high > second->high);
+}
+
+static graph_index_t find_root(graph_index_t *parents, graph_index_t v) {
+    while (parents[v] != v) {
+        parents[v] = parents[parents[v]];
+        v = parents[v];
+    }
+    return v;
+}
+
+/**
+ * @brief   Sequential Kruskal, the baseline of GRAPH_minimum_spanning_forest. Returns the edges of the forest sorted.
+ */
+static size_t reference_spanning_forest(const struct graph_csr *csr, struct test_edge *edges,
+                                        struct test_edge *forest) {
+    graph_index_t *parents = malloc(sizeof(*parents) * csr->vertex_count);
+    graph_index_t low_root = 0;
+    graph_index_t high_root = 0;
+    size_t count = 0;
+    size_t chosen = 0;
+    uint64_t i = 0;
+    size_t v = 0;
+
+    for (v = 0; v < csr->vertex_count; v++) {
+        parents[v] = (graph_index_t)v;
+        for (i = csr->offsets[v]; i < csr->offsets[v + 1]; i++) {
+            if (csr->targets[i] != v) {
+                edges[count].weight = csr->weights[i];
+                edges[count].low = (csr->targets[i] < v) ? csr->targets[i] : (graph_index_t)v;
+                edges[count].high = (csr->targets[i] < v) ? (graph_index_t)v : csr->targets[i];
+                count++;
+            }
+        }
+    }
+    qsort(edges, count, sizeof(*edges), compare_test_edges);
+    for (i = 0; i < count; i++) {
+        low_root = find_root(parents, edges[i].low);
+        high_root = find_root(parents, edges[i].high);
+        if (low_root != high_root) {
+            parents[low_root] = high_root;
+            forest[chosen++] = edges[i];
+        }
+    }
+    free(parents);
+
+    return chosen;
+}
+
+bool test_graph_minimum_spanning_forest() {
+    struct graph *g = NULL;
+    struct graph_csr *csr = NULL;
+    struct graph_spanning_forest forest;
+    struct test_edge *edges = NULL;
+    struct test_edge *expected = NULL;
+    struct test_edge *found = NULL;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    size_t threads[] = {1, 4};
+    uint64_t seed = 2024;
+    size_t expected_count = 0;
+    size_t n = 20000;
+    uint64_t i = 0;
+    size_t d = 0;
+    size_t t = 0;
+
+    GRAPH_spanning_forest_init(&forest);
+    for (d = 0; d < 2; d++) {
+        /* Few distinct weights so ties are common, a few separate chains, self loops and isolated vertices. */
+        res = GRAPH_init(1 == d, &g);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        for (i = 0; i < n; i++) {
+            res = GRAPH_add_vertex(g, i);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        }
+        for (i = 0; i < 60000; i++) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            (void)GRAPH_add_edge(g, (seed >> 20) % 18000, (seed >> 40) % 18000, (double)((seed >> 8) % 8));
+        }
+        for (i = 18000; i < 19900; i++) {
+            (void)GRAPH_add_edge(g, i, (0 == (i % 100)) ? i : (i + 1), (double)(i % 5));
+        }
+        res = GRAPH_freeze(g, 2, &csr);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        (void)GRAPH_destroy(g);
+
+        edges = malloc(sizeof(*edges) * (csr->edge_count + 1));
+        expected = malloc(sizeof(*expected) * n);
+        found = malloc(sizeof(*found) * n);
+        ASSERT_TRUE((NULL != edges) && (NULL != expected) && (NULL != found));
+        expected_count = reference_spanning_forest(csr, edges, expected);
+
+        for (t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            res = GRAPH_minimum_spanning_forest(csr, threads[t], &forest);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            ASSERT_EQUAL(forest.edge_count, expected_count);
+            ASSERT_EQUAL(forest.tree_count, n - expected_count);
+
+            /* Ties are broken the same way, so it is the very same forest. */
+            for (i = 0; i < forest.edge_count; i++) {
+                found[i].weight = forest.weights[i];
+                found[i].low = (forest.sources[i] < forest.targets[i]) ? forest.sources[i] : forest.targets[i];
+                found[i].high = (forest.sources[i] < forest.targets[i]) ? forest.targets[i] : forest.sources[i];
+            }
+            qsort(found, forest.edge_count, sizeof(*found), compare_test_edges);
+            ASSERT_EQUAL(memcmp(found, expected, sizeof(*found) * expected_count), 0);
+        }
+        ASSERT_TRUE(forest.tree_count > 100);
+        ASSERT_TRUE(forest.total_weight > 0);
+
+        free(found);
+        free(expected);
+        free(edges);
+        (void)GRAPH_csr_destroy(csr);
+    }
+    GRAPH_spanning_forest_destroy(&forest);
+
+    return true;
+}
+
+bool test_graph_strongly_connected_components() {
+    struct graph *g = NULL;
+    struct graph *condensation = NULL;
+    struct graph_csr *csr = NULL;
+    struct graph_csr *transpose = NULL;
+    struct graph_csr *condensed = NULL;
+    struct graph_scc scc;
+    struct graph_scc other;
+    struct graph_bfs forward;
+    struct graph_bfs backward;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    size_t threads[] = {1, 4};
+    uint64_t seed = 5150;
+    size_t n = 600;
+    size_t deep = 300000;
+    size_t total = 0;
+    double weight = 0;
+    uint64_t i = 0;
+    size_t t = 0;
+    size_t u = 0;
+    size_t v = 0;
+
+    GRAPH_scc_init(&scc);
+    GRAPH_scc_init(&other);
+    GRAPH_bfs_init(&forward);
+    GRAPH_bfs_init(&backward);
+
+    /* Random sparse edges, a few planted cycles and a trimmable tail. */
+    res = GRAPH_init(true, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    for (i = 0; i < n; i++) {
+        res = GRAPH_add_vertex(g, i);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    for (i = 0; i < 700; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        (void)GRAPH_add_edge(g, (seed >> 20) % 500, (seed >> 40) % 500, (double)((seed >> 8) % 10));
+    }
+    for (i = 500; i < 560; i++) {
+        (void)GRAPH_add_edge(g, i, (9 == (i % 10)) ? (i - 9) : (i + 1), 1);
+    }
+    for (i = 560; i < n - 1; i++) {
+        (void)GRAPH_add_edge(g, i, i + 1, 1);
+    }
+    res = GRAPH_freeze(g, 2, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    (void)GRAPH_destroy(g);
+    res = GRAPH_csr_transpose(csr, &transpose);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    res = GRAPH_strongly_connected_components(csr, NULL, GRAPH_SCC_TARJAN, 1, &scc);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(scc.labels[0], 0);
+    total = 0;
+    for (i = 0; i < scc.component_count; i++) {
+        total += scc.sizes[i];
+    }
+    ASSERT_EQUAL(total, n);
+    ASSERT_TRUE(scc.component_count > 100);
+
+    /* The reference: two vertices share a component when each reaches the other. */
+    for (v = 0; v < n; v++) {
+        res = GRAPH_bfs(csr, NULL, (graph_index_t)v, 1, &forward);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        res = GRAPH_bfs(transpose, NULL, (graph_index_t)v, 1, &backward);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        for (u = 0; u < n; u++) {
+            ASSERT_EQUAL(scc.labels[u] == scc.labels[v],
+                         (GRAPH_BFS_UNREACHED != forward.levels[u]) && (GRAPH_BFS_UNREACHED != backward.levels[u]));
+        }
+    }
+
+    for (t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        res = GRAPH_strongly_connected_components(csr, (0 == t) ? NULL : transpose, GRAPH_SCC_COLORING, threads[t],
+                                                  &other);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_EQUAL(other.component_count, scc.component_count);
+        ASSERT_EQUAL(memcmp(other.labels, scc.labels, sizeof(*scc.labels) * n), 0);
+    }
+
+    /* The condensation has a vertex per component, the lightest edges between them and no cycles. */
+    res = GRAPH_condensation(csr, &scc, &condensation);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_freeze(condensation, 1, &condensed);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(condensed->vertex_count, scc.component_count);
+    for (v = 0; v < n; v++) {
+        for (i = csr->offsets[v]; i < csr->offsets[v + 1]; i++) {
+            if (scc.labels[v] == scc.labels[csr->targets[i]]) {
+                continue;
+            }
+            res = GRAPH_get_edge_weight(condensation, scc.labels[v], scc.labels[csr->targets[i]], &weight);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            ASSERT_TRUE(weight <= csr->weights[i]);
+        }
+    }
+    res = GRAPH_strongly_connected_components(condensed, NULL, GRAPH_SCC_TARJAN, 1, &other);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(other.component_count, condensed->vertex_count);
+    (void)GRAPH_csr_destroy(condensed);
+    (void)GRAPH_destroy(condensation);
+    (void)GRAPH_csr_destroy(transpose);
+    (void)GRAPH_csr_destroy(csr);
+
+    /* A deep graph: a long chain closed into a cycle, followed by a long chain. */
+    res = GRAPH_init(true, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    for (i = 0; i < 2 * deep; i++) {
+        res = GRAPH_add_vertex(g, i);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    for (i = 0; i < (2 * deep) - 1; i++) {
+        (void)GRAPH_add_edge(g, i, i + 1, 1);
+    }
+    (void)GRAPH_add_edge(g, deep - 1, 0, 1);
+    res = GRAPH_freeze(g, 2, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    (void)GRAPH_destroy(g);
+    res = GRAPH_strongly_connected_components(csr, NULL, GRAPH_SCC_TARJAN, 1, &scc);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(scc.component_count, deep + 1);
+    ASSERT_EQUAL(scc.sizes[0], deep);
+    ASSERT_EQUAL(scc.labels[deep - 1], 0);
+    ASSERT_EQUAL(scc.labels[(2 * deep) - 1], deep);
+    (void)GRAPH_csr_destroy(csr);
+
+    GRAPH_bfs_destroy(&backward);
+    GRAPH_bfs_destroy(&forward);
+    GRAPH_scc_destroy(&other);
+    GRAPH_scc_destroy(&scc);
+
+    return true;
+}
+
+/**
+ * @brief   The Manhattan distance between two cells of a grid whose ids are y * width + x, never more than the
+ *          real distance when every step weighs at least 1.
+ */
+static double grid_heuristic(graph_index_t vertex, graph_index_t target, void *ctx) {
+    const struct graph_csr *csr = ctx;
+    uint64_t width = 40;
+    uint64_t a = csr->ids[vertex];
+    uint64_t b = csr->ids[target];
+    uint64_t dx = (a % width > b % width) ? (a % width - b % width) : (b % width - a % width);
+    uint64_t dy = (a / width > b / width) ? (a / width - b / width) : (b / width - a / width);
+
+    return (double)(dx + dy);
+}
+
+/**
+ * @brief   Checks that the path of a query joins the source and the target through edges summing up to its distance.
+ */
+static bool check_query_path(const struct graph_csr *csr, const struct graph_path_query *query,
+                             graph_index_t source, graph_index_t target) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    double length = 0;
+    double weight = 0;
+    size_t i = 0;
+
+    if (GRAPH_DISTANCE_INFINITY == query->distance) {
+        return 0 == query->path_length;
+    }
+    if ((0 == query->path_length) || (source != query->path[0]) || (target != query->path[query->path_length - 1])) {
+        return false;
+    }
+    for (i = 1; i < query->path_length; i++) {
+        res = GRAPH_csr_get_edge_weight(csr, csr->ids[query->path[i - 1]], csr->ids[query->path[i]], &weight);
+        if (GRAPH_ERR_SUCCESS != res) {
+            return false;
+        }
+        length += weight;
+    }
+
+    return length == query->distance;
+}
+
+bool test_graph_shortest_path() {
+    struct graph *g = NULL;
+    struct graph_csr *csr = NULL;
+    struct graph_csr *transpose = NULL;
+    struct graph_path_query query;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    double *expected = NULL;
+    uint64_t seed = 4242;
+    size_t width = 40;
+    size_t guided = 0;
+    size_t blind = 0;
+    uint64_t i = 0;
+    uint64_t source = 0;
+    uint64_t target = 0;
+
+    GRAPH_path_query_init(&query);
+
+    /* A random directional graph, against Bellman-Ford, with one context for all the queries. */
+    res = GRAPH_init(true, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    for (i = 0; i < 2000; i++) {
+        res = GRAPH_add_vertex(g, i);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    for (i = 0; i < 5000; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        (void)GRAPH_add_edge(g, (seed >> 33) % 2000, (seed >> 13) % 2000, (double)((seed >> 50) % 20));
+    }
+    res = GRAPH_freeze(g, 1, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_csr_transpose(csr, &transpose);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    expected = malloc(sizeof(*expected) * csr->vertex_count);
+    ASSERT_TRUE(NULL != expected);
+
+    for (source = 0; source < 2000; source += 397) {
+        reference_distances(csr, (graph_index_t)source, expected);
+        for (target = 3; target < 2000; target += 131) {
+            res = GRAPH_shortest_path(csr, transpose, (graph_index_t)source, (graph_index_t)target,
+                                      GRAPH_PATH_BIDIRECTIONAL, NULL, NULL, &query);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            ASSERT_EQUAL(query.distance, expected[target]);
+            ASSERT_TRUE(check_query_path(csr, &query, (graph_index_t)source, (graph_index_t)target));
+
+            res = GRAPH_shortest_path(csr, NULL, (graph_index_t)source, (graph_index_t)target, GRAPH_PATH_ASTAR,
+                                      NULL, NULL, &query);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            ASSERT_EQUAL(query.distance, expected[target]);
+            ASSERT_TRUE(check_query_path(csr, &query, (graph_index_t)source, (graph_index_t)target));
+        }
+
+        /* A path from a vertex to itself is the vertex alone. */
+        res = GRAPH_shortest_path(csr, transpose, (graph_index_t)source, (graph_index_t)source,
+                                  GRAPH_PATH_BIDIRECTIONAL, NULL, NULL, &query);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_EQUAL(query.distance, 0);
+        ASSERT_EQUAL(query.path_length, 1);
+    }
+
+    /* The stamp wrapping around doesn't let a stale state through. */
+    query.stamp = UINT32_MAX;
+    res = GRAPH_shortest_path(csr, transpose, 0, 1999, GRAPH_PATH_BIDIRECTIONAL, NULL, NULL, &query);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    reference_distances(csr, 0, expected);
+    ASSERT_EQUAL(query.distance, expected[1999]);
+    ASSERT_TRUE(check_query_path(csr, &query, 0, 1999));
+
+    /* The backward search of a directional snapshot needs its transpose. */
+    res = GRAPH_shortest_path(csr, NULL, 0, 1999, GRAPH_PATH_BIDIRECTIONAL, NULL, NULL, &query);
+    ASSERT_EQUAL(res, GRAPH_ERR_PARAMS);
+    res = GRAPH_shortest_path(csr, transpose, 0, 2000, GRAPH_PATH_BIDIRECTIONAL, NULL, NULL, &query);
+    ASSERT_EQUAL(res, GRAPH_ERR_PARAMS);
+    (void)GRAPH_csr_destroy(transpose);
+    (void)GRAPH_csr_destroy(csr);
+    (void)GRAPH_destroy(g);
+
+    /* An undirectional grid with steps of 1 to 3: the Manhattan distance guides A* without losing the path. */
+    res = GRAPH_init(false, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    for (i = 0; i < width * width; i++) {
+        res = GRAPH_add_vertex(g, i);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    for (i = 0; i < width * width; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        if (width - 1 != i % width) {
+            res = GRAPH_add_edge(g, i, i + 1, (double)(1 + ((seed >> 40) % 3)));
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        }
+        if (i + width < width * width) {
+            res = GRAPH_add_edge(g, i, i + width, (double)(1 + ((seed >> 50) % 3)));
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        }
+    }
+    res = GRAPH_freeze(g, 1, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    for (source = 0; source < width * width; source += 263) {
+        reference_distances(csr, (graph_index_t)source, expected);
+        for (target = 7; target < width * width; target += 101) {
+            res = GRAPH_shortest_path(csr, NULL, (graph_index_t)source, (graph_index_t)target,
+                                      GRAPH_PATH_BIDIRECTIONAL, NULL, NULL, &query);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            ASSERT_EQUAL(query.distance, expected[target]);
+            ASSERT_TRUE(check_query_path(csr, &query, (graph_index_t)source, (graph_index_t)target));
+
+            res = GRAPH_shortest_path(csr, NULL, (graph_index_t)source, (graph_index_t)target, GRAPH_PATH_ASTAR,
+                                      NULL, NULL, &query);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            ASSERT_EQUAL(query.distance, expected[target]);
+            blind += query.settled_count;
+
+            res = GRAPH_shortest_path(csr, NULL, (graph_index_t)source, (graph_index_t)target, GRAPH_PATH_ASTAR,
+                                      grid_heuristic, csr, &query);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            ASSERT_EQUAL(query.distance, expected[target]);
+            ASSERT_TRUE(check_query_path(csr, &query, (graph_index_t)source, (graph_index_t)target));
+            guided += query.settled_count;
+        }
+    }
+    ASSERT_TRUE(guided < blind);
+    (void)GRAPH_csr_destroy(csr);
+
+    /* Unreachable targets and negative weights. */
+    res = GRAPH_add_vertex(g, width * width);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_freeze(g, 1, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_shortest_path(csr, NULL, 0, (graph_index_t)(width * width), GRAPH_PATH_BIDIRECTIONAL, NULL, NULL,
+                              &query);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(query.distance, GRAPH_DISTANCE_INFINITY);
+    ASSERT_EQUAL(query.path_length, 0);
+    res = GRAPH_shortest_path(csr, NULL, 0, (graph_index_t)(width * width), GRAPH_PATH_ASTAR, NULL, NULL, &query);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(query.distance, GRAPH_DISTANCE_INFINITY);
+    ASSERT_EQUAL(query.path_length, 0);
+    (void)GRAPH_csr_destroy(csr);
+    (void)GRAPH_remove_edge(g, 0, 1);
+    res = GRAPH_add_edge(g, 0, 1, -1);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_freeze(g, 1, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_shortest_path(csr, NULL, 0, (graph_index_t)(width * width - 1), GRAPH_PATH_ASTAR, NULL, NULL,
+                              &query);
+    ASSERT_EQUAL(res, GRAPH_ERR_PARAMS);
+    ASSERT_EQUAL(query.distance, GRAPH_DISTANCE_INFINITY);
+
+    GRAPH_path_query_destroy(&query);
+    free(expected);
+    (void)GRAPH_csr_destroy(csr);
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    return true;
+}
+
+/**
+ * @brief   Checks that queries of a contraction hierarchy find the distances of Dijkstra, with valid paths, while
+ *          settling fewer vertices overall.
+ */
+static bool check_ch_queries(const struct graph_csr *csr, const struct graph_ch *ch, struct graph_path_query *query,
+                             struct graph_sssp *sssp) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    size_t ch_settled = 0;
+    size_t dijkstra_settled = 0;
+    size_t i = 0;
+    uint64_t source = 0;
+    uint64_t target = 0;
+
+    for (source = 0; source < csr->vertex_count; source += 97) {
+        res = GRAPH_sssp_dijkstra(csr, (graph_index_t)source, GRAPH_INDEX_NONE, GRAPH_SSSP_QUEUE_DARY_HEAP, sssp);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        for (target = 5; target < csr->vertex_count; target += 61) {
+            res = GRAPH_ch_query(ch, (graph_index_t)source, (graph_index_t)target, true, query);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            ASSERT_EQUAL(query->distance, sssp->distances[target]);
+            ASSERT_TRUE(check_query_path(csr, query, (graph_index_t)source, (graph_index_t)target));
+            ch_settled += query->settled_count;
+
+            res = GRAPH_ch_query(ch, (graph_index_t)source, (graph_index_t)target, false, query);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            ASSERT_EQUAL(query->distance, sssp->distances[target]);
+            ASSERT_EQUAL(query->path_length, 0);
+
+            res = GRAPH_shortest_path(csr, NULL, (graph_index_t)source, (graph_index_t)target, GRAPH_PATH_ASTAR, NULL,
+                                      NULL, query);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            dijkstra_settled += query->settled_count;
+        }
+    }
+    for (i = 0; i < csr->vertex_count; i++) {
+        ASSERT_TRUE(ch->ranks[i] < csr->vertex_count);
+    }
+    ASSERT_TRUE(ch_settled < dijkstra_settled);
+
+    return true;
+}
+
+bool test_graph_contraction_hierarchy() {
+    char path[] = "/tmp/libgraph_sanity_XXXXXX";
+    struct graph *g = NULL;
+    struct graph_csr *csr = NULL;
+    struct graph_csr *loaded = NULL;
+    struct graph_ch *ch = NULL;
+    struct graph_ch *other = NULL;
+    struct graph_path_query query;
+    struct graph_sssp sssp;
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    graph_index_t index = 0;
+    FILE *file = NULL;
+    uint64_t seed = 8080;
+    size_t width = 30;
+    uint64_t i = 0;
+    int fd = -1;
+
+    fd = mkstemp(path);
+    ASSERT_TRUE(fd >= 0);
+    (void)close(fd);
+    GRAPH_path_query_init(&query);
+    GRAPH_sssp_init(&sssp);
+
+    /* An undirectional grid with a few long roads. */
+    res = GRAPH_init(false, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    for (i = 0; i < width * width; i++) {
+        res = GRAPH_add_vertex(g, i * 2);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    for (i = 0; i < width * width; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        if (width - 1 != i % width) {
+            (void)GRAPH_add_edge(g, i * 2, (i + 1) * 2, (double)(1 + ((seed >> 40) % 9)));
+        }
+        if (i + width < width * width) {
+            (void)GRAPH_add_edge(g, i * 2, (i + width) * 2, (double)(1 + ((seed >> 50) % 9)));
+        }
+        if (0 == (seed >> 30) % 16) {
+            (void)GRAPH_add_edge(g, i * 2, ((seed >> 10) % (width * width)) * 2, (double)(20 + ((seed >> 20) % 30)));
+        }
+    }
+    res = GRAPH_freeze(g, 1, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    (void)GRAPH_destroy(g);
+
+    res = GRAPH_ch_build(csr, 1, &ch);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_TRUE(check_ch_queries(csr, ch, &query, &sssp));
+
+    /* The hierarchy doesn't depend on the amount of threads. */
+    res = GRAPH_ch_build(csr, 4, &other);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(other->forward.arc_count, ch->forward.arc_count);
+    ASSERT_EQUAL(other->shortcut_count, ch->shortcut_count);
+    ASSERT_EQUAL(0, memcmp(other->ranks, ch->ranks, sizeof(*ch->ranks) * ch->vertex_count));
+    (void)GRAPH_ch_destroy(other);
+
+    /* A saved hierarchy is mapped back and answers the same. */
+    res = GRAPH_ch_save(ch, path);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_ch_load_mmap(path, GRAPH_LOAD_VERIFY, &other);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(other->vertex_count, ch->vertex_count);
+    ASSERT_EQUAL(other->shortcut_count, ch->shortcut_count);
+    ASSERT_TRUE(check_ch_queries(csr, other, &query, &sssp));
+    res = GRAPH_ch_find_index(other, 2 * 17, &index);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(index, 17);
+    res = GRAPH_ch_find_index(other, 3, &index);
+    ASSERT_EQUAL(res, GRAPH_ERR_NOT_FOUND);
+    res = GRAPH_ch_destroy(other);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    other = NULL;
+
+    /* A corrupted payload is only caught when verifying. */
+    file = fopen(path, "r+b");
+    ASSERT_TRUE(NULL != file);
+    ASSERT_EQUAL(0, fseek(file, -8, SEEK_END));
+    ASSERT_EQUAL(EOF != fputc(0x5a, file), true);
+    ASSERT_EQUAL(0, fclose(file));
+    res = GRAPH_ch_load_mmap(path, GRAPH_LOAD_VERIFY, &other);
+    ASSERT_EQUAL(res, GRAPH_ERR_FORMAT);
+
+    /* Neither file format passes for the other. */
+    res = GRAPH_load_mmap(path, 0, &loaded);
+    ASSERT_EQUAL(res, GRAPH_ERR_FORMAT);
+    res = GRAPH_csr_save(csr, path);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_ch_load_mmap(path, 0, &other);
+    ASSERT_EQUAL(res, GRAPH_ERR_FORMAT);
+    (void)unlink(path);
+    (void)GRAPH_ch_destroy(ch);
+    (void)GRAPH_csr_destroy(csr);
+
+    /* A directional graph, with parallel and self loops, and vertices only reached one way. */
+    res = GRAPH_init(true, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    for (i = 0; i < 800; i++) {
+        res = GRAPH_add_vertex(g, i);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    for (i = 0; i < 2000; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        (void)GRAPH_add_edge(g, (seed >> 33) % 800, (seed >> 13) % 800, (double)((seed >> 50) % 20));
+    }
+    res = GRAPH_freeze(g, 2, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_ch_build(csr, 0, &ch);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_TRUE(check_ch_queries(csr, ch, &query, &sssp));
+    (void)GRAPH_ch_destroy(ch);
+    (void)GRAPH_csr_destroy(csr);
+
+    /* Negative weights are refused. */
+    (void)GRAPH_remove_edge(g, 0, 1);
+    res = GRAPH_add_edge(g, 0, 1, -1);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_freeze(g, 1, &csr);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_ch_build(csr, 1, &ch);
+    ASSERT_EQUAL(res, GRAPH_ERR_PARAMS);
+
+    GRAPH_path_query_destroy(&query);
+    GRAPH_sssp_destroy(&sssp);
+    (void)GRAPH_csr_destroy(csr);
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    return true;
+}
+
+#define READ_TEST_VERTICES  (64)
+#define READ_TEST_READERS   (3)
+
+struct read_test_ctx {
+    struct graph *g;
+    bool is_stopping;
+    bool is_failed;
+    size_t sections;
+};
+
+static void *read_test_reader(void *arg) {
+    struct read_test_ctx *ctx = arg;
+    struct graph_reader reader;
+    struct graph_vertex *v = NULL;
+    struct graph_edge *e = NULL;
+    size_t sections = 0;
+
+    if (GRAPH_ERR_SUCCESS != GRAPH_reader_register(ctx->g, &reader)) {
+        __atomic_store_n(&ctx->is_failed, true, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    while (!__atomic_load_n(&ctx->is_stopping, __ATOMIC_RELAXED)) {
+        (void)GRAPH_read_begin(ctx->g, &reader);
+        GRAPH_READ_FOREACH(v, &ctx->g->vertices, next) {
+            GRAPH_READ_FOREACH(e, &v->neighbors, next) {
+                /* A removed edge must still read as it was in the graph, the writer weighs each edge s + d. */
+                if ((e->s != v) || (e->s_id != v->id) || (e->d->id != e->d_id) ||
+                    (e->weight != (double)(e->s_id + e->d_id))) {
+                    __atomic_store_n(&ctx->is_failed, true, __ATOMIC_RELAXED);
+                }
+            }
+            GRAPH_READ_FOREACH(e, &v->in_neighbors, in_next) {
+                if ((e->d != v) || (e->d_id != v->id) || (e->s->id != e->s_id)) {
+                    __atomic_store_n(&ctx->is_failed, true, __ATOMIC_RELAXED);
+                }
+            }
+        }
+        (void)GRAPH_read_end(ctx->g, &reader);
+        sections++;
+    }
+
+    (void)GRAPH_reader_unregister(ctx->g, &reader);
+    __atomic_fetch_add(&ctx->sections, sections, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static bool check_concurrent_reads(bool is_directional) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct read_test_ctx ctx;
+    pthread_t readers[READ_TEST_READERS];
+    bool *shadow = NULL;
+    bool has_edge = false;
+    uint64_t seed = 4242;
+    uint64_t s = 0;
+    uint64_t d = 0;
+    size_t i = 0;
+
+    ctx.g = NULL;
+    ctx.is_stopping = false;
+    ctx.is_failed = false;
+    ctx.sections = 0;
+    shadow = calloc(READ_TEST_VERTICES * READ_TEST_VERTICES, sizeof(*shadow));
+    ASSERT_TRUE(NULL != shadow);
+
+    res = GRAPH_init(is_directional, &ctx.g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    for (i = 0; i < READ_TEST_VERTICES; ++i) {
+        res = GRAPH_add_vertex(ctx.g, i);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    res = GRAPH_enable_concurrent_reads(ctx.g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    for (i = 0; i < READ_TEST_READERS; ++i) {
+        ASSERT_EQUAL(pthread_create(&readers[i], NULL, read_test_reader, &ctx), 0);
+    }
+
+    /* Flip random edges, and now and then drop a vertex with all its edges and bring it back. */
+    for (i = 0; i < 40000; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        s = (seed >> 33) % READ_TEST_VERTICES;
+        d = (seed >> 13) % READ_TEST_VERTICES;
+        if (0 == ((seed >> 50) % 500)) {
+            res = GRAPH_remove_vertex(ctx.g, s);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            for (d = 0; d < READ_TEST_VERTICES; ++d) {
+                shadow[s * READ_TEST_VERTICES + d] = false;
+                shadow[d * READ_TEST_VERTICES + s] = false;
+            }
+            res = GRAPH_add_vertex(ctx.g, s);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        } else if (shadow[s * READ_TEST_VERTICES + d]) {
+            res = GRAPH_remove_edge(ctx.g, s, d);
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            shadow[s * READ_TEST_VERTICES + d] = false;
+            shadow[d * READ_TEST_VERTICES + s] = is_directional && shadow[d * READ_TEST_VERTICES + s];
+        } else {
+            res = GRAPH_add_edge(ctx.g, s, d, (double)(s + d));
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            shadow[s * READ_TEST_VERTICES + d] = true;
+            shadow[d * READ_TEST_VERTICES + s] = (!is_directional) || shadow[d * READ_TEST_VERTICES + s];
+        }
+    }
+
+    __atomic_store_n(&ctx.is_stopping, true, __ATOMIC_RELAXED);
+    for (i = 0; i < READ_TEST_READERS; ++i) {
+        ASSERT_EQUAL(pthread_join(readers[i], NULL), 0);
+    }
+    ASSERT_TRUE(!ctx.is_failed);
+    ASSERT_TRUE(ctx.sections > 0);
+
+    /* Everything removed goes back to the pools once no read section can hold it. */
+    res = GRAPH_synchronize(ctx.g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(ctx.g->epoch.retired_count, 0);
+
+    for (i = 0; i < READ_TEST_VERTICES * READ_TEST_VERTICES; ++i) {
+        res = GRAPH_has_edge(ctx.g, i / READ_TEST_VERTICES, i % READ_TEST_VERTICES, &has_edge);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_EQUAL(has_edge, shadow[i]);
+    }
+
+    res = GRAPH_destroy(ctx.g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    free(shadow);
+
+    return true;
+}
+
+bool test_graph_concurrent_reads() {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct graph *g = NULL;
+    struct graph_reader reader;
+
+    /* Readers can only register once concurrent reads are enabled. */
+    res = GRAPH_init(false, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_reader_register(g, &reader);
+    ASSERT_EQUAL(res, GRAPH_ERR_PARAMS);
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+
+    ASSERT_TRUE(check_concurrent_reads(false));
+    ASSERT_TRUE(check_concurrent_reads(true));
+
+    return true;
+}
+
+#define WRITE_TEST_THREADS  (8)
+#define WRITE_TEST_VERTICES (2000)
+#define WRITE_TEST_EDGES    (20000)
+
+struct write_test_ctx {
+    struct graph *g;
+
+    /* The edge k goes from k % V to (k % V) + 97 * (1 + k / V), no two edges share a pair in either direction. */
+    uint64_t s_ids[WRITE_TEST_EDGES];
+    uint64_t d_ids[WRITE_TEST_EDGES];
+
+    /* The results of the phase, summed over the threads. */
+    size_t succeeded;
+    size_t failed;
+    bool is_failed;
+};
+
+struct write_test_thread {
+    struct write_test_ctx *ctx;
+    size_t id;
+    void *(*phase)(struct write_test_ctx *ctx, size_t id);
+};
+
+/* Every item is owned by two threads, which race on it. */
+static bool write_test_owns(size_t item, size_t id) {
+    return ((item % WRITE_TEST_THREADS) == id) || ((item % WRITE_TEST_THREADS) == ((id + 1) % WRITE_TEST_THREADS));
+}
+
+static void write_test_count(struct write_test_ctx *ctx, graph_res_t res, graph_res_t expected_failure) {
+    if (GRAPH_ERR_SUCCESS == res) {
+        __atomic_fetch_add(&ctx->succeeded, 1, __ATOMIC_RELAXED);
+    } else if (expected_failure == res) {
+        __atomic_fetch_add(&ctx->failed, 1, __ATOMIC_RELAXED);
+    } else {
+        __atomic_store_n(&ctx->is_failed, true, __ATOMIC_RELAXED);
+    }
+}
+
+static void *write_test_add_vertices(struct write_test_ctx *ctx, size_t id) {
+    size_t i = 0;
+
+    for (i = 0; i < WRITE_TEST_VERTICES; ++i) {
+        if (write_test_owns(i, id)) {
+            write_test_count(ctx, GRAPH_add_vertex(ctx->g, i), GRAPH_ERR_FOUND);
+        }
+    }
+
+    return NULL;
+}
+
+static void *write_test_add_edges(struct write_test_ctx *ctx, size_t id) {
+    bool is_reversed = false;
+    bool has_edge = false;
+    double weight = 0;
+    size_t k = 0;
+
+    for (k = 0; k < WRITE_TEST_EDGES; ++k) {
+        if (!write_test_owns(k, id)) {
+            continue;
+        }
+
+        /* In an undirectional graph the second owner adds the edge the other way around, locking in reverse. */
+        is_reversed = (!ctx->g->is_directional) && ((k % WRITE_TEST_THREADS) != id);
+        if (is_reversed) {
+            write_test_count(ctx, GRAPH_add_edge(ctx->g, ctx->d_ids[k], ctx->s_ids[k], (double)k), GRAPH_ERR_FOUND);
+        } else {
+            write_test_count(ctx, GRAPH_add_edge(ctx->g, ctx->s_ids[k], ctx->d_ids[k], (double)k), GRAPH_ERR_FOUND);
+        }
+
+        /* Either way the edge is in by now. */
+        if ((GRAPH_ERR_SUCCESS != GRAPH_has_edge(ctx->g, ctx->s_ids[k], ctx->d_ids[k], &has_edge)) || (!has_edge) ||
+            (GRAPH_ERR_SUCCESS != GRAPH_get_edge_weight(ctx->g, ctx->s_ids[k], ctx->d_ids[k], &weight)) ||
+            (weight != (double)k)) {
+            __atomic_store_n(&ctx->is_failed, true, __ATOMIC_RELAXED);
+        }
+    }
+
+    return NULL;
+}
+
+static void *write_test_remove(struct write_test_ctx *ctx, size_t id) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    size_t k = 0;
+
+    for (k = 0; k < WRITE_TEST_EDGES; ++k) {
+        /* Drop every 50th vertex (once) along the way, the edges it takes with it race the removals below. */
+        if ((k < WRITE_TEST_VERTICES) && (0 == (k % 50)) && (((k / 50) % WRITE_TEST_THREADS) == id)) {
+            write_test_count(ctx, GRAPH_remove_vertex(ctx->g, k), GRAPH_ERR_NOT_FOUND);
+        }
+
+        if ((0 == (k % 2)) && write_test_owns(k, id)) {
+            res = GRAPH_remove_edge(ctx->g, ctx->s_ids[k], ctx->d_ids[k]);
+            write_test_count(ctx, res, GRAPH_ERR_NOT_FOUND);
+        }
+    }
+
+    return NULL;
+}
+
+static void *write_test_thread_main(void *arg) {
+    struct write_test_thread *thread = arg;
+
+    return thread->phase(thread->ctx, thread->id);
+}
+
+static bool run_write_test_phase(struct write_test_ctx *ctx, void *(*phase)(struct write_test_ctx *ctx, size_t id)) {
+    struct write_test_thread threads[WRITE_TEST_THREADS];
+    pthread_t handles[WRITE_TEST_THREADS];
+    size_t i = 0;
+
+    ctx->succeeded = 0;
+    ctx->failed = 0;
+    for (i = 0; i < WRITE_TEST_THREADS; ++i) {
+        threads[i].ctx = ctx;
+        threads[i].id = i;
+        threads[i].phase = phase;
+        ASSERT_EQUAL(pthread_create(&handles[i], NULL, write_test_thread_main, &threads[i]), 0);
+    }
+    for (i = 0; i < WRITE_TEST_THREADS; ++i) {
+        ASSERT_EQUAL(pthread_join(handles[i], NULL), 0);
+    }
+    ASSERT_TRUE(!ctx->is_failed);
+
+    return true;
+}
+
+static bool check_concurrent_writes(bool is_directional) {
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    struct write_test_ctx *ctx = NULL;
+    struct graph_vertex *v = NULL;
+    bool has_edge = false;
+    bool is_expected = false;
+    size_t edge_count = 0;
+    size_t neighbor_count = 0;
+    size_t vertex_count = 0;
+    size_t k = 0;
+
+    ctx = calloc(1, sizeof(*ctx));
+    ASSERT_TRUE(NULL != ctx);
+    for (k = 0; k < WRITE_TEST_EDGES; ++k) {
+        ctx->s_ids[k] = k % WRITE_TEST_VERTICES;
+        ctx->d_ids[k] = (ctx->s_ids[k] + 97 * (1 + k / WRITE_TEST_VERTICES)) % WRITE_TEST_VERTICES;
+    }
+
+    /* A few vertices before sharding, they move to their shards. */
+    res = GRAPH_init(is_directional, &ctx->g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    for (k = 0; k < 10; ++k) {
+        res = GRAPH_add_vertex(ctx->g, k * 3);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    }
+    res = GRAPH_enable_concurrent_writes(ctx->g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_enable_concurrent_reads(ctx->g);
+    ASSERT_EQUAL(res, GRAPH_ERR_PARAMS);
+
+    /* Each vertex and edge is added by two threads at once, exactly one of them wins. */
+    ASSERT_TRUE(run_write_test_phase(ctx, write_test_add_vertices));
+    ASSERT_EQUAL(ctx->succeeded, WRITE_TEST_VERTICES - 10);
+    ASSERT_EQUAL(ctx->failed, WRITE_TEST_VERTICES + 10);
+    ASSERT_EQUAL(ctx->g->vertex_count, WRITE_TEST_VERTICES);
+
+    ASSERT_TRUE(run_write_test_phase(ctx, write_test_add_edges));
+    ASSERT_EQUAL(ctx->succeeded, WRITE_TEST_EDGES);
+    ASSERT_EQUAL(ctx->failed, WRITE_TEST_EDGES);
+
+    ASSERT_TRUE(run_write_test_phase(ctx, write_test_remove));
+    ASSERT_EQUAL(ctx->succeeded + ctx->failed, WRITE_TEST_EDGES + (WRITE_TEST_VERTICES / 50));
+    ASSERT_EQUAL(ctx->g->vertex_count, WRITE_TEST_VERTICES - (WRITE_TEST_VERTICES / 50));
+
+    /* The odd edges whose ends both survived are left. */
+    for (k = 0; k < WRITE_TEST_EDGES; ++k) {
+        if ((0 == (ctx->s_ids[k] % 50)) || (0 == (ctx->d_ids[k] % 50))) {
+            res = GRAPH_has_edge(ctx->g, ctx->s_ids[k], ctx->d_ids[k], &has_edge);
+            ASSERT_EQUAL(res, GRAPH_ERR_NOT_FOUND);
+            continue;
+        }
+
+        is_expected = (0 != (k % 2));
+        res = GRAPH_has_edge(ctx->g, ctx->s_ids[k], ctx->d_ids[k], &has_edge);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_EQUAL(has_edge, is_expected);
+        res = GRAPH_has_edge(ctx->g, ctx->d_ids[k], ctx->s_ids[k], &has_edge);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        ASSERT_EQUAL(has_edge, is_expected && (!is_directional));
+        edge_count += is_expected ? 1 : 0;
+    }
+
+    /* The lists agree with the counts. */
+    LIST_FOREACH(v, &ctx->g->vertices, next) {
+        vertex_count++;
+        neighbor_count += v->neighbor_count;
+    }
+    ASSERT_EQUAL(vertex_count, ctx->g->vertex_count);
+    ASSERT_EQUAL(neighbor_count, is_directional ? edge_count : (edge_count * 2));
+
+    res = GRAPH_destroy(ctx->g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    free(ctx);
+
+    return true;
+}
+
+bool test_graph_concurrent_writes() {
+    ASSERT_TRUE(check_concurrent_writes(false));
+    ASSERT_TRUE(check_concurrent_writes(true));
+
+    return true;
+}
+
+#define CONN_TEST_N (48)
+
+/**
+ * @brief   The component of a vertex in the reference union-find of the connectivity test.
+ */
+static size_t conn_test_find(size_t *parents, size_t x) {
+    while (parents[x] != x) {
+        parents[x] = parents[parents[x]];
+        x = parents[x];
+    }
+    return x;
+}
+
+/**
+ * @brief   Compare GRAPH_connected on every pair of present vertices with components recomputed from the edges.
+ */
+static bool check_conn_pairs(struct graph *g, bool (*edges)[CONN_TEST_N], const bool *present) {
+    size_t parents[CONN_TEST_N];
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    bool is_connected = false;
+    size_t u = 0;
+    size_t v = 0;
+
+    for (u = 0; u < CONN_TEST_N; u++) {
+        parents[u] = u;
+    }
+    for (u = 0; u < CONN_TEST_N; u++) {
+        for (v = 0; v < CONN_TEST_N; v++) {
+            if (edges[u][v]) {
+                parents[conn_test_find(parents, u)] = conn_test_find(parents, v);
+            }
+        }
+    }
+
+    for (u = 0; u < CONN_TEST_N; u++) {
+        for (v = 0; v < CONN_TEST_N; v++) {
+            res = GRAPH_connected(g, u, v, &is_connected);
+            if (!(present[u] && present[v])) {
+                ASSERT_EQUAL(res, GRAPH_ERR_NOT_FOUND);
+                continue;
+            }
+            ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            ASSERT_EQUAL(is_connected, conn_test_find(parents, u) == conn_test_find(parents, v));
+        }
+    }
+
+    return true;
+}
+
+static bool check_connectivity(bool is_directional) {
+    struct graph *g = NULL;
+    struct counting_allocator_stats stats = {0};
+    struct graph_allocator allocator = {counting_alloc, counting_free, &stats};
+    bool edges[CONN_TEST_N][CONN_TEST_N] = {{false}};
+    bool present[CONN_TEST_N] = {false};
+    graph_res_t res = GRAPH_ERR_UNDEFINED;
+    bool is_connected = false;
+    uint64_t seed = 8086;
+    size_t phase = 0;
+    size_t step = 0;
+    size_t u = 0;
+    size_t v = 0;
+
+    res = GRAPH_init_ex(is_directional, &allocator, &g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_connected(g, 0, 0, &is_connected);
+    ASSERT_EQUAL(res, GRAPH_ERR_PARAMS);
+
+    /* The edges already there are taken in when tracking is enabled. */
+    for (u = 0; u < CONN_TEST_N; u++) {
+        res = GRAPH_add_vertex(g, u);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        present[u] = true;
+    }
+    for (u = 0; u + 1 < CONN_TEST_N / 2; u++) {
+        res = GRAPH_add_edge(g, u, u + 1, 1);
+        ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+        edges[u][u + 1] = true;
+    }
+    res = GRAPH_enable_connectivity(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    res = GRAPH_enable_concurrent_writes(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_PARAMS);
+    ASSERT_TRUE(check_conn_pairs(g, edges, present));
+
+    /* Phases of only additions, mostly removals and a mix, so the tracking goes back and forth between its modes. */
+    for (step = 0; step < 6000; step++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        u = (seed >> 20) % CONN_TEST_N;
+        v = (seed >> 40) % CONN_TEST_N;
+        phase = (step / 500) % 3;
+
+        if ((0 != phase) && (0 == ((seed >> 8) % 97))) {
+            if (present[u]) {
+                res = GRAPH_remove_vertex(g, u);
+                ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+                for (v = 0; v < CONN_TEST_N; v++) {
+                    edges[u][v] = false;
+                    edges[v][u] = false;
+                }
+            } else {
+                res = GRAPH_add_vertex(g, u);
+                ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+            }
+            present[u] = !present[u];
+        } else if ((0 == phase) || (((seed >> 8) % 10) < ((1 == phase) ? 1 : 6))) {
+            res = GRAPH_add_edge(g, u, v, 1);
+            if (GRAPH_ERR_SUCCESS == res) {
+                edges[u][v] = true;
+            }
+        } else {
+            /* Remove an edge of u, in either direction. */
+            for (v = 0; (v < CONN_TEST_N) && (!edges[u][v]) && (!edges[v][u]); v++) {
+            }
+            if (v < CONN_TEST_N) {
+                res = edges[u][v] ? GRAPH_remove_edge(g, u, v) : GRAPH_remove_edge(g, v, u);
+                ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+                if (!is_directional) {
+                    edges[u][v] = false;
+                    edges[v][u] = false;
+                } else if (edges[u][v]) {
+                    edges[u][v] = false;
+                } else {
+                    edges[v][u] = false;
+                }
+            }
+        }
+
+        if (0 == (step % 50)) {
+            ASSERT_TRUE(check_conn_pairs(g, edges, present));
+        }
+    }
+    ASSERT_TRUE(check_conn_pairs(g, edges, present));
+
+    /* A cleared graph starts over, still tracked. */
+    res = GRAPH_clear(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    (void)GRAPH_add_vertex(g, 1);
+    (void)GRAPH_add_vertex(g, 2);
+    res = GRAPH_connected(g, 1, 2, &is_connected);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_TRUE(!is_connected);
+    (void)GRAPH_add_edge(g, 2, 1, 1);
+    res = GRAPH_connected(g, 1, 2, &is_connected);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_TRUE(is_connected);
+
+    res = GRAPH_destroy(g);
+    ASSERT_EQUAL(res, GRAPH_ERR_SUCCESS);
+    ASSERT_EQUAL(stats.live_blocks, 0);
+
+    return true;
+}
+
+bool test_graph_connectivity() {
+    ASSERT_TRUE(check_connectivity(false));
+    ASSERT_TRUE(check_connectivity(true));
+
+    return true;
+}
+
+int main() {
+    SUITE_INIT(Sanity)
+        ASSERT_TEST(test_graph_init_happy_flow);
+        ASSERT_TEST(test_graph_init_bad_params);
+        ASSERT_TEST(test_graph_init_ex_allocator);
+
+        ASSERT_TEST(test_graph_add_vertex_happy_flow);
+        ASSERT_TEST(test_graph_add_vertex_already_exists);
+        ASSERT_TEST(test_graph_add_vertex_multiple);
+        ASSERT_TEST(test_graph_vertex_index_many);
+
+        ASSERT_TEST(test_graph_add_edge_happy_flow);
+        ASSERT_TEST(test_graph_add_edge_multiple);
+        ASSERT_TEST(test_graph_has_edge_hub);
+        ASSERT_TEST(test_graph_add_batches);
+        ASSERT_TEST(test_graph_clear);
+        ASSERT_TEST(test_graph_remove_vertex_edges);
+
+        ASSERT_TEST(test_graph_get_adj_matrix);
+        ASSERT_TEST(test_graph_get_adj_matrix_ids);
+        ASSERT_TEST(test_graph_get_adjacency_sparse);
+        ASSERT_TEST(test_graph_freeze);
+        ASSERT_TEST(test_graph_save_load);
+        ASSERT_TEST(test_graph_load_text);
+
+        ASSERT_TEST(test_graph_sssp_dijkstra);
+        ASSERT_TEST(test_graph_sssp_delta_stepping);
+        ASSERT_TEST(test_graph_bfs);
+        ASSERT_TEST(test_graph_connected_components);
+        ASSERT_TEST(test_graph_pagerank);
+        ASSERT_TEST(test_graph_triangles);
+        ASSERT_TEST(test_graph_all_pairs_shortest_paths);
+        ASSERT_TEST(test_graph_minimum_spanning_forest);
+        ASSERT_TEST(test_graph_strongly_connected_components);
+        ASSERT_TEST(test_graph_shortest_path);
+        ASSERT_TEST(test_graph_contraction_hierarchy);
+        ASSERT_TEST(test_graph_concurrent_reads);
+        ASSERT_TEST(test_graph_concurrent_writes);
+        ASSERT_TEST(test_graph_connectivity);
     SUITE_END(Sanity)
 }
 